@@ -0,0 +1,35 @@
+#ifndef _ASM_ARCH_TIMER_H
+#define _ASM_ARCH_TIMER_H
+
+#include <types.h>
+#include <asm/sysreg.h>
+
+/*
+ * ARM Generic Timer counter helpers.
+ *
+ * CNTVCT_EL0 is a 64-bit free-running virtual counter that is always
+ * readable from EL1. Its frequency is reported by CNTFRQ_EL0, which the
+ * firmware programs (19.2MHz on the Zero 2 W, 62.5MHz under QEMU raspi3b).
+ */
+
+/**
+ * arch_counter_get_cntvct - Read the virtual counter
+ *
+ * The isb stops the read from being speculated ahead of the code that
+ * is being timed.
+ */
+static inline uint64_t arch_counter_get_cntvct(void)
+{
+	__asm__ volatile("isb" : : : "memory");
+	return read_sysreg(cntvct_el0);
+}
+
+/**
+ * arch_timer_get_cntfrq - Counter frequency in Hz
+ */
+static inline uint32_t arch_timer_get_cntfrq(void)
+{
+	return (uint32_t)read_sysreg(cntfrq_el0);
+}
+
+#endif /* _ASM_ARCH_TIMER_H */
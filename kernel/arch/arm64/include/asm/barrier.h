@@ -0,0 +1,12 @@
+#ifndef _ASM_BARRIER_H
+#define _ASM_BARRIER_H
+
+/*
+ * Barriers and wait for interrupt. The host build replaces them
+ * (tests/host/asm/barrier.h) so that a driver that sleeps in wfi can
+ * run against a model of its device.
+ */
+#define dsb(opt)    __asm__ volatile("dsb " #opt : : : "memory")
+#define wfi()       __asm__ volatile("wfi" : : : "memory")
+
+#endif /* _ASM_BARRIER_H */
@@ -0,0 +1,23 @@
+#ifndef _ASM_CACHEFLUSH_H
+#define _ASM_CACHEFLUSH_H
+
+/*
+ * Data cache maintenance to the Point of Coherency (arch/arm64/mm/cache.S)
+ *
+ * The ranges are [start, end) kernel VAs and are widened to whole
+ * cache lines. All three complete (dsb sy) before returning.
+ */
+
+/* Write back dirty lines; the data stays cached */
+void dcache_clean_range(unsigned long start, unsigned long end);
+
+/*
+ * Discard cached lines. Lines that only partly overlap the range are
+ * written back first, so neighbouring data is never lost.
+ */
+void dcache_inval_range(unsigned long start, unsigned long end);
+
+/* Write back and discard */
+void dcache_clean_inval_range(unsigned long start, unsigned long end);
+
+#endif /* _ASM_CACHEFLUSH_H */
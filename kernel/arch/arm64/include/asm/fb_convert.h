@@ -0,0 +1,43 @@
+#ifndef _ASM_FB_CONVERT_H
+#define _ASM_FB_CONVERT_H
+
+#include <types.h>
+
+/*
+ * NEON pixel conversion kernels for drivers/video/fb_convert.c, in
+ * arch/arm64/lib/fb_convert_neon.c. They must be called inside
+ * kernel_neon_begin()/kernel_neon_end() and only cover whole vectors;
+ * the generic code does the rest of each row with the scalar version.
+ */
+#define __HAVE_ARCH_FB_CONVERT
+
+/*
+ * Below this many pixels a NEON section costs more than it saves. The
+ * fb_pack_neon_min* bench cases time the kernel against the scalar
+ * code at a quarter of, at and at four times this size.
+ */
+#define FB_NEON_MIN_PIXELS      1024
+
+/*
+ * Packs the first pixels of each row as fb_pack_gray8() does, with
+ * @bias[row % 4][column % 16] as the bias of each pixel. Returns the
+ * number of pixels done per row.
+ */
+unsigned int __fb_pack_gray8_neon(uint8_t *dst, unsigned int dst_stride,
+                                  const uint8_t *src, unsigned int src_stride,
+                                  unsigned int w, unsigned int h,
+                                  unsigned int format,
+                                  const uint8_t bias[4][16]);
+
+/*
+ * Rotates the top-left @bw x @bh pixels of a w x h image as
+ * fb_rotate_gray8() does. @bw must be a multiple of 16 and @bh of 8;
+ * FB_ROTATE_0 is not handled.
+ */
+void __fb_rotate_gray8_neon(uint8_t *dst, unsigned int dst_stride,
+                            const uint8_t *src, unsigned int src_stride,
+                            unsigned int w, unsigned int h,
+                            unsigned int bw, unsigned int bh,
+                            unsigned int rotation);
+
+#endif /* _ASM_FB_CONVERT_H */
@@ -0,0 +1,61 @@
+#ifndef _ASM_FPSIMD_H
+#define _ASM_FPSIMD_H
+
+#include <types.h>
+#include <asm/sysreg.h>
+
+/*
+ * FP/SIMD register file: 32 x 128-bit V registers plus FPSR/FPCR.
+ * Layout is shared with the save/restore code in entry-fpsimd.S.
+ */
+struct user_fpsimd_state {
+	__uint128_t	vregs[32];
+	uint32_t	fpsr;
+	uint32_t	fpcr;
+	uint32_t	__reserved[2];
+} __attribute__((aligned(16)));
+
+/*
+ * CPACR_EL1.FPEN [21:20] controls trapping of FP/SIMD instructions at
+ * EL0/EL1. 0b11 means no trapping; anything else makes FP/SIMD
+ * instructions raise an ESR_ELx_EC_FP_ASIMD exception.
+ */
+#define CPACR_EL1_FPEN_SHIFT	20
+#define CPACR_EL1_FPEN		(3UL << CPACR_EL1_FPEN_SHIFT)
+
+void fpsimd_save_state(struct user_fpsimd_state *state);
+void fpsimd_load_state(struct user_fpsimd_state *state);
+
+struct task_struct;
+
+/*
+ * Lazy FP/SIMD switching (fpsimd.c)
+ *
+ * fpsimd_thread_switch() is called by the scheduler before switching to
+ * @next; do_fpsimd_acc() handles the FP/SIMD access trap taken when a
+ * task that does not own the registers executes an FP instruction.
+ * fpsimd_flush_task_state() forgets any register copy held for an
+ * exiting task.
+ */
+void fpsimd_thread_switch(struct task_struct *next);
+void fpsimd_flush_task_state(struct task_struct *tsk);
+int do_fpsimd_acc(void);
+
+static inline int fpsimd_is_enabled(void)
+{
+	return (read_sysreg(cpacr_el1) & CPACR_EL1_FPEN) == CPACR_EL1_FPEN;
+}
+
+static inline void fpsimd_enable(void)
+{
+	write_sysreg(read_sysreg(cpacr_el1) | CPACR_EL1_FPEN, cpacr_el1);
+	__asm__ volatile("isb" : : : "memory");
+}
+
+static inline void fpsimd_disable(void)
+{
+	write_sysreg(read_sysreg(cpacr_el1) & ~CPACR_EL1_FPEN, cpacr_el1);
+	__asm__ volatile("isb" : : : "memory");
+}
+
+#endif /* _ASM_FPSIMD_H */
@@ -0,0 +1,31 @@
+#ifndef _ASM_IO_H
+#define _ASM_IO_H
+
+#include <types.h>
+#include <asm/memory.h>
+
+/*
+ * Peripheral addresses
+ *
+ * Drivers access MMIO through the kernel half: boot.S and paging_init()
+ * both map the GPU and local peripherals at KERNEL_VA_BASE + PA, so the
+ * same address works before and after the switch to swapper_pg_dir and
+ * does not depend on the TTBR0 identity map.
+ */
+#define IO_ADDRESS(pa)      ((uintptr_t)(pa) + KERNEL_VA_BASE)
+
+/*
+ * 32-bit register accessors. The host build replaces them so tests can
+ * put a model of a device behind its registers (tests/host/asm/io.h).
+ */
+static inline uint32_t readl(uintptr_t addr)
+{
+    return *(volatile uint32_t *)addr;
+}
+
+static inline void writel(uint32_t val, uintptr_t addr)
+{
+    *(volatile uint32_t *)addr = val;
+}
+
+#endif /* _ASM_IO_H */
@@ -0,0 +1,16 @@
+#ifndef _ASM_IRQ_H
+#define _ASM_IRQ_H
+
+#include <asm/smp.h>
+
+/*
+ * Per-CPU IRQ stacks
+ *
+ * IRQ handlers run on a dedicated stack per CPU instead of the stack of
+ * whatever thread they interrupted, so thread stacks only need to cover
+ * one exception frame on top of their own usage. Defined in exceptions.S.
+ */
+#define IRQ_STACK_SHIFT     14
+#define IRQ_STACK_SIZE      (1 << IRQ_STACK_SHIFT)     /* 16KB */
+
+#endif /* _ASM_IRQ_H */
@@ -40,6 +40,12 @@ static inline unsigned long local_irq_save(void)
     return flags;
 }
 
+/* Whether @flags, as saved by local_irq_save(), had IRQs masked */
+static inline int irqs_disabled_flags(unsigned long flags)
+{
+    return (flags >> 7) & 1;     /* PSTATE.I, bit 7 of DAIF */
+}
+
 /* Restore DAIF from saved flags */
 static inline void local_irq_restore(unsigned long flags)
 {
@@ -0,0 +1,41 @@
+#ifndef _ASM_MEMORY_H
+#define _ASM_MEMORY_H
+
+#include <asm/mmu.h>
+
+#define PAGE_SHIFT          L3_SHIFT
+#define PAGE_SIZE           L3_SIZE
+#define PAGE_MASK           (~(PAGE_SIZE - 1))
+#define PAGE_ALIGN(x)       (((x) + PAGE_SIZE - 1) & PAGE_MASK)
+
+/*
+ * Top of the RAM handed to the ARM cores when the device tree has no
+ * memory node. With the default 64MB GPU memory split on a 512MB board
+ * the firmware keeps 0x1C000000 and up.
+ */
+#define RAM_END_PA          _UL(0x1C000000)
+
+/*
+ * Highest end of RAM the linear map can cover. The DMA coherent window
+ * sits right above it.
+ */
+#define RAM_MAX_PA          _UL(0x30000000)
+
+/*
+ * Uncached window for the DMA coherent pool (kernel/dma/coherent.c),
+ * between the end of the linear map and the peripherals.
+ */
+#define DMA_COHERENT_BASE   (KERNEL_VA_BASE + RAM_MAX_PA)
+
+#ifndef __ASSEMBLY__
+
+/*
+ * Kernel linear map: all of RAM is mapped at KERNEL_VA_BASE + PA, and
+ * the kernel image itself is linked inside it at the same offset.
+ */
+#define __pa(x)             ((unsigned long)(x) - KERNEL_VA_BASE)
+#define __va(x)             ((void *)((unsigned long)(x) + KERNEL_VA_BASE))
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* _ASM_MEMORY_H */
@@ -34,6 +34,7 @@
  */
 
 /* TCR_EL1 field shifts */
+#define TCR_AS_SHIFT      36
 #define TCR_PS_SHIFT      32
 #define TCR_TG1_SHIFT     30
 #define TCR_SH1_SHIFT     28
@@ -83,10 +84,24 @@
 #define TCR_EPD_ENABLE   0
 #define TCR_EPD_DISABLE  1
 
+#define TCR_EPD0         (_UL(1) << TCR_EPD0_SHIFT)
+#define TCR_EPD1         (_UL(1) << TCR_EPD1_SHIFT)
+
 /* ASID Selection */
 #define TCR_ASID_TTBR0   0
 #define TCR_ASID_TTBR1   1
 
+/* ASID size: 0 = 8 bits, 1 = 16 bits (if ID_AA64MMFR0_EL1.ASIDBits allows) */
+#define TCR_AS           (_UL(1) << TCR_AS_SHIFT)
+
+/* ID_AA64MMFR0_EL1.ASIDBits */
+#define ID_AA64MMFR0_ASIDBITS_SHIFT  4
+#define ID_AA64MMFR0_ASIDBITS_8      0b0000
+#define ID_AA64MMFR0_ASIDBITS_16     0b0010
+
+/* TTBRx_EL1.ASID */
+#define TTBR_ASID_SHIFT  48
+
 /* Physical Address Size - PS */
 #define TCR_T0SZ_48BIT   16
 #define TCR_T1SZ_48BIT   16
@@ -119,10 +134,12 @@
  */
 #define MAIR_ATTR_DEVICE_nGnRE    0x00    /* Device-nGnRE memory */
 #define MAIR_ATTR_NORMAL_WB_RA_WA 0xFF    /* Normal Memory */
+#define MAIR_ATTR_NORMAL_NC       0x44    /* Normal Memory, Non-cacheable */
 
 #define MAIR_EL1_VALUE ( \
     (MAIR_ATTR_DEVICE_nGnRE    << 0)  | /* AttrIdx 0 */ \
-    (MAIR_ATTR_NORMAL_WB_RA_WA << 8)    /* AttrIdx 1 */ \
+    (MAIR_ATTR_NORMAL_WB_RA_WA << 8)  | /* AttrIdx 1 */ \
+    (MAIR_ATTR_NORMAL_NC       << 16)   /* AttrIdx 2 */ \
 )
 
 /*
@@ -130,7 +147,16 @@
  */
 #define PTE_TYPE_BLOCK   0x1UL   /* bits[1:0] = 01 */
 #define PTE_TYPE_TABLE   0x3UL   /* bits[1:0] = 11 */
+#define PTE_TYPE_PAGE    0x3UL   /* bits[1:0] = 11 at level 3 */
+#define PTE_TYPE_MASK    0x3UL
+#define PTE_VALID        0x1UL
 
+/* Output address / next-level table address, bits [47:12] */
+#define PTE_ADDR_MASK    0x0000FFFFFFFFF000UL
+
+#define PTE_USER         (1UL << 6)    /* AP[1]: accessible from EL0 */
+#define PTE_RDONLY       (1UL << 7)    /* AP[2]: read-only */
+#define PTE_NG           (1UL << 11)   /* Not global: tagged with the ASID */
 #define PTE_AF           (1UL << 10)   /* Access Flag */
 
 /* Shareability */
@@ -140,11 +166,20 @@
 /* AttrIndx (matches MAIR_EL1) */
 #define PTE_ATTR_DEVICE  (0UL << 2)
 #define PTE_ATTR_NORMAL  (1UL << 2)
+#define PTE_ATTR_NORMAL_NC (2UL << 2)
 
 /* Execute-never */
 #define PTE_PXN          (1UL << 53)
 #define PTE_UXN          (1UL << 54)
 
+/*
+ * Contiguous hint: set on each of 16 adjacent, aligned entries that map
+ * a physically contiguous range with identical attributes, so the TLB
+ * can cache the whole run (64KB of pages or 32MB of blocks) as one entry.
+ */
+#define PTE_CONT         (1UL << 52)
+#define CONT_PTES        16
+
 #define PTE_BLOCK_DEVICE ( \
     PTE_TYPE_BLOCK | \
     PTE_AF         | \
@@ -0,0 +1,49 @@
+#ifndef _ASM_MMU_CONTEXT_H
+#define _ASM_MMU_CONTEXT_H
+
+#include <kernel/mm_types.h>
+#include <asm/memory.h>
+#include <asm/mmu.h>
+#include <asm/sysreg.h>
+
+/*
+ * TTBR0 management
+ *
+ * With no user address space active, TCR_EL1.EPD0 is set: TLB misses on
+ * the lower half fault straight away instead of walking any table, and
+ * TTBR0 points nowhere.
+ */
+
+static inline void cpu_set_reserved_ttbr0(void)
+{
+    write_sysreg(read_sysreg(tcr_el1) | TCR_EPD0, tcr_el1);
+    __asm__ volatile("isb" : : : "memory");
+    write_sysreg(0, ttbr0_el1);
+    __asm__ volatile("isb" : : : "memory");
+}
+
+static inline void cpu_switch_mm(pte_t *pgd, unsigned long asid)
+{
+    write_sysreg(__pa(pgd) | (asid << TTBR_ASID_SHIFT), ttbr0_el1);
+    __asm__ volatile("isb" : : : "memory");
+    write_sysreg(read_sysreg(tcr_el1) & ~TCR_EPD0, tcr_el1);
+    __asm__ volatile("isb" : : : "memory");
+}
+
+/*
+ * asid_init - Size the ASID space from ID_AA64MMFR0_EL1.ASIDBits
+ *
+ * Enables 16-bit ASIDs in TCR_EL1 when the CPU has them. Must run
+ * before the first user address space is switched to.
+ */
+void asid_init(void);
+
+/*
+ * switch_mm - Install @next's address space on this CPU
+ *
+ * Called by the scheduler when the incoming task's mm differs from the
+ * outgoing one. @next may be NULL for a kernel thread.
+ */
+void switch_mm(struct mm_struct *prev, struct mm_struct *next);
+
+#endif /* _ASM_MMU_CONTEXT_H */
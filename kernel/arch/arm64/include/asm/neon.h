@@ -0,0 +1,22 @@
+#ifndef _ASM_NEON_H
+#define _ASM_NEON_H
+
+/*
+ * Kernel-mode NEON
+ *
+ * The kernel is built with -mgeneral-regs-only, so C code never touches
+ * the FP/SIMD registers and FP/SIMD access is normally disabled at EL1.
+ * Code that wants to use NEON (hand-written assembly, or files built
+ * without -mgeneral-regs-only) must bracket it with
+ * kernel_neon_begin()/kernel_neon_end(). These enable FP/SIMD access and
+ * preserve any FP/SIMD state that was live before the section.
+ *
+ * Sections do not nest and are not allowed in interrupt context:
+ * check may_use_simd() first and fall back to scalar code if it fails.
+ */
+
+int may_use_simd(void);
+void kernel_neon_begin(void);
+void kernel_neon_end(void);
+
+#endif /* _ASM_NEON_H */
@@ -0,0 +1,69 @@
+#ifndef _ASM_PGTABLE_H
+#define _ASM_PGTABLE_H
+
+#include <types.h>
+#include <asm/mmu.h>
+#include <asm/memory.h>
+
+/*
+ * Kernel page tables (4KB granule, 4 levels, 48-bit VA)
+ *
+ * Every level uses the same 512-entry, 64-bit descriptor format, so a
+ * single pte_t type is used for all of them.
+ */
+typedef uint64_t pte_t;
+
+#define PTRS_PER_TABLE      512
+
+/* Attribute sets for map_pages(), without the descriptor type bits */
+#define PROT_DEFAULT        (PTE_AF | PTE_SH_INNER)
+
+#define PAGE_KERNEL         (PROT_DEFAULT | PTE_ATTR_NORMAL | PTE_PXN | PTE_UXN)
+#define PAGE_KERNEL_RO      (PAGE_KERNEL | PTE_RDONLY)
+#define PAGE_KERNEL_ROX     (PROT_DEFAULT | PTE_ATTR_NORMAL | PTE_RDONLY | PTE_UXN)
+#define PAGE_KERNEL_DEVICE  (PTE_AF | PTE_SH_OUTER | PTE_ATTR_DEVICE | PTE_PXN | PTE_UXN)
+
+/* Uncached normal memory, for buffers shared with DMA masters */
+#define PAGE_KERNEL_NC      (PROT_DEFAULT | PTE_ATTR_NORMAL_NC | PTE_PXN | PTE_UXN)
+
+/* User (TTBR0) mappings are non-global so they never outlive their mm */
+#define PAGE_USER           (PROT_DEFAULT | PTE_NG | PTE_ATTR_NORMAL | PTE_USER | PTE_PXN | PTE_UXN)
+#define PAGE_USER_RO        (PAGE_USER | PTE_RDONLY)
+#define PAGE_USER_ROX       (PROT_DEFAULT | PTE_NG | PTE_ATTR_NORMAL | PTE_USER | PTE_RDONLY | PTE_PXN)
+
+/* Kernel (TTBR1) page tables, set up by paging_init() */
+extern pte_t *swapper_pg_dir;
+
+/*
+ * map_pages - Map [va, va + size) to [pa, pa + size) in @pgd
+ * @prot: One of the PAGE_KERNEL* attribute sets
+ *
+ * Uses 2MB blocks wherever va, pa and the remaining size allow and 4KB
+ * pages elsewhere, setting the contiguous hint on aligned runs of 16.
+ * Missing tables come from the page allocator; an existing block that
+ * is only partially covered is split into pages. Existing mappings are
+ * replaced break-before-make. Returns 0, or -1 if a table could not be
+ * allocated.
+ */
+int map_pages(pte_t *pgd, unsigned long va, unsigned long pa,
+              unsigned long size, uint64_t prot);
+
+/*
+ * unmap_pages - Remove the mappings for [va, va + size) from @pgd
+ *
+ * Blocks only partially covered are split first. Tables left empty are
+ * not freed. Returns 0, or -1 if a block could not be split.
+ */
+int unmap_pages(pte_t *pgd, unsigned long va, unsigned long size);
+
+/*
+ * paging_init - Build swapper_pg_dir and switch TTBR1 to it
+ *
+ * Replaces the 2MB-block boot mapping of the kernel half with one that
+ * maps text read-only/executable, rodata read-only and everything else
+ * non-executable, then disables the boot identity map in TTBR0. The
+ * page allocator must be initialised first.
+ */
+void paging_init(void);
+
+#endif /* _ASM_PGTABLE_H */
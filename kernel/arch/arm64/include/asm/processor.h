@@ -0,0 +1,44 @@
+#ifndef _ASM_PROCESSOR_H
+#define _ASM_PROCESSOR_H
+
+#include <types.h>
+#include <asm/fpsimd.h>
+
+/*
+ * Callee-saved register context of a sleeping kernel thread.
+ *
+ * Only x19-x28, the frame pointer, the stack pointer and the resume
+ * address need to survive a call to cpu_switch_to(); everything else is
+ * caller-saved under the AAPCS64. Layout is shared with switch_to.S.
+ */
+struct cpu_context {
+	unsigned long x19;
+	unsigned long x20;
+	unsigned long x21;
+	unsigned long x22;
+	unsigned long x23;
+	unsigned long x24;
+	unsigned long x25;
+	unsigned long x26;
+	unsigned long x27;
+	unsigned long x28;
+	unsigned long fp;
+	unsigned long sp;
+	unsigned long pc;
+};
+
+/*
+ * Per-thread architecture state.
+ *
+ * FP/SIMD registers are switched lazily (see fpsimd.c): @fpsimd_state is
+ * only up to date while the thread does not own the CPU's FP registers.
+ * @fpsimd_count counts how many times the thread trapped on its first
+ * FP/SIMD instruction after being switched in and had its state loaded.
+ */
+struct thread_struct {
+	struct cpu_context		cpu_context;	/* Must be first */
+	struct user_fpsimd_state	fpsimd_state;
+	unsigned long			fpsimd_count;
+};
+
+#endif /* _ASM_PROCESSOR_H */
@@ -0,0 +1,15 @@
+#ifndef _ASM_SECTIONS_H
+#define _ASM_SECTIONS_H
+
+/*
+ * Kernel image boundaries from linker.ld, all page aligned.
+ *
+ *   _stext .. _etext                 : vectors and code (read-only, executable)
+ *   __start_rodata .. __end_rodata   : read-only data
+ *   _sdata .. _end                   : data, BSS and bootstrap stack
+ */
+extern char _stext[], _etext[];
+extern char __start_rodata[], __end_rodata[];
+extern char _sdata[], _end[];
+
+#endif /* _ASM_SECTIONS_H */
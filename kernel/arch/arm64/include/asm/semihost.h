@@ -0,0 +1,36 @@
+#ifndef _ASM_SEMIHOST_H
+#define _ASM_SEMIHOST_H
+
+#include <types.h>
+
+/*
+ * Arm semihosting calls.
+ *
+ * Only usable when running under a debugger or an emulator started with
+ * semihosting enabled (qemu-system-aarch64 -semihosting). On real
+ * hardware the HLT instruction is UNDEFINED at EL1 and ends up in the
+ * synchronous exception handler.
+ */
+#define SEMIHOST_SYS_EXIT               0x18
+#define ADP_STOPPED_APPLICATION_EXIT    0x20026
+
+static inline void semihost_call(uint64_t op, uint64_t arg)
+{
+	register uint64_t x0 __asm__("x0") = op;
+	register uint64_t x1 __asm__("x1") = arg;
+
+	__asm__ volatile("hlt #0xf000" : "+r" (x0) : "r" (x1) : "memory");
+}
+
+/**
+ * semihost_exit - Ask the host to stop the emulator
+ * @code: Exit status reported by the emulator process
+ */
+static inline void semihost_exit(int code)
+{
+	uint64_t block[2] = { ADP_STOPPED_APPLICATION_EXIT, (uint64_t)code };
+
+	semihost_call(SEMIHOST_SYS_EXIT, (uint64_t)block);
+}
+
+#endif /* _ASM_SEMIHOST_H */
@@ -1,6 +1,11 @@
 #ifndef _ASM_SMP_H
 #define _ASM_SMP_H
 
+/* Quad-core Cortex-A53 */
+#define NR_CPUS     4
+
+#ifndef __ASSEMBLY__
+
 #include <asm/sysreg.h>
 
 /*
@@ -22,4 +27,6 @@ static inline unsigned int smp_processor_id(void)
     return (unsigned int)(mpidr & 0x3);
 }
 
-#endif
\ No newline at end of file
+#endif /* __ASSEMBLY__ */
+
+#endif /* _ASM_SMP_H */
@@ -0,0 +1,27 @@
+#ifndef _ASM_STRING_H
+#define _ASM_STRING_H
+
+#include <types.h>
+
+/*
+ * Optimised AArch64 versions in arch/arm64/lib replace the generic C
+ * implementations in lib/string.c.
+ */
+#define __HAVE_ARCH_MEMCPY
+#define __HAVE_ARCH_MEMMOVE
+#define __HAVE_ARCH_MEMSET
+#define __HAVE_ARCH_MEMCMP
+#define __HAVE_ARCH_STRLEN
+
+/*
+ * NEON bulk variants. The double-underscore versions must be called
+ * inside kernel_neon_begin()/kernel_neon_end(). The plain versions do
+ * that themselves and fall back to memcpy/memset when NEON is not
+ * usable or the buffer is too small to be worth it.
+ */
+void *__memcpy_neon(void *dest, const void *src, size_t n);
+void *__memset_neon(void *s, int c, size_t n);
+void *memcpy_neon(void *dest, const void *src, size_t n);
+void *memset_neon(void *s, int c, size_t n);
+
+#endif /* _ASM_STRING_H */
@@ -0,0 +1,146 @@
+#ifndef _ASM_TLBFLUSH_H
+#define _ASM_TLBFLUSH_H
+
+#include <kernel/mm_types.h>
+#include <asm/memory.h>
+#include <asm/mmu.h>
+
+/*
+ * TLB maintenance
+ *
+ * All invalidations use the Inner Shareable (IS) TLBI forms, which the
+ * hardware broadcasts to every core, so page table changes never need
+ * an IPI shootdown. The leading dsb makes page table updates visible to
+ * the table walker before the invalidation; the trailing dsb/isb wait
+ * for it to complete on all cores.
+ *
+ * Range flushes issue one TLBI per @stride bytes between a single pair
+ * of barriers. Beyond MAX_TLBI_OPS entries one ASID-wide (user) or full
+ * (kernel) invalidation is cheaper than the loop.
+ */
+
+#define MAX_TLBI_OPS    PTRS_PER_TABLE
+
+/* ASID of @mm as it sits in TTBR0 and in TLBI operands */
+#define ASID(mm)        ((mm)->context_id & 0xffffUL)
+
+#define __tlbi(op, arg) \
+    __asm__ volatile("tlbi " #op ", %0" : : "r" (arg) : "memory")
+
+/* TLBI operand: VA[55:12] in bits [43:0], ASID in bits [63:48] */
+static inline unsigned long __tlbi_vaddr(unsigned long va, unsigned long asid)
+{
+    return ((va >> PAGE_SHIFT) & ((1UL << 44) - 1)) | (asid << TTBR_ASID_SHIFT);
+}
+
+static inline void flush_tlb_all(void)
+{
+    __asm__ volatile(
+        "dsb    ishst\n"
+        "tlbi   vmalle1is\n"
+        "dsb    ish\n"
+        "isb"
+        : : : "memory");
+}
+
+/* This CPU only, e.g. after dropping the boot identity map */
+static inline void local_flush_tlb_all(void)
+{
+    __asm__ volatile(
+        "dsb    nshst\n"
+        "tlbi   vmalle1\n"
+        "dsb    nsh\n"
+        "isb"
+        : : : "memory");
+}
+
+/* Every entry tagged with @mm's ASID */
+static inline void flush_tlb_mm(struct mm_struct *mm)
+{
+    __asm__ volatile("dsb ishst" : : : "memory");
+    __tlbi(aside1is, __tlbi_vaddr(0, ASID(mm)));
+    __asm__ volatile("dsb ish\n isb" : : : "memory");
+}
+
+/*
+ * __flush_tlb_range - Invalidate [start, end) of @mm, one TLBI per @stride
+ *
+ * @last_level: only leaf entries changed, so cached table walks (the
+ * intermediate levels) may be kept.
+ */
+static inline void __flush_tlb_range(struct mm_struct *mm, unsigned long start,
+                                     unsigned long end, unsigned long stride,
+                                     int last_level)
+{
+    unsigned long asid = ASID(mm);
+    unsigned long va;
+
+    start &= ~(stride - 1);
+    if ((end - start) / stride > MAX_TLBI_OPS) {
+        flush_tlb_mm(mm);
+        return;
+    }
+
+    __asm__ volatile("dsb ishst" : : : "memory");
+    for (va = start; va < end; va += stride) {
+        if (last_level)
+            __tlbi(vale1is, __tlbi_vaddr(va, asid));
+        else
+            __tlbi(vae1is, __tlbi_vaddr(va, asid));
+    }
+    __asm__ volatile("dsb ish\n isb" : : : "memory");
+}
+
+static inline void flush_tlb_range(struct mm_struct *mm, unsigned long start,
+                                   unsigned long end)
+{
+    __flush_tlb_range(mm, start, end, PAGE_SIZE, 0);
+}
+
+static inline void flush_tlb_page(struct mm_struct *mm, unsigned long va)
+{
+    __asm__ volatile("dsb ishst" : : : "memory");
+    __tlbi(vale1is, __tlbi_vaddr(va, ASID(mm)));
+    __asm__ volatile("dsb ish\n isb" : : : "memory");
+}
+
+/*
+ * __flush_tlb_kernel_range - Invalidate [start, end) for all ASIDs
+ *
+ * Used for the kernel half (global entries) and by the page table code,
+ * which does not know which ASID a user table belongs to.
+ */
+static inline void __flush_tlb_kernel_range(unsigned long start, unsigned long end,
+                                            unsigned long stride, int last_level)
+{
+    unsigned long va;
+
+    start &= ~(stride - 1);
+    if ((end - start) / stride > MAX_TLBI_OPS) {
+        flush_tlb_all();
+        return;
+    }
+
+    __asm__ volatile("dsb ishst" : : : "memory");
+    for (va = start; va < end; va += stride) {
+        if (last_level)
+            __tlbi(vaale1is, __tlbi_vaddr(va, 0));
+        else
+            __tlbi(vaae1is, __tlbi_vaddr(va, 0));
+    }
+    __asm__ volatile("dsb ish\n isb" : : : "memory");
+}
+
+static inline void flush_tlb_kernel_range(unsigned long start, unsigned long end)
+{
+    __flush_tlb_kernel_range(start, end, PAGE_SIZE, 0);
+}
+
+static inline void flush_tlb_kernel_page(unsigned long va)
+{
+    __asm__ volatile("dsb ishst" : : : "memory");
+    __tlbi(vaale1is, __tlbi_vaddr(va, 0));
+    __asm__ volatile("dsb ish\n isb" : : : "memory");
+}
+
+#endif /* _ASM_TLBFLUSH_H */
@@ -3,6 +3,15 @@
 
 #include <types.h>
 
+/*
+ * Exception types passed to exception_handler_c, matching the slot
+ * order of the vector table in exceptions.S
+ */
+#define EXC_EL1T_SYNC       0   /* Current EL with SP_EL0 */
+#define EXC_EL1H_SYNC       4   /* Current EL with SP_ELx */
+#define EXC_EL0_64_SYNC     8   /* Lower EL, AArch64 */
+#define EXC_EL0_32_SYNC     12  /* Lower EL, AArch32 */
+
 /*
  * Core exception handling functions
  */
@@ -3,6 +3,7 @@
 #include <exception.h>
 #include <asm/sysreg.h>
 #include <asm/esr.h>
+#include <asm/fpsimd.h>
 
 static const char *exception_names[] = {
     "Current EL with SP_EL0 - Sync",
@@ -116,49 +117,49 @@ void dump_exception_info(uint32_t type, uint64_t esr, uint64_t elr,
     char hex_buf[19];
     uint32_t ec = ESR_ELx_EC(esr);
     
-    uart_poll_puts("\n");
-    uart_poll_puts("======================================\n");
-    uart_poll_puts("EXCEPTION OCCURRED!\n");
-    uart_poll_puts("======================================\n");
+    uart_sync_puts("\n");
+    uart_sync_puts("======================================\n");
+    uart_sync_puts("EXCEPTION OCCURRED!\n");
+    uart_sync_puts("======================================\n");
     
     /* Exception vector entry */
-    uart_poll_puts("Vector: ");
-    uart_poll_puts(exception_type_string(type));
-    uart_poll_puts("\n");
+    uart_sync_puts("Vector: ");
+    uart_sync_puts(exception_type_string(type));
+    uart_sync_puts("\n");
     
     /* Exception class from ESR */
-    uart_poll_puts("Class:  ");
-    uart_poll_puts(esr_get_class_string(esr));
-    uart_poll_puts(" (EC=0x");
+    uart_sync_puts("Class:  ");
+    uart_sync_puts(esr_get_class_string(esr));
+    uart_sync_puts(" (EC=0x");
     /* Print EC in hex (2 digits) */
     hex_buf[0] = "0123456789ABCDEF"[(ec >> 4) & 0xF];
     hex_buf[1] = "0123456789ABCDEF"[ec & 0xF];
     hex_buf[2] = ')';
     hex_buf[3] = '\0';
-    uart_poll_puts(hex_buf);
-    uart_poll_puts("\n");
+    uart_sync_puts(hex_buf);
+    uart_sync_puts("\n");
     
-    uart_poll_puts("ESR_EL1:  ");
+    uart_sync_puts("ESR_EL1:  ");
     uint64_to_hex(esr, hex_buf);
-    uart_poll_puts(hex_buf);
-    uart_poll_puts("\n");
+    uart_sync_puts(hex_buf);
+    uart_sync_puts("\n");
     
-    uart_poll_puts("ELR_EL1:  ");
+    uart_sync_puts("ELR_EL1:  ");
     uint64_to_hex(elr, hex_buf);
-    uart_poll_puts(hex_buf);
-    uart_poll_puts(" (PC at exception)\n");
+    uart_sync_puts(hex_buf);
+    uart_sync_puts(" (PC at exception)\n");
     
-    uart_poll_puts("SPSR_EL1: ");
+    uart_sync_puts("SPSR_EL1: ");
     uint64_to_hex(spsr, hex_buf);
-    uart_poll_puts(hex_buf);
-    uart_poll_puts("\n");
+    uart_sync_puts(hex_buf);
+    uart_sync_puts("\n");
     
-    uart_poll_puts("FAR_EL1:  ");
+    uart_sync_puts("FAR_EL1:  ");
     uint64_to_hex(far, hex_buf);
-    uart_poll_puts(hex_buf);
-    uart_poll_puts(" (Fault address)\n");
+    uart_sync_puts(hex_buf);
+    uart_sync_puts(" (Fault address)\n");
     
-    uart_poll_puts("======================================\n");
+    uart_sync_puts("======================================\n");
 }
 
 /**
@@ -176,12 +177,34 @@ void exception_handler_c(uint32_t type)
     elr  = read_elr_el1();
     spsr = read_spsr_el1();
     far  = read_far_el1();
+
+    /* Exceptions from the current EL that can be handled and returned from */
+    if (type == EXC_EL1H_SYNC) {
+        switch (ESR_ELx_EC(esr)) {
+        case ESR_ELx_EC_SVC64:
+            /*
+             * SVC from EL1 is a null trap (used by the exception
+             * round-trip benchmark). ELR_EL1 already points past the
+             * svc instruction, so just return.
+             */
+            return;
+        case ESR_ELx_EC_FP_ASIMD:
+            /*
+             * FP/SIMD access trap: the task does not own the FP
+             * registers yet. Load its state and re-execute the
+             * instruction.
+             */
+            if (do_fpsimd_acc() == 0)
+                return;
+            break;
+        }
+    }
     
     /* Display exception information */
     dump_exception_info(type, esr, elr, spsr, far);
     
     /* Halt the system */
-    uart_poll_puts("System halted.\n");
+    uart_sync_puts("System halted.\n");
     for (;;) {
         __asm__ volatile("wfe");
     }
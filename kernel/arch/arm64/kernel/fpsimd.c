@@ -0,0 +1,114 @@
+/*
+ * FP/SIMD support: lazy context switching and kernel-mode NEON
+ *
+ * FP/SIMD access at EL1 is disabled by default (CPACR_EL1.FPEN), so an
+ * FP instruction traps with ESR_ELx_EC_FP_ASIMD unless the running task
+ * owns the CPU's FP registers.
+ *
+ * Context switches never touch the 512-byte register file. Each CPU
+ * remembers which task's state its registers hold (fpsimd_last_state).
+ * On a switch, FP access is left enabled only if the incoming task is
+ * that owner; anyone else traps on first use, and do_fpsimd_acc() then
+ * saves the old owner's registers and loads the new task's. Tasks that
+ * never use FP/SIMD therefore never pay for it, and a task switching
+ * back to a CPU where its registers are still live reloads nothing.
+ *
+ * kernel_neon_begin() claims the registers for a kernel-mode NEON
+ * section: the owner's state is saved to its task and ownership is
+ * dropped, so the owner reloads lazily when it next uses FP.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/irq.h>
+#include <kernel/sched.h>
+#include <asm/fpsimd.h>
+#include <asm/neon.h>
+#include <asm/smp.h>
+
+/* Task whose FP/SIMD state is live in each CPU's registers, if any */
+static struct task_struct *fpsimd_last_state[NR_CPUS];
+
+/* Inside a kernel_neon_begin/end section */
+static int kernel_neon_busy[NR_CPUS];
+
+void fpsimd_thread_switch(struct task_struct *next)
+{
+    int owner = fpsimd_last_state[smp_processor_id()] == next;
+
+    if (owner != fpsimd_is_enabled()) {
+        if (owner)
+            fpsimd_enable();
+        else
+            fpsimd_disable();
+    }
+}
+
+void fpsimd_flush_task_state(struct task_struct *tsk)
+{
+    unsigned int cpu = smp_processor_id();
+
+    if (fpsimd_last_state[cpu] == tsk)
+        fpsimd_last_state[cpu] = NULL;
+}
+
+/*
+ * do_fpsimd_acc - FP/SIMD access trap from EL1
+ *
+ * Makes the registers hold the current task's state and enables access;
+ * the trapping instruction is then re-executed. Returns -1 if the trap
+ * came from a context that must not use FP (an IRQ handler), in which
+ * case the caller treats it as a fatal exception.
+ */
+int do_fpsimd_acc(void)
+{
+    unsigned int cpu = smp_processor_id();
+    struct task_struct *tsk = current;
+    struct task_struct *owner = fpsimd_last_state[cpu];
+
+    if (in_interrupt())
+        return -1;
+
+    fpsimd_enable();
+
+    if (owner != tsk) {
+        if (owner)
+            fpsimd_save_state(&owner->thread.fpsimd_state);
+        fpsimd_load_state(&tsk->thread.fpsimd_state);
+        fpsimd_last_state[cpu] = tsk;
+    }
+
+    tsk->thread.fpsimd_count++;
+    return 0;
+}
+
+int may_use_simd(void)
+{
+    return !in_interrupt() && !kernel_neon_busy[smp_processor_id()];
+}
+
+void kernel_neon_begin(void)
+{
+    unsigned int cpu = smp_processor_id();
+    struct task_struct *owner = fpsimd_last_state[cpu];
+
+    kernel_neon_busy[cpu] = 1;
+
+    if (!fpsimd_is_enabled())
+        fpsimd_enable();
+
+    if (owner) {
+        /* Somebody's registers are live: preserve them in their task */
+        fpsimd_save_state(&owner->thread.fpsimd_state);
+        fpsimd_last_state[cpu] = NULL;
+    }
+}
+
+void kernel_neon_end(void)
+{
+    unsigned int cpu = smp_processor_id();
+
+    /* Registers now hold no task's state; the next FP user reloads */
+    fpsimd_disable();
+    kernel_neon_busy[cpu] = 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * NEON pixel conversion kernels
+ *
+ * Built without -mgeneral-regs-only, so the compiler may use the FP/SIMD
+ * registers anywhere in this file: everything here must only be called
+ * between kernel_neon_begin() and kernel_neon_end(), which the callers
+ * in drivers/video/fb_convert.c take care of.
+ *
+ * Packing quantises 16 pixels at a time with a widening multiply-add,
+ * exactly as the scalar code does, then multiplies every level by its
+ * place value within the output byte (128, 64, ... for 1 bit per pixel)
+ * and folds neighbouring lanes together with pairwise adds until each
+ * lane holds one output byte. No sum can carry out of a lane.
+ *
+ * Rotation by 90 and 270 degrees transposes 8x8 blocks in registers
+ * with three rounds of TRN at 8, 16 and 32-bit granularity; 180 degrees
+ * reverses 16-byte runs.
+ */
+
+#include <arm_neon.h>
+#include <types.h>
+#include <kernel/fb_convert.h>
+#include <asm/fb_convert.h>
+
+static const uint8_t mono1_weights[16] = {
+    128, 64, 32, 16, 8, 4, 2, 1, 128, 64, 32, 16, 8, 4, 2, 1,
+};
+
+static const uint8_t gray2_weights[16] = {
+    64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1,
+};
+
+static const uint8_t gray4_weights[16] = {
+    16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1,
+};
+
+/* (g * steps + bias) >> 8 for 16 pixels */
+static inline uint8x16_t quantise(uint8x16_t g, uint8x16_t steps,
+                                  uint8x16_t bias)
+{
+    uint16x8_t lo = vmull_u8(vget_low_u8(g), vget_low_u8(steps));
+    uint16x8_t hi = vmull_high_u8(g, steps);
+
+    lo = vaddw_u8(lo, vget_low_u8(bias));
+    hi = vaddw_high_u8(hi, bias);
+    return vshrn_high_n_u16(vshrn_n_u16(lo, 8), hi, 8);
+}
+
+/* Levels of 16 pixels, each already shifted to its place in the byte */
+static inline uint8x16_t pack_load(const uint8_t *src, uint8x16_t steps,
+                                   uint8x16_t bias, uint8x16_t weights)
+{
+    return vmulq_u8(quantise(vld1q_u8(src), steps, bias), weights);
+}
+
+unsigned int __fb_pack_gray8_neon(uint8_t *dst, unsigned int dst_stride,
+                                  const uint8_t *src, unsigned int src_stride,
+                                  unsigned int w, unsigned int h,
+                                  unsigned int format,
+                                  const uint8_t bias[4][16])
+{
+    uint8x16_t steps = vdupq_n_u8((1U << format) - 1);
+    uint8x16_t weights, b, a0, a1, a2, a3, c;
+    unsigned int chunk, n, x, y;
+    const uint8_t *s;
+    uint8_t *d;
+
+    switch (format) {
+    case FB_FORMAT_MONO1:
+        weights = vld1q_u8(mono1_weights);
+        chunk = 64;
+        break;
+    case FB_FORMAT_GRAY2:
+        weights = vld1q_u8(gray2_weights);
+        chunk = 64;
+        break;
+    default:
+        weights = vld1q_u8(gray4_weights);
+        chunk = 32;
+        break;
+    }
+    n = w - w % chunk;
+
+    for (y = 0; y < h; y++) {
+        s = src + (size_t)y * src_stride;
+        d = dst + (size_t)y * dst_stride;
+        b = vld1q_u8(bias[y % 4]);
+
+        for (x = 0; x < n; x += chunk) {
+            a0 = pack_load(s + x, steps, b, weights);
+            a1 = pack_load(s + x + 16, steps, b, weights);
+
+            if (format == FB_FORMAT_GRAY4) {
+                /* 32 pixels, 2 per byte */
+                vst1q_u8(d + x / 2, vpaddq_u8(a0, a1));
+                continue;
+            }
+
+            a2 = pack_load(s + x + 32, steps, b, weights);
+            a3 = pack_load(s + x + 48, steps, b, weights);
+            c = vpaddq_u8(vpaddq_u8(a0, a1), vpaddq_u8(a2, a3));
+            if (format == FB_FORMAT_GRAY2) {
+                /* 64 pixels, 4 per byte */
+                vst1q_u8(d + x / 4, c);
+            } else {
+                /* 64 pixels, 8 per byte */
+                c = vpaddq_u8(c, c);
+                vst1_u8(d + x / 8, vget_low_u8(c));
+            }
+        }
+    }
+    return n;
+}
+
+/* Rows of an 8x8 block in, its columns out */
+static inline void transpose_8x8(uint8x8_t v[8])
+{
+    uint8x8x2_t t0 = vtrn_u8(v[0], v[1]);
+    uint8x8x2_t t1 = vtrn_u8(v[2], v[3]);
+    uint8x8x2_t t2 = vtrn_u8(v[4], v[5]);
+    uint8x8x2_t t3 = vtrn_u8(v[6], v[7]);
+    /* Rows 0-3 and 4-7 of columns 0 and 4, 2 and 6, 1 and 5, 3 and 7 */
+    uint16x4x2_t u0 = vtrn_u16(vreinterpret_u16_u8(t0.val[0]),
+                               vreinterpret_u16_u8(t1.val[0]));
+    uint16x4x2_t u1 = vtrn_u16(vreinterpret_u16_u8(t0.val[1]),
+                               vreinterpret_u16_u8(t1.val[1]));
+    uint16x4x2_t u2 = vtrn_u16(vreinterpret_u16_u8(t2.val[0]),
+                               vreinterpret_u16_u8(t3.val[0]));
+    uint16x4x2_t u3 = vtrn_u16(vreinterpret_u16_u8(t2.val[1]),
+                               vreinterpret_u16_u8(t3.val[1]));
+    uint32x2x2_t c04 = vtrn_u32(vreinterpret_u32_u16(u0.val[0]),
+                                vreinterpret_u32_u16(u2.val[0]));
+    uint32x2x2_t c15 = vtrn_u32(vreinterpret_u32_u16(u1.val[0]),
+                                vreinterpret_u32_u16(u3.val[0]));
+    uint32x2x2_t c26 = vtrn_u32(vreinterpret_u32_u16(u0.val[1]),
+                                vreinterpret_u32_u16(u2.val[1]));
+    uint32x2x2_t c37 = vtrn_u32(vreinterpret_u32_u16(u1.val[1]),
+                                vreinterpret_u32_u16(u3.val[1]));
+
+    v[0] = vreinterpret_u8_u32(c04.val[0]);
+    v[1] = vreinterpret_u8_u32(c15.val[0]);
+    v[2] = vreinterpret_u8_u32(c26.val[0]);
+    v[3] = vreinterpret_u8_u32(c37.val[0]);
+    v[4] = vreinterpret_u8_u32(c04.val[1]);
+    v[5] = vreinterpret_u8_u32(c15.val[1]);
+    v[6] = vreinterpret_u8_u32(c26.val[1]);
+    v[7] = vreinterpret_u8_u32(c37.val[1]);
+}
+
+static void rotate_180(uint8_t *dst, unsigned int dst_stride,
+                       const uint8_t *src, unsigned int src_stride,
+                       unsigned int w, unsigned int h,
+                       unsigned int bw, unsigned int bh)
+{
+    uint8x16_t v;
+    unsigned int x, y;
+
+    for (y = 0; y < bh; y++) {
+        for (x = 0; x < bw; x += 16) {
+            v = vrev64q_u8(vld1q_u8(src + (size_t)y * src_stride + x));
+            vst1q_u8(dst + (size_t)(h - 1 - y) * dst_stride + (w - 16 - x),
+                     vextq_u8(v, v, 8));
+        }
+    }
+}
+
+void __fb_rotate_gray8_neon(uint8_t *dst, unsigned int dst_stride,
+                            const uint8_t *src, unsigned int src_stride,
+                            unsigned int w, unsigned int h,
+                            unsigned int bw, unsigned int bh,
+                            unsigned int rotation)
+{
+    uint8x8_t v[8];
+    unsigned int bx, by, i;
+    const uint8_t *s;
+    uint8_t *d;
+
+    if (rotation == FB_ROTATE_180) {
+        rotate_180(dst, dst_stride, src, src_stride, w, h, bw, bh);
+        return;
+    }
+
+    for (by = 0; by < bh; by += 8) {
+        for (bx = 0; bx < bw; bx += 8) {
+            s = src + (size_t)by * src_stride + bx;
+            for (i = 0; i < 8; i++)
+                v[i] = vld1_u8(s + (size_t)i * src_stride);
+            transpose_8x8(v);
+
+            /* v[i] is now column bx + i, rows by to by + 7 */
+            for (i = 0; i < 8; i++) {
+                if (rotation == FB_ROTATE_90) {
+                    d = dst + (size_t)(bx + i) * dst_stride + (h - 8 - by);
+                    vst1_u8(d, vrev64_u8(v[i]));
+                } else {
+                    d = dst + (size_t)(w - 1 - bx - i) * dst_stride + by;
+                    vst1_u8(d, v[i]);
+                }
+            }
+        }
+    }
+}
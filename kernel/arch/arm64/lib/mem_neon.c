@@ -0,0 +1,39 @@
+/*
+ * NEON bulk copy/fill wrappers
+ *
+ * Entering a NEON section costs a couple of system register writes (and
+ * a full register save if FP state is live), so small buffers stay on
+ * the general-purpose register routines.
+ */
+
+#include <types.h>
+#include <kernel/string.h>
+#include <asm/neon.h>
+#include <asm/string.h>
+
+#define NEON_MEM_THRESHOLD  512
+
+void *memcpy_neon(void *dest, const void *src, size_t n)
+{
+    if (n < NEON_MEM_THRESHOLD || !may_use_simd())
+        return memcpy(dest, src, n);
+
+    kernel_neon_begin();
+    __memcpy_neon(dest, src, n);
+    kernel_neon_end();
+
+    return dest;
+}
+
+void *memset_neon(void *s, int c, size_t n)
+{
+    /* DC ZVA in memset() beats NEON stores for zeroing */
+    if (n < NEON_MEM_THRESHOLD || c == 0 || !may_use_simd())
+        return memset(s, c, n);
+
+    kernel_neon_begin();
+    __memset_neon(s, c, n);
+    kernel_neon_end();
+
+    return s;
+}
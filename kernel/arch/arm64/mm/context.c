@@ -0,0 +1,199 @@
+/*
+ * ASID allocation and user address space switching
+ *
+ * Each mm gets an ASID, so TLB entries of different address spaces
+ * (all user mappings are non-global) can coexist and switching mm is
+ * just a TTBR0 write. ASID 0 is never handed out; it is what TTBR0
+ * carries while no user task runs.
+ *
+ * context_id = generation | ASID. The generation lives above bit 16
+ * whatever the hardware ASID width, so ASID(mm) is always the low 16
+ * bits, as TTBR0 and TLBI take them. It is bumped on rollover, when
+ * the ASID space is exhausted. Rollover clears the bitmap, keeps the
+ * ASID that each CPU is currently running (reserved_asids) so live mms
+ * keep theirs, and marks every CPU as needing a full local TLB flush
+ * before it next installs an ASID. An mm whose context_id is from an
+ * older generation gets a fresh ASID on its next switch-in.
+ *
+ * This follows the Linux arm64 allocator. Callers run with IRQs masked
+ * (switch_mm is called from schedule()), which is all the locking the
+ * single scheduling CPU needs.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/string.h>
+#include <asm/irqflags.h>
+#include <asm/mmu_context.h>
+#include <asm/smp.h>
+#include <asm/tlbflush.h>
+
+#define MAX_ASID_BITS       16
+#define BITS_PER_LONG       64
+
+static unsigned int asid_bits = 8;
+static unsigned long asid_generation;
+static unsigned long asid_map[(1UL << MAX_ASID_BITS) / BITS_PER_LONG];
+static unsigned long cur_idx = 1;
+
+/* ASID each CPU is running, and what it held at the last rollover */
+static unsigned long active_asids[NR_CPUS];
+static unsigned long reserved_asids[NR_CPUS];
+
+/* CPUs that must flush their TLB before using a new-generation ASID */
+static unsigned long tlb_flush_pending;
+
+#define NUM_USER_ASIDS      (1UL << asid_bits)
+#define ASID_MASK           (~0UL << MAX_ASID_BITS)
+#define ASID_FIRST_VERSION  (1UL << MAX_ASID_BITS)
+#define asid2idx(asid)      ((asid) & ~ASID_MASK)
+
+static inline int asid_test_bit(unsigned long idx)
+{
+    return (asid_map[idx / BITS_PER_LONG] >> (idx % BITS_PER_LONG)) & 1;
+}
+
+static inline void asid_set_bit(unsigned long idx)
+{
+    asid_map[idx / BITS_PER_LONG] |= 1UL << (idx % BITS_PER_LONG);
+}
+
+static unsigned long asid_find_free(unsigned long start)
+{
+    unsigned long idx;
+
+    for (idx = start; idx < NUM_USER_ASIDS; idx++) {
+        if (asid_map[idx / BITS_PER_LONG] == ~0UL) {
+            idx |= BITS_PER_LONG - 1;
+            continue;
+        }
+        if (!asid_test_bit(idx))
+            return idx;
+    }
+    return NUM_USER_ASIDS;
+}
+
+void asid_init(void)
+{
+    uint64_t mmfr0 = read_sysreg(id_aa64mmfr0_el1);
+    unsigned int fld = (mmfr0 >> ID_AA64MMFR0_ASIDBITS_SHIFT) & 0xf;
+
+    if (fld == ID_AA64MMFR0_ASIDBITS_16) {
+        asid_bits = 16;
+        write_sysreg(read_sysreg(tcr_el1) | TCR_AS, tcr_el1);
+        __asm__ volatile("isb" : : : "memory");
+    }
+
+    asid_generation = ASID_FIRST_VERSION;
+}
+
+static void flush_context(void)
+{
+    unsigned long asid;
+    int cpu;
+
+    memset(asid_map, 0, sizeof(asid_map));
+
+    for (cpu = 0; cpu < NR_CPUS; cpu++) {
+        asid = active_asids[cpu];
+        active_asids[cpu] = 0;
+        /*
+         * A CPU that already rolled over once without switching since
+         * still runs its reserved ASID.
+         */
+        if (asid == 0)
+            asid = reserved_asids[cpu];
+        if (asid)
+            asid_set_bit(asid2idx(asid));
+        reserved_asids[cpu] = asid;
+    }
+
+    tlb_flush_pending = (1UL << NR_CPUS) - 1;
+}
+
+/*
+ * If @asid is reserved by some CPU, move all reservations of it to the
+ * new generation and keep using it.
+ */
+static int check_update_reserved_asid(unsigned long asid, unsigned long newasid)
+{
+    int cpu, hit = 0;
+
+    for (cpu = 0; cpu < NR_CPUS; cpu++) {
+        if (reserved_asids[cpu] == asid) {
+            hit = 1;
+            reserved_asids[cpu] = newasid;
+        }
+    }
+    return hit;
+}
+
+static unsigned long new_context(struct mm_struct *mm)
+{
+    unsigned long asid = mm->context_id;
+    unsigned long generation = asid_generation;
+
+    if (asid != 0) {
+        unsigned long newasid = generation | asid2idx(asid);
+
+        /* Still live on a CPU across a rollover: keep it */
+        if (check_update_reserved_asid(asid, newasid))
+            return newasid;
+
+        /* Otherwise reuse the old number if nobody took it yet */
+        if (!asid_test_bit(asid2idx(asid))) {
+            asid_set_bit(asid2idx(asid));
+            return newasid;
+        }
+    }
+
+    asid = asid_find_free(cur_idx);
+    if (asid == NUM_USER_ASIDS) {
+        /* Out of ASIDs: start a new generation */
+        asid_generation += ASID_FIRST_VERSION;
+        generation = asid_generation;
+        flush_context();
+        asid = asid_find_free(1);
+    }
+
+    asid_set_bit(asid);
+    cur_idx = asid;
+    return asid | generation;
+}
+
+static void check_and_switch_context(struct mm_struct *mm, unsigned int cpu)
+{
+    unsigned long asid = mm->context_id;
+
+    /* Fast path: ASID from the current generation, nothing to flush */
+    if (asid == 0 || (asid ^ asid_generation) >> MAX_ASID_BITS) {
+        asid = new_context(mm);
+        mm->context_id = asid;
+    }
+
+    if (tlb_flush_pending & (1UL << cpu)) {
+        tlb_flush_pending &= ~(1UL << cpu);
+        local_flush_tlb_all();
+    }
+
+    active_asids[cpu] = asid;
+    cpu_switch_mm(mm->pgd, asid2idx(asid));
+}
+
+void switch_mm(struct mm_struct *prev, struct mm_struct *next)
+{
+    unsigned int cpu = smp_processor_id();
+    unsigned long flags;
+
+    if (prev == next)
+        return;
+
+    if (!next) {
+        cpu_set_reserved_ttbr0();
+        return;
+    }
+
+    flags = local_irq_save();
+    check_and_switch_context(next, cpu);
+    local_irq_restore(flags);
+}
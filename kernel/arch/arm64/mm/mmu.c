@@ -0,0 +1,454 @@
+/*
+ * Kernel page table management
+ *
+ * map_pages()/unmap_pages() walk the 4-level table from the top,
+ * allocating next-level tables from the page allocator as needed. Leaf
+ * entries are 2MB blocks at level 2 or 4KB pages at level 3; aligned
+ * runs of 16 leaves also get the contiguous hint so one TLB entry can
+ * cover 64KB of pages or 32MB of blocks.
+ *
+ * A valid entry is never changed in place: it is invalidated and the
+ * TLB flushed before the new value is written (break-before-make).
+ * map_pages() does the break for the whole range up front, so that
+ * remapping n pages costs one batched flush rather than n. Every table
+ * the new mapping needs is allocated before that, so running out of
+ * memory leaves the old mapping in place rather than half of each.
+ *
+ * Unmapping gathers the cleared range in a struct tlb_gather and
+ * flushes it once at the end with broadcast TLBIs (asm/tlbflush.h).
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/mm.h>
+#include <asm/memory.h>
+#include <asm/mmu_context.h>
+#include <asm/pgtable.h>
+#include <asm/sections.h>
+#include <asm/tlbflush.h>
+
+#define TABLE_SHIFT     9   /* log2(PTRS_PER_TABLE) */
+
+pte_t *swapper_pg_dir;
+
+extern void idmap_cpu_replace_ttbr1(unsigned long ttbr1);
+
+static inline unsigned long pte_index(unsigned long va, unsigned int shift)
+{
+    return (va >> shift) & (PTRS_PER_TABLE - 1);
+}
+
+static inline pte_t *pte_table(pte_t entry)
+{
+    return __va(entry & PTE_ADDR_MASK);
+}
+
+static inline int pte_is_leaf(pte_t entry, unsigned int shift)
+{
+    return shift == L3_SHIFT || (entry & PTE_TYPE_MASK) == PTE_TYPE_BLOCK;
+}
+
+/* Levels that can hold leaf entries with a 4KB granule (we skip 1GB) */
+static inline int level_has_leaves(unsigned int shift)
+{
+    return shift == L2_SHIFT || shift == L3_SHIFT;
+}
+
+/* End of the entry covering @va at this level, clamped to @end */
+static inline unsigned long entry_end(unsigned long va, unsigned int shift,
+                                      unsigned long end)
+{
+    unsigned long next = (va | ((1UL << shift) - 1)) + 1;
+
+    return (next == 0 || next > end) ? end : next;
+}
+
+/* Make new descriptors visible to the table walker */
+static inline void pgtable_sync(void)
+{
+    __asm__ volatile("dsb ishst\n isb" : : : "memory");
+}
+
+/*
+ * Leaf entries cleared but not yet flushed from the TLB. @stride is
+ * the smallest leaf size seen, so a range of blocks costs one TLBI per
+ * block rather than one per page.
+ */
+struct tlb_gather {
+    unsigned long start;
+    unsigned long end;
+    unsigned long stride;
+};
+
+static inline void tlb_gather_init(struct tlb_gather *tlb)
+{
+    tlb->start = ~0UL;
+    tlb->end = 0;
+    tlb->stride = ~0UL;
+}
+
+static inline void tlb_gather_add(struct tlb_gather *tlb, unsigned long va,
+                                  unsigned long size)
+{
+    if (va < tlb->start)
+        tlb->start = va;
+    if (va + size > tlb->end)
+        tlb->end = va + size;
+    if (size < tlb->stride)
+        tlb->stride = size;
+}
+
+/* Only leaves were cleared, so cached table walks stay valid */
+static void tlb_gather_flush(struct tlb_gather *tlb)
+{
+    if (tlb->start >= tlb->end)
+        return;
+
+    __flush_tlb_kernel_range(tlb->start, tlb->end, tlb->stride, 1);
+    tlb_gather_init(tlb);
+}
+
+/*
+ * Drop the contiguous hint from the 16-entry group containing @idx.
+ * The TLB may hold the whole run as one entry, so the group is
+ * invalidated and flushed before being rewritten without the hint.
+ */
+static void clear_cont(pte_t *table, unsigned long idx, unsigned long va,
+                       unsigned int shift)
+{
+    pte_t *group = &table[idx & ~(unsigned long)(CONT_PTES - 1)];
+    unsigned long size = 1UL << shift;
+    unsigned long start = va & ~(size * CONT_PTES - 1);
+    pte_t saved[CONT_PTES];
+    int i;
+
+    if (!(table[idx] & PTE_CONT))
+        return;
+
+    for (i = 0; i < CONT_PTES; i++) {
+        saved[i] = group[i];
+        group[i] = 0;
+    }
+    __flush_tlb_kernel_range(start, start + size * CONT_PTES, size, 1);
+
+    for (i = 0; i < CONT_PTES; i++)
+        group[i] = saved[i] & ~PTE_CONT;
+}
+
+/*
+ * Replace the block at @table[@idx] with a next-level table mapping the
+ * same range with the same attributes.
+ */
+static pte_t *split_block(pte_t *table, unsigned long idx, unsigned long va,
+                          unsigned int shift)
+{
+    unsigned int child_shift = shift - TABLE_SHIFT;
+    pte_t type = child_shift == L3_SHIFT ? PTE_TYPE_PAGE : PTE_TYPE_BLOCK;
+    pte_t *child, block;
+    uint64_t attrs;
+    unsigned long pa;
+    int i;
+
+    child = get_zeroed_page();
+    if (!child)
+        return NULL;
+
+    clear_cont(table, idx, va, shift);
+    block = table[idx];
+    pa = block & PTE_ADDR_MASK;
+    attrs = block & ~(PTE_ADDR_MASK | PTE_TYPE_MASK);
+
+    /* The block was aligned, so every 16-entry group is contiguous */
+    for (i = 0; i < PTRS_PER_TABLE; i++)
+        child[i] = (pa + ((unsigned long)i << child_shift)) | attrs | type |
+                   PTE_CONT;
+    pgtable_sync();
+
+    table[idx] = 0;
+    flush_tlb_kernel_page(va);
+    table[idx] = __pa(child) | PTE_TYPE_TABLE;
+    pgtable_sync();
+
+    return child;
+}
+
+/* Next-level table for @va, allocating or splitting as needed */
+static pte_t *next_table(pte_t *table, unsigned long idx, unsigned long va,
+                         unsigned int shift)
+{
+    pte_t entry = table[idx];
+    pte_t *child;
+
+    if (!(entry & PTE_VALID)) {
+        child = get_zeroed_page();
+        if (!child)
+            return NULL;
+        pgtable_sync();
+        table[idx] = __pa(child) | PTE_TYPE_TABLE;
+        return child;
+    }
+
+    if (pte_is_leaf(entry, shift))
+        return split_block(table, idx, va, shift);
+
+    return pte_table(entry);
+}
+
+/*
+ * The range was already cleared by map_pages(), so a valid entry here
+ * can only be a table left behind that a block now replaces.
+ */
+static void set_leaf(pte_t *table, unsigned long idx, unsigned long va,
+                     pte_t val, unsigned int shift)
+{
+    pte_t old = table[idx];
+
+    if ((old & PTE_VALID) && !pte_is_leaf(old, shift)) {
+        /* Walks through the old table may be cached too: not last-level */
+        table[idx] = 0;
+        __flush_tlb_kernel_range(va, va + (1UL << shift), PAGE_SIZE, 0);
+        free_pages(pte_table(old), 0);
+    }
+
+    table[idx] = val;
+}
+
+/* Whether [@va, @end) -> @pa starts with a leaf at this level */
+static inline int leaf_fits(unsigned int shift, unsigned long va,
+                            unsigned long end, unsigned long pa)
+{
+    unsigned long size = 1UL << shift;
+
+    return level_has_leaves(shift) && !((va | pa) & (size - 1)) &&
+           end - va >= size;
+}
+
+/*
+ * Allocate, or split blocks into, every table map_range() will descend
+ * into for the same arguments. Neither changes what is mapped, so this
+ * can run before the break.
+ */
+static int alloc_tables(pte_t *table, unsigned int shift, unsigned long va,
+                        unsigned long end, unsigned long pa)
+{
+    unsigned long next;
+    pte_t *child;
+
+    while (va < end) {
+        next = entry_end(va, shift, end);
+        if (!leaf_fits(shift, va, end, pa)) {
+            child = next_table(table, pte_index(va, shift), va, shift);
+            if (!child ||
+                alloc_tables(child, shift - TABLE_SHIFT, va, next, pa))
+                return -1;
+        }
+        pa += next - va;
+        va = next;
+    }
+
+    return 0;
+}
+
+static int map_range(pte_t *table, unsigned int shift, unsigned long va,
+                     unsigned long end, unsigned long pa, uint64_t prot)
+{
+    unsigned long size = 1UL << shift;
+    pte_t type = shift == L3_SHIFT ? PTE_TYPE_PAGE : PTE_TYPE_BLOCK;
+
+    while (va < end) {
+        unsigned long idx = pte_index(va, shift);
+        unsigned long next;
+        pte_t *child;
+
+        if (leaf_fits(shift, va, end, pa)) {
+            unsigned long cont_size = size * CONT_PTES;
+            pte_t hint = 0;
+            int i, n = 1;
+
+            if (!((va | pa) & (cont_size - 1)) && end - va >= cont_size) {
+                hint = PTE_CONT;
+                n = CONT_PTES;
+            }
+
+            for (i = 0; i < n; i++)
+                set_leaf(table, idx + i, va + i * size,
+                         (pa + i * size) | prot | type | hint, shift);
+
+            va += n * size;
+            pa += n * size;
+            continue;
+        }
+
+        child = next_table(table, idx, va, shift);
+        if (!child)
+            return -1;
+
+        next = entry_end(va, shift, end);
+        if (map_range(child, shift - TABLE_SHIFT, va, next, pa, prot))
+            return -1;
+
+        pa += next - va;
+        va = next;
+    }
+
+    return 0;
+}
+
+static int unmap_range(pte_t *table, unsigned int shift, unsigned long va,
+                       unsigned long end, struct tlb_gather *tlb)
+{
+    unsigned long size = 1UL << shift;
+
+    while (va < end) {
+        unsigned long idx = pte_index(va, shift);
+        unsigned long next = entry_end(va, shift, end);
+        pte_t entry = table[idx];
+        pte_t *child;
+        int i;
+
+        if (!(entry & PTE_VALID)) {
+            va = next;
+            continue;
+        }
+
+        if (pte_is_leaf(entry, shift)) {
+            /* Whole contiguous group going away: no need to split it */
+            if ((entry & PTE_CONT) && !(va & (size * CONT_PTES - 1)) &&
+                end - va >= size * CONT_PTES) {
+                /* The hint is only a hint: entries may be cached singly */
+                for (i = 0; i < CONT_PTES; i++) {
+                    table[idx + i] = 0;
+                    tlb_gather_add(tlb, va, size);
+                    va += size;
+                }
+                continue;
+            }
+            if (next - va == size) {
+                clear_cont(table, idx, va, shift);
+                table[idx] = 0;
+                tlb_gather_add(tlb, va, size);
+                va = next;
+                continue;
+            }
+            child = split_block(table, idx, va, shift);
+            if (!child)
+                return -1;
+        } else {
+            child = pte_table(entry);
+        }
+
+        if (unmap_range(child, shift - TABLE_SHIFT, va, next, tlb))
+            return -1;
+        va = next;
+    }
+
+    return 0;
+}
+
+int map_pages(pte_t *pgd, unsigned long va, unsigned long pa,
+              unsigned long size, uint64_t prot)
+{
+    unsigned long end = PAGE_ALIGN(va + size);
+    struct tlb_gather tlb;
+    int ret;
+
+    va &= PAGE_MASK;
+    pa &= PAGE_MASK;
+
+    /*
+     * Tables first: with them in place, and the blocks the new mapping
+     * cuts into already split, neither step below allocates
+     */
+    ret = alloc_tables(pgd, L0_SHIFT, va, end, pa);
+    pgtable_sync();
+    if (ret)
+        return ret;
+
+    /* Break: clear any existing mapping of the range, one flush for all */
+    tlb_gather_init(&tlb);
+    ret = unmap_range(pgd, L0_SHIFT, va, end, &tlb);
+    tlb_gather_flush(&tlb);
+
+    /* Make */
+    if (!ret)
+        ret = map_range(pgd, L0_SHIFT, va, end, pa, prot);
+    pgtable_sync();
+
+    return ret;
+}
+
+int unmap_pages(pte_t *pgd, unsigned long va, unsigned long size)
+{
+    unsigned long end = PAGE_ALIGN(va + size);
+    struct tlb_gather tlb;
+    int ret;
+
+    tlb_gather_init(&tlb);
+    ret = unmap_range(pgd, L0_SHIFT, va & PAGE_MASK, end, &tlb);
+    tlb_gather_flush(&tlb);
+
+    return ret;
+}
+
+/*
+ * Switch TTBR1 while running from the identity map (TTBR0), since the
+ * kernel half cannot be translated halfway through the switch.
+ */
+static void cpu_replace_ttbr1(pte_t *pgd)
+{
+    void (*replace)(unsigned long) =
+        (void (*)(unsigned long))__pa(idmap_cpu_replace_ttbr1);
+
+    replace(__pa(pgd));
+}
+
+static int map_kernel_segment(pte_t *pgd, void *start, void *end, uint64_t prot)
+{
+    return map_pages(pgd, (unsigned long)start, __pa(start),
+                     (unsigned long)end - (unsigned long)start, prot);
+}
+
+void paging_init(void)
+{
+    pte_t *pgd = get_zeroed_page();
+    int ret;
+
+    if (!pgd) {
+        uart_poll_puts("paging_init: no memory for page tables\n");
+        return;
+    }
+
+    /* Firmware area and .text.boot below the image proper */
+    ret  = map_kernel_segment(pgd, __va(0), _stext, PAGE_KERNEL);
+    ret |= map_kernel_segment(pgd, _stext, _etext, PAGE_KERNEL_ROX);
+    ret |= map_kernel_segment(pgd, __start_rodata, __end_rodata,
+                              PAGE_KERNEL_RO);
+    ret |= map_kernel_segment(pgd, _sdata, _end, PAGE_KERNEL);
+
+    /* Rest of RAM: the linear map used by the page allocator */
+    ret |= map_kernel_segment(pgd, _end, __va(memory_end), PAGE_KERNEL);
+
+    /* GPU and local peripherals */
+    ret |= map_kernel_segment(pgd, __va(GPU_PERIPH_BASE_PA),
+                              __va(LOCAL_PERIPH_BASE_PA + L2_SIZE),
+                              PAGE_KERNEL_DEVICE);
+
+    if (ret) {
+        uart_poll_puts("paging_init: failed to build kernel page tables\n");
+        return;
+    }
+
+    swapper_pg_dir = pgd;
+    cpu_replace_ttbr1(pgd);
+
+    /*
+     * Everything now runs from the kernel half: drop the boot identity
+     * map from TTBR0 and flush its entries. TTBR0 stays disabled until
+     * a task with a user address space runs.
+     */
+    cpu_set_reserved_ttbr0();
+    local_flush_tlb_all();
+
+    asid_init();
+}
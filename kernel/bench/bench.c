@@ -0,0 +1,152 @@
+/*
+ * Kernel micro-benchmark runner
+ *
+ * Walks the .bench_cases linker section, times every case with the
+ * ARM generic timer virtual counter (CNTVCT_EL0) and prints one
+ * machine-readable BENCH line per case on the UART.
+ *
+ * Each case gets a short warm-up run followed by BENCH_RUNS timed runs.
+ * The fastest run is reported, which filters out timer interrupts and
+ * emulator scheduling noise. A case that skips or fails is not timed
+ * any further.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/bench.h>
+#include <kernel/time.h>
+#include <asm/arch_timer.h>
+#include <asm/semihost.h>
+
+#define BENCH_RUNS      5
+
+/* Provided by the linker script */
+extern const struct bench_case __bench_cases_start[];
+extern const struct bench_case __bench_cases_end[];
+
+/* Set by the running case */
+static const char *bench_skipped;
+static const char *bench_failed;
+
+void bench_skip(const char *why)
+{
+    if (!bench_skipped)
+        bench_skipped = why;
+}
+
+void bench_fail(const char *why)
+{
+    if (!bench_failed)
+        bench_failed = why;
+}
+
+static int bench_stopped(void)
+{
+    return bench_skipped || bench_failed;
+}
+
+static uint64_t bench_ticks_to_ns(uint64_t ticks, uint64_t freq)
+{
+    /* Split the conversion so ticks * NSEC_PER_SEC cannot overflow */
+    return (ticks / freq) * NSEC_PER_SEC +
+           ((ticks % freq) * NSEC_PER_SEC) / freq;
+}
+
+/* Print a value given in thousandths with three decimal places */
+static void bench_put_milli(uint64_t milli)
+{
+    uint64_t frac = milli % 1000;
+
+    uart_poll_put_dec(milli / 1000);
+    uart_poll_putc('.');
+    uart_poll_putc('0' + frac / 100);
+    uart_poll_putc('0' + (frac / 10) % 10);
+    uart_poll_putc('0' + frac % 10);
+}
+
+static void bench_report(const struct bench_case *bc, uint64_t ns)
+{
+    uart_poll_puts("BENCH ");
+    uart_poll_puts(bc->name);
+    uart_poll_puts(" iters=");
+    uart_poll_put_dec(bc->iters);
+    uart_poll_puts(" ns=");
+    uart_poll_put_dec(ns);
+    uart_poll_puts(" ns_per_op=");
+    bench_put_milli(ns * 1000 / bc->iters);
+
+    if (bc->bytes_per_op) {
+        uint64_t bytes = bc->bytes_per_op * bc->iters;
+
+        uart_poll_puts(" bytes=");
+        uart_poll_put_dec(bytes);
+        /* bytes per ns * 1000 = MB/s (10^6 bytes) */
+        uart_poll_puts(" mb_per_s=");
+        uart_poll_put_dec(ns ? bytes * 1000 / ns : 0);
+        /* Slow devices (the UART) would only ever show 0 MB/s */
+        uart_poll_puts(" bytes_per_s=");
+        uart_poll_put_dec(ns ? bytes * NSEC_PER_SEC / ns : 0);
+    }
+    uart_poll_puts("\n");
+}
+
+static void bench_report_stop(const struct bench_case *bc)
+{
+    uart_poll_puts(bench_failed ? "BENCH-FAIL " : "BENCH-SKIP ");
+    uart_poll_puts(bc->name);
+    uart_poll_puts(" ");
+    uart_poll_puts(bench_failed ? bench_failed : bench_skipped);
+    uart_poll_puts("\n");
+}
+
+static uint64_t bench_time_case(const struct bench_case *bc)
+{
+    uint64_t best = ~0UL;
+
+    /* Warm up caches and branch predictors */
+    bc->run(bc->iters / 16 ? bc->iters / 16 : 1);
+
+    for (int r = 0; r < BENCH_RUNS && !bench_stopped(); r++) {
+        uint64_t start, end;
+
+        start = arch_counter_get_cntvct();
+        bc->run(bc->iters);
+        end = arch_counter_get_cntvct();
+
+        if (end - start < best)
+            best = end - start;
+    }
+
+    return best;
+}
+
+void bench_run_all(void)
+{
+    uint64_t freq = arch_timer_get_cntfrq();
+    const struct bench_case *bc;
+    unsigned int failed = 0;
+    uint64_t ticks;
+
+    uart_poll_puts("BENCH-BEGIN cntfrq=");
+    uart_poll_put_dec(freq);
+    uart_poll_puts("\n");
+
+    for (bc = __bench_cases_start; bc < __bench_cases_end; bc++) {
+        bench_skipped = bench_failed = NULL;
+        if (bc->setup)
+            bc->setup();
+        ticks = bench_stopped() ? 0 : bench_time_case(bc);
+
+        if (bench_stopped()) {
+            bench_report_stop(bc);
+            failed += bench_failed != NULL;
+            continue;
+        }
+        bench_report(bc, bench_ticks_to_ns(ticks, freq));
+    }
+
+    uart_poll_puts("BENCH-END\n");
+
+    /* Stop QEMU so `make bench` can collect the results */
+    semihost_exit(failed ? 1 : 0);
+}
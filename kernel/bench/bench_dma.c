@@ -0,0 +1,137 @@
+/*
+ * Streaming vs coherent DMA buffers
+ *
+ * Each case is what the CPU pays to prepare a buffer for a device:
+ * filling a cacheable buffer and cleaning it with dma_map_single(), or
+ * filling an uncached one from dma_alloc_coherent(). The crossover sets
+ * DMA_COHERENT_THRESHOLD.
+ *
+ * dma_memcpy_* offload a copy to a DMA channel, including the cache
+ * maintenance, for comparison with the CPU memcpy cases. The wait is
+ * a busy poll, so these measure latency; the CPU time a real client
+ * saves is what it does instead of polling. They are skipped when no
+ * channel is free, and fail if a copy cannot be queued or errors.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/bench.h>
+#include <kernel/dma-mapping.h>
+#include <kernel/dmaengine.h>
+#include <kernel/string.h>
+
+#define BENCH_DMA_SMALL     512
+#define BENCH_DMA_MEDIUM    (4 * 1024)
+#define BENCH_DMA_LARGE     (64 * 1024)
+
+static uint8_t bench_dma_buf[BENCH_DMA_LARGE] __attribute__((aligned(64)));
+static uint8_t bench_dma_dst[BENCH_DMA_LARGE] __attribute__((aligned(64)));
+static uint8_t *bench_dma_coherent;
+static struct dma_chan *bench_dma_chan;
+
+static void bench_dma_setup(void)
+{
+    dma_addr_t handle;
+
+    if (!bench_dma_coherent)
+        bench_dma_coherent = dma_alloc_coherent(BENCH_DMA_LARGE, &handle);
+    if (!bench_dma_coherent)
+        bench_skip("no coherent memory");
+}
+
+static void bench_dma_streaming(unsigned long iters, size_t size)
+{
+    while (iters--) {
+        memset(bench_dma_buf, 0x5a, size);
+        dma_map_single(bench_dma_buf, size, DMA_TO_DEVICE);
+    }
+}
+
+static void bench_dma_coherent_fill(unsigned long iters, size_t size)
+{
+    while (iters--)
+        memset(bench_dma_coherent, 0x5a, size);
+}
+
+static void bench_dma_memcpy_setup(void)
+{
+    if (!bench_dma_chan)
+        bench_dma_chan = dma_request_chan();
+    if (!bench_dma_chan)
+        bench_skip("no free DMA channel");
+}
+
+static void bench_dma_memcpy(unsigned long iters, size_t size)
+{
+    struct dma_desc *desc;
+    dma_addr_t src, dst;
+    int ret = -1;
+
+    while (iters--) {
+        src = dma_map_single(bench_dma_buf, size, DMA_TO_DEVICE);
+        dst = dma_map_single(bench_dma_dst, size, DMA_FROM_DEVICE);
+        desc = dma_prep_memcpy(bench_dma_chan, dst, src, size);
+        if (desc)
+            ret = dma_sync_wait(bench_dma_chan, dma_submit(desc, NULL, NULL));
+        dma_unmap_single(dst, size, DMA_FROM_DEVICE);
+        dma_unmap_single(src, size, DMA_TO_DEVICE);
+
+        if (!desc) {
+            bench_fail("dma_prep_memcpy() failed");
+            return;
+        }
+        if (ret) {
+            bench_fail("DMA transfer error");
+            return;
+        }
+    }
+}
+
+static void bench_dma_memcpy_4k_run(unsigned long iters)
+{
+    bench_dma_memcpy(iters, BENCH_DMA_MEDIUM);
+}
+
+static void bench_dma_memcpy_64k_run(unsigned long iters)
+{
+    bench_dma_memcpy(iters, BENCH_DMA_LARGE);
+}
+
+static void bench_dma_streaming_512_run(unsigned long iters)
+{
+    bench_dma_streaming(iters, BENCH_DMA_SMALL);
+}
+
+static void bench_dma_streaming_4k_run(unsigned long iters)
+{
+    bench_dma_streaming(iters, BENCH_DMA_MEDIUM);
+}
+
+static void bench_dma_streaming_64k_run(unsigned long iters)
+{
+    bench_dma_streaming(iters, BENCH_DMA_LARGE);
+}
+
+static void bench_dma_coherent_512_run(unsigned long iters)
+{
+    bench_dma_coherent_fill(iters, BENCH_DMA_SMALL);
+}
+
+static void bench_dma_coherent_4k_run(unsigned long iters)
+{
+    bench_dma_coherent_fill(iters, BENCH_DMA_MEDIUM);
+}
+
+static void bench_dma_coherent_64k_run(unsigned long iters)
+{
+    bench_dma_coherent_fill(iters, BENCH_DMA_LARGE);
+}
+
+BENCH_CASE(dma_streaming_512, NULL, bench_dma_streaming_512_run, 1024, BENCH_DMA_SMALL);
+BENCH_CASE(dma_streaming_4k, NULL, bench_dma_streaming_4k_run, 512, BENCH_DMA_MEDIUM);
+BENCH_CASE(dma_streaming_64k, NULL, bench_dma_streaming_64k_run, 64, BENCH_DMA_LARGE);
+BENCH_CASE(dma_coherent_512, bench_dma_setup, bench_dma_coherent_512_run, 1024, BENCH_DMA_SMALL);
+BENCH_CASE(dma_coherent_4k, bench_dma_setup, bench_dma_coherent_4k_run, 512, BENCH_DMA_MEDIUM);
+BENCH_CASE(dma_coherent_64k, bench_dma_setup, bench_dma_coherent_64k_run, 64, BENCH_DMA_LARGE);
+BENCH_CASE(dma_memcpy_4k, bench_dma_memcpy_setup, bench_dma_memcpy_4k_run, 256, BENCH_DMA_MEDIUM);
+BENCH_CASE(dma_memcpy_64k, bench_dma_memcpy_setup, bench_dma_memcpy_64k_run, 64, BENCH_DMA_LARGE);
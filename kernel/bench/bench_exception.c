@@ -0,0 +1,18 @@
+/*
+ * Exception entry/exit round trip
+ *
+ * Issues an SVC from EL1. The synchronous exception goes through the
+ * vector table, kernel_entry, exception_handler_c (which returns
+ * straight away for EL1 SVCs) and kernel_exit.
+ */
+
+#include <types.h>
+#include <kernel/bench.h>
+
+static void bench_svc_run(unsigned long iters)
+{
+    while (iters--)
+        __asm__ volatile("svc #0" : : : "memory");
+}
+
+BENCH_CASE(exception_svc_roundtrip, NULL, bench_svc_run, 100000, 0);
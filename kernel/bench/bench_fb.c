@@ -0,0 +1,322 @@
+/*
+ * Grey to panel format conversion throughput
+ *
+ * An 800x480 8-bit grey frame, the size of a 7.5" e-ink panel, packed,
+ * rotated and dithered the way a UI frame is on its way to the panel.
+ * Each case is measured through the NEON dispatch and through the
+ * scalar reference. bytes counts source pixels, one byte each, so
+ * mb_per_s reads as Mpixels/s. Before any NEON case is timed, every
+ * NEON path is run once and its output compared with the reference;
+ * a mismatch fails the case.
+ *
+ * The fb_pack_neon_min* cases pack 64-pixel rows, one NEON chunk wide,
+ * calling the kernel directly at a quarter of, at and at four times
+ * FB_NEON_MIN_PIXELS; where they cross their _ref twins is where the
+ * threshold belongs.
+ *
+ * The text cases fill the same frame with console text from the glyph
+ * cache; there bytes counts characters, so bytes_per_s reads as chars/s.
+ */
+
+#include <types.h>
+#include <kernel/bench.h>
+#include <kernel/fb.h>
+#include <kernel/fb_convert.h>
+#include <kernel/font.h>
+#include <kernel/string.h>
+#include <asm/fb_convert.h>
+#ifdef __HAVE_ARCH_FB_CONVERT
+#include <asm/neon.h>
+#endif
+
+#define BENCH_FB_W          800
+#define BENCH_FB_H          480
+#define BENCH_FB_PIXELS     (BENCH_FB_W * BENCH_FB_H)
+
+static uint8_t bench_fb_src[BENCH_FB_PIXELS] __attribute__((aligned(64)));
+static uint8_t bench_fb_dst[BENCH_FB_PIXELS] __attribute__((aligned(64)));
+static uint8_t bench_fb_ref[BENCH_FB_PIXELS] __attribute__((aligned(64)));
+static struct fb_info bench_fb;
+
+/* NULL once every NEON path has matched the reference */
+static const char *bench_fb_mismatch;
+static int bench_fb_checked;
+
+static int bench_fb_refresh(struct fb_info *info, const struct fb_rect *rect,
+                            int full)
+{
+    return 0;
+}
+
+static const struct fb_ops bench_fb_ops = {
+    .fb_refresh = bench_fb_refresh,
+};
+
+static void bench_fb_setup(void)
+{
+    unsigned int x, y;
+
+    /* A horizontal ramp with some texture, so no level dominates */
+    for (y = 0; y < BENCH_FB_H; y++)
+        for (x = 0; x < BENCH_FB_W; x++)
+            bench_fb_src[y * BENCH_FB_W + x] = (x * 255 / BENCH_FB_W) ^ (y & 7);
+
+    /* Not registered: only the blit case draws into it */
+    bench_fb = (struct fb_info){
+        .name = "bench",
+        .width = BENCH_FB_W,
+        .height = BENCH_FB_H,
+        .format = FB_FORMAT_MONO1,
+        .stride = BENCH_FB_W / 8,
+        .x_align = 8,
+        .screen_base = bench_fb_dst,
+        .fbops = &bench_fb_ops,
+    };
+}
+
+/*
+ * A whole frame, then a rectangle with row tails for the scalar code
+ * and a dither pattern that does not start at its origin. Both are
+ * well above FB_NEON_MIN_PIXELS, so the dispatch takes NEON.
+ */
+static const struct {
+    unsigned int w, h, x, y;
+} bench_fb_check_rects[] = {
+    { BENCH_FB_W, BENCH_FB_H, 0, 0 },
+    { 200, 37, 3, 5 },
+};
+
+/* Both outputs start from the same bytes, so stray writes show too */
+static void bench_fb_check_clear(void)
+{
+    memset(bench_fb_dst, 0x5A, sizeof(bench_fb_dst));
+    memset(bench_fb_ref, 0x5A, sizeof(bench_fb_ref));
+}
+
+static int bench_fb_check_pack(unsigned int r, unsigned int format,
+                               unsigned int dither)
+{
+    unsigned int w = bench_fb_check_rects[r].w;
+    unsigned int h = bench_fb_check_rects[r].h;
+    unsigned int x = bench_fb_check_rects[r].x;
+    unsigned int y = bench_fb_check_rects[r].y;
+    unsigned int stride = w * format / 8;
+
+    bench_fb_check_clear();
+    fb_pack_gray8(bench_fb_dst, stride, bench_fb_src, BENCH_FB_W, w, h,
+                  format, x, y, dither);
+    fb_pack_gray8_ref(bench_fb_ref, stride, bench_fb_src, BENCH_FB_W, w, h,
+                      format, x, y, dither);
+    return memcmp(bench_fb_dst, bench_fb_ref, sizeof(bench_fb_dst));
+}
+
+static int bench_fb_check_rotate(unsigned int r, unsigned int rotation)
+{
+    unsigned int w = bench_fb_check_rects[r].w;
+    unsigned int h = bench_fb_check_rects[r].h;
+    unsigned int stride = rotation == FB_ROTATE_180 ? w : h;
+
+    bench_fb_check_clear();
+    fb_rotate_gray8(bench_fb_dst, stride, bench_fb_src, BENCH_FB_W, w, h,
+                    rotation);
+    fb_rotate_gray8_ref(bench_fb_ref, stride, bench_fb_src, BENCH_FB_W, w, h,
+                        rotation);
+    return memcmp(bench_fb_dst, bench_fb_ref, sizeof(bench_fb_dst));
+}
+
+static const char *bench_fb_check(void)
+{
+    static const unsigned int formats[] = {
+        FB_FORMAT_MONO1, FB_FORMAT_GRAY2, FB_FORMAT_GRAY4,
+    };
+    unsigned int r, f, rot;
+
+    for (r = 0; r < sizeof(bench_fb_check_rects) /
+                    sizeof(bench_fb_check_rects[0]); r++) {
+        for (f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+            if (bench_fb_check_pack(r, formats[f], FB_DITHER_NONE) ||
+                bench_fb_check_pack(r, formats[f], FB_DITHER_ORDERED))
+                return "fb_pack_gray8() differs from fb_pack_gray8_ref()";
+        }
+        for (rot = FB_ROTATE_90; rot <= FB_ROTATE_270; rot++) {
+            if (bench_fb_check_rotate(r, rot))
+                return "fb_rotate_gray8() differs from fb_rotate_gray8_ref()";
+        }
+    }
+    return NULL;
+}
+
+/* Setup of the cases that run NEON code */
+static void bench_fb_neon_setup(void)
+{
+    bench_fb_setup();
+
+#ifdef __HAVE_ARCH_FB_CONVERT
+    if (!bench_fb_checked) {
+        bench_fb_mismatch = bench_fb_check();
+        bench_fb_checked = 1;
+    }
+    if (bench_fb_mismatch)
+        bench_fail(bench_fb_mismatch);
+#else
+    bench_skip("no NEON kernels");
+#endif
+}
+
+static void bench_fb_pack_mono1_run(unsigned long iters)
+{
+    while (iters--)
+        fb_pack_gray8(bench_fb_dst, BENCH_FB_W / 8, bench_fb_src, BENCH_FB_W,
+                      BENCH_FB_W, BENCH_FB_H, FB_FORMAT_MONO1, 0, 0,
+                      FB_DITHER_ORDERED);
+}
+
+static void bench_fb_pack_mono1_ref_run(unsigned long iters)
+{
+    while (iters--)
+        fb_pack_gray8_ref(bench_fb_dst, BENCH_FB_W / 8, bench_fb_src,
+                          BENCH_FB_W, BENCH_FB_W, BENCH_FB_H, FB_FORMAT_MONO1,
+                          0, 0, FB_DITHER_ORDERED);
+}
+
+static void bench_fb_pack_gray2_run(unsigned long iters)
+{
+    while (iters--)
+        fb_pack_gray8(bench_fb_dst, BENCH_FB_W / 4, bench_fb_src, BENCH_FB_W,
+                      BENCH_FB_W, BENCH_FB_H, FB_FORMAT_GRAY2, 0, 0,
+                      FB_DITHER_ORDERED);
+}
+
+static void bench_fb_pack_gray2_ref_run(unsigned long iters)
+{
+    while (iters--)
+        fb_pack_gray8_ref(bench_fb_dst, BENCH_FB_W / 4, bench_fb_src,
+                          BENCH_FB_W, BENCH_FB_W, BENCH_FB_H, FB_FORMAT_GRAY2,
+                          0, 0, FB_DITHER_ORDERED);
+}
+
+static void bench_fb_rotate90_run(unsigned long iters)
+{
+    while (iters--)
+        fb_rotate_gray8(bench_fb_dst, BENCH_FB_H, bench_fb_src, BENCH_FB_W,
+                        BENCH_FB_W, BENCH_FB_H, FB_ROTATE_90);
+}
+
+static void bench_fb_rotate90_ref_run(unsigned long iters)
+{
+    while (iters--)
+        fb_rotate_gray8_ref(bench_fb_dst, BENCH_FB_H, bench_fb_src,
+                            BENCH_FB_W, BENCH_FB_W, BENCH_FB_H, FB_ROTATE_90);
+}
+
+static void bench_fb_blit_fs_run(unsigned long iters)
+{
+    struct fb_rect r = { 0, 0, BENCH_FB_W, BENCH_FB_H };
+
+    /* Scalar only: the error diffusion is serial along each row */
+    while (iters--)
+        fb_blit_gray8(&bench_fb, &r, bench_fb_src, BENCH_FB_W, FB_DITHER_FS);
+}
+
+/* Rows one NEON chunk wide, FB_NEON_MIN_PIXELS / 4 to 4 times that */
+#define BENCH_FB_MIN_W      64
+#define BENCH_FB_MIN_H      (FB_NEON_MIN_PIXELS / BENCH_FB_MIN_W)
+
+static void bench_fb_pack_min(unsigned long iters, unsigned int h)
+{
+#ifdef __HAVE_ARCH_FB_CONVERT
+    uint8_t bias[4][16];
+
+    /* FB_DITHER_NONE rounds every pixel */
+    memset(bias, 128, sizeof(bias));
+
+    /* What the dispatch does above the threshold */
+    while (iters--) {
+        kernel_neon_begin();
+        __fb_pack_gray8_neon(bench_fb_dst, BENCH_FB_MIN_W / 8, bench_fb_src,
+                             BENCH_FB_W, BENCH_FB_MIN_W, h, FB_FORMAT_MONO1,
+                             bias);
+        kernel_neon_end();
+    }
+#endif
+}
+
+static void bench_fb_pack_min_ref(unsigned long iters, unsigned int h)
+{
+    while (iters--)
+        fb_pack_gray8_ref(bench_fb_dst, BENCH_FB_MIN_W / 8, bench_fb_src,
+                          BENCH_FB_W, BENCH_FB_MIN_W, h, FB_FORMAT_MONO1,
+                          0, 0, FB_DITHER_NONE);
+}
+
+static void bench_fb_pack_neon_min_div4_run(unsigned long iters)
+{
+    bench_fb_pack_min(iters, BENCH_FB_MIN_H / 4);
+}
+
+static void bench_fb_pack_neon_min_div4_ref_run(unsigned long iters)
+{
+    bench_fb_pack_min_ref(iters, BENCH_FB_MIN_H / 4);
+}
+
+static void bench_fb_pack_neon_min_run(unsigned long iters)
+{
+    bench_fb_pack_min(iters, BENCH_FB_MIN_H);
+}
+
+static void bench_fb_pack_neon_min_ref_run(unsigned long iters)
+{
+    bench_fb_pack_min_ref(iters, BENCH_FB_MIN_H);
+}
+
+static void bench_fb_pack_neon_min_x4_run(unsigned long iters)
+{
+    bench_fb_pack_min(iters, BENCH_FB_MIN_H * 4);
+}
+
+static void bench_fb_pack_neon_min_x4_ref_run(unsigned long iters)
+{
+    bench_fb_pack_min_ref(iters, BENCH_FB_MIN_H * 4);
+}
+
+#define BENCH_TEXT_SCALE    2
+#define BENCH_TEXT_COLS     (BENCH_FB_W / (8 * BENCH_TEXT_SCALE))
+#define BENCH_TEXT_ROWS     (BENCH_FB_H / (8 * BENCH_TEXT_SCALE))
+#define BENCH_TEXT_CHARS    (BENCH_TEXT_COLS * BENCH_TEXT_ROWS)
+
+static char bench_text_line[BENCH_TEXT_COLS];
+
+static void bench_fb_text_setup(void)
+{
+    unsigned int i;
+
+    bench_fb_setup();
+    for (i = 0; i < BENCH_TEXT_COLS; i++)
+        bench_text_line[i] = ' ' + (i * 7) % 95;
+}
+
+static void bench_fb_text_run(unsigned long iters)
+{
+    struct text_style style = { BENCH_TEXT_SCALE, FB_BLACK, FB_WHITE };
+    unsigned int row;
+
+    while (iters--)
+        for (row = 0; row < BENCH_TEXT_ROWS; row++)
+            fb_draw_text(&bench_fb, 0, row * 8 * BENCH_TEXT_SCALE,
+                         bench_text_line, BENCH_TEXT_COLS, &style);
+}
+
+BENCH_CASE(fb_pack_mono1, bench_fb_neon_setup, bench_fb_pack_mono1_run, 16, BENCH_FB_PIXELS);
+BENCH_CASE(fb_pack_mono1_ref, bench_fb_setup, bench_fb_pack_mono1_ref_run, 4, BENCH_FB_PIXELS);
+BENCH_CASE(fb_pack_gray2, bench_fb_neon_setup, bench_fb_pack_gray2_run, 16, BENCH_FB_PIXELS);
+BENCH_CASE(fb_pack_gray2_ref, bench_fb_setup, bench_fb_pack_gray2_ref_run, 4, BENCH_FB_PIXELS);
+BENCH_CASE(fb_rotate90, bench_fb_neon_setup, bench_fb_rotate90_run, 16, BENCH_FB_PIXELS);
+BENCH_CASE(fb_rotate90_ref, bench_fb_setup, bench_fb_rotate90_ref_run, 4, BENCH_FB_PIXELS);
+BENCH_CASE(fb_blit_fs, bench_fb_setup, bench_fb_blit_fs_run, 4, BENCH_FB_PIXELS);
+BENCH_CASE(fb_pack_neon_min_div4, bench_fb_neon_setup, bench_fb_pack_neon_min_div4_run, 4096, FB_NEON_MIN_PIXELS / 4);
+BENCH_CASE(fb_pack_neon_min_div4_ref, bench_fb_setup, bench_fb_pack_neon_min_div4_ref_run, 4096, FB_NEON_MIN_PIXELS / 4);
+BENCH_CASE(fb_pack_neon_min, bench_fb_neon_setup, bench_fb_pack_neon_min_run, 1024, FB_NEON_MIN_PIXELS);
+BENCH_CASE(fb_pack_neon_min_ref, bench_fb_setup, bench_fb_pack_neon_min_ref_run, 1024, FB_NEON_MIN_PIXELS);
+BENCH_CASE(fb_pack_neon_min_x4, bench_fb_neon_setup, bench_fb_pack_neon_min_x4_run, 256, FB_NEON_MIN_PIXELS * 4);
+BENCH_CASE(fb_pack_neon_min_x4_ref, bench_fb_setup, bench_fb_pack_neon_min_x4_ref_run, 256, FB_NEON_MIN_PIXELS * 4);
+BENCH_CASE(fb_text_scale2, bench_fb_text_setup, bench_fb_text_run, 16, BENCH_TEXT_CHARS);
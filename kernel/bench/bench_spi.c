@@ -0,0 +1,79 @@
+/*
+ * SPI0 frame push
+ *
+ * Pushes a full 800x480 frame, 2 bits per pixel as the e-ink panel
+ * takes it, behind a one-byte command: the same message a panel driver
+ * sends per refresh. The data goes by DMA in SPI_DMA_CHUNK pieces and
+ * the wait polls (the bench runs with IRQs masked), so the time is all
+ * bus time. A saturated bus would move SCLK/8 bytes per second; setup
+ * prints that limit next to the case so a run on the board shows how
+ * close the DMA path gets.
+ *
+ * Skipped when SPI0 is missing (QEMU), failed if a push errors.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/bench.h>
+#include <kernel/string.h>
+#include <spi/spi.h>
+
+#define BENCH_SPI_WIDTH     800
+#define BENCH_SPI_HEIGHT    480
+#define BENCH_SPI_FRAME     (BENCH_SPI_WIDTH * BENCH_SPI_HEIGHT / 4)
+
+/* A typical e-ink controller's write clock limit */
+#define BENCH_SPI_HZ        32000000
+
+static uint8_t bench_spi_frame[BENCH_SPI_FRAME] __attribute__((aligned(64)));
+static const uint8_t bench_spi_cmd = 0x24;     /* Write RAM */
+
+static struct spi_device bench_spi_dev = {
+    .chip_select = 0,
+    .max_speed_hz = BENCH_SPI_HZ,
+    .mode = SPI_MODE_0,
+    .dc_gpio = SPI_NO_DC,
+};
+
+static void bench_spi_setup(void)
+{
+    uint32_t sclk = spi_effective_speed_hz(&bench_spi_dev);
+
+    if (!sclk) {
+        bench_skip("no SPI controller");
+        return;
+    }
+
+    memset(bench_spi_frame, 0xA5, sizeof(bench_spi_frame));
+
+    uart_poll_puts("bench_spi: SCLK ");
+    uart_poll_put_dec(sclk);
+    uart_poll_puts(" Hz, bus limit ");
+    uart_poll_put_dec(sclk / 8);
+    uart_poll_puts(" bytes_per_s\n");
+}
+
+static void bench_spi_frame_push(unsigned long iters)
+{
+    struct spi_transfer t[2] = {
+        { .tx_buf = &bench_spi_cmd, .len = 1, .dc = SPI_DC_COMMAND },
+        { .tx_buf = bench_spi_frame, .len = sizeof(bench_spi_frame),
+          .dc = SPI_DC_DATA },
+    };
+    struct spi_message msg = {
+        .spi = &bench_spi_dev,
+        .transfers = t,
+        .nr_transfers = 2,
+    };
+
+    while (iters--) {
+        if (spi_sync(&msg)) {
+            bench_fail("SPI transfer error");
+            return;
+        }
+    }
+}
+
+BENCH_CASE(spi_frame_800x480, bench_spi_setup, bench_spi_frame_push, 4,
+           BENCH_SPI_FRAME + 1);
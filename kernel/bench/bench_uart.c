@@ -0,0 +1,50 @@
+/*
+ * UART output throughput
+ *
+ * Pushes fixed 64-byte lines through uart_sync_puts(), the polled path
+ * that writes the FIFO directly, and through uart_write() at the boot
+ * rate and at 921600 baud. The lines start
+ * with '#' so that scripts/bench_compare.py ignores them.
+ *
+ * The uart_write() cases flush inside the timed run, so bytes_per_s is
+ * the rate achieved on the line rather than into the log ring. The
+ * fast case switches back to the previous rate before returning; the
+ * terminal will show its own lines as noise.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/bench.h>
+
+/* 63 characters + '\n' = 64 bytes per line */
+static const char bench_uart_line[] =
+    "# uart_sync_puts throughput 0123456789abcdefghijklmnopqrstuvwx\n";
+
+static void bench_uart_puts_run(unsigned long iters)
+{
+    while (iters--)
+        uart_sync_puts(bench_uart_line);
+}
+
+BENCH_CASE(uart_sync_puts, NULL, bench_uart_puts_run, 64, sizeof(bench_uart_line) - 1);
+
+static void bench_uart_write_run(unsigned long iters)
+{
+    while (iters--)
+        uart_write(bench_uart_line, sizeof(bench_uart_line) - 1);
+    uart_flush();
+}
+
+static void bench_uart_write_921600_run(unsigned long iters)
+{
+    unsigned int baud = uart_get_baud();
+
+    if (uart_set_baud(921600))
+        return;
+    bench_uart_write_run(iters);
+    uart_set_baud(baud);
+}
+
+BENCH_CASE(uart_write, NULL, bench_uart_write_run, 64, sizeof(bench_uart_line) - 1);
+BENCH_CASE(uart_write_921600, NULL, bench_uart_write_921600_run, 256,
+           sizeof(bench_uart_line) - 1);
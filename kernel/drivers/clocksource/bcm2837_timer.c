@@ -1,9 +1,12 @@
 #include <stddef.h>
 #include <stdint.h>
+#include <kernel/init.h>
 #include <kernel/clockchip.h>
 #include <kernel/irq_chip.h>
 #include <container_of.h>
 #include <serial_core.h>
+#include <kernel/of.h>
+#include <asm/io.h>
 
 /*
  * BCM2837 System Timer
@@ -26,7 +29,8 @@
  *      which maps to virtual IRQ = 3 + 32 (bank 1 offset) + 16 (ARMCTRL offset) = 51
  */
 
-#define BCM2837_TIMER_BASE 0x3F003000 
+/* Used when the device tree has no brcm,bcm2835-system-timer node */
+#define BCM2837_TIMER_BASE IO_ADDRESS(0x3F003000)
 
 /* Register offsets */
 #define REG_CONTROL 0x00
@@ -63,8 +67,6 @@ static void bcm2837_timer_set_next_event(unsigned long event, struct clock_event
 static irqreturn_t bcm2837_timer_interrupt_handler(unsigned int irq, void *dev_id);
 
 static struct bcm2837_timer bcm_timer = {
-    .control = (volatile uint32_t *)(BCM2837_TIMER_BASE + REG_CONTROL),
-    .compare = (volatile uint32_t *)(BCM2837_TIMER_BASE + REG_COMPARE(DEFAULT_TIMER)),
     .match_mask = TIMER_MATCH_MASK,
     .event_dev = {
         .name = "bcm2837-system-timer",
@@ -90,6 +92,13 @@ static struct bcm2837_timer bcm_timer = {
 static void bcm2837_timer_set_next_event(unsigned long event, struct clock_event_device *dev)
 {
     uint32_t current_counter;
+    /*
+     * Drop a match that is still pending from the old compare value,
+     * e.g. the one that woke an idle CPU with the tick stopped, so it
+     * is not taken as this event
+     */
+    *bcm_timer.control = bcm_timer.match_mask;
+
     /* Read current counter value and add delta */
     current_counter = *system_clock;
     
@@ -125,10 +134,20 @@ static irqreturn_t bcm2837_timer_interrupt_handler(unsigned int irq, void *dev_i
 
 int bcm2837_timer_init(void)
 {
+    struct device_node *np;
+    uintptr_t base;
     int ret;
-    
+
+    np = of_find_compatible_node(NULL, "brcm,bcm2835-system-timer");
+    base = (uintptr_t)of_iomap(np, 0);
+    if (!base)
+        base = BCM2837_TIMER_BASE;
+
+    bcm_timer.control = (volatile uint32_t *)(base + REG_CONTROL);
+    bcm_timer.compare = (volatile uint32_t *)(base + REG_COMPARE(DEFAULT_TIMER));
+
     /* Initialize the system clock pointer to counter low register */
-    system_clock = (volatile uint32_t *)(BCM2837_TIMER_BASE + REG_COUNTER_LOW);
+    system_clock = (volatile uint32_t *)(base + REG_COUNTER_LOW);
     
     /* Clear any pending match on our timer channel */
     *bcm_timer.control = bcm_timer.match_mask;
@@ -153,4 +172,5 @@ int bcm2837_timer_init(void)
     clockevents_config_and_register(&bcm_timer.event_dev);
     
     return 0;
-}
\ No newline at end of file
+}
+arch_initcall(bcm2837_timer_init, "bcm2837_armctrl_init");
@@ -1,15 +1,43 @@
 #include <stdint.h>
 #include <kernel/clockchip.h>
+#include <kernel/tick.h>
 #include <kernel/timekeeping.h>
+#include <asm/arch_timer.h>
 
 /*
- * Tick period in timer ticks (microseconds for 1MHz timer).
- * 10ms = 10,000 microseconds = 10,000 ticks
+ * Shortest delta handed to the clockevent. The system timer only
+ * matches on equality, so a compare value the counter has already
+ * passed would not fire until it wraps.
  */
-#define TICK_PERIOD_US  10000UL  /* 10ms */
+#define TICK_MIN_DELTA_US   10
 
 static struct clock_event_device *default_clockevent;
 
+/*
+ * The generic timer counter value the next jiffy is due at, and the
+ * tick period in counter ticks. The clockevent itself counts in
+ * microseconds; the counter is only used to work out how many ticks
+ * were skipped while the tick was stopped.
+ */
+static uint64_t tick_next;
+static uint64_t tick_period_cycles;
+static int tick_stopped;
+
+static uint64_t cycles_to_us(uint64_t cycles)
+{
+    return cycles * 1000000 / arch_timer_get_cntfrq();
+}
+
+static void tick_program_next(struct clock_event_device *dev)
+{
+    tick_next = arch_counter_get_cntvct() + tick_period_cycles;
+
+    /* Program the next tick event (delta from now) */
+    if (dev->set_next_event) {
+        dev->set_next_event(TICK_PERIOD_US, dev);
+    }
+}
+
 /*
  * Event handler for periodic ticks.
  * This is called by the hardware timer interrupt.
@@ -19,10 +47,7 @@ void tick_periodic_clockevent(struct clock_event_device *dev)
     /* Update the jiffies counter */
     do_timer(1);
 
-    /* Program the next tick event (delta from now) */
-    if (dev->set_next_event) {
-        dev->set_next_event(TICK_PERIOD_US, dev);
-    }
+    tick_program_next(dev);
 }
 
 /*
@@ -33,10 +58,11 @@ static void tick_setup_periodic(struct clock_event_device *dev)
     /* Set the periodic tick handler */
     dev->event_handler = tick_periodic_clockevent;
 
+    tick_period_cycles = (uint64_t)arch_timer_get_cntfrq() * TICK_PERIOD_US / 1000000;
+    tick_stopped = 0;
+
     /* Program the first tick */
-    if (dev->set_next_event) {
-        dev->set_next_event(TICK_PERIOD_US, dev);
-    }
+    tick_program_next(dev);
 }
 
 /*
@@ -49,4 +75,58 @@ void clockevents_config_and_register(struct clock_event_device *dev)
 
     /* Setup for periodic tick mode */
     tick_setup_periodic(dev);
-}
\ No newline at end of file
+}
+
+uint64_t tick_nohz_get_sleep_length(uint64_t *delta_tick)
+{
+    uint64_t now = arch_counter_get_cntvct();
+
+    if (!default_clockevent) {
+        /* No tick yet: nothing but an interrupt will wake us */
+        *delta_tick = TICK_NOHZ_MAX_US;
+        return TICK_NOHZ_MAX_US;
+    }
+
+    *delta_tick = tick_next > now ? cycles_to_us(tick_next - now) : 0;
+
+    /* No timers besides the tick: a stopped tick sleeps for the maximum */
+    return TICK_NOHZ_MAX_US;
+}
+
+void tick_nohz_idle_stop_tick(void)
+{
+    struct clock_event_device *dev = default_clockevent;
+
+    if (!dev || tick_stopped)
+        return;
+
+    tick_stopped = 1;
+    if (dev->set_next_event)
+        dev->set_next_event(TICK_NOHZ_MAX_US, dev);
+}
+
+void tick_nohz_idle_restart_tick(void)
+{
+    struct clock_event_device *dev = default_clockevent;
+    uint64_t now, missed, delta;
+
+    if (!dev || !tick_stopped)
+        return;
+
+    tick_stopped = 0;
+    now = arch_counter_get_cntvct();
+
+    /* Account every tick boundary crossed while stopped */
+    if (now >= tick_next) {
+        missed = (now - tick_next) / tick_period_cycles + 1;
+        do_timer(missed);
+        tick_next += missed * tick_period_cycles;
+    }
+
+    /* Resume on the old grid */
+    delta = cycles_to_us(tick_next - now);
+    if (delta < TICK_MIN_DELTA_US)
+        delta = TICK_MIN_DELTA_US;
+    if (dev->set_next_event)
+        dev->set_next_event(delta, dev);
+}
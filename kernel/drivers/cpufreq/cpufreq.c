@@ -0,0 +1,108 @@
+/*
+ * ARM clock scaling through the VideoCore firmware
+ *
+ * See include/kernel/cpufreq.h for the governor. Samples are timed from
+ * the generic timer counter, the same clock the idle time is measured
+ * with, so the load is a plain ratio of counter ticks.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/cpufreq.h>
+#include <kernel/init.h>
+#include <kernel/sched.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <asm/arch_timer.h>
+
+static struct cpufreq_policy policy;
+
+static uint64_t sample_ticks;
+static uint64_t last_sample;
+static uint64_t last_idle;
+
+const struct cpufreq_policy *cpufreq_get_policy(void)
+{
+    return &policy;
+}
+
+static uint32_t cpufreq_target(unsigned int load)
+{
+    uint32_t freq;
+
+    if (load >= CPUFREQ_UP_THRESHOLD)
+        return policy.max;
+
+    freq = policy.min + (uint64_t)(policy.max - policy.min) * load / 100;
+    freq -= freq % CPUFREQ_STEP_HZ;
+    return freq < policy.min ? policy.min : freq;
+}
+
+static void cpufreq_set(uint32_t freq)
+{
+    uint32_t actual;
+
+    if (freq == policy.cur)
+        return;
+    /* On failure keep the old rate and try again next sample */
+    if (mbox_set_clock_rate(MBOX_CLK_ARM, freq, &actual))
+        return;
+
+    policy.cur = actual;
+    policy.transitions++;
+}
+
+void cpufreq_update(void)
+{
+    uint64_t now, idle, wall, idle_delta;
+
+    if (!policy.max)
+        return;
+
+    now = arch_counter_get_cntvct();
+    wall = now - last_sample;
+    if (wall < sample_ticks)
+        return;
+
+    idle = cpu_idle_ticks(0);
+    idle_delta = idle - last_idle;
+    last_sample = now;
+    last_idle = idle;
+
+    if (nr_running())
+        policy.load = 100;
+    else
+        policy.load = idle_delta < wall ? (wall - idle_delta) * 100 / wall : 0;
+
+    cpufreq_set(cpufreq_target(policy.load));
+}
+
+int cpufreq_init(void)
+{
+    uint32_t min, max, cur;
+
+    policy.max = 0;
+    if (mbox_get_min_clock_rate(MBOX_CLK_ARM, &min) ||
+        mbox_get_max_clock_rate(MBOX_CLK_ARM, &max) ||
+        mbox_get_clock_rate(MBOX_CLK_ARM, &cur) || !max || min > max)
+        return -1;
+
+    policy.min = min;
+    policy.max = max;
+    policy.cur = cur;
+    policy.load = 0;
+    policy.transitions = 0;
+
+    sample_ticks = (uint64_t)arch_timer_get_cntfrq() * CPUFREQ_SAMPLE_US / 1000000;
+    last_sample = arch_counter_get_cntvct();
+    last_idle = cpu_idle_ticks(0);
+
+    uart_poll_puts("cpufreq: ARM clock ");
+    uart_poll_put_dec(cur / 1000000);
+    uart_poll_puts(" MHz (");
+    uart_poll_put_dec(min / 1000000);
+    uart_poll_puts("-");
+    uart_poll_put_dec(max / 1000000);
+    uart_poll_puts(" MHz)\n");
+    return 0;
+}
+device_initcall_async(cpufreq_init, "bcm2837_mbox_init");
@@ -0,0 +1,84 @@
+/*
+ * BCM2837 idle states
+ *
+ *   WFI       clock-gated until the next interrupt, tick running
+ *   WFI-NOHZ  the same with the tick stopped, for stays longer than a
+ *             tick period
+ *   RET       Cortex-A53 core retention with the tick stopped: after
+ *             CPURETCTL generic timer ticks in wfi the core powers its
+ *             logic down to retention voltage, keeping its state, and
+ *             comes back on the next interrupt
+ *
+ * The per-core local controller has no power switch, and without PSCI
+ * firmware a core that is really powered off can only come back through
+ * the spin table, so retention is the deepest state the boot CPU can
+ * leave and carry on from where it was.
+ *
+ * Latencies and residencies are conservative estimates; the per-state
+ * statistics (cpuidle_get_device()) show how they hold up.
+ */
+
+#include <types.h>
+#include <kernel/cpuidle.h>
+#include <kernel/init.h>
+#include <kernel/tick.h>
+#include <asm/sysreg.h>
+
+/*
+ * CPUECTLR_EL1 (s3_1_c15_c2_1), writable at EL1 because boot.S sets
+ * ACTLR_EL2.CPUECTLR. CPURETCTL is the number of generic timer ticks
+ * spent in wfi before the core enters retention, 0 for never.
+ */
+#define CPUECTLR_CPURETCTL_MASK     (7UL << 0)
+#define CPUECTLR_CPURETCTL_8        (2UL << 0)
+
+static void bcm2837_enter_wfi(struct cpuidle_driver *drv, int index)
+{
+    __asm__ volatile("dsb sy\n\twfi" : : : "memory");
+}
+
+static void bcm2837_enter_retention(struct cpuidle_driver *drv, int index)
+{
+    uint64_t ectlr = read_sysreg(s3_1_c15_c2_1);
+
+    write_sysreg((ectlr & ~CPUECTLR_CPURETCTL_MASK) | CPUECTLR_CPURETCTL_8,
+                 s3_1_c15_c2_1);
+    __asm__ volatile("isb\n\tdsb sy\n\twfi" : : : "memory");
+
+    /* Plain wfi in the shallower states must not drop into retention */
+    write_sysreg(ectlr, s3_1_c15_c2_1);
+    __asm__ volatile("isb" : : : "memory");
+}
+
+static struct cpuidle_driver bcm2837_idle_driver = {
+    .name = "bcm2837_idle",
+    .states = {
+        {
+            .name = "WFI",
+            .exit_latency = 1,
+            .target_residency = 1,
+            .enter = bcm2837_enter_wfi,
+        },
+        {
+            .name = "WFI-NOHZ",
+            .exit_latency = 10,
+            .target_residency = TICK_PERIOD_US,
+            .flags = CPUIDLE_FLAG_TICK_STOP,
+            .enter = bcm2837_enter_wfi,
+        },
+        {
+            .name = "RET",
+            .exit_latency = 100,
+            .target_residency = 2 * TICK_PERIOD_US,
+            .flags = CPUIDLE_FLAG_TICK_STOP,
+            .enter = bcm2837_enter_retention,
+        },
+    },
+    .state_count = 3,
+};
+
+int bcm2837_cpuidle_init(void)
+{
+    return cpuidle_register_driver(&bcm2837_idle_driver);
+}
+device_initcall(bcm2837_cpuidle_init, "bcm2837_timer_init");
@@ -0,0 +1,125 @@
+/*
+ * cpuidle core
+ *
+ * Runs one idle period: ask the governor for a state, stop the tick if
+ * the state wants it, sleep, then account the stay and report it back
+ * to the governor. See include/kernel/cpuidle.h.
+ *
+ * Residency is timed from the generic timer counter around the state's
+ * enter hook, so it includes the time to wake up. When the stay ran
+ * past the timer event the CPU was waiting for, the overshoot is the
+ * state's observed exit latency.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/cpuidle.h>
+#include <kernel/tick.h>
+#include <asm/arch_timer.h>
+#include <asm/smp.h>
+
+static struct cpuidle_driver *cpuidle_curr_driver;
+static struct cpuidle_device cpuidle_devices[NR_CPUS];
+
+static uint64_t cycles_to_us(uint64_t cycles)
+{
+    return cycles * 1000000 / arch_timer_get_cntfrq();
+}
+
+const struct cpuidle_driver *cpuidle_get_driver(void)
+{
+    return cpuidle_curr_driver;
+}
+
+const struct cpuidle_device *cpuidle_get_device(unsigned int cpu)
+{
+    return cpu < NR_CPUS ? &cpuidle_devices[cpu] : NULL;
+}
+
+int cpuidle_register_driver(struct cpuidle_driver *drv)
+{
+    struct cpuidle_device *dev;
+    unsigned int cpu;
+    int i;
+
+    if (drv->state_count <= 0 || drv->state_count > CPUIDLE_STATE_MAX)
+        return -1;
+
+    for (cpu = 0; cpu < NR_CPUS; cpu++) {
+        dev = &cpuidle_devices[cpu];
+        *dev = (struct cpuidle_device){ .cpu = cpu };
+        menu_enable_device(dev);
+    }
+    cpuidle_curr_driver = drv;
+
+    uart_poll_puts("cpuidle: ");
+    uart_poll_puts(drv->name);
+    uart_poll_puts(",");
+    for (i = 0; i < drv->state_count; i++) {
+        uart_poll_puts(" ");
+        uart_poll_puts(drv->states[i].name);
+    }
+    uart_poll_puts("\n");
+    return 0;
+}
+
+static void cpuidle_account(struct cpuidle_driver *drv,
+                            struct cpuidle_device *dev, int index,
+                            uint64_t residency, uint64_t timer_us)
+{
+    struct cpuidle_state_usage *u = &dev->states_usage[index];
+    unsigned int latency;
+
+    u->usage++;
+    u->time += residency;
+
+    if (residency < drv->states[index].target_residency)
+        u->above++;
+    else if (index + 1 < drv->state_count &&
+             residency >= drv->states[index + 1].target_residency)
+        u->below++;
+
+    if (residency >= timer_us) {
+        latency = residency - timer_us;
+        u->exit_samples++;
+        u->exit_latency_total += latency;
+        if (latency > u->exit_latency_max)
+            u->exit_latency_max = latency;
+    }
+}
+
+int cpuidle_idle_call(void)
+{
+    struct cpuidle_driver *drv = cpuidle_curr_driver;
+    struct cpuidle_device *dev;
+    struct cpuidle_state *state;
+    uint64_t sleep_us, tick_us, timer_us, start, residency;
+    int index;
+
+    if (!drv)
+        return -1;
+
+    dev = &cpuidle_devices[smp_processor_id()];
+    sleep_us = tick_nohz_get_sleep_length(&tick_us);
+    index = menu_select(drv, dev, sleep_us, tick_us);
+    state = &drv->states[index];
+
+    if (state->flags & CPUIDLE_FLAG_TICK_STOP) {
+        tick_nohz_idle_stop_tick();
+        timer_us = sleep_us;
+    } else {
+        timer_us = tick_us;
+    }
+
+    start = arch_counter_get_cntvct();
+    state->enter(drv, index);
+    residency = cycles_to_us(arch_counter_get_cntvct() - start);
+
+    if (state->flags & CPUIDLE_FLAG_TICK_STOP)
+        tick_nohz_idle_restart_tick();
+
+    dev->last_residency = residency;
+    cpuidle_account(drv, dev, index, residency, timer_us);
+    menu_reflect(drv, dev, index);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Menu idle governor
+ *
+ * A cut-down version of Linux's menu governor. The CPU will sleep at
+ * most until the next timer event, but some other interrupt usually
+ * comes first; how much earlier depends mostly on how far away the
+ * timer is, so a correction factor is kept per order of magnitude of
+ * that distance and the timer distance is scaled by it. Separately, if
+ * the last few stays were about the same length (a device interrupting
+ * at a steady rate), their average is a better guess than any timer.
+ * The prediction is the smaller of the two, and the governor picks the
+ * deepest state whose target residency it covers.
+ */
+
+#include <types.h>
+#include <kernel/cpuidle.h>
+
+/* Correction factors are fixed point, RESOLUTION * DECAY meaning 1.0 */
+#define RESOLUTION          1024
+#define DECAY               8
+/* Stays longer than this say nothing about the correction factor */
+#define MAX_INTERESTING     50000
+
+#define NO_PATTERN          (~0U)
+
+static unsigned int which_bucket(uint64_t duration_us)
+{
+    if (duration_us < 10)
+        return 0;
+    if (duration_us < 100)
+        return 1;
+    if (duration_us < 1000)
+        return 2;
+    if (duration_us < 10000)
+        return 3;
+    if (duration_us < 100000)
+        return 4;
+    return 5;
+}
+
+/*
+ * Average of the recent stays if they are regular: the standard
+ * deviation is within a sixth of the mean, or under 20us. Otherwise
+ * drop the longest and try again, as long as three quarters of the
+ * samples are left.
+ */
+static unsigned int get_typical_interval(const struct menu_device *data)
+{
+    unsigned int thresh = NO_PATTERN;
+    unsigned int max, divisor, avg, v;
+    uint64_t sum, variance;
+    int64_t diff;
+    int i;
+
+    for (;;) {
+        max = 0;
+        divisor = 0;
+        sum = 0;
+        for (i = 0; i < MENU_INTERVALS; i++) {
+            v = data->intervals[i];
+            if (v <= thresh) {
+                sum += v;
+                divisor++;
+                if (v > max)
+                    max = v;
+            }
+        }
+
+        /* No history yet */
+        if (!max)
+            return NO_PATTERN;
+
+        avg = sum / divisor;
+        variance = 0;
+        for (i = 0; i < MENU_INTERVALS; i++) {
+            v = data->intervals[i];
+            if (v <= thresh) {
+                diff = (int64_t)v - avg;
+                variance += diff * diff;
+            }
+        }
+        variance /= divisor;
+
+        if ((uint64_t)avg * avg > 36 * variance || variance <= 400)
+            return avg;
+
+        if (divisor * 4 <= MENU_INTERVALS * 3)
+            return NO_PATTERN;
+
+        thresh = max - 1;
+    }
+}
+
+void menu_enable_device(struct cpuidle_device *dev)
+{
+    struct menu_device *data = &dev->menu;
+    int i;
+
+    *data = (struct menu_device){ 0 };
+    for (i = 0; i < MENU_BUCKETS; i++)
+        data->correction_factor[i] = RESOLUTION * DECAY;
+}
+
+int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
+                uint64_t sleep_us, uint64_t tick_us)
+{
+    struct menu_device *data = &dev->menu;
+    const struct cpuidle_state *s;
+    uint64_t predicted;
+    unsigned int typical;
+    int i, idx;
+
+    data->next_timer_us = sleep_us;
+    data->tick_us = tick_us;
+    data->bucket = which_bucket(sleep_us);
+
+    predicted = sleep_us * data->correction_factor[data->bucket] /
+                (RESOLUTION * DECAY);
+    typical = get_typical_interval(data);
+    if (typical < predicted)
+        predicted = typical;
+    data->predicted_us = predicted;
+
+    idx = 0;
+    for (i = 1; i < drv->state_count; i++) {
+        s = &drv->states[i];
+        if (s->target_residency > predicted)
+            break;
+        /* With the tick running the stay ends at the next tick at the latest */
+        if (!(s->flags & CPUIDLE_FLAG_TICK_STOP) && s->target_residency > tick_us)
+            continue;
+        idx = i;
+    }
+
+    data->last_state_idx = idx;
+    return idx;
+}
+
+void menu_reflect(struct cpuidle_driver *drv, struct cpuidle_device *dev,
+                  int index)
+{
+    struct menu_device *data = &dev->menu;
+    const struct cpuidle_state *s = &drv->states[index];
+    uint64_t measured = dev->last_residency;
+    unsigned int new_factor;
+
+    if (!(s->flags & CPUIDLE_FLAG_TICK_STOP) &&
+        data->next_timer_us > data->tick_us && measured >= data->tick_us) {
+        /*
+         * The tick cut short a stay that could have gone on: count it
+         * as a long one rather than teaching the governor that wake-ups
+         * come every tick
+         */
+        measured = MAX_INTERESTING * 9 / 10;
+    } else {
+        /* Part of the measured time was spent waking up */
+        if (measured > 2 * s->exit_latency)
+            measured -= s->exit_latency;
+        else
+            measured /= 2;
+
+        if (measured > data->next_timer_us)
+            measured = data->next_timer_us;
+    }
+
+    new_factor = data->correction_factor[data->bucket];
+    new_factor -= new_factor / DECAY;
+    if (data->next_timer_us && measured < MAX_INTERESTING)
+        new_factor += RESOLUTION * measured / data->next_timer_us;
+    else
+        new_factor += RESOLUTION;
+    /* A factor of 0 would never recover */
+    if (!new_factor)
+        new_factor = 1;
+    data->correction_factor[data->bucket] = new_factor;
+
+    data->intervals[data->interval_ptr++] = measured;
+    if (data->interval_ptr >= MENU_INTERVALS)
+        data->interval_ptr = 0;
+}
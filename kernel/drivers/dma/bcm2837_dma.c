@@ -0,0 +1,466 @@
+/*
+ * BCM2837 DMA controller
+ *
+ * Sixteen channels at 0x3F007000 + 0x100 * n (channel 15 lives
+ * elsewhere and is not used). Channels 0-6 are full channels with
+ * 30-bit transfer lengths; 7-14 are "lite" channels limited to 64KB per
+ * control block. The firmware owns some channels, and 11-14 share one
+ * interrupt, so we only hand out the ones in DMA_CHANNEL_MASK, further
+ * limited by the device tree's brcm,dma-channel-mask when there is one.
+ *
+ * A transfer is described by a chain of 32-byte control blocks (CBs)
+ * in memory, linked by bus address through NEXTCONBK. Each allocated
+ * channel gets one page of CBs from the DMA coherent pool, split into
+ * DMA_DESCS_PER_CHAN fixed slots of DMA_CBS_PER_DESC blocks, so the
+ * engine and the CPU always see the same CB contents without cache
+ * maintenance.
+ *
+ * Completion: the last CB of a chain has INTEN set. The channel IRQ
+ * (ARMCTRL GPU IRQ 16 + n, virq 64 + n) clears CS.INT, retires the
+ * running descriptor and starts the next queued one.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <serial_core.h>
+#include <kernel/dmaengine.h>
+#include <kernel/dma-mapping.h>
+#include <kernel/init.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <dma/bcm2837_dma.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+#include <asm/memory.h>
+
+#define BCM2837_DMA_BASE        IO_ADDRESS(0x3F007000)
+#define DMA_CHAN_OFFSET(n)      ((n) * 0x100)
+#define DMA_REG_INT_STATUS      0xFE0
+#define DMA_REG_ENABLE          0xFF0
+
+/* Channels 0, 2, 4-10: not used by the firmware, own interrupt line */
+#define DMA_CHANNEL_MASK        0x07F5
+#define DMA_NR_CHANNELS         11
+#define DMA_FIRST_LITE          7
+
+/* Per-channel registers */
+#define DMA_CS                  0x00
+#define DMA_CONBLK_AD           0x04
+#define DMA_DEBUG               0x20
+
+/* CS */
+#define DMA_CS_ACTIVE           (1U << 0)
+#define DMA_CS_END              (1U << 1)
+#define DMA_CS_INT              (1U << 2)
+#define DMA_CS_ERROR            (1U << 8)
+#define DMA_CS_PRIORITY(x)      ((x) << 16)
+#define DMA_CS_PANIC_PRIORITY(x) ((x) << 20)
+#define DMA_CS_WAIT_WRITES      (1U << 28)
+#define DMA_CS_ABORT            (1U << 30)
+#define DMA_CS_RESET            (1U << 31)
+
+/* DEBUG: error flags are write-1-to-clear */
+#define DMA_DEBUG_ERRORS        0x7
+
+/* TI (transfer information, first word of a CB) */
+#define DMA_TI_INTEN            (1U << 0)
+#define DMA_TI_WAIT_RESP        (1U << 3)
+#define DMA_TI_DEST_INC         (1U << 4)
+#define DMA_TI_DEST_WIDTH       (1U << 5)
+#define DMA_TI_DEST_DREQ        (1U << 6)
+#define DMA_TI_DEST_IGNORE      (1U << 7)
+#define DMA_TI_SRC_INC          (1U << 8)
+#define DMA_TI_SRC_WIDTH        (1U << 9)
+#define DMA_TI_SRC_DREQ         (1U << 10)
+#define DMA_TI_BURST_LENGTH(x)  ((x) << 12)
+#define DMA_TI_PERMAP(x)        ((x) << 16)
+
+#define DMA_MAX_LEN_FULL        (1U << 29)
+#define DMA_MAX_LEN_LITE        0xFFF0U
+
+#define DMA_DESCS_PER_CHAN      4
+#define DMA_CBS_PER_DESC        32
+
+/* ARMCTRL GPU IRQ 16 + n, bank 1 */
+#define DMA_CHAN_IRQ(n)         (16 + (n) + 32 + ARMCTRL_IRQ_OFFSET)
+
+struct bcm2837_dma_cb {
+    uint32_t info;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t length;
+    uint32_t stride;
+    uint32_t next;
+    uint32_t pad[2];
+} __attribute__((aligned(32)));
+
+struct dma_desc {
+    struct dma_chan *chan;
+    struct bcm2837_dma_cb *cb;      /* First CB of this slot */
+    dma_addr_t cb_bus;
+    unsigned int nr_cbs;
+    dma_cookie_t cookie;
+    dma_callback_t callback;
+    void *param;
+    struct dma_desc *next;          /* Submission queue */
+    int in_use;
+};
+
+struct dma_chan {
+    unsigned int id;
+    uintptr_t base;
+    int allocated;
+    uint32_t max_len;
+    struct bcm2837_dma_cb *cbs;     /* One coherent page */
+    dma_addr_t cbs_bus;
+    struct dma_desc descs[DMA_DESCS_PER_CHAN];
+    struct dma_desc *queue_head;    /* Running descriptor first */
+    struct dma_desc *queue_tail;
+    dma_cookie_t last_cookie;
+    dma_cookie_t completed_cookie;
+    unsigned int errors;
+};
+
+static struct dma_chan dma_chans[DMA_NR_CHANNELS];
+
+static inline uint32_t dma_readl(struct dma_chan *chan, unsigned int reg)
+{
+    return readl(chan->base + reg);
+}
+
+static inline void dma_writel(struct dma_chan *chan, unsigned int reg, uint32_t val)
+{
+    writel(val, chan->base + reg);
+}
+
+static void dma_chan_reset(struct dma_chan *chan)
+{
+    dma_writel(chan, DMA_CS, DMA_CS_RESET);
+    while (dma_readl(chan, DMA_CS) & DMA_CS_RESET)
+        ;
+    dma_writel(chan, DMA_DEBUG, DMA_DEBUG_ERRORS);
+}
+
+static void dma_chan_start(struct dma_chan *chan, struct dma_desc *desc)
+{
+    dma_writel(chan, DMA_CONBLK_AD, desc->cb_bus);
+    dma_writel(chan, DMA_CS, DMA_CS_ACTIVE | DMA_CS_WAIT_WRITES |
+                             DMA_CS_PRIORITY(8) | DMA_CS_PANIC_PRIORITY(15));
+}
+
+/*
+ * Retire the running descriptor and start the next one. Called with
+ * IRQs masked, from the channel IRQ or from dma_sync_wait().
+ */
+static void dma_chan_complete(struct dma_chan *chan)
+{
+    struct dma_desc *desc = chan->queue_head;
+    uint32_t cs = dma_readl(chan, DMA_CS);
+    int error = 0;
+
+    if (!(cs & (DMA_CS_INT | DMA_CS_ERROR)))
+        return;
+    dma_writel(chan, DMA_CS, DMA_CS_INT | DMA_CS_END);
+
+    if (cs & DMA_CS_ERROR) {
+        chan->errors++;
+        error = -1;
+        dma_chan_reset(chan);
+    }
+
+    if (!desc)
+        return;
+
+    chan->queue_head = desc->next;
+    if (!chan->queue_head)
+        chan->queue_tail = NULL;
+    else
+        dma_chan_start(chan, chan->queue_head);
+
+    chan->completed_cookie = desc->cookie;
+    if (desc->callback)
+        desc->callback(desc->param, error);
+    desc->in_use = 0;
+}
+
+static irqreturn_t bcm2837_dma_interrupt(unsigned int irq, void *dev_id)
+{
+    struct dma_chan *chan = dev_id;
+
+    if (!(dma_readl(chan, DMA_CS) & (DMA_CS_INT | DMA_CS_ERROR)))
+        return IRQ_NONE;
+
+    dma_chan_complete(chan);
+    return IRQ_HANDLED;
+}
+
+struct dma_chan *dma_request_chan(void)
+{
+    struct dma_chan *chan = NULL;
+    unsigned long flags;
+    dma_addr_t bus;
+    void *cbs;
+    unsigned int i;
+
+    flags = local_irq_save();
+    for (i = 0; i < DMA_NR_CHANNELS; i++) {
+        if ((DMA_CHANNEL_MASK & (1U << i)) && !dma_chans[i].allocated &&
+            dma_chans[i].base) {
+            chan = &dma_chans[i];
+            chan->allocated = 1;
+            break;
+        }
+    }
+    local_irq_restore(flags);
+
+    if (!chan)
+        return NULL;
+
+    cbs = dma_alloc_coherent(DMA_DESCS_PER_CHAN * DMA_CBS_PER_DESC *
+                             sizeof(struct bcm2837_dma_cb), &bus);
+    if (!cbs) {
+        chan->allocated = 0;
+        return NULL;
+    }
+
+    chan->cbs = cbs;
+    chan->cbs_bus = bus;
+    for (i = 0; i < DMA_DESCS_PER_CHAN; i++) {
+        chan->descs[i].chan = chan;
+        chan->descs[i].cb = &chan->cbs[i * DMA_CBS_PER_DESC];
+        chan->descs[i].cb_bus = bus + i * DMA_CBS_PER_DESC *
+                                      sizeof(struct bcm2837_dma_cb);
+        chan->descs[i].in_use = 0;
+    }
+    chan->queue_head = chan->queue_tail = NULL;
+    chan->errors = 0;
+
+    dma_chan_reset(chan);
+    enable_irq(DMA_CHAN_IRQ(chan->id));
+    return chan;
+}
+
+void dma_release_chan(struct dma_chan *chan)
+{
+    dma_terminate_all(chan);
+    disable_irq(DMA_CHAN_IRQ(chan->id));
+    dma_free_coherent(DMA_DESCS_PER_CHAN * DMA_CBS_PER_DESC *
+                      sizeof(struct bcm2837_dma_cb), chan->cbs, chan->cbs_bus);
+    chan->cbs = NULL;
+    chan->allocated = 0;
+}
+
+static struct dma_desc *dma_desc_get(struct dma_chan *chan)
+{
+    struct dma_desc *desc = NULL;
+    unsigned long flags;
+    int i;
+
+    flags = local_irq_save();
+    for (i = 0; i < DMA_DESCS_PER_CHAN; i++) {
+        if (!chan->descs[i].in_use) {
+            desc = &chan->descs[i];
+            desc->in_use = 1;
+            desc->nr_cbs = 0;
+            desc->next = NULL;
+            break;
+        }
+    }
+    local_irq_restore(flags);
+
+    return desc;
+}
+
+static void dma_desc_put(struct dma_desc *desc)
+{
+    desc->in_use = 0;
+}
+
+static void dma_desc_add_cb(struct dma_desc *desc, uint32_t info,
+                            dma_addr_t src, dma_addr_t dst, uint32_t len)
+{
+    struct bcm2837_dma_cb *cb = &desc->cb[desc->nr_cbs];
+
+    cb->info = info;
+    cb->src = src;
+    cb->dst = dst;
+    cb->length = len;
+    cb->stride = 0;
+    cb->next = 0;
+
+    if (desc->nr_cbs)
+        desc->cb[desc->nr_cbs - 1].next = desc->cb_bus +
+                                          desc->nr_cbs * sizeof(*cb);
+    desc->nr_cbs++;
+}
+
+/* Interrupt only at the end of the chain */
+static void dma_desc_finish(struct dma_desc *desc)
+{
+    desc->cb[desc->nr_cbs - 1].info |= DMA_TI_INTEN;
+}
+
+struct dma_desc *dma_prep_memcpy(struct dma_chan *chan, dma_addr_t dst,
+                                 dma_addr_t src, size_t len)
+{
+    uint32_t info = DMA_TI_SRC_INC | DMA_TI_DEST_INC | DMA_TI_WAIT_RESP;
+    struct dma_desc *desc;
+
+    if (!len || (len + chan->max_len - 1) / chan->max_len > DMA_CBS_PER_DESC)
+        return NULL;
+
+    desc = dma_desc_get(chan);
+    if (!desc)
+        return NULL;
+
+    /* 128-bit reads and writes when everything is 16-byte aligned */
+    if (!((dst | src | len) & 15))
+        info |= DMA_TI_SRC_WIDTH | DMA_TI_DEST_WIDTH | DMA_TI_BURST_LENGTH(4);
+
+    while (len) {
+        uint32_t chunk = len > chan->max_len ? chan->max_len : len;
+
+        dma_desc_add_cb(desc, info, src, dst, chunk);
+        src += chunk;
+        dst += chunk;
+        len -= chunk;
+    }
+    dma_desc_finish(desc);
+
+    return desc;
+}
+
+struct dma_desc *dma_prep_slave_sg(struct dma_chan *chan,
+                                   const struct dma_sg *sg, unsigned int nents,
+                                   enum dma_transfer_direction dir,
+                                   dma_addr_t dev_addr, unsigned int dreq)
+{
+    uint32_t info = DMA_TI_WAIT_RESP | DMA_TI_PERMAP(dreq);
+    struct dma_desc *desc;
+    unsigned int i;
+
+    if (!nents || nents > DMA_CBS_PER_DESC || dir == DMA_MEM_TO_MEM)
+        return NULL;
+
+    if (dir == DMA_MEM_TO_DEV)
+        info |= DMA_TI_SRC_INC | DMA_TI_DEST_DREQ;
+    else
+        info |= DMA_TI_DEST_INC | DMA_TI_SRC_DREQ;
+
+    desc = dma_desc_get(chan);
+    if (!desc)
+        return NULL;
+
+    for (i = 0; i < nents; i++) {
+        if (!sg[i].len || sg[i].len > chan->max_len) {
+            dma_desc_put(desc);
+            return NULL;
+        }
+        if (dir == DMA_MEM_TO_DEV)
+            dma_desc_add_cb(desc, info, sg[i].addr, dev_addr, sg[i].len);
+        else if (sg[i].addr == DMA_SG_DISCARD)
+            dma_desc_add_cb(desc, (info & ~DMA_TI_DEST_INC) | DMA_TI_DEST_IGNORE,
+                            dev_addr, 0, sg[i].len);
+        else
+            dma_desc_add_cb(desc, info, dev_addr, sg[i].addr, sg[i].len);
+    }
+    dma_desc_finish(desc);
+
+    return desc;
+}
+
+dma_cookie_t dma_submit(struct dma_desc *desc, dma_callback_t callback,
+                        void *param)
+{
+    struct dma_chan *chan = desc->chan;
+    unsigned long flags;
+
+    desc->callback = callback;
+    desc->param = param;
+
+    flags = local_irq_save();
+    desc->cookie = ++chan->last_cookie;
+    if (chan->queue_tail) {
+        chan->queue_tail->next = desc;
+        chan->queue_tail = desc;
+    } else {
+        chan->queue_head = chan->queue_tail = desc;
+        dma_chan_start(chan, desc);
+    }
+    local_irq_restore(flags);
+
+    return desc->cookie;
+}
+
+int dma_cookie_complete(struct dma_chan *chan, dma_cookie_t cookie)
+{
+    return (int32_t)(chan->completed_cookie - cookie) >= 0;
+}
+
+int dma_sync_wait(struct dma_chan *chan, dma_cookie_t cookie)
+{
+    unsigned int errors = chan->errors;
+    unsigned long flags;
+
+    while (!dma_cookie_complete(chan, cookie)) {
+        flags = local_irq_save();
+        dma_chan_complete(chan);
+        local_irq_restore(flags);
+    }
+
+    return chan->errors == errors ? 0 : -1;
+}
+
+void dma_terminate_all(struct dma_chan *chan)
+{
+    struct dma_desc *desc;
+    unsigned long flags;
+
+    flags = local_irq_save();
+    dma_chan_reset(chan);
+    dma_writel(chan, DMA_CS, DMA_CS_INT | DMA_CS_END);
+
+    for (desc = chan->queue_head; desc; desc = desc->next) {
+        chan->completed_cookie = desc->cookie;
+        desc->in_use = 0;
+    }
+    chan->queue_head = chan->queue_tail = NULL;
+    local_irq_restore(flags);
+}
+
+int bcm2837_dma_init(void)
+{
+    struct device_node *np = of_find_compatible_node(NULL, "brcm,bcm2835-dma");
+    uintptr_t base = (uintptr_t)of_iomap(np, 0);
+    uint32_t mask = DMA_CHANNEL_MASK, dt_mask;
+    unsigned int i;
+    int ret;
+
+    if (!base)
+        base = BCM2837_DMA_BASE;
+    /* Channels the firmware leaves to the ARM */
+    if (!of_property_read_u32(np, "brcm,dma-channel-mask", &dt_mask))
+        mask &= dt_mask;
+
+    for (i = 0; i < DMA_NR_CHANNELS; i++) {
+        struct dma_chan *chan = &dma_chans[i];
+
+        if (!(mask & (1U << i)))
+            continue;
+
+        chan->id = i;
+        chan->base = base + DMA_CHAN_OFFSET(i);
+        chan->max_len = i >= DMA_FIRST_LITE ? DMA_MAX_LEN_LITE : DMA_MAX_LEN_FULL;
+
+        ret = request_irq(DMA_CHAN_IRQ(i), bcm2837_dma_interrupt, 0, chan);
+        if (ret) {
+            uart_poll_puts("dma: failed to request channel IRQ\n");
+            chan->base = 0;
+            continue;
+        }
+        writel(readl(base + DMA_REG_ENABLE) | 1U << i, base + DMA_REG_ENABLE);
+    }
+
+    return 0;
+}
+arch_initcall(bcm2837_dma_init, "bcm2837_armctrl_init");
@@ -0,0 +1,194 @@
+/*
+ * BCM2837 GPIO
+ *
+ * Register layout (at physical address 0x3F200000):
+ *   0x00-0x14  GPFSEL0-5   function select, 3 bits per pin, 10 per word
+ *   0x1C-0x20  GPSET0-1    write 1 to drive a pin high
+ *   0x28-0x2C  GPCLR0-1    write 1 to drive a pin low
+ *   0x34-0x38  GPLEV0-1    pin levels
+ *   0x40-0x44  GPEDS0-1    event detect status, write 1 to clear
+ *   0x4C-0x50  GPREN0-1    rising edge detect enable
+ *   0x58-0x5C  GPFEN0-1    falling edge detect enable
+ *
+ * Only the function select needs a read-modify-write; levels are
+ * changed through the set and clear registers, which leave every other
+ * pin alone.
+ *
+ * A detected edge latches the pin's GPEDS bit, which raises gpio_int[0],
+ * [1] or [2] (GPU IRQs 49-51, for pins 0-27, 28-45 and 46-53) until it
+ * is cleared. One handler serves all three lines: it clears what it
+ * found pending before calling the pins' handlers, so an edge that
+ * comes in meanwhile is not lost.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <kernel/init.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <gpio/bcm2837_gpio.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+
+#define GPFSEL(n)       (0x00 + (n) * 4)
+#define GPSET(n)        (0x1C + (n) * 4)
+#define GPCLR(n)        (0x28 + (n) * 4)
+#define GPLEV(n)        (0x34 + (n) * 4)
+#define GPEDS(n)        (0x40 + (n) * 4)
+#define GPREN(n)        (0x4C + (n) * 4)
+#define GPFEN(n)        (0x58 + (n) * 4)
+
+/* gpio_int[n] = GPU IRQ 49 + n, + ARMCTRL_IRQ_OFFSET */
+#define GPIO_IRQ(n)     (49 + (n) + 32 + ARMCTRL_IRQ_OFFSET)
+#define GPIO_NR_IRQS    3
+
+struct gpio_irq_action {
+    irq_handler_t handler;
+    void *dev_id;
+};
+
+static struct gpio_irq_action gpio_irq_actions[BCM2837_NR_GPIOS];
+static unsigned int gpio_irqs_requested;   /* Bit n: gpio_int[n] */
+
+/* Used until bcm2837_gpio_init() has looked in the device tree */
+static uintptr_t gpio_base = IO_ADDRESS(BCM2837_GPIO_PA);
+
+static inline volatile uint32_t *gpio_reg(unsigned int off)
+{
+    return (volatile uint32_t *)(gpio_base + off);
+}
+
+void bcm2837_gpio_set_function(unsigned int gpio, unsigned int fsel)
+{
+    volatile uint32_t *reg;
+    unsigned int shift;
+    unsigned long flags;
+
+    if (gpio >= BCM2837_NR_GPIOS)
+        return;
+
+    reg = gpio_reg(GPFSEL(gpio / 10));
+    shift = (gpio % 10) * 3;
+
+    flags = local_irq_save();
+    *reg = (*reg & ~(7U << shift)) | ((fsel & 7) << shift);
+    local_irq_restore(flags);
+}
+
+void bcm2837_gpio_set(unsigned int gpio, int value)
+{
+    if (gpio >= BCM2837_NR_GPIOS)
+        return;
+
+    if (value)
+        *gpio_reg(GPSET(gpio / 32)) = 1U << (gpio % 32);
+    else
+        *gpio_reg(GPCLR(gpio / 32)) = 1U << (gpio % 32);
+}
+
+int bcm2837_gpio_get(unsigned int gpio)
+{
+    if (gpio >= BCM2837_NR_GPIOS)
+        return 0;
+
+    return (*gpio_reg(GPLEV(gpio / 32)) >> (gpio % 32)) & 1;
+}
+
+static unsigned int gpio_irq_line(unsigned int gpio)
+{
+    return gpio < 28 ? 0 : gpio < 46 ? 1 : 2;
+}
+
+static irqreturn_t bcm2837_gpio_interrupt(unsigned int irq, void *dev_id)
+{
+    struct gpio_irq_action *action;
+    irqreturn_t ret = IRQ_NONE;
+    unsigned int bank, gpio;
+    uint32_t pending;
+
+    for (bank = 0; bank < 2; bank++) {
+        pending = *gpio_reg(GPEDS(bank));
+        if (!pending)
+            continue;
+        *gpio_reg(GPEDS(bank)) = pending;
+
+        while (pending) {
+            gpio = bank * 32 + __builtin_ctz(pending);
+            pending &= pending - 1;
+            if (gpio >= BCM2837_NR_GPIOS)
+                break;
+            action = &gpio_irq_actions[gpio];
+            if (action->handler) {
+                action->handler(gpio, action->dev_id);
+                ret = IRQ_HANDLED;
+            }
+        }
+    }
+    return ret;
+}
+
+int bcm2837_gpio_request_irq(unsigned int gpio, unsigned int type,
+                             irq_handler_t handler, void *dev_id)
+{
+    unsigned int line, bank, bit;
+    unsigned long flags;
+
+    if (gpio >= BCM2837_NR_GPIOS || !handler ||
+        !(type & BCM2837_GPIO_IRQ_BOTH) || gpio_irq_actions[gpio].handler)
+        return -1;
+
+    line = gpio_irq_line(gpio);
+    if (!(gpio_irqs_requested & (1U << line))) {
+        if (request_irq(GPIO_IRQ(line), bcm2837_gpio_interrupt, IRQF_SHARED,
+                        NULL))
+            return -1;
+        gpio_irqs_requested |= 1U << line;
+        enable_irq(GPIO_IRQ(line));
+    }
+
+    bank = gpio / 32;
+    bit = 1U << (gpio % 32);
+
+    flags = local_irq_save();
+    gpio_irq_actions[gpio].handler = handler;
+    gpio_irq_actions[gpio].dev_id = dev_id;
+    /* Drop an edge seen before anyone asked */
+    *gpio_reg(GPEDS(bank)) = bit;
+    if (type & BCM2837_GPIO_IRQ_RISING)
+        *gpio_reg(GPREN(bank)) |= bit;
+    if (type & BCM2837_GPIO_IRQ_FALLING)
+        *gpio_reg(GPFEN(bank)) |= bit;
+    local_irq_restore(flags);
+
+    return 0;
+}
+
+void bcm2837_gpio_free_irq(unsigned int gpio)
+{
+    unsigned int bank, bit;
+    unsigned long flags;
+
+    if (gpio >= BCM2837_NR_GPIOS)
+        return;
+
+    bank = gpio / 32;
+    bit = 1U << (gpio % 32);
+
+    flags = local_irq_save();
+    *gpio_reg(GPREN(bank)) &= ~bit;
+    *gpio_reg(GPFEN(bank)) &= ~bit;
+    *gpio_reg(GPEDS(bank)) = bit;
+    gpio_irq_actions[gpio].handler = NULL;
+    local_irq_restore(flags);
+}
+
+int bcm2837_gpio_init(void)
+{
+    struct device_node *np = of_find_compatible_node(NULL, "brcm,bcm2835-gpio");
+    uintptr_t base = (uintptr_t)of_iomap(np, 0);
+
+    if (base)
+        gpio_base = base;
+    return 0;
+}
+arch_initcall(bcm2837_gpio_init);
@@ -0,0 +1,388 @@
+/*
+ * BCM2837 BSC1 I2C master
+ *
+ * Register layout (at physical address 0x3F804000):
+ *   0x00 - C     control: enable, interrupt enables, start, read
+ *   0x04 - S     status; CLKT, ERR and DONE are write 1 to clear
+ *   0x08 - DLEN  bytes in the transfer started by C.ST
+ *   0x0C - A     slave address
+ *   0x10 - FIFO  TX and RX data, 16 bytes deep
+ *   0x14 - DIV   clock divider: SCL = core clock / CDIV
+ *   0x18 - DEL   data delay after the falling and rising SCL edges
+ *   0x1C - CLKT  clock stretch timeout, in SCL cycles
+ *
+ * Every message is one BSC transfer of DLEN bytes, driven by the I2C
+ * interrupt (GPU IRQ 53, shared by all three BSC masters):
+ *
+ *  - a write enables C.INTT, and the handler refills the FIFO on S.TXW
+ *    until every byte of the message is in it;
+ *  - a read enables C.INTR, and the handler empties the FIFO on S.RXR
+ *    (3/4 full); the tail is collected on S.DONE.
+ *
+ * The controller does a repeated start if C.ST is written again while
+ * a transfer is still active, so the next message is started from the
+ * handler as soon as the current one needs nothing more from the CPU:
+ * once its last byte is in the TX FIFO, or out of the RX FIFO. Only the
+ * last message enables C.INTD; its S.DONE, or S.ERR (no acknowledge)
+ * or S.CLKT (slave held SCL too long) at any point, ends the
+ * transaction.
+ *
+ * The status register is only ever read from the handler, or from
+ * i2c_sync() when it runs with interrupts masked. That masked path is
+ * the only place that spins on S, and ft5x06 never takes it: its probe
+ * runs in an async initcall thread with interrupts on, and its report
+ * reads are queued with i2c_async() from the INT edge.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <serial_core.h>
+#include <kernel/init.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <kernel/sched.h>
+#include <gpio/bcm2837_gpio.h>
+#include <i2c/bcm2837_i2c.h>
+#include <i2c/i2c.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+
+#define BSC_C                   0x00
+#define BSC_S                   0x04
+#define BSC_DLEN                0x08
+#define BSC_A                   0x0C
+#define BSC_FIFO                0x10
+#define BSC_DIV                 0x14
+#define BSC_DEL                 0x18
+#define BSC_CLKT                0x1C
+
+/* C */
+#define BSC_C_READ              (1U << 0)
+#define BSC_C_CLEAR             (3U << 4)
+#define BSC_C_ST                (1U << 7)
+#define BSC_C_INTD              (1U << 8)
+#define BSC_C_INTT              (1U << 9)
+#define BSC_C_INTR              (1U << 10)
+#define BSC_C_I2CEN             (1U << 15)
+
+/* S */
+#define BSC_S_DONE              (1U << 1)
+#define BSC_S_TXW               (1U << 2)
+#define BSC_S_RXR               (1U << 3)
+#define BSC_S_TXD               (1U << 4)
+#define BSC_S_RXD               (1U << 5)
+#define BSC_S_ERR               (1U << 8)
+#define BSC_S_CLKT              (1U << 9)
+
+#define BSC_DEL_FEDL_SHIFT      16
+
+#define I2C_MAX_ADDR            0x7F
+#define I2C_DEFAULT_BUS_HZ      100000U
+
+/* Slaves may stretch the clock this long, as SMBus allows */
+#define I2C_CLKT_MS             35
+
+/* Used if the firmware does not report the core clock */
+#define I2C_DEFAULT_CORE_CLK    250000000U
+
+/* GPU IRQ 53 = bank 2 bit 21 = hwirq 85, + ARMCTRL_IRQ_OFFSET */
+#define I2C_IRQ                 (53 + 32 + ARMCTRL_IRQ_OFFSET)
+
+/* BSC1 pins, ALT0 */
+#define I2C1_SDA_GPIO           2
+#define I2C1_SCL_GPIO           3
+
+struct bcm2837_i2c {
+    uintptr_t base;
+    uint32_t core_clk;
+    uint32_t bus_hz;
+
+    struct i2c_transaction *queue_head;     /* Running transaction first */
+    struct i2c_transaction *queue_tail;
+    int busy;
+
+    /* Running transaction */
+    struct i2c_msg *msg;                    /* Message on the bus */
+    unsigned int msgs_left;                 /* Not yet started */
+    uint8_t *buf;                           /* Next byte of @msg */
+    size_t remaining;
+};
+
+static struct bcm2837_i2c bcm_i2c;
+
+static inline uint32_t bsc_readl(struct bcm2837_i2c *bi, unsigned int reg)
+{
+    return readl(bi->base + reg);
+}
+
+static inline void bsc_writel(struct bcm2837_i2c *bi, unsigned int reg, uint32_t val)
+{
+    writel(val, bi->base + reg);
+}
+
+static void i2c_start_transaction(struct bcm2837_i2c *bi);
+
+/* Called with IRQs masked from here on */
+
+static void i2c_finish_transaction(struct bcm2837_i2c *bi, int status)
+{
+    struct i2c_transaction *t = bi->queue_head;
+
+    /* Disables the controller and its interrupts too */
+    bsc_writel(bi, BSC_C, BSC_C_CLEAR);
+    bsc_writel(bi, BSC_S, BSC_S_CLKT | BSC_S_ERR | BSC_S_DONE);
+    bi->msg = NULL;
+
+    bi->queue_head = t->next;
+    if (!bi->queue_head)
+        bi->queue_tail = NULL;
+    bi->busy = 0;
+
+    t->status = status;
+    /* May queue another transaction, and start it if we are idle */
+    if (t->complete)
+        t->complete(t->context);
+
+    if (!bi->busy && bi->queue_head)
+        i2c_start_transaction(bi);
+}
+
+/* Start bi->msg, as a repeated start if a transfer is still active */
+static void i2c_start_msg(struct bcm2837_i2c *bi)
+{
+    struct i2c_msg *msg = bi->msg;
+    uint32_t c = BSC_C_I2CEN | BSC_C_ST;
+
+    if (!bi->msgs_left)
+        c |= BSC_C_INTD;
+    if (msg->flags & I2C_M_RD)
+        c |= BSC_C_READ | BSC_C_INTR;
+    else
+        c |= BSC_C_INTT;
+
+    bi->buf = msg->buf;
+    bi->remaining = msg->len;
+
+    bsc_writel(bi, BSC_A, msg->addr);
+    bsc_writel(bi, BSC_DLEN, msg->len);
+    bsc_writel(bi, BSC_C, c);
+}
+
+/* The current message needs nothing more: queue the next one */
+static void i2c_next_msg(struct bcm2837_i2c *bi)
+{
+    if (!bi->msgs_left)
+        return;
+    bi->msg++;
+    bi->msgs_left--;
+    i2c_start_msg(bi);
+}
+
+static void i2c_fill_fifo(struct bcm2837_i2c *bi)
+{
+    while (bi->remaining && (bsc_readl(bi, BSC_S) & BSC_S_TXD)) {
+        bsc_writel(bi, BSC_FIFO, *bi->buf++);
+        bi->remaining--;
+    }
+}
+
+static void i2c_drain_fifo(struct bcm2837_i2c *bi)
+{
+    while (bi->remaining && (bsc_readl(bi, BSC_S) & BSC_S_RXD)) {
+        *bi->buf++ = bsc_readl(bi, BSC_FIFO);
+        bi->remaining--;
+    }
+}
+
+static void i2c_service(struct bcm2837_i2c *bi)
+{
+    uint32_t s = bsc_readl(bi, BSC_S);
+
+    if (s & (BSC_S_ERR | BSC_S_CLKT)) {
+        i2c_finish_transaction(bi, -1);
+        return;
+    }
+
+    if (s & BSC_S_DONE) {
+        if (bi->msg->flags & I2C_M_RD)
+            i2c_drain_fifo(bi);
+        /* Done early: the slave or the controller cut it short */
+        i2c_finish_transaction(bi, bi->remaining || bi->msgs_left ? -1 : 0);
+        return;
+    }
+
+    if ((s & BSC_S_TXW) && !(bi->msg->flags & I2C_M_RD)) {
+        i2c_fill_fifo(bi);
+        if (!bi->remaining)
+            i2c_next_msg(bi);
+    } else if ((s & BSC_S_RXR) && (bi->msg->flags & I2C_M_RD)) {
+        i2c_drain_fifo(bi);
+        if (!bi->remaining)
+            i2c_next_msg(bi);
+    }
+}
+
+static void i2c_start_transaction(struct bcm2837_i2c *bi)
+{
+    struct i2c_transaction *t = bi->queue_head;
+
+    bi->busy = 1;
+
+    bsc_writel(bi, BSC_C, BSC_C_CLEAR);
+    bsc_writel(bi, BSC_S, BSC_S_CLKT | BSC_S_ERR | BSC_S_DONE);
+
+    bi->msg = t->msgs;
+    bi->msgs_left = t->nr_msgs - 1;
+    i2c_start_msg(bi);
+}
+
+static irqreturn_t bcm2837_i2c_interrupt(unsigned int irq, void *dev_id)
+{
+    struct bcm2837_i2c *bi = dev_id;
+
+    /* Shared with BSC0 and BSC2 */
+    if (!bi->msg)
+        return IRQ_NONE;
+
+    i2c_service(bi);
+    return IRQ_HANDLED;
+}
+
+int i2c_async(struct i2c_transaction *t)
+{
+    struct bcm2837_i2c *bi = &bcm_i2c;
+    unsigned long flags;
+    unsigned int i;
+
+    if (!bi->base || !t->nr_msgs || !t->msgs)
+        return -1;
+    for (i = 0; i < t->nr_msgs; i++)
+        if (t->msgs[i].addr > I2C_MAX_ADDR || !t->msgs[i].len ||
+            !t->msgs[i].buf)
+            return -1;
+
+    t->status = I2C_XFER_QUEUED;
+    t->next = NULL;
+
+    flags = local_irq_save();
+    if (bi->queue_tail)
+        bi->queue_tail->next = t;
+    else
+        bi->queue_head = t;
+    bi->queue_tail = t;
+
+    if (!bi->busy)
+        i2c_start_transaction(bi);
+    local_irq_restore(flags);
+
+    return 0;
+}
+
+int i2c_sync(struct i2c_transaction *t)
+{
+    unsigned long flags;
+
+    if (i2c_async(t))
+        return -1;
+
+    for (;;) {
+        flags = local_irq_save();
+        if (t->status != I2C_XFER_QUEUED)
+            break;
+        if (irqs_disabled_flags(flags))
+            /* The interrupt handler's work, for a waiter that masked it */
+            i2c_service(&bcm_i2c);
+        else
+            /* Woken by the I2C interrupt, taken on restore */
+            yield_or_wfi();
+        local_irq_restore(flags);
+    }
+    local_irq_restore(flags);
+
+    return t->status;
+}
+
+int i2c_write_read(uint16_t addr, const void *wbuf, size_t wlen,
+                   void *rbuf, size_t rlen)
+{
+    struct i2c_msg msgs[2] = {
+        { .addr = addr, .len = wlen, .buf = (uint8_t *)wbuf },
+        { .addr = addr, .flags = I2C_M_RD, .len = rlen, .buf = rbuf },
+    };
+    struct i2c_transaction t = {
+        .msgs = msgs,
+        .nr_msgs = 2,
+    };
+
+    if (wlen > UINT16_MAX || rlen > UINT16_MAX)
+        return -1;
+    return i2c_sync(&t);
+}
+
+/* The BSC1 node from the device tree, if there is one */
+static struct device_node *bcm2837_i2c_find_node(void)
+{
+    struct device_node *np = NULL;
+    unsigned long pa;
+
+    while ((np = of_find_compatible_node(np, "brcm,bcm2835-i2c")) != NULL) {
+        if (!of_device_is_available(np) || of_address_to_phys(np, 0, &pa, NULL))
+            continue;
+        if (pa == BCM2837_I2C1_PA)
+            return np;
+    }
+    return NULL;
+}
+
+int bcm2837_i2c_init(void)
+{
+    struct bcm2837_i2c *bi = &bcm_i2c;
+    struct device_node *np = bcm2837_i2c_find_node();
+    uint32_t cdiv, fedl, redl, clkt;
+    int ret;
+
+    if (!np || of_property_read_u32(np, "clock-frequency", &bi->bus_hz) ||
+        !bi->bus_hz)
+        bi->bus_hz = I2C_DEFAULT_BUS_HZ;
+
+    bcm2837_gpio_set_function(I2C1_SDA_GPIO, BCM2837_FSEL_ALT0);
+    bcm2837_gpio_set_function(I2C1_SCL_GPIO, BCM2837_FSEL_ALT0);
+
+    /* The mailbox is up by now (arch_initcall) unless it failed */
+    if (mbox_get_clock_rate(MBOX_CLK_CORE, &bi->core_clk) || !bi->core_clk)
+        bi->core_clk = I2C_DEFAULT_CORE_CLK;
+
+    /* Even divider, rounded up so the bus speed is not exceeded */
+    cdiv = (bi->core_clk + bi->bus_hz - 1) / bi->bus_hz;
+    cdiv += cdiv & 1;
+    if (cdiv > 65534)
+        cdiv = 65534;
+
+    clkt = (uint64_t)bi->bus_hz * I2C_CLKT_MS / 1000;
+    if (clkt > 0xFFFF)
+        clkt = 0xFFFF;
+
+    bi->base = IO_ADDRESS(BCM2837_I2C1_PA);
+    bsc_writel(bi, BSC_C, BSC_C_CLEAR);
+    bsc_writel(bi, BSC_S, BSC_S_CLKT | BSC_S_ERR | BSC_S_DONE);
+    bsc_writel(bi, BSC_DIV, cdiv);
+    /* Change SDA 1/16 of a period after SCL falls, sample it 1/4 after it rises */
+    fedl = cdiv / 16 ? cdiv / 16 : 1;
+    redl = cdiv / 4 ? cdiv / 4 : 1;
+    bsc_writel(bi, BSC_DEL, fedl << BSC_DEL_FEDL_SHIFT | redl);
+    bsc_writel(bi, BSC_CLKT, clkt);
+
+    ret = request_irq(I2C_IRQ, bcm2837_i2c_interrupt, IRQF_SHARED, bi);
+    if (ret) {
+        bi->base = 0;
+        return ret;
+    }
+    enable_irq(I2C_IRQ);
+
+    uart_poll_puts("i2c1: ");
+    uart_poll_put_dec(bi->bus_hz / 1000);
+    uart_poll_puts(" kHz\n");
+    return 0;
+}
+device_initcall(bcm2837_i2c_init, "bcm2837_gpio_init");
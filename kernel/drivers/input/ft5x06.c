@@ -0,0 +1,226 @@
+/*
+ * FocalTech FT5x06/FT6x36 touch controller
+ *
+ * The controller scans the panel on its own and pulls its INT line low
+ * for each new report. Registers from 0x02 hold the report, with one
+ * 6-byte slot per contact it can track (five on the FT5x06, two on the
+ * FT6x36, told apart by CHIP_ID):
+ *   0x02       TD_STATUS   number of contacts, low nibble
+ *   0x03 + 6n  XH          event (7:6), X (11:8)
+ *   0x04 + 6n  XL          X (7:0)
+ *   0x05 + 6n  YH          contact id (7:4), Y (11:8)
+ *   0x06 + 6n  YL          Y (7:0)
+ *   0x07-0x08 + 6n         weight and area, unused
+ *
+ * The falling edge on INT queues one I2C transaction that writes the
+ * register number and reads the whole report back after a repeated
+ * start; its completion interrupt turns the report into touch events.
+ * Nothing waits on the bus: an edge that comes in while a read is in
+ * flight is remembered, and the read is redone once the current one
+ * completes.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <serial_core.h>
+#include <kernel/init.h>
+#include <kernel/of.h>
+#include <gpio/bcm2837_gpio.h>
+#include <i2c/i2c.h>
+#include <input/ft5x06.h>
+#include <input/touch.h>
+#include <asm/irqflags.h>
+
+#define FT5X06_REG_TD_STATUS    0x02
+#define FT5X06_REG_CHIP_ID      0xA3
+
+/* FT5x06 chips track five contacts, the FT6x36 family two */
+#define FT5X06_MAX_POINTS       5
+#define FT6X36_MAX_POINTS       2
+#define FT5X06_POINT_LEN        6
+#define FT5X06_REPORT_LEN       (1 + FT5X06_MAX_POINTS * FT5X06_POINT_LEN)
+
+/* CHIP_ID values of the FT6x36 family */
+#define FT6206_CHIP_ID          0x06
+#define FT6236_CHIP_ID          0x36
+#define FT6336_CHIP_ID          0x64
+
+/* Event field of XH */
+#define FT5X06_EVENT_DOWN       0
+#define FT5X06_EVENT_UP         1
+#define FT5X06_EVENT_CONTACT    2
+#define FT5X06_EVENT_NONE       3
+
+#define FT5X06_ID_INVALID       0x0F
+
+struct ft5x06 {
+    uint16_t addr;
+    unsigned int int_gpio;
+    unsigned int max_points;
+
+    uint8_t reg;                            /* Written before each read */
+    uint8_t report[FT5X06_REPORT_LEN];
+    struct i2c_msg msgs[2];
+    struct i2c_transaction xfer;
+
+    int busy;                               /* Report read queued */
+    int pending;                            /* Another edge meanwhile */
+    unsigned long errors;
+};
+
+static struct ft5x06 ft5x06;
+
+static void ft5x06_parse(struct ft5x06 *ts)
+{
+    static const uint8_t event_type[] = {
+        [FT5X06_EVENT_DOWN] = TOUCH_DOWN,
+        [FT5X06_EVENT_UP] = TOUCH_UP,
+        [FT5X06_EVENT_CONTACT] = TOUCH_MOVE,
+    };
+    unsigned int contacts = ts->report[0] & 0x0F;
+    struct touch_event ev;
+    const uint8_t *p;
+    unsigned int i, event;
+
+    /* Read mid-update, or not a report at all */
+    if (contacts > ts->max_points) {
+        ts->errors++;
+        return;
+    }
+
+    /* Lifts come in slots past the contact count, so look at them all */
+    for (i = 0; i < ts->max_points; i++) {
+        p = &ts->report[1 + i * FT5X06_POINT_LEN];
+        event = p[0] >> 6;
+        ev.id = p[2] >> 4;
+        if (event == FT5X06_EVENT_NONE || ev.id == FT5X06_ID_INVALID)
+            continue;
+
+        ev.type = event_type[event];
+        ev.x = (p[0] & 0x0F) << 8 | p[1];
+        ev.y = (p[2] & 0x0F) << 8 | p[3];
+        touch_report(&ev);
+    }
+}
+
+static void ft5x06_read_report(struct ft5x06 *ts)
+{
+    ts->busy = 1;
+    ts->pending = 0;
+    if (i2c_async(&ts->xfer)) {
+        ts->busy = 0;
+        ts->errors++;
+    }
+}
+
+/* Completion of the report read, in interrupt context */
+static void ft5x06_read_done(void *context)
+{
+    struct ft5x06 *ts = context;
+
+    ts->busy = 0;
+    if (ts->xfer.status)
+        ts->errors++;
+    else
+        ft5x06_parse(ts);
+
+    if (ts->pending)
+        ft5x06_read_report(ts);
+}
+
+static irqreturn_t ft5x06_interrupt(unsigned int gpio, void *dev_id)
+{
+    struct ft5x06 *ts = dev_id;
+
+    if (ts->busy)
+        ts->pending = 1;
+    else
+        ft5x06_read_report(ts);
+    return IRQ_HANDLED;
+}
+
+static void ft5x06_probe_dt(struct ft5x06 *ts)
+{
+    struct device_node *np;
+    uint32_t val;
+
+    ts->addr = FT5X06_DEFAULT_ADDR;
+    ts->int_gpio = FT5X06_DEFAULT_INT_GPIO;
+
+    np = of_find_compatible_node(NULL, "edt,edt-ft5406");
+    if (!np)
+        np = of_find_compatible_node(NULL, "focaltech,ft6236");
+    if (!np || !of_device_is_available(np))
+        return;
+
+    if (!of_property_read_u32(np, "reg", &val))
+        ts->addr = val;
+    if (!of_property_read_u32(np, "interrupts", &val))
+        ts->int_gpio = val;
+}
+
+int ft5x06_init(void)
+{
+    struct ft5x06 *ts = &ft5x06;
+    uint8_t reg = FT5X06_REG_CHIP_ID, chip_id;
+    unsigned long flags;
+
+    ft5x06_probe_dt(ts);
+
+    /* Before the INT line is armed, so a plain synchronous read */
+    if (i2c_write_read(ts->addr, &reg, 1, &chip_id, 1)) {
+        uart_poll_puts("ft5x06: no controller\n");
+        return -1;
+    }
+
+    switch (chip_id) {
+    case FT6206_CHIP_ID:
+    case FT6236_CHIP_ID:
+    case FT6336_CHIP_ID:
+        ts->max_points = FT6X36_MAX_POINTS;
+        break;
+    default:
+        ts->max_points = FT5X06_MAX_POINTS;
+        break;
+    }
+
+    ts->reg = FT5X06_REG_TD_STATUS;
+    ts->msgs[0] = (struct i2c_msg){
+        .addr = ts->addr,
+        .len = 1,
+        .buf = &ts->reg,
+    };
+    ts->msgs[1] = (struct i2c_msg){
+        .addr = ts->addr,
+        .flags = I2C_M_RD,
+        .len = 1 + ts->max_points * FT5X06_POINT_LEN,
+        .buf = ts->report,
+    };
+    ts->xfer = (struct i2c_transaction){
+        .msgs = ts->msgs,
+        .nr_msgs = 2,
+        .complete = ft5x06_read_done,
+        .context = ts,
+    };
+
+    bcm2837_gpio_set_function(ts->int_gpio, BCM2837_FSEL_INPUT);
+    if (bcm2837_gpio_request_irq(ts->int_gpio, BCM2837_GPIO_IRQ_FALLING,
+                                 ft5x06_interrupt, ts))
+        return -1;
+
+    /* A report that was already waiting gave no edge */
+    flags = local_irq_save();
+    if (!bcm2837_gpio_get(ts->int_gpio) && !ts->busy)
+        ft5x06_read_report(ts);
+    local_irq_restore(flags);
+
+    uart_poll_puts("ft5x06: chip ");
+    uart_poll_put_hex(chip_id);
+    uart_poll_puts(", ");
+    uart_poll_put_dec(ts->max_points);
+    uart_poll_puts(" contacts, INT on GPIO ");
+    uart_poll_put_dec(ts->int_gpio);
+    uart_poll_puts("\n");
+    return 0;
+}
+device_initcall_async(ft5x06_init, "bcm2837_i2c_init", "bcm2837_gpio_init");
@@ -0,0 +1,76 @@
+/*
+ * Touch event queue
+ *
+ * See include/input/touch.h. @head and @tail run freely and are masked
+ * on use, so head - tail is the number of queued events.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <input/touch.h>
+#include <asm/irqflags.h>
+
+#define TOUCH_QUEUE_MASK        (TOUCH_QUEUE_SIZE - 1)
+
+static struct touch_event touch_queue[TOUCH_QUEUE_SIZE];
+static unsigned int touch_head;
+static unsigned int touch_tail;
+static unsigned long touch_nr_dropped;
+
+/* Newest queued event of contact @id, or NULL */
+static struct touch_event *touch_find_newest(uint8_t id)
+{
+    unsigned int i;
+
+    for (i = touch_head; i != touch_tail; i--)
+        if (touch_queue[(i - 1) & TOUCH_QUEUE_MASK].id == id)
+            return &touch_queue[(i - 1) & TOUCH_QUEUE_MASK];
+    return NULL;
+}
+
+void touch_report(const struct touch_event *ev)
+{
+    unsigned int queued, limit;
+    struct touch_event *last;
+    unsigned long flags;
+
+    flags = local_irq_save();
+    queued = touch_head - touch_tail;
+    limit = ev->type == TOUCH_UP ? TOUCH_QUEUE_SIZE :
+            TOUCH_QUEUE_SIZE - TOUCH_LIFT_RESERVE;
+
+    if (queued < limit) {
+        touch_queue[touch_head++ & TOUCH_QUEUE_MASK] = *ev;
+    } else if (ev->type == TOUCH_MOVE) {
+        last = &touch_queue[(touch_head - 1) & TOUCH_QUEUE_MASK];
+        if (last->type == TOUCH_MOVE && last->id == ev->id)
+            *last = *ev;
+        else
+            touch_nr_dropped++;
+    } else if (ev->type == TOUCH_UP && (last = touch_find_newest(ev->id))) {
+        *last = *ev;
+    } else {
+        touch_nr_dropped++;
+    }
+    local_irq_restore(flags);
+}
+
+int touch_get_event(struct touch_event *ev)
+{
+    unsigned long flags;
+    int ret = -1;
+
+    flags = local_irq_save();
+    if (touch_head != touch_tail) {
+        *ev = touch_queue[touch_tail++ & TOUCH_QUEUE_MASK];
+        ret = 0;
+    }
+    local_irq_restore(flags);
+
+    return ret;
+}
+
+unsigned long touch_dropped(void)
+{
+    return touch_nr_dropped;
+}
@@ -20,8 +20,12 @@
  *
  */
 
+#include <stddef.h>
 #include <stdint.h>
+#include <kernel/init.h>
 #include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <asm/io.h>
 
 #define HWIRQ_BANK(i)       (i >> 5)
 #define HWIRQ_BIT(i)        (1U << (i & 0x1f))
@@ -29,8 +33,11 @@
 #define NR_BANKS        3
 #define IRQ_PER_BANK    32
 
-/* ARM Control interrupt controller base address (0x7e00b200 in VC bus address) */
-#define ARMCTRL_IRQ_BASE    0x3F00B200
+/*
+ * ARM Control interrupt controller base address (0x7e00b200 in VC bus
+ * address), used when the device tree has no brcm,bcm2836-armctrl-ic
+ */
+#define ARMCTRL_IRQ_BASE    IO_ADDRESS(0x3F00B200)
 #define LOCAL_IRQ_GPU_FAST  8
 
 static const int reg_pending[] = { 0x00, 0x04, 0x08 };
@@ -86,7 +93,10 @@ static void bcm2837_chained_armctrl_irq(struct irq_desc *desc)
 
 int bcm2837_armctrl_init(void)
 {
-    intc.base = ARMCTRL_IRQ_BASE;
+    intc.base = (uintptr_t)of_iomap(of_find_compatible_node(NULL,
+                                    "brcm,bcm2836-armctrl-ic"), 0);
+    if (!intc.base)
+        intc.base = ARMCTRL_IRQ_BASE;
     for (int b = 0; b < NR_BANKS; b++) {
         intc.pending[b] = (volatile uint32_t *)(intc.base + reg_pending[b]);
         intc.enable[b] = (volatile uint32_t *)(intc.base + reg_enable[b]);
@@ -110,3 +120,5 @@ int bcm2837_armctrl_init(void)
     irq_set_chained_handler(LOCAL_IRQ_GPU_FAST, bcm2837_chained_armctrl_irq);
     return 0;
 }
+/* Chains off the local controller's GPU interrupt */
+core_initcall(bcm2837_armctrl_init, "bcm2837_irq_init");
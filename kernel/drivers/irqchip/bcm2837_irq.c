@@ -1,26 +1,25 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <kernel/irq_chip.h>
+#include <kernel/init.h>
 #include <kernel/irq.h>
+#include <kernel/of.h>
+#include <irqchip/bcm2837.h>
+#include <asm/io.h>
 #include <asm/smp.h>
 
-#define LOCAL_IRQ_CNTPSIRQ	0
-#define LOCAL_IRQ_CNTPNSIRQ	1
-#define LOCAL_IRQ_CNTHPIRQ	2
-#define LOCAL_IRQ_CNTVIRQ	3
-#define LOCAL_IRQ_MAILBOX0	4
-#define LOCAL_IRQ_MAILBOX1	5
-#define LOCAL_IRQ_MAILBOX2	6
-#define LOCAL_IRQ_MAILBOX3	7
-#define LOCAL_IRQ_GPU_FAST	8
-#define LOCAL_IRQ_PMU_FAST	9
-#define LOCAL_IRQ_SIZE LOCAL_IRQ_PMU_FAST + 1
-
 // Local Timer base address
 // Last 4 bits -> IRQ enable
 // Next 4 bits -> FIQ enable
 #define LOCAL_TIMER_BASE_CONTROL_OFFSET 0x040
 
+/* Mailbox IRQ control per CPU: bits 0-3 enable IRQs for mailboxes 0-3 */
+#define LOCAL_MAILBOX_INT_CONTROL_OFFSET(cpu)   (0x050 + ((cpu) * 4))
+
+/* Mailbox write-set and read/write-clear registers, 4 per CPU */
+#define LOCAL_MAILBOX_SET_OFFSET(cpu, mbox)     (0x080 + ((cpu) * 16) + ((mbox) * 4))
+#define LOCAL_MAILBOX_CLR_OFFSET(cpu, mbox)     (0x0C0 + ((cpu) * 16) + ((mbox) * 4))
+
 /* IRQ pending register per CPU */
 #define LOCAL_IRQ_PENDING_OFFSET(cpu)   (0x060 + (cpu * 4))
 
@@ -29,8 +28,8 @@
 /* Setting bits 0-3 disables PMU interrupts, each corresponding to a CPUß */
 #define LOCAL_PM_ROUTING_CLR		0x014
 
-/* TODO: not a fan of defining these addresses hardcoded, will DT once we have that setup */
-#define BCM2837_IRQ_BASE 0x40000000
+/* Used until bcm2837_irq_init() has looked in the device tree */
+#define BCM2837_IRQ_BASE IO_ADDRESS(0x40000000)
 
 struct bcm2837_irqchip_intc {
    uintptr_t base; 
@@ -111,6 +110,45 @@ static struct irq_chip bcm2837_pmu_irqchip = {
     .irq_unmask = bcm2837_pmu_irq_unmask,
 };
 
+static volatile uint32_t *bcm2837_mailbox_int_control(void)
+{
+    return (volatile uint32_t *)(bcm2837_irqchip.base +
+                                 LOCAL_MAILBOX_INT_CONTROL_OFFSET(smp_processor_id()));
+}
+
+static void bcm2837_mailbox_irq_mask(struct irq_data *d)
+{
+    *bcm2837_mailbox_int_control() &= ~(1U << (d->hwirq - LOCAL_IRQ_MAILBOX0));
+}
+
+static void bcm2837_mailbox_irq_unmask(struct irq_data *d)
+{
+    *bcm2837_mailbox_int_control() |= (1U << (d->hwirq - LOCAL_IRQ_MAILBOX0));
+}
+
+static struct irq_chip bcm2837_mailbox_irqchip = {
+    .name       = "bcm2837-mailbox-irqchip",
+    .irq_mask   = bcm2837_mailbox_irq_mask,
+    .irq_unmask = bcm2837_mailbox_irq_unmask,
+};
+
+void bcm2837_mailbox_send(unsigned int cpu, unsigned int mbox, uint32_t bits)
+{
+    volatile uint32_t *reg = (volatile uint32_t *)(bcm2837_irqchip.base +
+                                                   LOCAL_MAILBOX_SET_OFFSET(cpu, mbox));
+    *reg = bits;
+}
+
+uint32_t bcm2837_mailbox_read_clear(unsigned int cpu, unsigned int mbox)
+{
+    volatile uint32_t *reg = (volatile uint32_t *)(bcm2837_irqchip.base +
+                                                   LOCAL_MAILBOX_CLR_OFFSET(cpu, mbox));
+    uint32_t bits = *reg;
+
+    *reg = bits;
+    return bits;
+}
+
 static void bcm2837_gpu_irq_mask(struct irq_data *d)
 {
 }
@@ -156,6 +194,12 @@ static void bcm2836_arm_irqchip_handle_irq(void)
 
 int bcm2837_irq_init(void)
 {
+    void __iomem *base = of_iomap(of_find_compatible_node(NULL,
+                                  "brcm,bcm2836-l1-intc"), 0);
+
+    if (base)
+        bcm2837_irqchip.base = (uintptr_t)base;
+
     // TODO: Ideally we should be assigning a virtual IRQ number for each hardware IRQ
     // Linux does this using irq_domain, we can implement something similar later
     
@@ -163,6 +207,10 @@ int bcm2837_irq_init(void)
     for (unsigned int i = LOCAL_IRQ_CNTPSIRQ; i <= LOCAL_IRQ_CNTVIRQ; i++) {
         irq_set_chip_and_handler(i, &bcm2837_timer_irqchip, handle_simple_irq);
     }
+    // Register mailbox IRQs with simple flow handler; handlers clear the mailbox
+    for (unsigned int i = LOCAL_IRQ_MAILBOX0; i <= LOCAL_IRQ_MAILBOX3; i++) {
+        irq_set_chip_and_handler(i, &bcm2837_mailbox_irqchip, handle_simple_irq);
+    }
     // Register PMU IRQ with simple flow handler
     irq_set_chip_and_handler(LOCAL_IRQ_PMU_FAST, &bcm2837_pmu_irqchip, handle_simple_irq);
     // Register GPU IRQ with simple flow handler
@@ -172,4 +220,5 @@ int bcm2837_irq_init(void)
     set_handle_irq(bcm2836_arm_irqchip_handle_irq);
     
     return 0;
-}
\ No newline at end of file
+}
+core_initcall(bcm2837_irq_init);
@@ -0,0 +1,394 @@
+/*
+ * BCM2837 VideoCore mailbox, property channel
+ *
+ * The ARM sends a message by writing the bus address of a 16-byte
+ * aligned buffer, ORed with the channel number, to mailbox 1; the
+ * firmware rewrites the buffer in place with its answers and posts the
+ * same word back in mailbox 0. The buffer is a page of the DMA coherent
+ * pool, so neither side needs cache maintenance; callers build their
+ * batch in ordinary memory and it is copied in and out around the
+ * transaction.
+ *
+ * Completion: mailbox 0 raises ARMCTRL basic IRQ 1 (virq 17) while it
+ * holds a message. The handler drains it and marks the transaction
+ * done. The submitter sleeps in wfi until then, which also works while
+ * interrupts are still masked during boot: the pending interrupt wakes
+ * the core and the waiter drains the mailbox itself. With interrupts
+ * on, it lets other threads run instead; there is one buffer, so a
+ * second submitter waits for the first message to complete.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <serial_core.h>
+#include <kernel/dma-mapping.h>
+#include <kernel/init.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <kernel/sched.h>
+#include <kernel/string.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <asm/barrier.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+
+/* Used when the device tree has no brcm,bcm2835-mbox */
+#define BCM2837_MBOX_BASE       IO_ADDRESS(0x3F00B880)
+
+/* Mailbox 0 (VideoCore to ARM) and mailbox 1 (ARM to VideoCore) */
+#define MBOX0_READ              0x00
+#define MBOX0_STATUS            0x18
+#define MBOX0_CONFIG            0x1C
+#define MBOX1_WRITE             0x20
+#define MBOX1_STATUS            0x38
+
+#define MBOX_STATUS_FULL        (1U << 31)
+#define MBOX_STATUS_EMPTY       (1U << 30)
+
+/* Interrupt while mailbox 0 holds data */
+#define MBOX_CONFIG_DATA_IRQ    (1U << 0)
+
+#define MBOX_CHAN_PROPERTY      8
+
+/* ARMCTRL basic pending bit 1 */
+#define MBOX_IRQ                (1 + ARMCTRL_IRQ_OFFSET)
+
+/* Message header codes */
+#define MBOX_REQUEST            0x00000000
+#define MBOX_RESPONSE_OK        0x80000000
+/* Set in a tag's code word when the firmware answered it */
+#define MBOX_TAG_RESPONSE       (1U << 31)
+
+/* Tag header: id, value buffer size in bytes, request/response code */
+#define MBOX_TAG_HDR_WORDS      3
+/* Header of the message, then the end tag and padding to 16 bytes */
+#define MBOX_MSG_HDR_WORDS      2
+#define MBOX_MSG_TAIL_WORDS     4
+
+struct bcm2837_mbox {
+    uintptr_t base;
+    uint32_t *buf;              /* Coherent message buffer */
+    dma_addr_t bus;
+    volatile int done;
+    int busy;                   /* A message owns the buffer */
+};
+
+static struct bcm2837_mbox mbox = {
+    .base = BCM2837_MBOX_BASE,
+};
+
+static inline uint32_t mbox_readl(unsigned int reg)
+{
+    return readl(mbox.base + reg);
+}
+
+static inline void mbox_writel(unsigned int reg, uint32_t val)
+{
+    writel(val, mbox.base + reg);
+}
+
+/*
+ * Take every message out of mailbox 0. Called with IRQs masked, from
+ * the mailbox IRQ or from mbox_wait().
+ */
+static void mbox_rx(void)
+{
+    while (!(mbox_readl(MBOX0_STATUS) & MBOX_STATUS_EMPTY)) {
+        uint32_t msg = mbox_readl(MBOX0_READ);
+
+        if (msg == (mbox.bus | MBOX_CHAN_PROPERTY))
+            mbox.done = 1;
+    }
+}
+
+static irqreturn_t bcm2837_mbox_interrupt(unsigned int irq, void *dev_id)
+{
+    if (mbox_readl(MBOX0_STATUS) & MBOX_STATUS_EMPTY)
+        return IRQ_NONE;
+
+    mbox_rx();
+    return IRQ_HANDLED;
+}
+
+static void mbox_wait(void)
+{
+    unsigned long flags;
+
+    for (;;) {
+        flags = local_irq_save();
+        mbox_rx();
+        if (mbox.done)
+            break;
+        if (irqs_disabled_flags(flags))
+            /* Wakes on the mailbox IRQ even with interrupts masked */
+            wfi();
+        else
+            yield_or_wfi();
+        local_irq_restore(flags);
+    }
+    local_irq_restore(flags);
+}
+
+void mbox_batch_init(struct mbox_batch *b)
+{
+    b->len = MBOX_MSG_HDR_WORDS;
+    b->overflow = 0;
+}
+
+int mbox_batch_add(struct mbox_batch *b, uint32_t tag, const uint32_t *req,
+                   unsigned int req_words, unsigned int val_words)
+{
+    unsigned int handle = b->len;
+
+    if (val_words < req_words)
+        val_words = req_words;
+    if (b->overflow || handle + MBOX_TAG_HDR_WORDS + val_words +
+                       MBOX_MSG_TAIL_WORDS > MBOX_BATCH_WORDS) {
+        b->overflow = 1;
+        return -1;
+    }
+
+    b->buf[handle] = tag;
+    b->buf[handle + 1] = val_words * 4;
+    b->buf[handle + 2] = MBOX_REQUEST;
+    memset(&b->buf[handle + MBOX_TAG_HDR_WORDS], 0, val_words * 4);
+    if (req_words)
+        memcpy(&b->buf[handle + MBOX_TAG_HDR_WORDS], req, req_words * 4);
+
+    b->len += MBOX_TAG_HDR_WORDS + val_words;
+    return handle;
+}
+
+int mbox_batch_submit(struct mbox_batch *b)
+{
+    unsigned int len = b->len;
+    unsigned long flags;
+
+    if (!mbox.buf || b->overflow)
+        return -1;
+
+    /* The owner is a thread that yielded in mbox_wait() */
+    flags = local_irq_save();
+    while (mbox.busy)
+        schedule();
+    mbox.busy = 1;
+    local_irq_restore(flags);
+
+    /* End tag, then zeroes up to a multiple of 16 bytes */
+    do
+        b->buf[len++] = 0;
+    while (len & 3);
+
+    b->buf[0] = len * 4;
+    b->buf[1] = MBOX_REQUEST;
+    memcpy(mbox.buf, b->buf, len * 4);
+    mbox.done = 0;
+
+    /* The buffer must reach memory before the firmware is told */
+    dsb(st);
+    while (mbox_readl(MBOX1_STATUS) & MBOX_STATUS_FULL)
+        ;
+    mbox_writel(MBOX1_WRITE, mbox.bus | MBOX_CHAN_PROPERTY);
+
+    mbox_wait();
+
+    memcpy(b->buf, mbox.buf, len * 4);
+    mbox.busy = 0;
+    return b->buf[1] == MBOX_RESPONSE_OK ? 0 : -1;
+}
+
+const uint32_t *mbox_batch_value(const struct mbox_batch *b, int handle)
+{
+    uint32_t code;
+
+    if (handle < MBOX_MSG_HDR_WORDS || handle >= (int)b->len)
+        return NULL;
+
+    code = b->buf[handle + 2];
+    if (!(code & MBOX_TAG_RESPONSE) ||
+        (code & ~MBOX_TAG_RESPONSE) > b->buf[handle + 1])
+        return NULL;
+    return &b->buf[handle + MBOX_TAG_HDR_WORDS];
+}
+
+/*
+ * Send one tag and copy @out_words of its answer to @out
+ */
+static int mbox_property(uint32_t tag, const uint32_t *req,
+                         unsigned int req_words, uint32_t *out,
+                         unsigned int out_words)
+{
+    struct mbox_batch b;
+    const uint32_t *val;
+    int handle;
+
+    mbox_batch_init(&b);
+    handle = mbox_batch_add(&b, tag, req, req_words, out_words);
+    if (mbox_batch_submit(&b))
+        return -1;
+
+    val = mbox_batch_value(&b, handle);
+    if (!val)
+        return -1;
+    memcpy(out, val, out_words * 4);
+    return 0;
+}
+
+int mbox_get_firmware_revision(uint32_t *rev)
+{
+    return mbox_property(MBOX_TAG_GET_FIRMWARE_REV, NULL, 0, rev, 1);
+}
+
+int mbox_get_arm_memory(uint32_t *base, uint32_t *size)
+{
+    uint32_t val[2];
+
+    if (mbox_property(MBOX_TAG_GET_ARM_MEMORY, NULL, 0, val, 2))
+        return -1;
+    *base = val[0];
+    *size = val[1];
+    return 0;
+}
+
+/* Tags whose request is an ID and whose answer is (ID, value) */
+static int mbox_get_id_value(uint32_t tag, uint32_t id, uint32_t *value)
+{
+    uint32_t val[2];
+
+    if (mbox_property(tag, &id, 1, val, 2))
+        return -1;
+    *value = val[1];
+    return 0;
+}
+
+int mbox_get_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    return mbox_get_id_value(MBOX_TAG_GET_CLOCK_RATE, clk, rate);
+}
+
+int mbox_get_max_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    return mbox_get_id_value(MBOX_TAG_GET_MAX_CLOCK_RATE, clk, rate);
+}
+
+int mbox_get_min_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    return mbox_get_id_value(MBOX_TAG_GET_MIN_CLOCK_RATE, clk, rate);
+}
+
+int mbox_set_clock_rate(unsigned int clk, uint32_t rate, uint32_t *actual)
+{
+    /* ID, rate, skip setting turbo */
+    const uint32_t req[3] = { clk, rate, 0 };
+    uint32_t val[2];
+
+    if (mbox_property(MBOX_TAG_SET_CLOCK_RATE, req, 3, val, 2))
+        return -1;
+    /* The firmware answers 0 for a clock it does not know */
+    if (!val[1])
+        return -1;
+    if (actual)
+        *actual = val[1];
+    return 0;
+}
+
+int mbox_get_temperature(uint32_t *millicelsius)
+{
+    return mbox_get_id_value(MBOX_TAG_GET_TEMPERATURE, 0, millicelsius);
+}
+
+int mbox_get_max_temperature(uint32_t *millicelsius)
+{
+    return mbox_get_id_value(MBOX_TAG_GET_MAX_TEMPERATURE, 0, millicelsius);
+}
+
+int mbox_fb_alloc(struct mbox_fb_config *cfg)
+{
+    struct mbox_batch b;
+    const uint32_t *phys, *virt, *depth, *order, *alloc, *pitch;
+    int h_phys, h_virt, h_depth, h_order, h_alloc, h_pitch;
+
+    if (!cfg->virt_width || !cfg->virt_height) {
+        cfg->virt_width = cfg->width;
+        cfg->virt_height = cfg->height;
+    }
+
+    mbox_batch_init(&b);
+    h_phys = mbox_batch_add(&b, MBOX_TAG_FB_SET_PHYS_WH,
+                            (const uint32_t[]){ cfg->width, cfg->height }, 2, 2);
+    h_virt = mbox_batch_add(&b, MBOX_TAG_FB_SET_VIRT_WH,
+                            (const uint32_t[]){ cfg->virt_width, cfg->virt_height }, 2, 2);
+    mbox_batch_add(&b, MBOX_TAG_FB_SET_VIRT_OFFSET,
+                   (const uint32_t[]){ 0, 0 }, 2, 2);
+    h_depth = mbox_batch_add(&b, MBOX_TAG_FB_SET_DEPTH,
+                             &cfg->depth, 1, 1);
+    h_order = mbox_batch_add(&b, MBOX_TAG_FB_SET_PIXEL_ORDER,
+                             &cfg->pixel_order, 1, 1);
+    /* Request: alignment; answer: bus address and size */
+    h_alloc = mbox_batch_add(&b, MBOX_TAG_FB_ALLOCATE,
+                             (const uint32_t[]){ 4096 }, 1, 2);
+    h_pitch = mbox_batch_add(&b, MBOX_TAG_FB_GET_PITCH, NULL, 0, 1);
+
+    if (mbox_batch_submit(&b))
+        return -1;
+
+    phys = mbox_batch_value(&b, h_phys);
+    virt = mbox_batch_value(&b, h_virt);
+    depth = mbox_batch_value(&b, h_depth);
+    order = mbox_batch_value(&b, h_order);
+    alloc = mbox_batch_value(&b, h_alloc);
+    pitch = mbox_batch_value(&b, h_pitch);
+    if (!phys || !virt || !depth || !order || !alloc || !pitch || !alloc[0])
+        return -1;
+
+    cfg->width = phys[0];
+    cfg->height = phys[1];
+    cfg->virt_width = virt[0];
+    cfg->virt_height = virt[1];
+    cfg->depth = depth[0];
+    cfg->pixel_order = order[0];
+    cfg->bus_addr = alloc[0];
+    cfg->size = alloc[1];
+    cfg->pitch = pitch[0];
+    return 0;
+}
+
+int bcm2837_mbox_init(void)
+{
+    struct device_node *np = of_find_compatible_node(NULL, "brcm,bcm2835-mbox");
+    uintptr_t base = (uintptr_t)of_iomap(np, 0);
+    dma_addr_t bus;
+    uint32_t *buf;
+    uint32_t rev;
+    int ret;
+
+    if (base)
+        mbox.base = base;
+
+    buf = dma_alloc_coherent(MBOX_BATCH_WORDS * sizeof(uint32_t), &bus);
+    if (!buf)
+        return -1;
+
+    /* Drop anything left over from the firmware or a previous kernel */
+    while (!(mbox_readl(MBOX0_STATUS) & MBOX_STATUS_EMPTY))
+        mbox_readl(MBOX0_READ);
+
+    ret = request_irq(MBOX_IRQ, bcm2837_mbox_interrupt, 0, &mbox);
+    if (ret) {
+        dma_free_coherent(MBOX_BATCH_WORDS * sizeof(uint32_t), buf, bus);
+        return ret;
+    }
+    mbox_writel(MBOX0_CONFIG, MBOX_CONFIG_DATA_IRQ);
+    enable_irq(MBOX_IRQ);
+
+    mbox.bus = bus;
+    mbox.buf = buf;
+
+    if (!mbox_get_firmware_revision(&rev)) {
+        uart_poll_puts("mbox: firmware revision ");
+        uart_poll_put_dec(rev);
+        uart_poll_puts("\n");
+    }
+    return 0;
+}
+arch_initcall(bcm2837_mbox_init, "bcm2837_armctrl_init");
@@ -0,0 +1,237 @@
+/*
+ * Device tree lookups over the node index built by fdt.c
+ *
+ * of_nodes[] is in blob order, so a node's parent always comes before
+ * it and "the next compatible node" is simply the next match in the
+ * table. Property values are only ever read, straight from the blob.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/of.h>
+#include <kernel/string.h>
+#include <asm/io.h>
+#include "of_private.h"
+
+int of_have_populated_dt(void)
+{
+    return of_nr_nodes != 0;
+}
+
+/* @len bytes of @path match node name @name (unit address optional) */
+static int of_node_name_eq(const char *name, const char *path, size_t len)
+{
+    if (strncmp(name, path, len))
+        return 0;
+    return name[len] == '\0' || (name[len] == '@' && !memchr(path, '@', len));
+}
+
+struct device_node *of_find_node_by_path(const char *path)
+{
+    struct device_node *np;
+    unsigned int i;
+
+    if (!of_nr_nodes || *path != '/')
+        return NULL;
+
+    np = &of_nodes[0];
+    while (*path) {
+        size_t len;
+
+        while (*path == '/')
+            path++;
+        if (!*path)
+            break;
+        for (len = 0; path[len] && path[len] != '/'; len++)
+            ;
+
+        /* Children follow their parent in the table */
+        for (i = np - of_nodes + 1; i < of_nr_nodes; i++) {
+            if (of_nodes[i].parent == np &&
+                of_node_name_eq(of_nodes[i].name, path, len))
+                break;
+        }
+        if (i == of_nr_nodes)
+            return NULL;
+
+        np = &of_nodes[i];
+        path += len;
+    }
+
+    return np;
+}
+
+/* @str is one of the strings in the NUL-separated list @list */
+static int of_string_in_list(const char *list, int len, const char *str)
+{
+    size_t n = strlen(str) + 1;
+
+    while (len > 0) {
+        size_t l = strnlen(list, len) + 1;
+
+        if (l == n && !memcmp(list, str, n))
+            return 1;
+        list += l;
+        len -= l;
+    }
+    return 0;
+}
+
+int of_device_is_compatible(const struct device_node *np, const char *compat)
+{
+    return np && np->compatible &&
+           of_string_in_list(np->compatible, np->compatible_len, compat);
+}
+
+int of_device_is_available(const struct device_node *np)
+{
+    const char *status;
+    int len;
+
+    if (!np)
+        return 0;
+
+    status = of_get_property(np, "status", &len);
+    if (!status)
+        return 1;
+    return of_string_in_list(status, len, "okay") ||
+           of_string_in_list(status, len, "ok");
+}
+
+struct device_node *of_find_compatible_node(struct device_node *from,
+                                            const char *compat)
+{
+    unsigned int i = from ? from - of_nodes + 1 : 0;
+
+    for (; i < of_nr_nodes; i++) {
+        if (of_device_is_compatible(&of_nodes[i], compat))
+            return &of_nodes[i];
+    }
+    return NULL;
+}
+
+struct device_node *of_find_node_by_phandle(uint32_t phandle)
+{
+    if (!phandle)
+        return NULL;
+
+    for (unsigned int i = 0; i < of_nr_nodes; i++) {
+        if (of_nodes[i].phandle == phandle)
+            return &of_nodes[i];
+    }
+    return NULL;
+}
+
+const void *of_get_property(const struct device_node *np, const char *name,
+                            int *lenp)
+{
+    const void *val;
+    const char *pname;
+    uint32_t off;
+    int len;
+
+    if (!np)
+        return NULL;
+
+    /* Cached while indexing: no need to walk the property list */
+    if (!strcmp(name, "compatible")) {
+        val = np->compatible;
+        len = np->compatible_len;
+    } else if (!strcmp(name, "reg")) {
+        val = np->reg;
+        len = np->reg_len;
+    } else {
+        off = np->props;
+        while ((val = __of_next_prop(&off, &pname, &len)) != NULL) {
+            if (!strcmp(pname, name))
+                break;
+        }
+    }
+
+    if (val && lenp)
+        *lenp = len;
+    return val;
+}
+
+int of_property_read_u32(const struct device_node *np, const char *name,
+                         uint32_t *out)
+{
+    const uint32_t *val;
+    int len;
+
+    val = of_get_property(np, name, &len);
+    if (!val || len < 4)
+        return -1;
+
+    *out = be32_to_cpup(val);
+    return 0;
+}
+
+/* Map @addr on the bus below @bus to the address on @bus's parent */
+static int of_translate_one(const struct device_node *bus, uint64_t *addr)
+{
+    int cna = bus->n_addr_cells;
+    int cns = bus->n_size_cells;
+    int pna = bus->parent->n_addr_cells;
+    const uint32_t *ranges;
+    int len;
+
+    ranges = of_get_property(bus, "ranges", &len);
+    if (!ranges)
+        return -1;
+    /* Empty ranges: the bus maps addresses 1:1 */
+    if (!len)
+        return 0;
+
+    for (len /= 4; len >= cna + pna + cns; len -= cna + pna + cns) {
+        uint64_t child = of_read_number(ranges, cna);
+        uint64_t parent = of_read_number(ranges + cna, pna);
+        uint64_t size = of_read_number(ranges + cna + pna, cns);
+
+        if (*addr >= child && *addr - child < size) {
+            *addr = *addr - child + parent;
+            return 0;
+        }
+        ranges += cna + pna + cns;
+    }
+    return -1;
+}
+
+int of_address_to_phys(const struct device_node *np, int index,
+                       unsigned long *pa, unsigned long *size)
+{
+    const struct device_node *bus;
+    const uint32_t *reg;
+    uint64_t addr;
+    int na, ns;
+
+    if (!np || !np->parent || !np->reg || index < 0)
+        return -1;
+
+    na = np->parent->n_addr_cells;
+    ns = np->parent->n_size_cells;
+    if ((index + 1) * (na + ns) * 4 > np->reg_len)
+        return -1;
+
+    reg = np->reg + index * (na + ns);
+    addr = of_read_number(reg, na);
+
+    for (bus = np->parent; bus->parent; bus = bus->parent) {
+        if (of_translate_one(bus, &addr))
+            return -1;
+    }
+
+    *pa = addr;
+    if (size)
+        *size = of_read_number(reg + na, ns);
+    return 0;
+}
+
+void __iomem *of_iomap(const struct device_node *np, int index)
+{
+    unsigned long pa;
+
+    if (of_address_to_phys(np, index, &pa, NULL))
+        return NULL;
+    return (void __iomem *)IO_ADDRESS(pa);
+}
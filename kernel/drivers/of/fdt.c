@@ -0,0 +1,267 @@
+/*
+ * Flattened device tree parsing
+ *
+ * The blob is walked exactly once, by early_init_dt_scan(), to fill
+ * the static device_node table. Each node records where its property
+ * list starts, so property lookups later on only walk that list, and
+ * the values drivers use at probe time (compatible, reg, phandle and
+ * the cell sizes for its children) are picked out on the way.
+ *
+ * Every offset read from the blob is bounds checked against the header
+ * sizes: a truncated or corrupt blob makes the scan fail rather than
+ * read past the end.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/init.h>
+#include <kernel/mm.h>
+#include <kernel/of_fdt.h>
+#include <kernel/string.h>
+#include <asm/memory.h>
+#include "of_private.h"
+
+#define FDT_ALIGN(x)    (((x) + 3) & ~3U)
+
+struct device_node of_nodes[OF_MAX_NODES];
+unsigned int of_nr_nodes;
+
+static const char *fdt_blob;
+static uint32_t fdt_struct_end;
+static const char *fdt_strings;
+static uint32_t fdt_strings_size;
+
+static inline uint32_t fdt_word(uint32_t off)
+{
+    return be32_to_cpup((const uint32_t *)(fdt_blob + off));
+}
+
+#define fdt_get_header(h, field)    be32_to_cpup(&(h)->field)
+
+static int fdt_check_header(const struct fdt_header *h)
+{
+    uint32_t size;
+
+    if (((uintptr_t)h & 3) || fdt_get_header(h, magic) != FDT_MAGIC)
+        return -1;
+    if (fdt_get_header(h, version) < FDT_FIRST_VERSION ||
+        fdt_get_header(h, last_comp_version) > FDT_LAST_COMP)
+        return -1;
+
+    size = fdt_get_header(h, totalsize);
+    if (size < sizeof(*h))
+        return -1;
+    if ((fdt_get_header(h, off_dt_struct) & 3) ||
+        fdt_get_header(h, off_dt_struct) > size ||
+        fdt_get_header(h, size_dt_struct) > size - fdt_get_header(h, off_dt_struct))
+        return -1;
+    if (fdt_get_header(h, off_dt_strings) > size ||
+        fdt_get_header(h, size_dt_strings) > size - fdt_get_header(h, off_dt_strings))
+        return -1;
+    if ((fdt_get_header(h, off_mem_rsvmap) & 7) ||
+        fdt_get_header(h, off_mem_rsvmap) > size)
+        return -1;
+
+    return 0;
+}
+
+const void *__of_next_prop(uint32_t *off, const char **name, int *len)
+{
+    uint32_t o = *off;
+    uint32_t plen, nameoff;
+
+    while (o + 4 <= fdt_struct_end && fdt_word(o) == FDT_NOP)
+        o += 4;
+
+    if (o + 12 > fdt_struct_end || fdt_word(o) != FDT_PROP)
+        return NULL;
+
+    plen = fdt_word(o + 4);
+    nameoff = fdt_word(o + 8);
+    if (plen > fdt_struct_end - (o + 12) || nameoff >= fdt_strings_size)
+        return NULL;
+
+    *name = fdt_strings + nameoff;
+    *len = plen;
+    *off = FDT_ALIGN(o + 12 + plen);
+    return fdt_blob + o + 12;
+}
+
+/* Record one node and the properties the lookups keep at hand */
+static struct device_node *fdt_add_node(uint32_t *off, const char *name,
+                                        struct device_node *parent)
+{
+    struct device_node *np = &of_nodes[of_nr_nodes++];
+    const void *val;
+    const char *pname;
+    int len;
+
+    memset(np, 0, sizeof(*np));
+    np->name = name;
+    np->parent = parent;
+    np->props = *off;
+    /* Defaults from the devicetree specification */
+    np->n_addr_cells = 2;
+    np->n_size_cells = 1;
+
+    while ((val = __of_next_prop(off, &pname, &len)) != NULL) {
+        if (!strcmp(pname, "compatible")) {
+            np->compatible = val;
+            np->compatible_len = len;
+        } else if (!strcmp(pname, "reg")) {
+            np->reg = val;
+            np->reg_len = len;
+        } else if (len == 4 && (!strcmp(pname, "phandle") ||
+                                !strcmp(pname, "linux,phandle"))) {
+            np->phandle = be32_to_cpup(val);
+        } else if (len == 4 && !strcmp(pname, "#address-cells")) {
+            np->n_addr_cells = be32_to_cpup(val);
+        } else if (len == 4 && !strcmp(pname, "#size-cells")) {
+            np->n_size_cells = be32_to_cpup(val);
+        }
+    }
+
+    return np;
+}
+
+/* Walk the structure block once and build of_nodes[] */
+static int fdt_unflatten(uint32_t off)
+{
+    struct device_node *stack[OF_MAX_DEPTH];
+    int depth = 0;
+
+    while (off + 4 <= fdt_struct_end) {
+        uint32_t tag = fdt_word(off);
+        const char *name;
+        uint32_t end;
+
+        off += 4;
+        switch (tag) {
+        case FDT_BEGIN_NODE:
+            name = fdt_blob + off;
+            for (end = off; end < fdt_struct_end && fdt_blob[end]; end++)
+                ;
+            if (end == fdt_struct_end)
+                return -1;
+            off = FDT_ALIGN(end + 1);
+
+            if (depth == OF_MAX_DEPTH || of_nr_nodes == OF_MAX_NODES)
+                return -1;
+            stack[depth] = fdt_add_node(&off, name, depth ? stack[depth - 1] : NULL);
+            depth++;
+            break;
+        case FDT_END_NODE:
+            if (!depth--)
+                return -1;
+            break;
+        case FDT_NOP:
+            break;
+        case FDT_END:
+            return depth || !of_nr_nodes ? -1 : 0;
+        default:
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * RAM starting at 0, where the kernel is loaded. The firmware lists
+ * only the ARM's share of memory, so this also follows the GPU split.
+ */
+static void early_init_dt_scan_memory(void)
+{
+    struct device_node *root = &of_nodes[0];
+    int na = root->n_addr_cells, ns = root->n_size_cells;
+
+    for (unsigned int i = 0; i < of_nr_nodes; i++) {
+        struct device_node *np = &of_nodes[i];
+        const uint32_t *reg = np->reg;
+        const char *type;
+        int n, len;
+
+        type = of_get_property(np, "device_type", &len);
+        if (np->parent != root || !reg || !type ||
+            len != sizeof("memory") || strcmp(type, "memory"))
+            continue;
+
+        for (n = np->reg_len / (4 * (na + ns)); n--; reg += na + ns) {
+            uint64_t base = of_read_number(reg, na);
+            uint64_t size = of_read_number(reg + na, ns);
+
+            if (base != 0 || !size)
+                continue;
+            memory_end = size < RAM_MAX_PA ? size : RAM_MAX_PA;
+            memory_end &= PAGE_MASK;
+        }
+    }
+}
+
+/* The firmware's command line wins over the built-in one */
+static void early_init_dt_scan_chosen(void)
+{
+    struct device_node *chosen = of_find_node_by_path("/chosen");
+    const char *args;
+    int len;
+
+    args = of_get_property(chosen, "bootargs", &len);
+    if (!args || len <= 1 || args[len - 1])
+        return;
+
+    if (len > COMMAND_LINE_SIZE)
+        len = COMMAND_LINE_SIZE;
+    memcpy(boot_command_line, args, len - 1);
+    boot_command_line[len - 1] = '\0';
+}
+
+int early_init_dt_scan(const void *params)
+{
+    const struct fdt_header *h = params;
+
+    of_nr_nodes = 0;
+    fdt_blob = NULL;
+    if (!params || fdt_check_header(h))
+        return -1;
+
+    fdt_blob = params;
+    fdt_struct_end = fdt_get_header(h, off_dt_struct) + fdt_get_header(h, size_dt_struct);
+    fdt_strings = fdt_blob + fdt_get_header(h, off_dt_strings);
+    fdt_strings_size = fdt_get_header(h, size_dt_strings);
+    /* Property names are looked up with strcmp() */
+    if (!fdt_strings_size || fdt_strings[fdt_strings_size - 1]) {
+        fdt_blob = NULL;
+        return -1;
+    }
+
+    if (fdt_unflatten(fdt_get_header(h, off_dt_struct))) {
+        of_nr_nodes = 0;
+        fdt_blob = NULL;
+        return -1;
+    }
+
+    early_init_dt_scan_memory();
+    early_init_dt_scan_chosen();
+    return 0;
+}
+
+void early_init_fdt_scan_reserved_mem(void)
+{
+    const struct fdt_header *h = (const struct fdt_header *)fdt_blob;
+    uint32_t off, size;
+
+    if (!fdt_blob)
+        return;
+
+    size = fdt_get_header(h, totalsize);
+    page_alloc_reserve(__pa(fdt_blob), size);
+
+    for (off = fdt_get_header(h, off_mem_rsvmap); off + 16 <= size; off += 16) {
+        uint64_t base = of_read_number((const uint32_t *)(fdt_blob + off), 2);
+        uint64_t len = of_read_number((const uint32_t *)(fdt_blob + off + 8), 2);
+
+        if (!base && !len)
+            break;
+        page_alloc_reserve(base, len);
+    }
+}
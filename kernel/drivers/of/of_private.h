@@ -0,0 +1,23 @@
+#ifndef _OF_PRIVATE_H
+#define _OF_PRIVATE_H
+
+#include <kernel/of.h>
+
+/* Shared between the blob parser (fdt.c) and the lookups (base.c) */
+
+/* Sized for the Raspberry Pi trees with some room for overlays */
+#define OF_MAX_NODES    512
+#define OF_MAX_DEPTH    16
+
+extern struct device_node of_nodes[OF_MAX_NODES];
+extern unsigned int of_nr_nodes;
+
+/*
+ * __of_next_prop - Property at blob offset *@off, skipping NOPs
+ *
+ * Returns its value and advances *@off past it, or returns NULL at the
+ * first token that is not a property (the end of the node's list).
+ */
+const void *__of_next_prop(uint32_t *off, const char **name, int *len);
+
+#endif /* _OF_PRIVATE_H */
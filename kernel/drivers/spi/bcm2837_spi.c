@@ -0,0 +1,514 @@
+/*
+ * BCM2837 SPI0 master
+ *
+ * Register layout (at physical address 0x3F204000):
+ *   0x00 - CS    control and status
+ *   0x04 - FIFO  TX and RX data, 64 bytes deep each way
+ *   0x08 - CLK   clock divider: SCLK = core clock / CDIV
+ *   0x0C - DLEN  bytes to clock in DMA mode
+ *
+ * Chip select is the controller's own: it is asserted while CS.TA is
+ * set, which is from the start of a message to its end, across all of
+ * its transfers.
+ *
+ * Each transfer runs in one of two ways, both driven by interrupts:
+ *
+ *  - FIFO: the TX FIFO is filled, and the SPI interrupt (GPU IRQ 54)
+ *    fires when the RX FIFO is 3/4 full (CS.INTR) or the transfer has
+ *    drained (CS.INTD); the handler empties RX and refills TX.
+ *
+ *  - DMA, for transfers with data to send of SPI_DMA_MIN_LEN bytes or
+ *    more: with CS.DMAEN the FIFO takes 32-bit words, one DMA channel
+ *    feeds TX and another drains RX (into the buffer, or discarded),
+ *    both paced by the SPI DREQs. DLEN holds the byte count of the
+ *    phase, so one phase is at most SPI_DMA_CHUNK bytes. The RX channel
+ *    finishes last, once every byte has been clocked, and its
+ *    completion interrupt starts the next phase or the next transfer.
+ *    A length that is not a multiple of four finishes its last bytes
+ *    through the FIFO.
+ *
+ * Between transfers the completion interrupt sets the DC line for the
+ * next one, so a command/data sequence never waits for the CPU beyond
+ * one interrupt.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <serial_core.h>
+#include <kernel/dmaengine.h>
+#include <kernel/dma-mapping.h>
+#include <kernel/init.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <kernel/sched.h>
+#include <dma/bcm2837_dma.h>
+#include <gpio/bcm2837_gpio.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <spi/bcm2837_spi.h>
+#include <spi/spi.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+
+#define SPI_CS                  0x00
+#define SPI_FIFO                0x04
+#define SPI_CLK                 0x08
+#define SPI_DLEN                0x0C
+
+/* CS */
+#define SPI_CS_CPHA             (1U << 2)
+#define SPI_CS_CPOL             (1U << 3)
+#define SPI_CS_CLEAR_TX         (1U << 4)
+#define SPI_CS_CLEAR_RX         (1U << 5)
+#define SPI_CS_TA               (1U << 7)
+#define SPI_CS_DMAEN            (1U << 8)
+#define SPI_CS_INTD             (1U << 9)
+#define SPI_CS_INTR             (1U << 10)
+#define SPI_CS_DONE             (1U << 16)
+#define SPI_CS_RXD              (1U << 17)
+#define SPI_CS_TXD              (1U << 18)
+#define SPI_CS_RXR              (1U << 19)
+#define SPI_CS_CSPOL(n)         (1U << (21 + (n)))
+
+#define SPI_FIFO_SIZE           64
+#define SPI_NR_CS               3
+
+/* Below this, setting up two DMA channels costs more than the FIFO */
+#define SPI_DMA_MIN_LEN         96
+
+/*
+ * Per DMA phase: within the 16-bit DLEN and the 64KB limit of the lite
+ * channels, and a multiple of the FIFO word. A longer transfer simply
+ * runs several phases.
+ */
+#define SPI_DMA_CHUNK           0xFFF0U
+
+/* Used if the firmware does not report the core clock */
+#define SPI_DEFAULT_CORE_CLK    250000000U
+
+/* GPU IRQ 54 = bank 2 bit 22 = hwirq 86, + ARMCTRL_IRQ_OFFSET */
+#define SPI0_IRQ                (54 + 32 + ARMCTRL_IRQ_OFFSET)
+
+/* SPI0 pins, ALT0 */
+#define SPI0_FIRST_GPIO         7
+#define SPI0_LAST_GPIO          11
+
+struct bcm2837_spi {
+    uintptr_t base;
+    uint32_t core_clk;
+    struct dma_chan *tx_chan;
+    struct dma_chan *rx_chan;
+
+    struct spi_message *queue_head;     /* Running message first */
+    struct spi_message *queue_tail;
+    int busy;
+
+    /* Running message */
+    uint32_t cs;                        /* CS bits without TA */
+    unsigned int xfer_idx;
+    struct spi_transfer *xfer;
+    size_t pos;                         /* Bytes of @xfer done */
+
+    /* FIFO phase */
+    int fifo_active;
+    size_t tx_pos;
+    size_t rx_pos;
+
+    /* DMA phase */
+    int dma_active;
+    size_t dma_len;
+    dma_addr_t tx_dma;
+    dma_addr_t rx_dma;
+    dma_cookie_t rx_cookie;
+    struct dma_sg tx_sg;
+    struct dma_sg rx_sg;
+};
+
+static struct bcm2837_spi bcm_spi;
+
+static inline uint32_t spi_readl(struct bcm2837_spi *bs, unsigned int reg)
+{
+    return readl(bs->base + reg);
+}
+
+static inline void spi_writel(struct bcm2837_spi *bs, unsigned int reg, uint32_t val)
+{
+    writel(val, bs->base + reg);
+}
+
+static void spi_start_message(struct bcm2837_spi *bs);
+static void spi_start_transfer(struct bcm2837_spi *bs);
+
+/* Called with IRQs masked from here on */
+
+static void spi_finish_message(struct bcm2837_spi *bs, int status)
+{
+    struct spi_message *msg = bs->queue_head;
+
+    /* Drop TA: chip select goes inactive */
+    spi_writel(bs, SPI_CS, bs->cs | SPI_CS_CLEAR_TX | SPI_CS_CLEAR_RX);
+    bs->fifo_active = 0;
+    bs->dma_active = 0;
+
+    bs->queue_head = msg->next;
+    if (!bs->queue_head)
+        bs->queue_tail = NULL;
+    bs->busy = 0;
+
+    msg->status = status;
+    /* May queue another message, and start it if we are idle */
+    if (msg->complete)
+        msg->complete(msg->context);
+
+    if (!bs->busy && bs->queue_head)
+        spi_start_message(bs);
+}
+
+static void spi_transfer_done(struct bcm2837_spi *bs)
+{
+    bs->queue_head->actual_length += bs->xfer->len;
+    bs->xfer_idx++;
+    spi_start_transfer(bs);
+}
+
+static void spi_fifo_fill(struct bcm2837_spi *bs)
+{
+    const uint8_t *tx = bs->xfer->tx_buf;
+
+    /* Never more in flight than RX can hold, or the controller stalls */
+    while (bs->tx_pos < bs->xfer->len &&
+           bs->tx_pos - bs->rx_pos < SPI_FIFO_SIZE &&
+           (spi_readl(bs, SPI_CS) & SPI_CS_TXD)) {
+        spi_writel(bs, SPI_FIFO, tx ? tx[bs->tx_pos] : 0);
+        bs->tx_pos++;
+    }
+}
+
+static void spi_fifo_service(struct bcm2837_spi *bs)
+{
+    struct spi_transfer *t = bs->xfer;
+    uint8_t *rx = t->rx_buf;
+    uint32_t data;
+
+    while (bs->rx_pos < t->len && (spi_readl(bs, SPI_CS) & SPI_CS_RXD)) {
+        data = spi_readl(bs, SPI_FIFO);
+        if (rx)
+            rx[bs->rx_pos] = data;
+        bs->rx_pos++;
+    }
+
+    if (bs->rx_pos < t->len) {
+        spi_fifo_fill(bs);
+        return;
+    }
+
+    /* Every byte is back: mask INTR/INTD, keep chip select */
+    spi_writel(bs, SPI_CS, bs->cs | SPI_CS_TA);
+    bs->fifo_active = 0;
+    bs->pos = t->len;
+    spi_transfer_done(bs);
+}
+
+static void spi_start_fifo(struct bcm2837_spi *bs)
+{
+    bs->tx_pos = bs->rx_pos = bs->pos;
+    bs->fifo_active = 1;
+    spi_writel(bs, SPI_CS, bs->cs | SPI_CS_TA | SPI_CS_INTR | SPI_CS_INTD);
+    spi_fifo_fill(bs);
+}
+
+static void spi_continue(struct bcm2837_spi *bs);
+
+static void spi_dma_done(void *param, int error)
+{
+    struct bcm2837_spi *bs = param;
+    struct spi_transfer *t = bs->xfer;
+
+    dma_unmap_single(bs->tx_dma, bs->dma_len, DMA_TO_DEVICE);
+    if (t->rx_buf)
+        dma_unmap_single(bs->rx_dma, bs->dma_len, DMA_FROM_DEVICE);
+    bs->dma_active = 0;
+
+    /* Back to byte-wide FIFO access, chip select still asserted */
+    spi_writel(bs, SPI_CS, bs->cs | SPI_CS_TA);
+
+    if (error) {
+        dma_terminate_all(bs->tx_chan);
+        spi_finish_message(bs, -1);
+        return;
+    }
+
+    bs->pos += bs->dma_len;
+    spi_continue(bs);
+}
+
+static int spi_start_dma(struct bcm2837_spi *bs, size_t len)
+{
+    struct spi_transfer *t = bs->xfer;
+    struct dma_desc *tx_desc, *rx_desc;
+    dma_addr_t fifo = periph_to_dma(BCM2837_SPI0_PA + SPI_FIFO);
+
+    if (len > SPI_DMA_CHUNK)
+        len = SPI_DMA_CHUNK;
+
+    bs->dma_len = len;
+    bs->tx_dma = dma_map_single((void *)((const uint8_t *)t->tx_buf + bs->pos),
+                                len, DMA_TO_DEVICE);
+    bs->rx_dma = t->rx_buf ?
+                 dma_map_single((uint8_t *)t->rx_buf + bs->pos, len,
+                                DMA_FROM_DEVICE) :
+                 DMA_SG_DISCARD;
+
+    bs->tx_sg = (struct dma_sg){ bs->tx_dma, len };
+    bs->rx_sg = (struct dma_sg){ bs->rx_dma, len };
+
+    /* Both channels are ours alone and run one descriptor at a time */
+    rx_desc = dma_prep_slave_sg(bs->rx_chan, &bs->rx_sg, 1, DMA_DEV_TO_MEM,
+                                fifo, BCM2837_DREQ_SPI_RX);
+    tx_desc = dma_prep_slave_sg(bs->tx_chan, &bs->tx_sg, 1, DMA_MEM_TO_DEV,
+                                fifo, BCM2837_DREQ_SPI_TX);
+    if (!rx_desc || !tx_desc) {
+        dma_unmap_single(bs->tx_dma, len, DMA_TO_DEVICE);
+        if (t->rx_buf)
+            dma_unmap_single(bs->rx_dma, len, DMA_FROM_DEVICE);
+        return -1;
+    }
+
+    bs->dma_active = 1;
+    /* The count the controller clocks before it drops the DREQs */
+    spi_writel(bs, SPI_DLEN, len);
+    spi_writel(bs, SPI_CS, bs->cs | SPI_CS_TA | SPI_CS_DMAEN);
+    bs->rx_cookie = dma_submit(rx_desc, spi_dma_done, bs);
+    dma_submit(tx_desc, NULL, NULL);
+    return 0;
+}
+
+/* Run the next phase of the current transfer, or move past it */
+static void spi_continue(struct bcm2837_spi *bs)
+{
+    struct spi_transfer *t = bs->xfer;
+    size_t left = t->len - bs->pos;
+
+    if (!left) {
+        spi_transfer_done(bs);
+        return;
+    }
+
+    if (t->tx_buf && left >= SPI_DMA_MIN_LEN && bs->rx_chan &&
+        !spi_start_dma(bs, left & ~(size_t)3))
+        return;
+
+    spi_start_fifo(bs);
+}
+
+static void spi_start_transfer(struct bcm2837_spi *bs)
+{
+    struct spi_message *msg = bs->queue_head;
+    struct spi_transfer *t;
+
+    if (bs->xfer_idx == msg->nr_transfers) {
+        spi_finish_message(bs, 0);
+        return;
+    }
+
+    t = &msg->transfers[bs->xfer_idx];
+    bs->xfer = t;
+    bs->pos = 0;
+
+    /* The bus is idle here: the previous transfer has fully drained */
+    if (msg->spi->dc_gpio != SPI_NO_DC && t->dc != SPI_DC_KEEP)
+        bcm2837_gpio_set(msg->spi->dc_gpio, t->dc);
+
+    spi_continue(bs);
+}
+
+/* CLK value for @spi: even, rounded up so the device's limit is respected */
+static uint32_t spi_cdiv(struct bcm2837_spi *bs, struct spi_device *spi)
+{
+    uint32_t speed = spi->max_speed_hz ? spi->max_speed_hz : 1;
+    uint32_t cdiv;
+
+    cdiv = (bs->core_clk + speed - 1) / speed;
+    cdiv += cdiv & 1;
+    if (cdiv < 2)
+        cdiv = 2;
+    if (cdiv > 65534)
+        cdiv = 0;                       /* 0 divides by 65536 */
+    return cdiv;
+}
+
+static void spi_start_message(struct bcm2837_spi *bs)
+{
+    struct spi_message *msg = bs->queue_head;
+    struct spi_device *spi = msg->spi;
+    uint32_t cdiv = spi_cdiv(bs, spi);
+
+    bs->busy = 1;
+
+    bs->cs = spi->chip_select;
+    if (spi->mode & SPI_CPHA)
+        bs->cs |= SPI_CS_CPHA;
+    if (spi->mode & SPI_CPOL)
+        bs->cs |= SPI_CS_CPOL;
+    if (spi->mode & SPI_CS_HIGH)
+        bs->cs |= SPI_CS_CSPOL(spi->chip_select);
+
+    spi_writel(bs, SPI_CLK, cdiv);
+    spi_writel(bs, SPI_CS, bs->cs | SPI_CS_CLEAR_TX | SPI_CS_CLEAR_RX);
+
+    msg->actual_length = 0;
+    bs->xfer_idx = 0;
+    spi_start_transfer(bs);
+}
+
+static irqreturn_t bcm2837_spi_interrupt(unsigned int irq, void *dev_id)
+{
+    struct bcm2837_spi *bs = dev_id;
+
+    if (!bs->fifo_active)
+        return IRQ_NONE;
+
+    spi_fifo_service(bs);
+    return IRQ_HANDLED;
+}
+
+int spi_async(struct spi_message *msg)
+{
+    struct bcm2837_spi *bs = &bcm_spi;
+    unsigned long flags;
+
+    if (!bs->base || !msg->spi || msg->spi->chip_select >= SPI_NR_CS ||
+        (msg->nr_transfers && !msg->transfers))
+        return -1;
+
+    msg->status = SPI_MSG_QUEUED;
+    msg->actual_length = 0;
+    msg->next = NULL;
+
+    flags = local_irq_save();
+    if (bs->queue_tail)
+        bs->queue_tail->next = msg;
+    else
+        bs->queue_head = msg;
+    bs->queue_tail = msg;
+
+    if (!bs->busy)
+        spi_start_message(bs);
+    local_irq_restore(flags);
+
+    return 0;
+}
+
+/* The interrupt handlers' work, for a waiter that has them masked */
+static void spi_poll(struct bcm2837_spi *bs)
+{
+    if (bs->fifo_active)
+        spi_fifo_service(bs);
+    else if (bs->dma_active)
+        dma_sync_wait(bs->rx_chan, bs->rx_cookie);
+}
+
+int spi_sync(struct spi_message *msg)
+{
+    unsigned long flags;
+
+    if (spi_async(msg))
+        return -1;
+
+    for (;;) {
+        flags = local_irq_save();
+        if (msg->status != SPI_MSG_QUEUED)
+            break;
+        if (irqs_disabled_flags(flags))
+            spi_poll(&bcm_spi);
+        else
+            /* Woken by the SPI or DMA interrupt, taken on restore */
+            yield_or_wfi();
+        local_irq_restore(flags);
+    }
+    local_irq_restore(flags);
+
+    return msg->status;
+}
+
+int spi_write(struct spi_device *spi, const void *buf, size_t len, int dc)
+{
+    struct spi_transfer t = {
+        .tx_buf = buf,
+        .len = len,
+        .dc = dc,
+    };
+    struct spi_message msg = {
+        .spi = spi,
+        .transfers = &t,
+        .nr_transfers = 1,
+    };
+
+    return spi_sync(&msg);
+}
+
+uint32_t spi_effective_speed_hz(struct spi_device *spi)
+{
+    struct bcm2837_spi *bs = &bcm_spi;
+    uint32_t cdiv;
+
+    if (!bs->base)
+        return 0;
+    cdiv = spi_cdiv(bs, spi);
+    return cdiv ? bs->core_clk / cdiv : bs->core_clk / 65536;
+}
+
+int bcm2837_spi_init(void)
+{
+    struct bcm2837_spi *bs = &bcm_spi;
+    struct device_node *np;
+    uintptr_t base;
+    unsigned int gpio;
+    int ret;
+
+    np = of_find_compatible_node(NULL, "brcm,bcm2835-spi");
+    base = (uintptr_t)of_iomap(np, 0);
+    if (!base)
+        base = IO_ADDRESS(BCM2837_SPI0_PA);
+
+    for (gpio = SPI0_FIRST_GPIO; gpio <= SPI0_LAST_GPIO; gpio++)
+        bcm2837_gpio_set_function(gpio, BCM2837_FSEL_ALT0);
+
+    /* The mailbox is up by now (arch_initcall) unless it failed */
+    if (mbox_get_clock_rate(MBOX_CLK_CORE, &bs->core_clk) || !bs->core_clk)
+        bs->core_clk = SPI_DEFAULT_CORE_CLK;
+
+    bs->base = base;
+    spi_writel(bs, SPI_CS, SPI_CS_CLEAR_TX | SPI_CS_CLEAR_RX);
+
+    /*
+     * An empty TX FIFO has room, so TXD only reads 0 where nothing
+     * answers at all (an emulator without SPI0)
+     */
+    if (!(spi_readl(bs, SPI_CS) & SPI_CS_TXD)) {
+        uart_poll_puts("spi0: no controller\n");
+        bs->base = 0;
+        return -1;
+    }
+
+    ret = request_irq(SPI0_IRQ, bcm2837_spi_interrupt, 0, bs);
+    if (ret) {
+        bs->base = 0;
+        return ret;
+    }
+    enable_irq(SPI0_IRQ);
+
+    /* Without two channels every transfer goes through the FIFO */
+    bs->tx_chan = dma_request_chan();
+    bs->rx_chan = bs->tx_chan ? dma_request_chan() : NULL;
+    if (!bs->rx_chan && bs->tx_chan) {
+        dma_release_chan(bs->tx_chan);
+        bs->tx_chan = NULL;
+    }
+
+    uart_poll_puts("spi0: core clock ");
+    uart_poll_put_dec(bs->core_clk / 1000000);
+    uart_poll_puts(" MHz, ");
+    uart_poll_puts(bs->rx_chan ? "DMA\n" : "no DMA\n");
+    return 0;
+}
+device_initcall_async(bcm2837_spi_init, "bcm2837_dma_init", "bcm2837_gpio_init");
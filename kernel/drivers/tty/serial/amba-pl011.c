@@ -3,17 +3,31 @@
  *
  * This is a simplified UART driver for ARM PL011 UART controllers,
  * targeting the Raspberry Pi Zero 2 W.
- * Only basic polling and write (transmit) support is implemented.
+ * Only transmit is implemented: polled, and once pl011_dma_probe() has
+ * run, DMA from the serial core's log ring.
+ *
+ * DMA transmit uses two buffers that are kept queued on one channel:
+ * while one drains into the FIFO (paced by the UART TX DREQ), the other
+ * is already waiting behind it, and each completion refills its buffer
+ * from the ring and queues it again. The BCM DMA engine only does
+ * 32-bit writes to a peripheral and UARTDR takes its data from bits
+ * [7:0], so the buffers hold one character per word.
  *
  * Reference:
  * https://developer.arm.com/documentation/ddi0183/g/?lang=en
  *
  */   
 
+#include <stddef.h>
 #include <amba/serial.h>
 #include <serial_core.h>
 #include <types.h>
 #include <container_of.h> 
+#include <kernel/dmaengine.h>
+#include <kernel/init.h>
+#include <kernel/of.h>
+#include <dma/bcm2837_dma.h>
+#include <asm/irqflags.h>
 
 /* Register indices */
 enum {
@@ -54,10 +68,23 @@ static const uint16_t pl011_std_offsets[REG_ARRAY_SIZE] = {
     [REG_DMACR] = UARTDMACR,
 };
 
+/* One page of 32-bit FIFO writes per buffer */
+#define PL011_DMA_BUF_CHARS 1024
+
+struct pl011_dmatx {
+    struct dma_chan *chan;
+    uint32_t        *buf[2];
+    dma_addr_t       bus[2];
+    unsigned int     len[2];        /* Characters in flight, 0 if free */
+    dma_cookie_t     cookie[2];
+    unsigned int     next;          /* Buffer to fill and queue next */
+};
+
 struct uart_pl011_port {
     struct uart_port port;
     uintptr_t        base;
     const uint16_t  *offsets;
+    struct pl011_dmatx dmatx;
 };
 
 static struct uart_pl011_port pl011_uart0 = {
@@ -65,7 +92,9 @@ static struct uart_pl011_port pl011_uart0 = {
     .offsets = pl011_std_offsets,
     .port = {
         .membase  = (void *)PL011_UART0_BASE,
+        .mapbase  = PL011_UART0_PHYS,
         .uartclk  = PL011_UART_CLOCK_HZ,
+        .baud     = PL011_DEFAULT_BAUD,
         .fifosize = 16,
         .regshift = 0,
         .iotype   = UPIO_MEM,
@@ -89,6 +118,14 @@ static inline uint32_t pl011_read(struct uart_pl011_port *p,
     return *addr;
 }
 
+/* IBRD/FBRD only take effect on the next write to LCR_H */
+static void pl011_write_divisors(struct uart_pl011_port *uap,
+                                 unsigned int uartclk, unsigned int baud)
+{
+    pl011_write(uap, REG_IBRD, PL011_IBRD(uartclk, baud));
+    pl011_write(uap, REG_FBRD, PL011_FBRD(uartclk, baud));
+}
+
 /* uart_ops callbacks (serial_core-facing) */
 static int pl011_startup(struct uart_port *port)
 {
@@ -98,14 +135,41 @@ static int pl011_startup(struct uart_port *port)
     pl011_write(uap, REG_CR, 0);
     pl011_write(uap, REG_ICR, 0x7FF);
 
-    pl011_write(uap, REG_IBRD,
-        PL011_IBRD(port->uartclk, PL011_DEFAULT_BAUD));
-    pl011_write(uap, REG_FBRD,
-        PL011_FBRD(port->uartclk, PL011_DEFAULT_BAUD));
+    pl011_write_divisors(uap, port->uartclk, port->baud);
+
+    pl011_write(uap, REG_LCR_H, UARTLCR_H_WLEN_8 | UARTLCR_H_FEN);
+    pl011_write(uap, REG_CR, UARTCR_UARTEN | UARTCR_TXE | UARTCR_RXE);
+
+    return 0;
+}
+
+/*
+ * Follows the reprogramming sequence from the PL011 TRM: wait for the
+ * transmitter to go idle, disable the UART, flush the FIFO by clearing
+ * FEN, then write the divisors and latch them with LCR_H.
+ */
+static int pl011_set_termios(struct uart_port *port, unsigned int baud)
+{
+    struct uart_pl011_port *uap =
+        container_of(port, struct uart_pl011_port, port);
+    uint32_t cr, lcr_h;
+
+    if (!PL011_BAUD_VALID(port->uartclk, baud))
+        return -1;
+
+    while (pl011_read(uap, REG_FR) & UARTFR_BUSY);
+
+    cr = pl011_read(uap, REG_CR);
+    lcr_h = pl011_read(uap, REG_LCR_H);
+    pl011_write(uap, REG_CR, 0);
+    pl011_write(uap, REG_LCR_H, lcr_h & ~UARTLCR_H_FEN);
+
+    pl011_write_divisors(uap, port->uartclk, baud);
 
-    pl011_write(uap, REG_LCR_H, (3 << 5) | (1 << 4));
-    pl011_write(uap, REG_CR, (1 << 0) | (1 << 8) | (1 << 9));
+    pl011_write(uap, REG_LCR_H, lcr_h);
+    pl011_write(uap, REG_CR, cr);
 
+    port->baud = baud;
     return 0;
 }
 
@@ -114,19 +178,168 @@ static void pl011_poll_put_char(struct uart_port *port, unsigned char ch)
     struct uart_pl011_port *uap =
             container_of(port, struct uart_pl011_port, port);
 
-    while (pl011_read(uap, REG_FR) & (1 << 5));
+    while (pl011_read(uap, REG_FR) & UARTFR_TXFF);
 
     pl011_write(uap, REG_DR, ch);
 
 }
 
+static void pl011_dma_tx_callback(void *param, int error);
+
+/* Fill buffer @i from the ring and queue it; returns 0 if there was nothing to send */
+static int pl011_dma_tx_refill(struct uart_pl011_port *uap, unsigned int i)
+{
+    struct pl011_dmatx *dmatx = &uap->dmatx;
+    struct dma_desc *desc;
+    struct dma_sg sg;
+    const char *data;
+    unsigned int n = 0;
+    size_t avail;
+
+    /* The ring may wrap, so take up to two contiguous pieces */
+    while (n < PL011_DMA_BUF_CHARS && (avail = uart_tx_peek(&data)) != 0) {
+        size_t k;
+
+        if (avail > PL011_DMA_BUF_CHARS - n)
+            avail = PL011_DMA_BUF_CHARS - n;
+        for (k = 0; k < avail; k++)
+            dmatx->buf[i][n + k] = (unsigned char)data[k];
+        uart_tx_consume(avail);
+        n += avail;
+    }
+    if (!n)
+        return 0;
+
+    sg.addr = dmatx->bus[i];
+    sg.len = n * sizeof(uint32_t);
+    desc = dma_prep_slave_sg(dmatx->chan, &sg, 1, DMA_MEM_TO_DEV,
+                             periph_to_dma(uap->port.mapbase + UARTDR),
+                             BCM2837_DREQ_UART_TX);
+    if (!desc) {
+        /* Out of descriptors: fall back to the FIFO for this chunk */
+        for (unsigned int k = 0; k < n; k++)
+            pl011_poll_put_char(&uap->port, (unsigned char)dmatx->buf[i][k]);
+        return 1;
+    }
+
+    dmatx->len[i] = n;
+    dmatx->cookie[i] = dma_submit(desc, pl011_dma_tx_callback,
+                                  (void *)(uintptr_t)i);
+    return 1;
+}
+
+static void pl011_dma_start_tx(struct uart_port *port)
+{
+    struct uart_pl011_port *uap =
+            container_of(port, struct uart_pl011_port, port);
+    struct pl011_dmatx *dmatx = &uap->dmatx;
+    unsigned long flags;
+
+    flags = local_irq_save();
+    while (!dmatx->len[dmatx->next]) {
+        if (!pl011_dma_tx_refill(uap, dmatx->next))
+            break;
+        dmatx->next ^= 1;
+    }
+    local_irq_restore(flags);
+}
+
+static void pl011_dma_tx_callback(void *param, int error)
+{
+    unsigned int i = (unsigned int)(uintptr_t)param;
+
+    pl011_uart0.dmatx.len[i] = 0;
+    pl011_dma_start_tx(&pl011_uart0.port);
+}
+
+static int pl011_dma_poll_tx(struct uart_port *port)
+{
+    struct uart_pl011_port *uap =
+            container_of(port, struct uart_pl011_port, port);
+    struct pl011_dmatx *dmatx = &uap->dmatx;
+    /* Buffers complete in the order they were queued */
+    unsigned int oldest = dmatx->len[dmatx->next] ? dmatx->next : dmatx->next ^ 1;
+
+    if (dmatx->len[oldest])
+        dma_sync_wait(dmatx->chan, dmatx->cookie[oldest]);
+    else
+        pl011_dma_start_tx(port);
+
+    return dmatx->len[0] || dmatx->len[1] ||
+           (pl011_read(uap, REG_FR) & UARTFR_BUSY);
+}
+
 static const struct uart_ops pl011_uart_ops = {
     .startup       = pl011_startup,
     .poll_put_char = pl011_poll_put_char,
+    .set_termios   = pl011_set_termios,
 };
 
+static const struct uart_ops pl011_dma_uart_ops = {
+    .startup       = pl011_startup,
+    .poll_put_char = pl011_poll_put_char,
+    .start_tx      = pl011_dma_start_tx,
+    .poll_tx       = pl011_dma_poll_tx,
+    .set_termios   = pl011_set_termios,
+};
+
+/* Registers from the device tree when there is one */
+static void pl011_probe_dt(struct uart_pl011_port *uap)
+{
+    struct device_node *np = NULL;
+    unsigned long pa;
+
+    while ((np = of_find_compatible_node(np, "arm,pl011")) != NULL) {
+        if (!of_device_is_available(np) || of_address_to_phys(np, 0, &pa, NULL))
+            continue;
+        uap->base = IO_ADDRESS(pa);
+        uap->port.membase = (void *)uap->base;
+        uap->port.mapbase = pa;
+        return;
+    }
+}
+
 void pl011_register(void)
 {
+    pl011_probe_dt(&pl011_uart0);
     pl011_uart0.port.ops = &pl011_uart_ops;
     uart_add_one_port(&pl011_uart0.port);
 }
+
+/*
+ * pl011_dma_probe - Switch console output to DMA
+ *
+ * Needs the DMA engine, so it runs after pl011_register(). Until then,
+ * or if no channel is free, all output is sent polled. After it, only
+ * uart_sync_puts() still writes the FIFO directly.
+ */
+int pl011_dma_probe(void)
+{
+    struct uart_pl011_port *uap = &pl011_uart0;
+    struct pl011_dmatx *dmatx = &uap->dmatx;
+    int i;
+
+    dmatx->chan = dma_request_chan();
+    if (!dmatx->chan)
+        return -1;
+
+    for (i = 0; i < 2; i++) {
+        dmatx->buf[i] = dma_alloc_coherent(PL011_DMA_BUF_CHARS * sizeof(uint32_t),
+                                           &dmatx->bus[i]);
+        if (!dmatx->buf[i]) {
+            if (i)
+                dma_free_coherent(PL011_DMA_BUF_CHARS * sizeof(uint32_t),
+                                  dmatx->buf[0], dmatx->bus[0]);
+            dma_release_chan(dmatx->chan);
+            dmatx->chan = NULL;
+            return -1;
+        }
+        dmatx->len[i] = 0;
+    }
+    dmatx->next = 0;
+
+    pl011_write(uap, REG_DMACR, UARTDMACR_TXDMAE);
+    uap->port.ops = &pl011_dma_uart_ops;
+    return 0;
+}
+device_initcall(pl011_dma_probe, "bcm2837_dma_init");
@@ -1,5 +1,9 @@
 #include <serial_core.h>
 #include <types.h>
+#include <kernel/init.h>
+#include <kernel/kstrtox.h>
+#include <kernel/string.h>
+#include <asm/irqflags.h>
 
 #include <stdint.h>
 typedef unsigned int u32;
@@ -9,6 +13,27 @@ typedef unsigned int u32;
 #define UART0_DR             ((volatile u32*)(UART0_BASE + 0x00))
 
 static struct uart_port *active_uart;
+static void (*uart_mirror)(char c);
+
+/*
+ * Log ring for uart_write(). head and tail run freely and are masked
+ * on access; head - tail bytes are queued. '\n' is expanded to "\r\n"
+ * on the way in so drivers can send the ring contents as they are.
+ */
+#define UART_LOG_BUF_SIZE   (1 << 14)
+
+static char log_buf[UART_LOG_BUF_SIZE];
+static unsigned long log_head, log_tail;
+
+static inline unsigned long log_space(void)
+{
+    return UART_LOG_BUF_SIZE - (log_head - log_tail);
+}
+
+static inline void log_putc(char c)
+{
+    log_buf[log_head++ & (UART_LOG_BUF_SIZE - 1)] = c;
+}
 
 void uart_add_one_port(struct uart_port *port)
 {
@@ -17,8 +42,57 @@ void uart_add_one_port(struct uart_port *port)
         port->ops->startup(port);
 }
 
-void uart_poll_putc(char c)
+int uart_set_baud(unsigned int baud)
+{
+    if (!active_uart || !active_uart->ops || !active_uart->ops->set_termios)
+        return -1;
+
+    uart_flush();
+    return active_uart->ops->set_termios(active_uart, baud);
+}
+
+unsigned int uart_get_baud(void)
+{
+    return active_uart ? active_uart->baud : 0;
+}
+
+/*
+ * console=[<name>,]<baud>, e.g. console=ttyAMA0,921600. There is only
+ * one port, so the name is accepted but not checked.
+ */
+static int uart_console_setup(const char *val)
+{
+    const char *baud = val;
+    unsigned int rate;
+
+    for (const char *p = val; *p; p++)
+        if (*p == ',')
+            baud = p + 1;
+
+    if (baud == val && (*val < '0' || *val > '9'))
+        return 0;
+    if (kstrtouint(baud, 10, &rate))
+        return -1;
+    return uart_set_baud(rate);
+}
+early_param("console", uart_console_setup);
+
+void uart_set_mirror(void (*mirror)(char c))
+{
+    uart_mirror = mirror;
+}
+
+static int uart_has_async_tx(void)
 {
+    return active_uart && active_uart->ops && active_uart->ops->start_tx;
+}
+
+/* Straight into the UART FIFO, whatever else is queued */
+static void uart_fifo_putc(char c)
+{
+    if (uart_mirror)
+        uart_mirror(c);
+
     if (!active_uart || !active_uart->ops || !active_uart->ops->poll_put_char)
         return;
 
@@ -27,8 +101,128 @@ void uart_poll_putc(char c)
     active_uart->ops->poll_put_char(active_uart, c);
 }
 
+void uart_sync_putc(char c)
+{
+    uart_flush();
+    uart_fifo_putc(c);
+}
+
+void uart_sync_puts(const char *s)
+{
+    uart_flush();
+    while (*s)
+        uart_fifo_putc(*s++);
+}
+
+void uart_poll_putc(char c)
+{
+    if (uart_has_async_tx())
+        uart_write(&c, 1);
+    else
+        uart_fifo_putc(c);
+}
+
 void uart_poll_puts(const char *s)
 {
+    if (uart_has_async_tx()) {
+        uart_write(s, strlen(s));
+        return;
+    }
+
     while (*s)
-        uart_poll_putc(*s++);
-}
\ No newline at end of file
+        uart_fifo_putc(*s++);
+}
+
+void uart_poll_put_dec(uint64_t val)
+{
+    char buf[21];
+    int i = sizeof(buf) - 1;
+
+    buf[i] = '\0';
+    do {
+        buf[--i] = '0' + (val % 10);
+        val /= 10;
+    } while (val);
+
+    uart_poll_puts(&buf[i]);
+}
+
+void uart_poll_put_hex(uint64_t val)
+{
+    const char hex_chars[] = "0123456789abcdef";
+    char buf[19];
+    int i = sizeof(buf) - 1;
+
+    buf[i] = '\0';
+    do {
+        buf[--i] = hex_chars[val & 0xF];
+        val >>= 4;
+    } while (val);
+    buf[--i] = 'x';
+    buf[--i] = '0';
+
+    uart_poll_puts(&buf[i]);
+}
+
+size_t uart_write(const char *buf, size_t len)
+{
+    size_t done = 0;
+    unsigned long flags;
+
+    if (!uart_has_async_tx()) {
+        while (done < len)
+            uart_fifo_putc(buf[done++]);
+        return len;
+    }
+
+    while (done < len) {
+        flags = local_irq_save();
+        /* Keep room for the '\r' of a '\n' */
+        while (done < len && log_space() >= 2) {
+            if (uart_mirror)
+                uart_mirror(buf[done]);
+            if (buf[done] == '\n')
+                log_putc('\r');
+            log_putc(buf[done++]);
+        }
+        local_irq_restore(flags);
+
+        active_uart->ops->start_tx(active_uart);
+
+        /* Ring full: push some of it out before queueing more */
+        if (done < len && active_uart->ops->poll_tx)
+            active_uart->ops->poll_tx(active_uart);
+    }
+
+    return len;
+}
+
+void uart_flush(void)
+{
+    if (!uart_has_async_tx())
+        return;
+
+    active_uart->ops->start_tx(active_uart);
+    if (!active_uart->ops->poll_tx)
+        return;
+
+    while (active_uart->ops->poll_tx(active_uart) || log_head != log_tail)
+        ;
+}
+
+size_t uart_tx_peek(const char **data)
+{
+    unsigned long tail = log_tail & (UART_LOG_BUF_SIZE - 1);
+    size_t n = log_head - log_tail;
+
+    if (n > UART_LOG_BUF_SIZE - tail)
+        n = UART_LOG_BUF_SIZE - tail;
+
+    *data = &log_buf[tail];
+    return n;
+}
+
+void uart_tx_consume(size_t n)
+{
+    log_tail += n;
+}
@@ -0,0 +1,362 @@
+/*
+ * E-ink framebuffer core
+ *
+ * Keeps the packed screen copy, the dirty rectangles and the ghosting
+ * budget for the panel driver that registered it; see
+ * include/kernel/fb.h.
+ *
+ * Drawing, and so marking, may happen in interrupt context, so the
+ * dirty list is only touched with IRQs masked. fb_flush() takes the
+ * whole list in one go and refreshes from its copy, with IRQs on: what
+ * is marked during a slow refresh lands in a fresh list for the next
+ * flush.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/fb.h>
+#include <kernel/string.h>
+#include <asm/irqflags.h>
+
+static struct fb_info *registered_fb;
+
+struct fb_info *fb_get_info(void)
+{
+    return registered_fb;
+}
+
+int register_framebuffer(struct fb_info *info)
+{
+    unsigned int row_bytes;
+
+    if (!info->width || !info->height || !info->screen_base ||
+        !info->fbops || !info->fbops->fb_refresh)
+        return -1;
+    if (info->format != FB_FORMAT_MONO1 && info->format != FB_FORMAT_GRAY2 &&
+        info->format != FB_FORMAT_GRAY4)
+        return -1;
+
+    row_bytes = (info->width * info->format + 7) / 8;
+    if (!info->stride)
+        info->stride = row_bytes;
+    if (info->stride < row_bytes)
+        return -1;
+    if (!info->x_align)
+        info->x_align = 8 / info->format;
+    if (!info->ghost_budget)
+        info->ghost_budget = (uint64_t)FB_GHOST_SCREENS * info->width * info->height;
+
+    info->nr_dirty = 0;
+    info->ghost_used = 0;
+    /* Whatever the panel shows now is unknown: start from a clean screen */
+    info->full_pending = 1;
+    info->full_refreshes = 0;
+    info->partial_refreshes = 0;
+    info->pixels_refreshed = 0;
+    registered_fb = info;
+
+    uart_poll_puts("fb: ");
+    uart_poll_puts(info->name);
+    uart_poll_puts(" ");
+    uart_poll_put_dec(info->width);
+    uart_poll_puts("x");
+    uart_poll_put_dec(info->height);
+    uart_poll_puts(", ");
+    uart_poll_put_dec(info->format);
+    uart_poll_puts(" bpp\n");
+    return 0;
+}
+
+/* Dirty rectangle bookkeeping */
+
+static uint64_t rect_area(const struct fb_rect *r)
+{
+    return (uint64_t)r->w * r->h;
+}
+
+static uint64_t rect_cost(const struct fb_rect *r)
+{
+    return FB_REFRESH_COST + rect_area(r);
+}
+
+static void rect_union(const struct fb_rect *a, const struct fb_rect *b,
+                       struct fb_rect *out)
+{
+    unsigned int x0 = a->x < b->x ? a->x : b->x;
+    unsigned int y0 = a->y < b->y ? a->y : b->y;
+    unsigned int x1 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+    unsigned int y1 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+
+    out->x = x0;
+    out->y = y0;
+    out->w = x1 - x0;
+    out->h = y1 - y0;
+}
+
+static int rect_overlaps(const struct fb_rect *a, const struct fb_rect *b)
+{
+    return a->x < b->x + b->w && b->x < a->x + a->w &&
+           a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static int rect_contains(const struct fb_rect *a, const struct fb_rect *b)
+{
+    return b->x >= a->x && b->x + b->w <= a->x + a->w &&
+           b->y >= a->y && b->y + b->h <= a->y + a->h;
+}
+
+/* What merging @a and @b saves, negative if it costs more */
+static int64_t merge_gain(const struct fb_rect *a, const struct fb_rect *b)
+{
+    struct fb_rect u;
+
+    rect_union(a, b, &u);
+    return (int64_t)(rect_cost(a) + rect_cost(b)) - (int64_t)rect_cost(&u);
+}
+
+/* Clip @in to the screen and widen it to x_align; 0 if nothing is left */
+static int fb_clip_rect(const struct fb_info *info, const struct fb_rect *in,
+                        struct fb_rect *out)
+{
+    unsigned int x0, x1, y1;
+
+    if (in->x >= info->width || in->y >= info->height || !in->w || !in->h)
+        return 0;
+
+    x1 = in->w > info->width - in->x ? info->width : in->x + in->w;
+    y1 = in->h > info->height - in->y ? info->height : in->y + in->h;
+
+    x0 = in->x - in->x % info->x_align;
+    x1 += (info->x_align - x1 % info->x_align) % info->x_align;
+    if (x1 > info->width)
+        x1 = info->width;
+
+    out->x = x0;
+    out->y = in->y;
+    out->w = x1 - x0;
+    out->h = y1 - in->y;
+    return 1;
+}
+
+static void fb_remove_dirty(struct fb_info *info, int i)
+{
+    info->dirty[i] = info->dirty[--info->nr_dirty];
+}
+
+/* Called with IRQs masked */
+static void __fb_mark_dirty(struct fb_info *info, const struct fb_rect *rect)
+{
+    struct fb_rect r, *d;
+    int64_t gain, best_gain;
+    int i, best;
+
+    if (!fb_clip_rect(info, rect, &r))
+        return;
+
+again:
+    for (i = 0; i < info->nr_dirty; i++) {
+        d = &info->dirty[i];
+        if (rect_contains(d, &r))
+            return;
+        if (rect_overlaps(d, &r) || merge_gain(d, &r) >= 0) {
+            /* The union may now reach other rectangles too */
+            rect_union(d, &r, &r);
+            fb_remove_dirty(info, i);
+            goto again;
+        }
+    }
+
+    if (info->nr_dirty == FB_MAX_DIRTY) {
+        /* No room: fold into the rectangle it is cheapest to merge with */
+        best = 0;
+        best_gain = merge_gain(&info->dirty[0], &r);
+        for (i = 1; i < info->nr_dirty; i++) {
+            gain = merge_gain(&info->dirty[i], &r);
+            if (gain > best_gain) {
+                best_gain = gain;
+                best = i;
+            }
+        }
+        rect_union(&info->dirty[best], &r, &r);
+        fb_remove_dirty(info, best);
+        goto again;
+    }
+
+    info->dirty[info->nr_dirty++] = r;
+}
+
+void fb_mark_dirty(struct fb_info *info, const struct fb_rect *rect)
+{
+    unsigned long flags;
+
+    flags = local_irq_save();
+    __fb_mark_dirty(info, rect);
+    local_irq_restore(flags);
+}
+
+/* Put back what a failed flush took but did not refresh */
+static void fb_requeue_dirty(struct fb_info *info, const struct fb_rect *rects,
+                             int n, int full)
+{
+    unsigned long flags;
+    int i;
+
+    flags = local_irq_save();
+    for (i = 0; i < n; i++)
+        __fb_mark_dirty(info, &rects[i]);
+    if (full)
+        info->full_pending = 1;
+    local_irq_restore(flags);
+}
+
+void fb_force_full_refresh(struct fb_info *info)
+{
+    info->full_pending = 1;
+}
+
+static int fb_full_refresh(struct fb_info *info)
+{
+    struct fb_rect screen = { 0, 0, info->width, info->height };
+
+    if (info->fbops->fb_refresh(info, &screen, 1))
+        return -1;
+
+    info->full_refreshes++;
+    info->pixels_refreshed += rect_area(&screen);
+    info->ghost_used = 0;
+    return 0;
+}
+
+int fb_flush(struct fb_info *info)
+{
+    struct fb_rect rects[FB_MAX_DIRTY];
+    uint64_t dirty_area = 0, screen_area;
+    unsigned long flags;
+    int i, n, full;
+
+    flags = local_irq_save();
+    n = info->nr_dirty;
+    memcpy(rects, info->dirty, n * sizeof(rects[0]));
+    full = info->full_pending;
+    info->nr_dirty = 0;
+    info->full_pending = 0;
+    local_irq_restore(flags);
+
+    if (!n && !full)
+        return 0;
+
+    screen_area = (uint64_t)info->width * info->height;
+    for (i = 0; i < n; i++)
+        dirty_area += rect_area(&rects[i]);
+
+    if (full || info->ghost_used >= info->ghost_budget ||
+        dirty_area * 100 >= screen_area * FB_FULL_PERCENT) {
+        if (fb_full_refresh(info)) {
+            fb_requeue_dirty(info, rects, n, full);
+            return -1;
+        }
+        return 0;
+    }
+
+    for (i = n - 1; i >= 0; i--) {
+        if (info->fbops->fb_refresh(info, &rects[i], 0)) {
+            fb_requeue_dirty(info, rects, i + 1, 0);
+            return -1;
+        }
+
+        info->partial_refreshes++;
+        info->pixels_refreshed += rect_area(&rects[i]);
+        info->ghost_used += rect_area(&rects[i]);
+    }
+    return 0;
+}
+
+/* Drawing */
+
+static uint8_t *fb_pixel_byte(const struct fb_info *info, unsigned int x,
+                              unsigned int y)
+{
+    return info->screen_base + (size_t)y * info->stride +
+           x * info->format / 8;
+}
+
+/* Bits of the byte holding pixel @x, counted from the bottom */
+static unsigned int fb_pixel_shift(const struct fb_info *info, unsigned int x)
+{
+    unsigned int ppb = 8 / info->format;
+
+    return (ppb - 1 - x % ppb) * info->format;
+}
+
+unsigned int fb_get_pixel(const struct fb_info *info, unsigned int x,
+                          unsigned int y)
+{
+    unsigned int mask = (1U << info->format) - 1;
+    unsigned int level;
+
+    if (x >= info->width || y >= info->height)
+        return 0;
+
+    level = (*fb_pixel_byte(info, x, y) >> fb_pixel_shift(info, x)) & mask;
+    return level * FB_WHITE / mask;
+}
+
+static void fb_put_pixel(struct fb_info *info, unsigned int x, unsigned int y,
+                         unsigned int color)
+{
+    uint8_t *p = fb_pixel_byte(info, x, y);
+    unsigned int shift = fb_pixel_shift(info, x);
+    unsigned int mask = (1U << info->format) - 1;
+    /* The top bits of the 4-bit level */
+    unsigned int level = (color & 0xf) >> (4 - info->format);
+
+    *p = (*p & ~(mask << shift)) | (level << shift);
+}
+
+void fb_set_pixel(struct fb_info *info, unsigned int x, unsigned int y,
+                  unsigned int color)
+{
+    struct fb_rect r = { x, y, 1, 1 };
+
+    if (x >= info->width || y >= info->height)
+        return;
+
+    fb_put_pixel(info, x, y, color);
+    fb_mark_dirty(info, &r);
+}
+
+void fb_fill_rect(struct fb_info *info, const struct fb_rect *rect,
+                  unsigned int color)
+{
+    unsigned int ppb = 8 / info->format;    /* Pixels per byte */
+    unsigned int x0, x1, y, y1, x, head, body, level;
+    uint8_t fill;
+
+    if (rect->x >= info->width || rect->y >= info->height)
+        return;
+
+    x0 = rect->x;
+    x1 = rect->w > info->width - x0 ? info->width : x0 + rect->w;
+    y1 = rect->h > info->height - rect->y ? info->height : rect->y + rect->h;
+
+    /* The level repeated in every pixel of the byte */
+    level = (color & 0xf) >> (4 - info->format);
+    fill = level * (0xff / ((1U << info->format) - 1));
+
+    /* Pixels up to the first whole byte, the whole bytes, and the rest */
+    head = (ppb - x0 % ppb) % ppb;
+    if (head > x1 - x0)
+        head = x1 - x0;
+    body = (x1 - x0 - head) / ppb;
+
+    for (y = rect->y; y < y1; y++) {
+        for (x = x0; x < x0 + head; x++)
+            fb_put_pixel(info, x, y, color);
+        if (body)
+            memset(fb_pixel_byte(info, x0 + head, y), fill, body);
+        for (x = x0 + head + body * ppb; x < x1; x++)
+            fb_put_pixel(info, x, y, color);
+    }
+
+    fb_mark_dirty(info, rect);
+}
@@ -0,0 +1,306 @@
+/*
+ * 8-bit grey to panel format conversion
+ *
+ * The scalar versions of the conversion routines, which are also the
+ * reference for the NEON kernels, and the dispatch to those kernels;
+ * see include/kernel/fb_convert.h.
+ */
+
+#include <types.h>
+#include <kernel/fb_convert.h>
+#include <kernel/string.h>
+#include <asm/fb_convert.h>
+#ifdef __HAVE_ARCH_FB_CONVERT
+#include <asm/neon.h>
+#endif
+
+/* 4x4 Bayer matrix: thresholds 0-15 spread as evenly as possible */
+static const uint8_t bayer4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+/* Rounding bias of the pixel at (@x, @y), in 1/256 of a level */
+static unsigned int fb_pixel_bias(unsigned int x, unsigned int y,
+                                  unsigned int dither)
+{
+    if (dither == FB_DITHER_ORDERED)
+        return bayer4[y % 4][x % 4] * 16 + 8;
+    return 128;
+}
+
+/*
+ * Biases of a rectangle whose first pixel is at (@x, @y): pixel (i, j)
+ * of the rectangle takes bias[j % 4][i % 16]
+ */
+static void fb_dither_bias(uint8_t bias[4][16], unsigned int x,
+                           unsigned int y, unsigned int dither)
+{
+    unsigned int i, j;
+
+    for (j = 0; j < 4; j++)
+        for (i = 0; i < 16; i++)
+            bias[j][i] = fb_pixel_bias(x + i, y + j, dither);
+}
+
+static inline unsigned int fb_quantise(unsigned int g, unsigned int format,
+                                       unsigned int bias)
+{
+    return (g * ((1U << format) - 1) + bias) >> 8;
+}
+
+/* Scalar packing of pixels @x0 to @w of each row; @x0 a multiple of 16 */
+static void fb_pack_rows(uint8_t *dst, unsigned int dst_stride,
+                         const uint8_t *src, unsigned int src_stride,
+                         unsigned int x0, unsigned int w, unsigned int h,
+                         unsigned int format, const uint8_t bias[4][16])
+{
+    unsigned int ppb = 8 / format;
+    unsigned int x, y, i, byte;
+    const uint8_t *s, *b;
+    uint8_t *d;
+
+    for (y = 0; y < h; y++) {
+        s = src + (size_t)y * src_stride;
+        d = dst + (size_t)y * dst_stride;
+        b = bias[y % 4];
+
+        for (x = x0; x < w; x += ppb) {
+            byte = 0;
+            for (i = 0; i < ppb; i++)
+                byte = (byte << format) |
+                       fb_quantise(s[x + i], format, b[(x + i) % 16]);
+            d[x / ppb] = byte;
+        }
+    }
+}
+
+void fb_pack_gray8_ref(uint8_t *dst, unsigned int dst_stride,
+                       const uint8_t *src, unsigned int src_stride,
+                       unsigned int w, unsigned int h, unsigned int format,
+                       unsigned int x, unsigned int y, unsigned int dither)
+{
+    uint8_t bias[4][16];
+
+    fb_dither_bias(bias, x, y, dither);
+    fb_pack_rows(dst, dst_stride, src, src_stride, 0, w, h, format, bias);
+}
+
+void fb_pack_gray8(uint8_t *dst, unsigned int dst_stride,
+                   const uint8_t *src, unsigned int src_stride,
+                   unsigned int w, unsigned int h, unsigned int format,
+                   unsigned int x, unsigned int y, unsigned int dither)
+{
+    uint8_t bias[4][16];
+    unsigned int done = 0;
+
+    fb_dither_bias(bias, x, y, dither);
+
+#ifdef __HAVE_ARCH_FB_CONVERT
+    if ((size_t)w * h >= FB_NEON_MIN_PIXELS && may_use_simd()) {
+        kernel_neon_begin();
+        done = __fb_pack_gray8_neon(dst, dst_stride, src, src_stride,
+                                    w, h, format, bias);
+        kernel_neon_end();
+    }
+#endif
+
+    /* Whatever is left of each row */
+    fb_pack_rows(dst, dst_stride, src, src_stride, done, w, h, format, bias);
+}
+
+/* Scalar rotation of the pixels in [@x0, @x1) x [@y0, @y1) */
+static void fb_rotate_region(uint8_t *dst, unsigned int dst_stride,
+                             const uint8_t *src, unsigned int src_stride,
+                             unsigned int w, unsigned int h,
+                             unsigned int x0, unsigned int y0,
+                             unsigned int x1, unsigned int y1,
+                             unsigned int rotation)
+{
+    unsigned int x, y;
+    const uint8_t *s;
+
+    for (y = y0; y < y1; y++) {
+        s = src + (size_t)y * src_stride;
+        switch (rotation) {
+        case FB_ROTATE_90:
+            for (x = x0; x < x1; x++)
+                dst[(size_t)x * dst_stride + (h - 1 - y)] = s[x];
+            break;
+        case FB_ROTATE_180:
+            for (x = x0; x < x1; x++)
+                dst[(size_t)(h - 1 - y) * dst_stride + (w - 1 - x)] = s[x];
+            break;
+        case FB_ROTATE_270:
+            for (x = x0; x < x1; x++)
+                dst[(size_t)(w - 1 - x) * dst_stride + y] = s[x];
+            break;
+        }
+    }
+}
+
+static void fb_copy_rows(uint8_t *dst, unsigned int dst_stride,
+                         const uint8_t *src, unsigned int src_stride,
+                         unsigned int w, unsigned int h)
+{
+    unsigned int y;
+
+    for (y = 0; y < h; y++)
+        memcpy(dst + (size_t)y * dst_stride, src + (size_t)y * src_stride, w);
+}
+
+void fb_rotate_gray8_ref(uint8_t *dst, unsigned int dst_stride,
+                         const uint8_t *src, unsigned int src_stride,
+                         unsigned int w, unsigned int h,
+                         unsigned int rotation)
+{
+    if (rotation == FB_ROTATE_0)
+        fb_copy_rows(dst, dst_stride, src, src_stride, w, h);
+    else
+        fb_rotate_region(dst, dst_stride, src, src_stride, w, h,
+                         0, 0, w, h, rotation);
+}
+
+void fb_rotate_gray8(uint8_t *dst, unsigned int dst_stride,
+                     const uint8_t *src, unsigned int src_stride,
+                     unsigned int w, unsigned int h, unsigned int rotation)
+{
+    /* Top-left part done with NEON */
+    unsigned int bw = 0, bh = 0;
+
+    if (rotation == FB_ROTATE_0) {
+        fb_copy_rows(dst, dst_stride, src, src_stride, w, h);
+        return;
+    }
+
+#ifdef __HAVE_ARCH_FB_CONVERT
+    if ((size_t)w * h >= FB_NEON_MIN_PIXELS && may_use_simd()) {
+        bw = w & ~15U;
+        bh = h & ~7U;
+        kernel_neon_begin();
+        __fb_rotate_gray8_neon(dst, dst_stride, src, src_stride, w, h,
+                               bw, bh, rotation);
+        kernel_neon_end();
+    }
+#endif
+
+    /* The columns right of it, then the rows below it */
+    fb_rotate_region(dst, dst_stride, src, src_stride, w, h,
+                     bw, 0, w, h, rotation);
+    fb_rotate_region(dst, dst_stride, src, src_stride, w, h,
+                     0, bh, bw, h, rotation);
+}
+
+/* Blitting into the framebuffer */
+
+/* Floyd-Steinberg error of the current and the next row, one pixel of
+   margin on either side */
+static int16_t fs_err[2][FB_BLIT_MAX_WIDTH + 2];
+
+static void fb_put_level(struct fb_info *info, unsigned int x, unsigned int y,
+                         unsigned int level)
+{
+    uint8_t *p = info->screen_base + (size_t)y * info->stride +
+                 x * info->format / 8;
+    unsigned int ppb = 8 / info->format;
+    unsigned int shift = (ppb - 1 - x % ppb) * info->format;
+    unsigned int mask = (1U << info->format) - 1;
+
+    *p = (*p & ~(mask << shift)) | (level << shift);
+}
+
+static void fb_blit_fs(struct fb_info *info, unsigned int x0, unsigned int y0,
+                       unsigned int w, unsigned int h, const uint8_t *src,
+                       unsigned int src_stride)
+{
+    unsigned int steps = (1U << info->format) - 1;
+    int16_t *cur = fs_err[0], *next = fs_err[1], *tmp;
+    unsigned int x, y, level;
+    const uint8_t *s;
+    int v, e;
+
+    memset(fs_err, 0, sizeof(fs_err));
+
+    for (y = 0; y < h; y++) {
+        s = src + (size_t)y * src_stride;
+
+        /* Pixel x has its error at index x + 1 */
+        for (x = 0; x < w; x++) {
+            v = s[x] + cur[x + 1];
+            if (v < 0)
+                v = 0;
+            if (v > 255)
+                v = 255;
+
+            level = fb_quantise(v, info->format, 128);
+            fb_put_level(info, x0 + x, y0 + y, level);
+
+            e = v - (int)(level * 255 / steps);
+            cur[x + 2] += e * 7 / 16;
+            next[x] += e * 3 / 16;
+            next[x + 1] += e * 5 / 16;
+            next[x + 2] += e / 16;
+        }
+
+        tmp = cur;
+        cur = next;
+        next = tmp;
+        memset(next, 0, (w + 2) * sizeof(*next));
+    }
+}
+
+int fb_blit_gray8(struct fb_info *info, const struct fb_rect *rect,
+                  const uint8_t *src, unsigned int src_stride,
+                  unsigned int dither)
+{
+    unsigned int ppb = 8 / info->format;
+    unsigned int x0 = rect->x, y0 = rect->y;
+    unsigned int w, h, x, y, head, body;
+    const uint8_t *s;
+
+    if (dither > FB_DITHER_FS)
+        return -1;
+    if (x0 >= info->width || y0 >= info->height)
+        return 0;
+
+    w = rect->w > info->width - x0 ? info->width - x0 : rect->w;
+    h = rect->h > info->height - y0 ? info->height - y0 : rect->h;
+
+    if (dither == FB_DITHER_FS) {
+        if (w > FB_BLIT_MAX_WIDTH)
+            return -1;
+        fb_blit_fs(info, x0, y0, w, h, src, src_stride);
+        fb_mark_dirty(info, rect);
+        return 0;
+    }
+
+    /* Pixels up to the first whole byte, the whole bytes, and the rest */
+    head = (ppb - x0 % ppb) % ppb;
+    if (head > w)
+        head = w;
+    body = (w - head) / ppb * ppb;
+
+    if (body)
+        fb_pack_gray8(info->screen_base + (size_t)y0 * info->stride +
+                      (x0 + head) / ppb, info->stride,
+                      src + head, src_stride, body, h, info->format,
+                      x0 + head, y0, dither);
+
+    for (y = 0; y < h; y++) {
+        s = src + (size_t)y * src_stride;
+        for (x = 0; x < w; x++) {
+            if (x == head)
+                x += body;
+            if (x == w)
+                break;
+            fb_put_level(info, x0 + x, y0 + y,
+                         fb_quantise(s[x], info->format,
+                                     fb_pixel_bias(x0 + x, y0 + y, dither)));
+        }
+    }
+
+    fb_mark_dirty(info, rect);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Framebuffer console
+ *
+ * Dark text on white in a grid of font cells, a cursor that wraps at
+ * the right edge, and scrolling by one text line at the bottom.
+ *
+ * Output can arrive from any context (it mirrors the UART console), but
+ * drawing a line, let alone scrolling the whole screen, is far too slow
+ * for an IRQ handler or uart_write()'s IRQ-masked loop. fbcon_putc()
+ * only queues the character in a ring and makes sure an fbcon thread
+ * is on its way; the thread draws everything queued in task context
+ * and then refreshes the panel with fb_flush(). When the ring is full,
+ * new output is dropped and counted.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/fb.h>
+#include <kernel/fbcon.h>
+#include <kernel/font.h>
+#include <kernel/sched.h>
+#include <kernel/string.h>
+#include <asm/irqflags.h>
+
+#define FBCON_TAB_WIDTH     8
+#define FBCON_BUF_SIZE      1024        /* Power of two */
+
+struct fbcon {
+    struct fb_info *info;
+    struct text_style style;
+    unsigned int cell_w;
+    unsigned int cell_h;
+    unsigned int cols;
+    unsigned int rows;
+    unsigned int col;               /* Cursor; col == cols wraps on */
+    unsigned int row;               /* the next printable character */
+
+    /* Queued output; head and tail run freely and are masked on access */
+    char buf[FBCON_BUF_SIZE];
+    unsigned long head;
+    unsigned long tail;
+    int thread_queued;              /* An fbcon thread will drain buf */
+    unsigned long dropped;
+};
+
+static struct fbcon fbcon;
+
+int fbcon_init(struct fb_info *info, unsigned int scale)
+{
+    struct fb_rect screen = { 0, 0, info->width, info->height };
+    unsigned long flags;
+
+    if (!scale || scale > FONT_MAX_SCALE ||
+        font_8x8.width * scale * info->format > 64)
+        return -1;
+
+    fbcon.style = (struct text_style){
+        .scale = scale,
+        .fg = FB_BLACK,
+        .bg = FB_WHITE,
+    };
+    fbcon.cell_w = font_8x8.width * scale;
+    fbcon.cell_h = font_8x8.height * scale;
+    fbcon.cols = info->width / fbcon.cell_w;
+    fbcon.rows = info->height / fbcon.cell_h;
+    if (!fbcon.cols || !fbcon.rows)
+        return -1;
+
+    fbcon.col = 0;
+    fbcon.row = 0;
+    fb_fill_rect(info, &screen, fbcon.style.bg);
+
+    flags = local_irq_save();
+    fbcon.head = fbcon.tail = 0;
+    fbcon.info = info;
+    local_irq_restore(flags);
+
+    uart_set_mirror(fbcon_putc);
+    return 0;
+}
+
+void fbcon_exit(void)
+{
+    unsigned long flags;
+
+    uart_set_mirror(NULL);
+
+    flags = local_irq_save();
+    fbcon.info = NULL;
+    fbcon.tail = fbcon.head;
+    local_irq_restore(flags);
+}
+
+/* Move every text line up by one and clear the last */
+static void fbcon_scroll(void)
+{
+    struct fb_info *info = fbcon.info;
+    size_t line = (size_t)fbcon.cell_h * info->stride;
+    struct fb_rect text = { 0, 0, info->width, fbcon.rows * fbcon.cell_h };
+    struct fb_rect last = { 0, (fbcon.rows - 1) * fbcon.cell_h,
+                            info->width, fbcon.cell_h };
+
+    memmove(info->screen_base, info->screen_base + line,
+            (fbcon.rows - 1) * line);
+    fb_fill_rect(info, &last, fbcon.style.bg);
+    fb_mark_dirty(info, &text);
+}
+
+static void fbcon_newline(void)
+{
+    fbcon.col = 0;
+    if (++fbcon.row == fbcon.rows) {
+        fbcon_scroll();
+        fbcon.row--;
+    }
+}
+
+static void fbcon_draw_char(char c)
+{
+    switch (c) {
+    case '\n':
+        fbcon_newline();
+        break;
+    case '\r':
+        fbcon.col = 0;
+        break;
+    case '\b':
+        if (fbcon.col)
+            fbcon.col--;
+        break;
+    case '\t':
+        fbcon.col = (fbcon.col / FBCON_TAB_WIDTH + 1) * FBCON_TAB_WIDTH;
+        if (fbcon.col > fbcon.cols)
+            fbcon.col = fbcon.cols;
+        break;
+    default:
+        if (fbcon.col == fbcon.cols)
+            fbcon_newline();
+        fb_draw_text(fbcon.info, fbcon.col * fbcon.cell_w,
+                     fbcon.row * fbcon.cell_h, &c, 1, &fbcon.style);
+        fbcon.col++;
+        break;
+    }
+}
+
+void fbcon_flush(void)
+{
+    unsigned long flags;
+    char c;
+
+    for (;;) {
+        flags = local_irq_save();
+        if (fbcon.head == fbcon.tail) {
+            local_irq_restore(flags);
+            return;
+        }
+        c = fbcon.buf[fbcon.tail++ & (FBCON_BUF_SIZE - 1)];
+        local_irq_restore(flags);
+
+        /* Stopped meanwhile: fbcon_exit() emptied the ring */
+        if (!fbcon.info)
+            return;
+        fbcon_draw_char(c);
+    }
+}
+
+/*
+ * Draw, then refresh the panel. A refresh takes hundreds of
+ * milliseconds, which is all the rate limiting it needs: what is queued
+ * meanwhile is drawn and refreshed in one more pass of this thread. It
+ * stays the only one until it leaves, so two refreshes never overlap.
+ */
+static int fbcon_thread(void *arg)
+{
+    struct fb_info *info;
+    unsigned long flags;
+
+    for (;;) {
+        fbcon_flush();
+        info = fbcon.info;
+        if (info)
+            fb_flush(info);
+
+        flags = local_irq_save();
+        if (fbcon.head == fbcon.tail || !fbcon.info) {
+            fbcon.thread_queued = 0;
+            local_irq_restore(flags);
+            return 0;
+        }
+        local_irq_restore(flags);
+    }
+}
+
+void fbcon_putc(char c)
+{
+    unsigned long flags;
+
+    flags = local_irq_save();
+    if (fbcon.info) {
+        if (fbcon.head - fbcon.tail == FBCON_BUF_SIZE)
+            fbcon.dropped++;
+        else
+            fbcon.buf[fbcon.head++ & (FBCON_BUF_SIZE - 1)] = c;
+
+        /* No free thread slot: the next character tries again */
+        if (!fbcon.thread_queued &&
+            kthread_run(fbcon_thread, NULL, "fbcon"))
+            fbcon.thread_queued = 1;
+    }
+    local_irq_restore(flags);
+}
+
+void fbcon_puts(const char *s)
+{
+    while (*s)
+        fbcon_putc(*s++);
+}
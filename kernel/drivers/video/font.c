@@ -0,0 +1,198 @@
+/*
+ * Glyph cache and text rendering
+ *
+ * See include/kernel/font.h. Framebuffer rows are MSB-first bit strings,
+ * so a cell row is written by loading the 64-bit words it spans as big
+ * endian, merging the shifted glyph row in, and storing them back. Only
+ * at the very start and end of the screen buffer, where a word would
+ * reach outside it, is it done a byte at a time.
+ */
+
+#include <types.h>
+#include <kernel/fb.h>
+#include <kernel/font.h>
+#include <kernel/string.h>
+#include <asm/irqflags.h>
+
+#define GLYPH_MAX_ROWS      (8 * FONT_MAX_SCALE)
+
+/* A framebuffer word: the screen is a byte array underneath */
+typedef uint64_t __attribute__((may_alias)) fb_word_t;
+
+struct glyph {
+    uint32_t key;                   /* codepoint << 8 | scale, 0 if free */
+    unsigned long last_used;
+    uint64_t rows[GLYPH_MAX_ROWS];  /* Inked pixels, left-aligned */
+};
+
+static struct glyph glyph_cache[GLYPH_CACHE_SETS][GLYPH_CACHE_WAYS];
+static unsigned int glyph_cache_format;
+static unsigned long glyph_cache_clock;
+static struct glyph_cache_stats glyph_stats;
+
+void glyph_cache_flush(void)
+{
+    memset(glyph_cache, 0, sizeof(glyph_cache));
+}
+
+void glyph_cache_get_stats(struct glyph_cache_stats *stats)
+{
+    *stats = glyph_stats;
+}
+
+/* Scale and expand @cp from the font into @g */
+static void glyph_render(struct glyph *g, unsigned int cp, unsigned int scale,
+                         unsigned int bpp)
+{
+    const struct font_desc *font = &font_8x8;
+    /* One font pixel: scale screen pixels of bpp bits */
+    uint64_t pixel = (1ULL << (scale * bpp)) - 1;
+    unsigned int r, c, i;
+    const uint8_t *bitmap;
+    uint64_t row;
+
+    if (cp < font->first || cp >= font->first + font->count)
+        cp = '?';
+    bitmap = font->data + (cp - font->first) * font->height;
+
+    for (r = 0; r < font->height; r++) {
+        row = 0;
+        for (c = 0; c < font->width; c++)
+            if (bitmap[r] & (0x80 >> c))
+                row |= pixel << (64 - (c + 1) * scale * bpp);
+        for (i = 0; i < scale; i++)
+            g->rows[r * scale + i] = row;
+    }
+}
+
+/* Called with IRQs masked: the cache is shared with the console */
+static const struct glyph *glyph_lookup(unsigned int cp, unsigned int scale,
+                                        unsigned int bpp)
+{
+    uint32_t key = cp << 8 | scale;
+    struct glyph *set = glyph_cache[(cp + scale * 7) % GLYPH_CACHE_SETS];
+    struct glyph *victim = &set[0];
+    int i;
+
+    if (bpp != glyph_cache_format) {
+        glyph_cache_flush();
+        glyph_cache_format = bpp;
+    }
+
+    glyph_cache_clock++;
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++) {
+        if (set[i].key == key) {
+            set[i].last_used = glyph_cache_clock;
+            glyph_stats.hits++;
+            return &set[i];
+        }
+        /* Free slots were last used at 0 */
+        if (set[i].last_used < victim->last_used)
+            victim = &set[i];
+    }
+
+    glyph_stats.misses++;
+    victim->key = key;
+    victim->last_used = glyph_cache_clock;
+    glyph_render(victim, cp, scale, bpp);
+    return victim;
+}
+
+/* @color's level in every pixel of a 64-bit word */
+static uint64_t fb_color_pattern(unsigned int color, unsigned int bpp)
+{
+    uint64_t mask = (1U << bpp) - 1;
+
+    return ((color & 0xf) >> (4 - bpp)) * (~0ULL / mask);
+}
+
+static inline void fb_merge_word(fb_word_t *word, uint64_t mask, uint64_t bits)
+{
+    uint64_t v = __builtin_bswap64(*word);
+
+    *word = __builtin_bswap64((v & ~mask) | bits);
+}
+
+/* @v moved right by @shift bits, left for a negative @shift */
+static inline uint64_t shift_right(uint64_t v, int shift)
+{
+    if (shift >= 64 || shift <= -64)
+        return 0;
+    return shift >= 0 ? v >> shift : v << -shift;
+}
+
+/*
+ * Replace the bits under @mask of the bit string at @row, starting at
+ * bit @pos, with @bits; both are left-aligned
+ */
+static void fb_put_bits(struct fb_info *info, uint8_t *row, unsigned int pos,
+                        uint64_t mask, uint64_t bits)
+{
+    uint8_t *end = info->screen_base + (size_t)info->stride * info->height;
+    uintptr_t addr = (uintptr_t)row + pos / 8;
+    unsigned int shift = (addr & 7) * 8 + pos % 8;
+    fb_word_t *word = (fb_word_t *)(addr & ~(uintptr_t)7);
+    uint8_t *p = (uint8_t *)addr;
+    uint8_t m;
+    int k;
+
+    bits &= mask;
+
+    if ((uint8_t *)word >= info->screen_base && (uint8_t *)(word + 2) <= end) {
+        fb_merge_word(&word[0], mask >> shift, bits >> shift);
+        if (shift)
+            fb_merge_word(&word[1], mask << (64 - shift), bits << (64 - shift));
+        return;
+    }
+
+    shift = pos % 8;
+    for (k = 0; k < 9 && p + k < end; k++) {
+        m = shift_right(mask, 56 + shift - 8 * k);
+        if (m)
+            p[k] = (p[k] & ~m) | (uint8_t)shift_right(bits, 56 + shift - 8 * k);
+    }
+}
+
+unsigned int fb_draw_text(struct fb_info *info, unsigned int x, unsigned int y,
+                          const char *s, size_t len,
+                          const struct text_style *style)
+{
+    const struct font_desc *font = &font_8x8;
+    unsigned int bpp = info->format;
+    unsigned int scale = style->scale;
+    unsigned int cw = font->width * scale, ch = font->height * scale;
+    unsigned int rows, vis, cx, r;
+    uint64_t fg, bg, mask, ink;
+    struct fb_rect rect = { x, y, len * cw, ch };
+    const struct glyph *g;
+    unsigned long flags;
+    uint8_t *row;
+    size_t i;
+
+    if (!scale || scale > FONT_MAX_SCALE || cw * bpp > 64)
+        return 0;
+    if (y >= info->height)
+        return len * cw;
+
+    fg = fb_color_pattern(style->fg, bpp);
+    bg = fb_color_pattern(style->bg, bpp);
+    rows = ch < info->height - y ? ch : info->height - y;
+
+    for (i = 0, cx = x; i < len && cx < info->width; i++, cx += cw) {
+        /* Drop the pixels right of the screen */
+        vis = cw < info->width - cx ? cw : info->width - cx;
+        mask = vis * bpp < 64 ? ~(~0ULL >> (vis * bpp)) : ~0ULL;
+
+        flags = local_irq_save();
+        g = glyph_lookup((unsigned char)s[i], scale, bpp);
+        for (r = 0; r < rows; r++) {
+            row = info->screen_base + (size_t)(y + r) * info->stride;
+            ink = g->rows[r];
+            fb_put_bits(info, row, cx * bpp, mask, (ink & fg) | (~ink & bg));
+        }
+        local_irq_restore(flags);
+    }
+
+    fb_mark_dirty(info, &rect);
+    return len * cw;
+}
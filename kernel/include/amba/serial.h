@@ -6,16 +6,32 @@
 #ifndef _AMBA_SERIAL_H
 #define _AMBA_SERIAL_H
 
+#include <asm/io.h>
+
 /* PL011 Base Address */
 // TODO: Implement DTB parsing to get base addresses dynamically
-# define PL011_UART0_BASE      0x3F201000  /* GPU peripheral space - UART0 */
+#define PL011_UART0_PHYS      0x3F201000
+#ifndef PL011_UART0_BASE
+# define PL011_UART0_BASE      IO_ADDRESS(PL011_UART0_PHYS)  /* GPU peripheral space - UART0 */
+#endif
 
 /* PL011 UART Clock and Baud Rate Calculation Macros */
 #define PL011_UART_CLOCK_HZ 48000000U
 #define PL011_DEFAULT_BAUD 115200U
-#define PL011_IBRD(uartclk, baud) ((uartclk) / (16U * (baud)))
-#define PL011_FBRD(uartclk, baud) \
-    ((((uartclk) % (16U * (baud))) * 64U + ((baud) / 2U)) / (baud))
+/*
+ * The baud divisor is uartclk / (16 * baud), split into a 16-bit integer
+ * part (IBRD) and a 6-bit fraction (FBRD, in 64ths). Computing the whole
+ * divisor in 64ths and rounding once keeps FBRD in range: rounding the
+ * fraction on its own could yield 64.
+ */
+#define PL011_DIVISOR_64THS(uartclk, baud) \
+    (((uartclk) * 4U + ((baud) / 2U)) / (baud))
+#define PL011_IBRD(uartclk, baud) (PL011_DIVISOR_64THS(uartclk, baud) >> 6)
+#define PL011_FBRD(uartclk, baud) (PL011_DIVISOR_64THS(uartclk, baud) & 0x3F)
+/* IBRD must be 1..0xFFFF, which bounds the baud rates uartclk can reach */
+#define PL011_BAUD_VALID(uartclk, baud) \
+    ((baud) != 0 && PL011_IBRD(uartclk, baud) >= 1U && \
+     PL011_IBRD(uartclk, baud) <= 0xFFFFU)
 
 
 /*
@@ -39,4 +55,20 @@
 # define UARTICR       0x44  /* Interrupt Clear Register - WO */
 # define UARTDMACR     0x48  /* DMA Control Register - RW */
 
+/* UARTFR bits */
+# define UARTFR_BUSY       (1 << 3)
+# define UARTFR_TXFF       (1 << 5)
+
+/* UARTLCR_H bits */
+# define UARTLCR_H_FEN     (1 << 4)
+# define UARTLCR_H_WLEN_8  (3 << 5)
+
+/* UARTCR bits */
+# define UARTCR_UARTEN     (1 << 0)
+# define UARTCR_TXE        (1 << 8)
+# define UARTCR_RXE        (1 << 9)
+
+/* UARTDMACR bits */
+# define UARTDMACR_TXDMAE  (1 << 1)
+
 #endif /* _AMBA_SERIAL_H */
\ No newline at end of file
@@ -12,7 +12,7 @@
  * pointed to by @ptr matches the declared type of @member within @type.
  *
  * HOW THE TYPE CHECK WORKS:
- * The static_assert inside this macro performs a compile-time verification
+ * The _Static_assert inside this macro performs a compile-time verification
  * that @ptr points to the correct member type.
  *
  *   (type *)0
@@ -29,7 +29,7 @@
  *
  *   *(ptr)
  *     - Dereferencing @ptr yields the type of the object it points to.
- *     - This does NOT generate a memory access in the static_assert;
+ *     - This does NOT generate a memory access in the _Static_assert;
  *       it is used only for type inspection.
  *
  *   __same_type(*(ptr), ((type *)0)->member)
@@ -51,7 +51,7 @@
 */
 #define container_of(ptr, type, member) ({                              \
     void *__mptr = (void *)(ptr);                                       \
-    static_assert(__same_type(*(ptr), ((type *)0)->member) ||           \
+    _Static_assert(__same_type(*(ptr), ((type *)0)->member) ||           \
                   __same_type(*(ptr), void),                            \
                   "container_of(): pointer type mismatch");             \
     (type *)(__mptr - offsetof(type, member));                          \
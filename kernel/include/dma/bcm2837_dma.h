@@ -0,0 +1,42 @@
+#ifndef _DMA_BCM2837_DMA_H
+#define _DMA_BCM2837_DMA_H
+
+#include <kernel/dma-mapping.h>
+
+/*
+ * BCM2837 DMA controller
+ *
+ * Peripherals are addressed by DMA masters through the VideoCore bus
+ * map, where the 0x3F000000 ARM window appears at 0x7E000000.
+ */
+#define BCM2837_PERIPH_PA_BASE      0x3F000000U
+#define BCM2837_PERIPH_BUS_BASE     0x7E000000U
+
+static inline dma_addr_t periph_to_dma(unsigned long pa)
+{
+    return (dma_addr_t)(pa - BCM2837_PERIPH_PA_BASE + BCM2837_PERIPH_BUS_BASE);
+}
+
+/* Peripheral DREQ lines (TI.PERMAP) */
+#define BCM2837_DREQ_NONE           0
+#define BCM2837_DREQ_DSI            1
+#define BCM2837_DREQ_PCM_TX         2
+#define BCM2837_DREQ_PCM_RX         3
+#define BCM2837_DREQ_SMI            4
+#define BCM2837_DREQ_PWM            5
+#define BCM2837_DREQ_SPI_TX         6
+#define BCM2837_DREQ_SPI_RX         7
+#define BCM2837_DREQ_BSC_SPI_TX     8
+#define BCM2837_DREQ_BSC_SPI_RX     9
+#define BCM2837_DREQ_EMMC           11
+#define BCM2837_DREQ_UART_TX        12
+#define BCM2837_DREQ_SDHOST         13
+#define BCM2837_DREQ_UART_RX        14
+
+/*
+ * bcm2837_dma_init - Reset the usable channels and hook their IRQs
+ * Needs the IRQ controllers and the DMA coherent pool.
+ */
+int bcm2837_dma_init(void);
+
+#endif /* _DMA_BCM2837_DMA_H */
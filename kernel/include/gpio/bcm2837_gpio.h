@@ -0,0 +1,79 @@
+#ifndef _GPIO_BCM2837_GPIO_H
+#define _GPIO_BCM2837_GPIO_H
+
+#include <types.h>
+#include <kernel/irq_chip.h>
+
+/*
+ * BCM2837 GPIO
+ *
+ * 54 pins, each with a function select: input, output or one of six
+ * alternate functions (see the BCM2835 peripherals manual, section 6.2,
+ * for what each pin carries in each).
+ */
+#define BCM2837_NR_GPIOS        54
+
+#define BCM2837_FSEL_INPUT      0
+#define BCM2837_FSEL_OUTPUT     1
+#define BCM2837_FSEL_ALT0       4
+#define BCM2837_FSEL_ALT1       5
+#define BCM2837_FSEL_ALT2       6
+#define BCM2837_FSEL_ALT3       7
+#define BCM2837_FSEL_ALT4       3
+#define BCM2837_FSEL_ALT5       2
+
+#define BCM2837_GPIO_IRQ_RISING     0x01
+#define BCM2837_GPIO_IRQ_FALLING    0x02
+#define BCM2837_GPIO_IRQ_BOTH       (BCM2837_GPIO_IRQ_RISING | \
+                                     BCM2837_GPIO_IRQ_FALLING)
+
+/*
+ * Physical addresses of the output set and clear registers for pins
+ * 0-31, for DMA control blocks and other masters that drive pins
+ * without the CPU
+ */
+#define BCM2837_GPIO_PA         0x3F200000
+#define BCM2837_GPSET0_PA       (BCM2837_GPIO_PA + 0x1C)
+#define BCM2837_GPCLR0_PA       (BCM2837_GPIO_PA + 0x28)
+
+/*
+ * bcm2837_gpio_set_function - Select what drives pin @gpio
+ * @fsel: BCM2837_FSEL_*
+ */
+void bcm2837_gpio_set_function(unsigned int gpio, unsigned int fsel);
+
+/*
+ * bcm2837_gpio_set - Drive output pin @gpio high (@value != 0) or low
+ *
+ * A single write to the set or clear register, so it is safe from
+ * interrupt context and never disturbs other pins.
+ */
+void bcm2837_gpio_set(unsigned int gpio, int value);
+
+/*
+ * bcm2837_gpio_get - Current level of pin @gpio, 0 or 1
+ */
+int bcm2837_gpio_get(unsigned int gpio);
+
+/*
+ * bcm2837_gpio_request_irq - Call @handler on edges of input pin @gpio
+ * @type: BCM2837_GPIO_IRQ_RISING, _FALLING or both
+ *
+ * @handler runs in interrupt context and gets @gpio as its irq
+ * argument. Returns 0, or -1 if the pin already has a handler or the
+ * GPIO interrupt cannot be requested.
+ */
+int bcm2837_gpio_request_irq(unsigned int gpio, unsigned int type,
+                             irq_handler_t handler, void *dev_id);
+
+/*
+ * bcm2837_gpio_free_irq - Stop edge detection on @gpio and drop its handler
+ */
+void bcm2837_gpio_free_irq(unsigned int gpio);
+
+/*
+ * bcm2837_gpio_init - Find the GPIO block in the device tree
+ */
+int bcm2837_gpio_init(void);
+
+#endif /* _GPIO_BCM2837_GPIO_H */
@@ -0,0 +1,18 @@
+#ifndef _I2C_BCM2837_I2C_H
+#define _I2C_BCM2837_I2C_H
+
+/*
+ * BCM2837 BSC1 I2C master
+ *
+ * On the 40-pin header: SDA GPIO 2 and SCL GPIO 3, both ALT0, with
+ * 1.8k pull-ups on the board.
+ */
+#define BCM2837_I2C1_PA         0x3F804000
+
+/*
+ * bcm2837_i2c_init - Set up BSC1
+ * Needs GPIO and the mailbox (for the core clock).
+ */
+int bcm2837_i2c_init(void);
+
+#endif /* _I2C_BCM2837_I2C_H */
@@ -0,0 +1,67 @@
+#ifndef _I2C_I2C_H
+#define _I2C_I2C_H
+
+#include <stddef.h>
+#include <types.h>
+
+/*
+ * I2C master
+ *
+ * A client describes one exchange with a device as a transaction: an
+ * array of messages, each a read or a write of one buffer, run back to
+ * back with a repeated start between them and a single stop at the end.
+ * The usual register read is a one-byte write of the register number
+ * followed by a read, as one transaction, so no other master can get
+ * in between.
+ *
+ * Transactions are queued on the controller and run in order, driven
+ * entirely from interrupts, like SPI messages (see spi/spi.h).
+ */
+
+#define I2C_M_RD            0x0001  /* Read into @buf, else write from it */
+
+#define I2C_XFER_QUEUED     1       /* t->status until it completes */
+
+struct i2c_msg {
+    uint16_t addr;                  /* 7-bit device address */
+    uint16_t flags;                 /* I2C_M_RD */
+    uint16_t len;                   /* At least 1 */
+    uint8_t *buf;
+};
+
+struct i2c_transaction {
+    struct i2c_msg *msgs;
+    unsigned int nr_msgs;
+    /* Called from interrupt context once it is done, may be NULL */
+    void (*complete)(void *context);
+    void *context;
+    int status;                     /* 0, -1 on error (no acknowledge,
+                                       clock stretch timeout), or
+                                       I2C_XFER_QUEUED */
+    struct i2c_transaction *next;   /* Controller queue */
+};
+
+/*
+ * i2c_async - Queue @t and return at once
+ *
+ * The buffers must stay untouched until t->complete runs. Returns 0,
+ * or -1 if the controller is not available or @t is invalid.
+ */
+int i2c_async(struct i2c_transaction *t);
+
+/*
+ * i2c_sync - Queue @t and sleep until it is done
+ *
+ * Works with interrupts masked too, by doing the interrupt handler's
+ * work while waiting. Returns t->status.
+ */
+int i2c_sync(struct i2c_transaction *t);
+
+/*
+ * i2c_write_read - Write @wlen bytes to device @addr, then read @rlen
+ * bytes back in the same transaction
+ */
+int i2c_write_read(uint16_t addr, const void *wbuf, size_t wlen,
+                   void *rbuf, size_t rlen);
+
+#endif /* _I2C_I2C_H */
@@ -0,0 +1,20 @@
+#ifndef _INPUT_FT5X06_H
+#define _INPUT_FT5X06_H
+
+/*
+ * FocalTech FT5x06/FT6x36 capacitive touch controller on I2C1
+ *
+ * Used unless the device tree has an "edt,edt-ft5406" or
+ * "focaltech,ft6236" node with its own "reg" and "interrupts" (the INT
+ * line's GPIO, the node's interrupt parent being the GPIO block).
+ */
+#define FT5X06_DEFAULT_ADDR     0x38
+#define FT5X06_DEFAULT_INT_GPIO 27
+
+/*
+ * ft5x06_init - Find the controller and report its touches
+ * Needs I2C and GPIO.
+ */
+int ft5x06_init(void);
+
+#endif /* _INPUT_FT5X06_H */
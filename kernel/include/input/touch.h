@@ -0,0 +1,50 @@
+#ifndef _INPUT_TOUCH_H
+#define _INPUT_TOUCH_H
+
+#include <types.h>
+
+/*
+ * Touch input
+ *
+ * Touchscreen drivers report contacts from interrupt context into one
+ * queue of events, which the UI drains at its own pace. If it falls
+ * behind, the queue degrades in order of harm:
+ *
+ *  - the last TOUCH_LIFT_RESERVE slots only take lifts, since a lost
+ *    lift leaves a contact down for good;
+ *  - a move that finds the rest full is merged into the queued move of
+ *    the same contact it follows, so the latest position is kept;
+ *  - a lift that finds even the reserve full replaces the newest queued
+ *    event of its contact.
+ *
+ * Anything else is dropped and counted.
+ */
+#define TOUCH_QUEUE_SIZE        64      /* Power of two */
+#define TOUCH_LIFT_RESERVE      16      /* One per possible contact id */
+
+#define TOUCH_DOWN              0
+#define TOUCH_MOVE              1
+#define TOUCH_UP                2
+
+struct touch_event {
+    uint16_t x;                         /* Panel coordinates */
+    uint16_t y;
+    uint8_t id;                         /* Contact, stable from down to up */
+    uint8_t type;                       /* TOUCH_DOWN, _MOVE or _UP */
+};
+
+/*
+ * touch_report - Queue @ev, from any context
+ */
+void touch_report(const struct touch_event *ev);
+
+/*
+ * touch_get_event - Take the oldest queued event into @ev
+ * Returns 0, or -1 if the queue is empty.
+ */
+int touch_get_event(struct touch_event *ev);
+
+/* Events dropped because the queue was full */
+unsigned long touch_dropped(void);
+
+#endif /* _INPUT_TOUCH_H */
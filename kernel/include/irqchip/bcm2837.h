@@ -0,0 +1,43 @@
+#ifndef _IRQCHIP_BCM2837_H
+#define _IRQCHIP_BCM2837_H
+
+#include <types.h>
+
+/*
+ * BCM2836/7 per-core local interrupt controller
+ *
+ * Local interrupts use virtual IRQ numbers equal to their bit in the
+ * per-core pending register.
+ */
+#define LOCAL_IRQ_CNTPSIRQ	0
+#define LOCAL_IRQ_CNTPNSIRQ	1
+#define LOCAL_IRQ_CNTHPIRQ	2
+#define LOCAL_IRQ_CNTVIRQ	3
+#define LOCAL_IRQ_MAILBOX0	4
+#define LOCAL_IRQ_MAILBOX1	5
+#define LOCAL_IRQ_MAILBOX2	6
+#define LOCAL_IRQ_MAILBOX3	7
+#define LOCAL_IRQ_GPU_FAST	8
+#define LOCAL_IRQ_PMU_FAST	9
+#define LOCAL_IRQ_SIZE		(LOCAL_IRQ_PMU_FAST + 1)
+
+int bcm2837_irq_init(void);
+
+/*
+ * Core mailboxes: four 32-bit write-set/write-clear registers per core.
+ * A mailbox raises its LOCAL_IRQ_MAILBOXn interrupt on the owning core
+ * while any bit is set, so handlers must clear what they consume.
+ */
+
+/*
+ * bcm2837_mailbox_send - Set @bits in mailbox @mbox of core @cpu
+ */
+void bcm2837_mailbox_send(unsigned int cpu, unsigned int mbox, uint32_t bits);
+
+/*
+ * bcm2837_mailbox_read_clear - Read and clear mailbox @mbox of core @cpu
+ * Returns the bits that were set.
+ */
+uint32_t bcm2837_mailbox_read_clear(unsigned int cpu, unsigned int mbox);
+
+#endif /* _IRQCHIP_BCM2837_H */
@@ -0,0 +1,60 @@
+#ifndef _KERNEL_BENCH_H
+#define _KERNEL_BENCH_H
+
+#include <stddef.h>
+#include <types.h>
+
+/*
+ * Kernel micro-benchmark harness.
+ *
+ * Benchmark cases are only built into the benchmark kernel image
+ * (make bench, which defines CONFIG_BENCH). Each case is placed in the
+ * .bench_cases linker section so that bench_run_all() can find every
+ * registered case without a central list.
+ *
+ * Results are printed on the UART, one line per case:
+ *
+ *   BENCH <name> iters=<n> ns=<total> ns_per_op=<x.xxx> [bytes=<b> mb_per_s=<y> bytes_per_s=<z>]
+ *
+ * A case that cannot run here (say, the hardware it needs is missing)
+ * calls bench_skip() from its setup or run function; one whose work
+ * went wrong calls bench_fail(). It is stopped and reported as
+ *
+ *   BENCH-SKIP <name> <why>
+ *   BENCH-FAIL <name> <why>
+ *
+ * instead. scripts/bench_compare.py parses these lines and compares
+ * them against bench/baseline.txt; any BENCH-FAIL fails the comparison.
+ */
+struct bench_case {
+    const char *name;
+    /* Number of operations timed per run */
+    unsigned long iters;
+    /* Bytes moved per operation, 0 if this is not a bandwidth case */
+    unsigned long bytes_per_op;
+    /* Optional one-off setup, called before the first run */
+    void (*setup)(void);
+    /* Perform @iters operations */
+    void (*run)(unsigned long iters);
+};
+
+#define BENCH_CASE(_name, _setup, _run, _iters, _bytes)                  \
+    static const struct bench_case __bench_case_##_name                  \
+    __attribute__((used, section(".bench_cases"), aligned(8))) = {       \
+        .name         = #_name,                                          \
+        .iters        = (_iters),                                        \
+        .bytes_per_op = (_bytes),                                        \
+        .setup        = (_setup),                                        \
+        .run          = (_run),                                          \
+    }
+
+/*
+ * bench_run_all - Run every registered benchmark case and report results
+ */
+void bench_run_all(void);
+
+/* Stop the running case; see above. The first reason given is kept. */
+void bench_skip(const char *why);
+void bench_fail(const char *why);
+
+#endif /* _KERNEL_BENCH_H */
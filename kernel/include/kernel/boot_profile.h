@@ -0,0 +1,52 @@
+#ifndef _KERNEL_BOOT_PROFILE_H
+#define _KERNEL_BOOT_PROFILE_H
+
+/*
+ * Boot-time profiler.
+ *
+ * Boot is split into stages, each closed by a CNTVCT_EL0 timestamp
+ * named after the step that just finished. boot.S keeps its stamps in
+ * x20-x25, since nothing can be stored before BSS is cleared, and
+ * writes them to boot_stamps[] once it runs in the higher half.
+ * kernel_main() adds its own with boot_profile_mark(), and
+ * boot_profile_dump() prints the timeline at the end of boot.
+ *
+ * The counter runs from reset, so the first stamp is the time the
+ * firmware took to reach _start.
+ */
+
+/* boot.S stamps, in the order they are taken */
+#define BOOT_STAMP_START        0   /* Firmware jumped to _start */
+#define BOOT_STAMP_EL1          1   /* Dropped from EL2 to EL1 */
+#define BOOT_STAMP_PGTABLE      2   /* TCR, MAIR and TTBRs set up */
+#define BOOT_STAMP_MMU          3   /* MMU and caches on */
+#define BOOT_STAMP_HIGHER_HALF  4   /* Running at the kernel VA */
+#define BOOT_STAMP_BSS          5   /* BSS cleared */
+#define BOOT_NR_ASM_STAMPS      6
+
+#ifndef __ASSEMBLY__
+
+#include <types.h>
+
+extern uint64_t boot_stamps[BOOT_NR_ASM_STAMPS];
+
+/*
+ * boot_profile_mark - Close the boot stage called @name
+ *
+ * @name must stay valid until boot_profile_dump(); pass a literal.
+ * Marks past the size of the table are dropped.
+ */
+void boot_profile_mark(const char *name);
+
+/*
+ * boot_profile_dump - Print every stage with its end time and duration
+ *
+ * The benchmark kernel also reports each stage as a BENCH line, so
+ * bench_compare.py flags a slower BSS clear or page-table fill like
+ * any other regression.
+ */
+void boot_profile_dump(void);
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* _KERNEL_BOOT_PROFILE_H */
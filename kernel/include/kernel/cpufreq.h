@@ -0,0 +1,53 @@
+#ifndef _KERNEL_CPUFREQ_H
+#define _KERNEL_CPUFREQ_H
+
+#include <types.h>
+
+/*
+ * CPU frequency scaling
+ *
+ * One policy covers every core, since they share the ARM clock. The
+ * governor samples the boot CPU, the only one running the scheduler,
+ * every CPUFREQ_SAMPLE_US: load is the share of the window not spent
+ * asleep in the idle loop, and a non-empty run queue counts as fully
+ * loaded. Above CPUFREQ_UP_THRESHOLD percent the clock goes straight
+ * to the maximum, so a burst of work is not held back; below it the
+ * clock scales with the load down to the minimum (like Linux's
+ * ondemand governor), in CPUFREQ_STEP_HZ steps so a load that wobbles
+ * does not cause a mailbox round trip every sample.
+ *
+ * The ARM clock is set through the firmware's SET_CLOCK_RATE tag; the
+ * limits are what the firmware reports for it (arm_freq_min/arm_freq).
+ */
+#define CPUFREQ_SAMPLE_US       20000
+#define CPUFREQ_UP_THRESHOLD    80
+#define CPUFREQ_STEP_HZ         100000000U
+
+struct cpufreq_policy {
+    uint32_t min;               /* Hz */
+    uint32_t max;
+    uint32_t cur;
+    unsigned int load;          /* Of the last sample, percent */
+    unsigned long transitions;  /* Clock changes made */
+};
+
+/*
+ * cpufreq_init - Read the ARM clock limits and start governing
+ * Needs the mailbox. Returns 0, or -1 if the firmware did not answer.
+ */
+int cpufreq_init(void);
+
+/*
+ * cpufreq_update - Run the governor if a sample period has passed
+ *
+ * Called from the idle loop on every pass. Does nothing until
+ * cpufreq_init() succeeded.
+ */
+void cpufreq_update(void);
+
+/*
+ * cpufreq_get_policy - Current limits, clock and load
+ */
+const struct cpufreq_policy *cpufreq_get_policy(void);
+
+#endif /* _KERNEL_CPUFREQ_H */
@@ -0,0 +1,129 @@
+#ifndef _KERNEL_CPUIDLE_H
+#define _KERNEL_CPUIDLE_H
+
+#include <types.h>
+
+/*
+ * CPU idle states
+ *
+ * A cpuidle driver lists the platform's idle states from shallowest to
+ * deepest. Each pass of the idle loop with nothing to run asks the menu
+ * governor for a state, enters it, and feeds the measured residency
+ * back. A deeper state saves more power but costs more to get out of,
+ * so it only pays off when the CPU stays in it for at least its
+ * target_residency.
+ *
+ * States flagged CPUIDLE_FLAG_TICK_STOP are entered with the periodic
+ * tick stopped (see include/kernel/tick.h), so the CPU is not woken
+ * every TICK_PERIOD_US just to count jiffies.
+ */
+#define CPUIDLE_STATE_MAX       4
+
+#define CPUIDLE_FLAG_TICK_STOP  (1U << 0)
+
+struct cpuidle_driver;
+
+struct cpuidle_state {
+    const char *name;
+    unsigned int exit_latency;      /* us, worst case to wake up */
+    unsigned int target_residency;  /* us, least stay that saves power */
+    unsigned int flags;
+    void (*enter)(struct cpuidle_driver *drv, int index);
+};
+
+struct cpuidle_driver {
+    const char *name;
+    struct cpuidle_state states[CPUIDLE_STATE_MAX];
+    int state_count;
+};
+
+/* Per-state statistics, all times in microseconds */
+struct cpuidle_state_usage {
+    unsigned long usage;            /* Times entered */
+    uint64_t time;                  /* Total residency */
+    unsigned long above;            /* Left before target_residency */
+    unsigned long below;            /* Stayed long enough for a deeper one */
+    /* Wake-up delay past the timer event, when a timer ended the stay */
+    unsigned long exit_samples;
+    uint64_t exit_latency_total;
+    unsigned int exit_latency_max;
+};
+
+/*
+ * Menu governor state. The predicted idle time starts from the time to
+ * the next timer event, scaled by a correction factor learnt per range
+ * of that time (how much earlier than the timer the CPU usually gets
+ * woken), and is cut to the recent wake-up interval when the last
+ * MENU_INTERVALS stays were regular.
+ */
+#define MENU_BUCKETS            6
+#define MENU_INTERVALS          8
+
+struct menu_device {
+    int last_state_idx;
+    unsigned int bucket;
+    uint64_t next_timer_us;
+    uint64_t tick_us;
+    unsigned int predicted_us;
+    unsigned int correction_factor[MENU_BUCKETS];
+    unsigned int intervals[MENU_INTERVALS];
+    int interval_ptr;
+};
+
+struct cpuidle_device {
+    unsigned int cpu;
+    unsigned int last_residency;    /* us */
+    struct cpuidle_state_usage states_usage[CPUIDLE_STATE_MAX];
+    struct menu_device menu;
+};
+
+/*
+ * cpuidle_register_driver - Use @drv for every CPU
+ * Returns 0, or -1 if @drv has no states or too many.
+ */
+int cpuidle_register_driver(struct cpuidle_driver *drv);
+
+/*
+ * cpuidle_idle_call - Pick an idle state and sleep in it
+ *
+ * Called from the idle loop with interrupts masked; returns once the
+ * CPU has woken up, still masked. Returns 0, or -1 if no driver is
+ * registered and the caller has to idle by itself.
+ */
+int cpuidle_idle_call(void);
+
+/*
+ * cpuidle_get_device - Idle statistics of @cpu
+ */
+const struct cpuidle_device *cpuidle_get_device(unsigned int cpu);
+
+/*
+ * cpuidle_get_driver - The registered driver, or NULL
+ */
+const struct cpuidle_driver *cpuidle_get_driver(void);
+
+/*
+ * menu_enable_device - Reset the governor state of @dev
+ */
+void menu_enable_device(struct cpuidle_device *dev);
+
+/*
+ * menu_select - Choose the state to enter
+ * @sleep_us: Time to the next timer event with the tick stopped
+ * @tick_us: Time to the next tick
+ *
+ * Returns the index of the deepest state expected to pay off.
+ */
+int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
+                uint64_t sleep_us, uint64_t tick_us);
+
+/*
+ * menu_reflect - Learn from the stay that just ended
+ * @index: State that was entered
+ *
+ * dev->last_residency must hold the measured residency.
+ */
+void menu_reflect(struct cpuidle_driver *drv, struct cpuidle_device *dev,
+                  int index);
+
+#endif /* _KERNEL_CPUIDLE_H */
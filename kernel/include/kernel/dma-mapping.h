@@ -0,0 +1,105 @@
+#ifndef _KERNEL_DMA_MAPPING_H
+#define _KERNEL_DMA_MAPPING_H
+
+#include <stddef.h>
+#include <types.h>
+
+/*
+ * DMA buffers
+ *
+ * Normal RAM is mapped write-back cacheable and the DMA masters (DMA
+ * engine, VideoCore, EMMC) do not snoop the ARM caches, so a buffer
+ * handed to a device is either:
+ *
+ *  - streaming: ordinary cacheable memory, with dma_map_single() and
+ *    dma_unmap_single() doing the cache maintenance around each
+ *    transfer. Cheap for the CPU to fill and read, but every transfer
+ *    pays for one maintenance op per cache line.
+ *
+ *  - coherent: from dma_alloc_coherent(), mapped Normal Non-cacheable,
+ *    so no maintenance is ever needed but every CPU access goes to
+ *    memory.
+ *
+ * Up to DMA_COHERENT_THRESHOLD bytes the fixed cost of maintenance
+ * dominates and a coherent buffer is cheaper; above it, streaming wins
+ * (see the dma_* bench cases). dma_prefer_coherent() encodes that.
+ */
+
+/* Address of a buffer as seen by a DMA master */
+typedef uint32_t dma_addr_t;
+
+enum dma_data_direction {
+    DMA_BIDIRECTIONAL = 0,
+    DMA_TO_DEVICE = 1,      /* Device reads the buffer */
+    DMA_FROM_DEVICE = 2,    /* Device writes the buffer */
+};
+
+/*
+ * Bus masters reach SDRAM through the VideoCore bus map. The 0xC0000000
+ * alias bypasses the VideoCore L2 cache, which the ARM is not coherent
+ * with.
+ */
+#define DMA_BUS_RAM_BASE        0xC0000000U
+
+#define DMA_COHERENT_THRESHOLD  2048
+
+static inline dma_addr_t phys_to_dma(unsigned long pa)
+{
+    return (dma_addr_t)pa | DMA_BUS_RAM_BASE;
+}
+
+static inline unsigned long dma_to_phys(dma_addr_t addr)
+{
+    return addr & ~DMA_BUS_RAM_BASE;
+}
+
+static inline int dma_prefer_coherent(size_t size)
+{
+    return size <= DMA_COHERENT_THRESHOLD;
+}
+
+/*
+ * dma_map_single - Hand a linear-map buffer to a device
+ *
+ * Cleans the buffer to memory (or, for DMA_FROM_DEVICE, invalidates
+ * it) and returns its bus address. The CPU must not touch the buffer
+ * until dma_unmap_single().
+ */
+dma_addr_t dma_map_single(void *cpu_addr, size_t size,
+                          enum dma_data_direction dir);
+
+/*
+ * dma_unmap_single - Give a buffer back to the CPU after the transfer
+ *
+ * Invalidates lines the CPU may have speculatively fetched while the
+ * device was writing.
+ */
+void dma_unmap_single(dma_addr_t addr, size_t size,
+                      enum dma_data_direction dir);
+
+/* Ownership transfers for a buffer that stays mapped across transfers */
+void dma_sync_single_for_cpu(dma_addr_t addr, size_t size,
+                             enum dma_data_direction dir);
+void dma_sync_single_for_device(dma_addr_t addr, size_t size,
+                                enum dma_data_direction dir);
+
+/*
+ * dma_coherent_init - Set up the uncached pool
+ *
+ * Takes 1MB from the page allocator and maps it Non-cacheable at
+ * DMA_COHERENT_BASE. Call after paging_init().
+ * Returns 0, or -1 if the pool could not be set up.
+ */
+int dma_coherent_init(void);
+
+/*
+ * dma_alloc_coherent - Allocate an uncached buffer
+ * @handle: Set to the buffer's bus address
+ *
+ * Sizes are rounded up to whole pages. Returns NULL when the pool is
+ * exhausted. Not for use in interrupt context.
+ */
+void *dma_alloc_coherent(size_t size, dma_addr_t *handle);
+void dma_free_coherent(size_t size, void *cpu_addr, dma_addr_t handle);
+
+#endif /* _KERNEL_DMA_MAPPING_H */
@@ -0,0 +1,102 @@
+#ifndef _KERNEL_DMAENGINE_H
+#define _KERNEL_DMAENGINE_H
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/dma-mapping.h>
+
+/*
+ * DMA engine client API
+ *
+ * A client takes a channel, prepares a transfer descriptor (a chain of
+ * hardware control blocks) and submits it. Submitted descriptors run
+ * in order on their channel; each completion calls the descriptor's
+ * callback from interrupt context and then frees the descriptor.
+ * Submission returns a cookie that dma_sync_wait() can poll on, which
+ * also works with interrupts masked. Cookies count up per channel and
+ * wrap; they are compared by their difference, so only cookies less
+ * than 2^31 submissions apart can be told apart.
+ *
+ * Addresses are bus addresses: dma_map_single() or dma_alloc_coherent()
+ * for memory, the peripheral's bus address for device FIFOs.
+ */
+
+struct dma_chan;
+struct dma_desc;
+
+typedef uint32_t dma_cookie_t;
+
+/* @error is 0, or -1 if the channel reported a bus error */
+typedef void (*dma_callback_t)(void *param, int error);
+
+enum dma_transfer_direction {
+    DMA_MEM_TO_MEM,
+    DMA_MEM_TO_DEV,
+    DMA_DEV_TO_MEM,
+};
+
+/* One contiguous piece of a scatter-gather transfer */
+struct dma_sg {
+    dma_addr_t addr;
+    uint32_t len;
+};
+
+/*
+ * As the address of a DMA_DEV_TO_MEM entry: read @len bytes from the
+ * device and throw them away, e.g. to drain a receive FIFO during a
+ * transmit-only transfer
+ */
+#define DMA_SG_DISCARD      ((dma_addr_t)~0U)
+
+/*
+ * dma_request_chan - Allocate a free channel
+ * Returns NULL if every channel is in use.
+ */
+struct dma_chan *dma_request_chan(void);
+void dma_release_chan(struct dma_chan *chan);
+
+/*
+ * dma_prep_memcpy - Memory to memory copy of @len bytes
+ *
+ * Split into as many control blocks as the channel's maximum transfer
+ * length requires. Returns NULL if no descriptor is free.
+ */
+struct dma_desc *dma_prep_memcpy(struct dma_chan *chan, dma_addr_t dst,
+                                 dma_addr_t src, size_t len);
+
+/*
+ * dma_prep_slave_sg - Scatter-gather transfer to or from a device FIFO
+ * @dev_addr: Bus address of the peripheral's data register
+ * @dreq: Peripheral DREQ line pacing the transfer
+ *
+ * One control block per @sg entry, chained so the whole list runs
+ * without CPU involvement.
+ */
+struct dma_desc *dma_prep_slave_sg(struct dma_chan *chan,
+                                   const struct dma_sg *sg, unsigned int nents,
+                                   enum dma_transfer_direction dir,
+                                   dma_addr_t dev_addr, unsigned int dreq);
+
+/*
+ * dma_submit - Queue a prepared descriptor and start it if the channel
+ * is idle
+ * @callback: Called on completion from interrupt context, may be NULL
+ */
+dma_cookie_t dma_submit(struct dma_desc *desc, dma_callback_t callback,
+                        void *param);
+
+/* Whether the descriptor with @cookie has finished */
+int dma_cookie_complete(struct dma_chan *chan, dma_cookie_t cookie);
+
+/*
+ * dma_sync_wait - Busy-wait for @cookie to complete
+ *
+ * Handles the completion itself if interrupts are masked. Returns 0,
+ * or -1 if any transfer on the channel failed meanwhile.
+ */
+int dma_sync_wait(struct dma_chan *chan, dma_cookie_t cookie);
+
+/* Stop the channel and drop every queued descriptor without callbacks */
+void dma_terminate_all(struct dma_chan *chan);
+
+#endif /* _KERNEL_DMAENGINE_H */
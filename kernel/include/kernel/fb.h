@@ -0,0 +1,138 @@
+#ifndef _KERNEL_FB_H
+#define _KERNEL_FB_H
+
+#include <types.h>
+
+/*
+ * Framebuffer for e-ink panels
+ *
+ * Drawing goes into a packed in-memory copy of the screen and only
+ * marks the area it touched as dirty; nothing reaches the panel until
+ * fb_flush(). An e-ink update takes hundreds of milliseconds whatever
+ * its size, plus the time to send the pixels, so the dirty rectangles
+ * are coalesced: two rectangles are merged when they overlap, or when
+ * refreshing their bounding box costs less than refreshing both, with
+ * a fixed cost of FB_REFRESH_COST pixels charged per refresh.
+ *
+ * Partial refreshes leave a little ghosting behind. Every partially
+ * refreshed pixel is charged to the ghosting budget, and once the
+ * budget is spent (or most of the screen is dirty anyway) the next
+ * flush is one full refresh, which clears the ghosts and the budget.
+ *
+ * Pixel formats, in rows of @stride bytes:
+ *   FB_FORMAT_MONO1  1 bit per pixel, leftmost pixel in the top bit,
+ *                    1 is white
+ *   FB_FORMAT_GRAY2  2 bits per pixel, leftmost pixel in the top two
+ *                    bits, 0 is black and 3 white
+ *   FB_FORMAT_GRAY4  4 bits per pixel, leftmost pixel in the high
+ *                    nibble, 0 is black and 15 white
+ * Colours passed to the drawing functions are 4-bit grey levels, of
+ * which the narrower formats keep the top bits: the 1-bit format shows
+ * levels 8 and up as white.
+ */
+#define FB_FORMAT_MONO1         1
+#define FB_FORMAT_GRAY2         2
+#define FB_FORMAT_GRAY4         4
+
+#define FB_BLACK                0
+#define FB_WHITE                15
+
+#define FB_MAX_DIRTY            8       /* Rectangles kept before forced merging */
+#define FB_REFRESH_COST         16384   /* Fixed cost of a refresh, in pixels */
+#define FB_FULL_PERCENT         50      /* Dirty share that gets a full refresh */
+#define FB_GHOST_SCREENS        4       /* Default budget, in screen areas */
+
+struct fb_info;
+
+struct fb_rect {
+    unsigned int x;
+    unsigned int y;
+    unsigned int w;
+    unsigned int h;
+};
+
+struct fb_ops {
+    /*
+     * Send @rect of the screen to the panel and update it. @full asks
+     * for a full (flashing) refresh of the whole screen, @rect then
+     * covers all of it. Returns 0 or -1.
+     */
+    int (*fb_refresh)(struct fb_info *info, const struct fb_rect *rect,
+                      int full);
+};
+
+struct fb_info {
+    const char *name;
+    unsigned int width;
+    unsigned int height;
+    unsigned int format;            /* FB_FORMAT_*, also bits per pixel */
+    unsigned int stride;            /* Bytes per row, 0 for packed rows */
+    unsigned int x_align;           /* Refresh rectangles start and end on
+                                       multiples of this, 0 for a byte */
+    uint8_t *screen_base;
+    const struct fb_ops *fbops;
+    void *par;                      /* Driver private data */
+
+    /* Dirty rectangles, disjoint after coalescing */
+    struct fb_rect dirty[FB_MAX_DIRTY];
+    int nr_dirty;
+
+    /* Ghosting: partially refreshed pixels since the last full refresh */
+    uint64_t ghost_budget;          /* 0 for FB_GHOST_SCREENS screens */
+    uint64_t ghost_used;
+    int full_pending;               /* Next flush is a full refresh */
+
+    /* Statistics */
+    unsigned long full_refreshes;
+    unsigned long partial_refreshes;
+    uint64_t pixels_refreshed;
+};
+
+/*
+ * register_framebuffer - Make @info the system framebuffer
+ *
+ * The driver fills in the geometry, format, screen_base and fbops; the
+ * rest is filled in or reset here. Returns 0, or -1 if @info is not
+ * usable.
+ */
+int register_framebuffer(struct fb_info *info);
+
+/*
+ * fb_get_info - The registered framebuffer, or NULL
+ */
+struct fb_info *fb_get_info(void);
+
+/*
+ * fb_mark_dirty - Record that @rect changed and needs refreshing
+ *
+ * @rect is clipped to the screen and widened to x_align. Safe from
+ * interrupt context.
+ */
+void fb_mark_dirty(struct fb_info *info, const struct fb_rect *rect);
+
+/*
+ * fb_flush - Refresh everything marked dirty
+ *
+ * Issues one refresh per coalesced rectangle, or a single full refresh
+ * when the ghosting budget is spent or most of the screen changed.
+ * Returns 0, or -1 if the driver failed a refresh; the rectangles that
+ * were not refreshed stay dirty. Task context only; a panel refresh is
+ * slow, so IRQs stay on while it runs, and what is marked meanwhile is
+ * left dirty for the next flush.
+ */
+int fb_flush(struct fb_info *info);
+
+/*
+ * fb_force_full_refresh - Make the next flush a full refresh
+ */
+void fb_force_full_refresh(struct fb_info *info);
+
+/* Drawing; all of these clip to the screen and mark what they touch */
+void fb_set_pixel(struct fb_info *info, unsigned int x, unsigned int y,
+                  unsigned int color);
+unsigned int fb_get_pixel(const struct fb_info *info, unsigned int x,
+                          unsigned int y);
+void fb_fill_rect(struct fb_info *info, const struct fb_rect *rect,
+                  unsigned int color);
+
+#endif /* _KERNEL_FB_H */
@@ -0,0 +1,83 @@
+#ifndef _KERNEL_FB_CONVERT_H
+#define _KERNEL_FB_CONVERT_H
+
+#include <types.h>
+#include <kernel/fb.h>
+
+/*
+ * 8-bit grey to panel format conversion
+ *
+ * User interfaces are drawn into plain 8-bit grey buffers (0 black,
+ * 255 white), which are rotated to the panel's orientation and packed
+ * into its 1, 2 or 4-bit framebuffer format once per frame.
+ *
+ * Packing quantises every pixel g to one of the L levels of the format
+ * as (g * (L - 1) + bias) >> 8. Without dithering the bias is 128, which
+ * rounds; ordered dithering takes the bias from a 4x4 Bayer matrix
+ * indexed by screen position instead, so flat greys come out as a
+ * stable pattern. Floyd-Steinberg dithering spreads each pixel's
+ * quantisation error to its unvisited neighbours; it gives the best
+ * looking images but is serial along a row and is only available
+ * through fb_blit_gray8().
+ *
+ * The plain functions use NEON when they can, and process what NEON
+ * does not cover with the scalar code. The _ref versions always run the
+ * scalar code and produce exactly the same output.
+ */
+#define FB_DITHER_NONE          0
+#define FB_DITHER_ORDERED       1
+#define FB_DITHER_FS            2
+
+/* Clockwise */
+#define FB_ROTATE_0             0
+#define FB_ROTATE_90            1
+#define FB_ROTATE_180           2
+#define FB_ROTATE_270           3
+
+/* Widest rectangle fb_blit_gray8() takes with FB_DITHER_FS */
+#define FB_BLIT_MAX_WIDTH       2048
+
+/*
+ * fb_pack_gray8 - Pack a w x h grey image into @format
+ * @dst: First byte of the packed rectangle, rows @dst_stride bytes apart
+ * @w: Width, a multiple of the pixels per byte of @format
+ * @x, @y: Screen position of the first pixel, for the dither pattern
+ * @dither: FB_DITHER_NONE or FB_DITHER_ORDERED
+ */
+void fb_pack_gray8(uint8_t *dst, unsigned int dst_stride,
+                   const uint8_t *src, unsigned int src_stride,
+                   unsigned int w, unsigned int h, unsigned int format,
+                   unsigned int x, unsigned int y, unsigned int dither);
+void fb_pack_gray8_ref(uint8_t *dst, unsigned int dst_stride,
+                       const uint8_t *src, unsigned int src_stride,
+                       unsigned int w, unsigned int h, unsigned int format,
+                       unsigned int x, unsigned int y, unsigned int dither);
+
+/*
+ * fb_rotate_gray8 - Rotate a w x h grey image clockwise by @rotation
+ *
+ * For FB_ROTATE_90 and FB_ROTATE_270 @dst is h pixels wide and w high.
+ * @dst and @src must not overlap.
+ */
+void fb_rotate_gray8(uint8_t *dst, unsigned int dst_stride,
+                     const uint8_t *src, unsigned int src_stride,
+                     unsigned int w, unsigned int h, unsigned int rotation);
+void fb_rotate_gray8_ref(uint8_t *dst, unsigned int dst_stride,
+                         const uint8_t *src, unsigned int src_stride,
+                         unsigned int w, unsigned int h,
+                         unsigned int rotation);
+
+/*
+ * fb_blit_gray8 - Convert a grey image into @rect of the framebuffer
+ *
+ * @src holds @rect's w x h pixels; the part of @rect outside the screen
+ * is dropped. The rectangle is marked dirty. With FB_DITHER_FS the
+ * error buffer is shared, so only one such blit may run at a time.
+ * Returns 0, or -1 for an unknown @dither or a rectangle too wide for
+ * Floyd-Steinberg.
+ */
+int fb_blit_gray8(struct fb_info *info, const struct fb_rect *rect,
+                  const uint8_t *src, unsigned int src_stride,
+                  unsigned int dither);
+
+#endif /* _KERNEL_FB_CONVERT_H */
@@ -0,0 +1,39 @@
+#ifndef _KERNEL_FBCON_H
+#define _KERNEL_FBCON_H
+
+#include <kernel/fb.h>
+
+/*
+ * Framebuffer console
+ *
+ * A text console on the framebuffer with the same interface as polled
+ * UART output. Once started it also mirrors everything written to the
+ * UART console, so kernel logs show up on the panel. Output may come
+ * from any context; it is queued, then drawn by a kernel thread that
+ * refreshes the panel once it has caught up.
+ */
+
+/*
+ * fbcon_init - Clear @info and start the console on it
+ * @scale: Font scale, see struct text_style
+ * Returns 0, or -1 if the font cannot be drawn at @scale on @info.
+ */
+int fbcon_init(struct fb_info *info, unsigned int scale);
+
+/*
+ * fbcon_exit - Stop the console and the mirroring of UART output
+ */
+void fbcon_exit(void);
+
+void fbcon_putc(char c);
+void fbcon_puts(const char *s);
+
+/*
+ * fbcon_flush - Draw all queued output now, in task context
+ *
+ * Only draws: the panel shows it after the fbcon thread's, or the
+ * caller's, next fb_flush().
+ */
+void fbcon_flush(void);
+
+#endif /* _KERNEL_FBCON_H */
@@ -0,0 +1,72 @@
+#ifndef _KERNEL_FONT_H
+#define _KERNEL_FONT_H
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/fb.h>
+
+/*
+ * Bitmap fonts and text rendering
+ *
+ * Text is drawn from a glyph cache rather than from the font: the first
+ * time a character is drawn at a given size, its bitmap is scaled and
+ * expanded to the framebuffer's pixel format, giving one 64-bit mask
+ * per row with every bit of each inked pixel set, left-aligned. Drawing
+ * a cell row is then a couple of shifts and one read-modify-write of
+ * the 64-bit framebuffer words it spans, whatever the size and format.
+ *
+ * The cache is keyed by (codepoint, scale) and is 4-way set associative
+ * with least recently used replacement; it is emptied when text is
+ * drawn into a framebuffer of another pixel format.
+ *
+ * A cell row must fit in 64 bits: width * scale * bits per pixel, so
+ * the 8x8 font goes up to scale 4 in 1 and 2-bit formats and scale 2
+ * in 4-bit ones.
+ */
+#define FONT_MAX_SCALE          4
+#define GLYPH_CACHE_SETS        32
+#define GLYPH_CACHE_WAYS        4
+
+struct font_desc {
+    const char *name;
+    unsigned int width;             /* Pixels, at most 8 */
+    unsigned int height;
+    unsigned int first;             /* First codepoint in @data */
+    unsigned int count;
+    const uint8_t *data;            /* @height bytes per glyph, leftmost
+                                       pixel in the top bit */
+};
+
+/* The built-in font: printable ASCII, others are drawn as '?' */
+extern const struct font_desc font_8x8;
+
+struct text_style {
+    unsigned int scale;             /* 1 to FONT_MAX_SCALE */
+    unsigned int fg;                /* 4-bit grey levels, as for fb_fill_rect */
+    unsigned int bg;
+};
+
+struct glyph_cache_stats {
+    unsigned long hits;
+    unsigned long misses;
+};
+
+/*
+ * fb_draw_text - Draw @len characters of @s with their top-left at (@x, @y)
+ *
+ * Cells are drawn opaque, background included, and clipped to the
+ * screen; the run is marked dirty as one rectangle. Returns the width
+ * of the run in pixels, or 0 if @style cannot be drawn in this format.
+ */
+unsigned int fb_draw_text(struct fb_info *info, unsigned int x, unsigned int y,
+                          const char *s, size_t len,
+                          const struct text_style *style);
+
+/*
+ * glyph_cache_flush - Drop every cached glyph
+ */
+void glyph_cache_flush(void);
+
+void glyph_cache_get_stats(struct glyph_cache_stats *stats);
+
+#endif /* _KERNEL_FONT_H */
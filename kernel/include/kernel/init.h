@@ -0,0 +1,121 @@
+#ifndef _KERNEL_INIT_H
+#define _KERNEL_INIT_H
+
+#include <types.h>
+
+/*
+ * Kernel command line.
+ *
+ * The command line is a list of space separated name=value (or bare
+ * name) arguments. Until the firmware's copy is read from the device
+ * tree, it is built in: make CMDLINE="console=ttyAMA0,921600".
+ *
+ * Code that wants an argument registers a handler with early_param().
+ * Handlers are collected in the .init.setup linker section, so no
+ * central list is needed, and run from parse_early_params() in the
+ * order they were linked. @val is "" for a bare name.
+ */
+#define COMMAND_LINE_SIZE   256
+
+struct early_param {
+    const char *name;
+    int (*setup)(const char *val);
+};
+
+#define early_param(_str, _fn)                                           \
+    static const struct early_param __early_param_##_fn                  \
+    __attribute__((used, section(".init.setup"), aligned(8))) = {        \
+        .name  = (_str),                                                 \
+        .setup = (_fn),                                                  \
+    }
+
+extern char boot_command_line[COMMAND_LINE_SIZE];
+
+/*
+ * parse_early_params - Run the handler of every argument in @cmdline
+ *
+ * Unknown arguments are ignored. A handler returning nonzero is
+ * reported on the console.
+ */
+void parse_early_params(const char *cmdline);
+
+/*
+ * Initcalls.
+ *
+ * Driver and subsystem setup registers itself with one of the level
+ * macros below instead of being called from kernel_main(). Levels run
+ * in increasing order; inside a level a call runs once every initcall
+ * it names as a dependency (by function name) has succeeded, and is
+ * skipped if one of them failed. Dependencies on earlier levels are
+ * always met by the time a level starts.
+ *
+ *     arch_initcall(bcm2837_timer_init, "bcm2837_armctrl_init");
+ *
+ * The _async variants run the call in a kernel thread, so a probe that
+ * waits on hardware with yield_or_wfi(), as spi_sync(), i2c_sync() and
+ * mailbox calls do, lets the rest of its level go on.
+ * Threads start with interrupts enabled, so async calls are only
+ * allowed from device level on, once the interrupt controllers are up.
+ * Every level waits for its async calls before the next one starts.
+ */
+typedef int (*initcall_t)(void);
+
+#define INITCALL_ASYNC      0x1
+
+struct initcall {
+    const char *name;
+    initcall_t fn;
+    const char *const *deps;
+    unsigned int nr_deps;
+    unsigned int level;
+    unsigned int flags;
+};
+
+#define __define_initcall(_fn, _level, _flags, ...)                      \
+    static const char *const __initcall_deps_##_fn[] = { __VA_ARGS__ };  \
+    static const struct initcall __initcall_##_fn                        \
+    __attribute__((used, section(".initcall" #_level ".init"),           \
+                   aligned(8))) = {                                      \
+        .name    = #_fn,                                                 \
+        .fn      = (_fn),                                                \
+        .deps    = __initcall_deps_##_fn,                                \
+        .nr_deps = sizeof(__initcall_deps_##_fn) / sizeof(char *),       \
+        .level   = (_level),                                             \
+        .flags   = (_flags),                                             \
+    }
+
+#define core_initcall(fn, ...)          __define_initcall(fn, 1, 0, __VA_ARGS__)
+#define arch_initcall(fn, ...)          __define_initcall(fn, 3, 0, __VA_ARGS__)
+#define subsys_initcall(fn, ...)        __define_initcall(fn, 4, 0, __VA_ARGS__)
+#define device_initcall(fn, ...)        __define_initcall(fn, 6, 0, __VA_ARGS__)
+#define device_initcall_async(fn, ...)  __define_initcall(fn, 6, INITCALL_ASYNC, __VA_ARGS__)
+#define late_initcall(fn, ...)          __define_initcall(fn, 7, 0, __VA_ARGS__)
+#define late_initcall_async(fn, ...)    __define_initcall(fn, 7, INITCALL_ASYNC, __VA_ARGS__)
+
+#define INITCALL_LEVEL_DEVICE   6
+
+/*
+ * do_initcalls - Run every registered initcall
+ *
+ * Each call's duration is recorded; initcall_debug on the command line
+ * prints them as they finish. Failed and skipped calls are always
+ * reported. Returns 0 if every call succeeded, -1 otherwise.
+ */
+int do_initcalls(void);
+
+/*
+ * do_initcall_table - Run the initcalls in [@start, @end)
+ *
+ * The table must be sorted by level, as the linker lays it out.
+ * do_initcalls() passes the linked-in table; tests pass their own.
+ */
+int do_initcall_table(const struct initcall *start, const struct initcall *end);
+
+/*
+ * initcall_usecs - Time the named initcall took, in microseconds
+ *
+ * Returns -1 if it did not run in the last do_initcall_table().
+ */
+long initcall_usecs(const char *name);
+
+#endif /* _KERNEL_INIT_H */
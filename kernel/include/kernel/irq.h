@@ -12,4 +12,9 @@ void set_handle_irq(void (*handler)(void));
  */
 void irq_handler_c(void);
 
+/*
+ * in_interrupt - Non-zero while the current CPU is running an IRQ handler
+ */
+int in_interrupt(void);
+
 #endif /* _KERNEL_IRQ_H */
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef _KERNEL_KSTRTOX_H
+#define _KERNEL_KSTRTOX_H
+
+/*
+ * kstrtouint - Convert a whole string to an unsigned int
+ *
+ * @base 0 picks the base from the prefix: "0x" for 16, a leading "0"
+ * for 8, 10 otherwise. Returns 0 and stores the value in @res, or -1
+ * if the string is empty, has trailing characters or overflows.
+ */
+int kstrtouint(const char *s, unsigned int base, unsigned int *res);
+
+#endif /* _KERNEL_KSTRTOX_H */
@@ -0,0 +1,52 @@
+#ifndef _KERNEL_MM_H
+#define _KERNEL_MM_H
+
+#include <types.h>
+
+/*
+ * Physical page allocator
+ *
+ * Hands out naturally aligned runs of 2^order pages, so an order-9
+ * allocation can be mapped with a single 2MB block.
+ */
+
+/*
+ * End of RAM the kernel manages. RAM_END_PA unless the device tree
+ * memory node says otherwise (see early_init_dt_scan()).
+ */
+extern unsigned long memory_end;
+
+/*
+ * page_alloc_init - Manage the physical range [start, end)
+ * @start: First usable physical address (rounded up to a page)
+ * @end: End of usable RAM (rounded down to a page)
+ */
+void page_alloc_init(unsigned long start, unsigned long end);
+
+/*
+ * page_alloc_reserve - Mark [pa, pa + size) as in use
+ */
+void page_alloc_reserve(unsigned long pa, unsigned long size);
+
+/*
+ * __alloc_pages - Allocate 2^order contiguous pages
+ * Returns the physical address, or 0 if no suitable run is free.
+ */
+unsigned long __alloc_pages(unsigned int order);
+
+/*
+ * __free_pages - Free pages returned by __alloc_pages()
+ */
+void __free_pages(unsigned long pa, unsigned int order);
+
+/* Linear-map virtual address wrappers, NULL on failure */
+void *alloc_pages(unsigned int order);
+void free_pages(void *addr, unsigned int order);
+void *get_zeroed_page(void);
+
+/*
+ * nr_free_pages - Number of free pages left
+ */
+unsigned long nr_free_pages(void);
+
+#endif /* _KERNEL_MM_H */
@@ -0,0 +1,18 @@
+#ifndef _KERNEL_MM_TYPES_H
+#define _KERNEL_MM_TYPES_H
+
+#include <asm/pgtable.h>
+
+/*
+ * A user address space: the TTBR0 half of the translation regime.
+ *
+ * Kernel threads have no mm (task->mm == NULL) and run with TTBR0 walks
+ * disabled; the kernel half is always translated through swapper_pg_dir
+ * in TTBR1.
+ */
+struct mm_struct {
+    pte_t *pgd;                 /* Level 0 table for TTBR0 */
+    unsigned long context_id;   /* ASID generation | ASID, 0 if none yet */
+};
+
+#endif /* _KERNEL_MM_TYPES_H */
@@ -0,0 +1,102 @@
+#ifndef _KERNEL_OF_H
+#define _KERNEL_OF_H
+
+#include <types.h>
+
+#ifndef __iomem
+#define __iomem
+#endif
+
+/*
+ * Device tree lookups
+ *
+ * The firmware's flattened device tree is indexed once at boot by
+ * early_init_dt_scan() (see <kernel/of_fdt.h>). Every node gets a
+ * device_node in a static table, in the order the nodes appear in the
+ * blob, with the properties drivers ask for most often already located.
+ * Names and property values point into the blob itself, which stays
+ * mapped and is never modified or copied.
+ *
+ * Lookups only scan the index, or the properties of a single node, so
+ * they are cheap enough for every driver probe. All of them return
+ * NULL (or -1) when there is no device tree, and drivers then fall back
+ * to their built-in addresses.
+ */
+struct device_node {
+    const char          *name;          /* "serial@7e201000" */
+    struct device_node  *parent;
+    uint32_t            props;          /* Blob offset of the first property */
+    uint32_t            phandle;
+    const char          *compatible;    /* Cached property values */
+    int                 compatible_len;
+    const uint32_t      *reg;
+    int                 reg_len;
+    uint8_t             n_addr_cells;   /* #address-cells for the children */
+    uint8_t             n_size_cells;   /* #size-cells for the children */
+};
+
+/* Device tree cells are big-endian */
+static inline uint32_t be32_to_cpup(const uint32_t *p)
+{
+    return __builtin_bswap32(*p);
+}
+
+/* Value of @size consecutive cells, the low 64 bits if that is more than 2 */
+static inline uint64_t of_read_number(const uint32_t *cell, int size)
+{
+    uint64_t r = 0;
+
+    while (size--)
+        r = (r << 32) | be32_to_cpup(cell++);
+    return r;
+}
+
+int of_have_populated_dt(void);
+
+/*
+ * of_find_node_by_path - Look up a node by full path, e.g. "/soc/dma"
+ *
+ * A path component without a unit address ("dma") matches the first
+ * child whose name is "dma" or starts with "dma@".
+ */
+struct device_node *of_find_node_by_path(const char *path);
+
+/*
+ * of_find_compatible_node - Next node after @from (or the first, if
+ * @from is NULL) with @compat in its compatible list
+ */
+struct device_node *of_find_compatible_node(struct device_node *from,
+                                            const char *compat);
+struct device_node *of_find_node_by_phandle(uint32_t phandle);
+
+int of_device_is_compatible(const struct device_node *np, const char *compat);
+
+/* Nonzero unless the node has a status property other than "okay"/"ok" */
+int of_device_is_available(const struct device_node *np);
+
+/*
+ * of_get_property - Value of property @name, NULL if the node has none
+ * @lenp: Set to the value length in bytes, may be NULL
+ */
+const void *of_get_property(const struct device_node *np, const char *name,
+                            int *lenp);
+
+/* Returns 0, or -1 if the property is missing or too short */
+int of_property_read_u32(const struct device_node *np, const char *name,
+                         uint32_t *out);
+
+/*
+ * of_address_to_phys - CPU physical address of entry @index of "reg"
+ *
+ * The bus address is translated through the "ranges" of every parent
+ * bus, so the VideoCore bus addresses in the soc node (0x7e......)
+ * come back as ARM physical addresses (0x3f......). @size may be NULL.
+ * Returns 0, or -1 if there is no such entry or it cannot be translated.
+ */
+int of_address_to_phys(const struct device_node *np, int index,
+                       unsigned long *pa, unsigned long *size);
+
+/* Kernel virtual address of peripheral register block @index, or NULL */
+void __iomem *of_iomap(const struct device_node *np, int index);
+
+#endif /* _KERNEL_OF_H */
@@ -0,0 +1,51 @@
+#ifndef _KERNEL_OF_FDT_H
+#define _KERNEL_OF_FDT_H
+
+#include <types.h>
+
+/*
+ * Flattened device tree (DTB) format, as passed by the firmware.
+ * All header fields and tokens are big-endian.
+ */
+#define FDT_MAGIC           0xd00dfeed
+#define FDT_FIRST_VERSION   16  /* size_dt_strings appeared here */
+#define FDT_LAST_COMP       17
+
+#define FDT_BEGIN_NODE      0x1
+#define FDT_END_NODE        0x2
+#define FDT_PROP            0x3
+#define FDT_NOP             0x4
+#define FDT_END             0x9
+
+struct fdt_header {
+    uint32_t magic;
+    uint32_t totalsize;
+    uint32_t off_dt_struct;
+    uint32_t off_dt_strings;
+    uint32_t off_mem_rsvmap;
+    uint32_t version;
+    uint32_t last_comp_version;
+    uint32_t boot_cpuid_phys;
+    uint32_t size_dt_strings;
+    uint32_t size_dt_struct;
+};
+
+/*
+ * early_init_dt_scan - Validate and index the blob at @params
+ *
+ * Builds the device_node table used by <kernel/of.h>, then reads the
+ * memory node into memory_end and /chosen/bootargs into
+ * boot_command_line. Needs no allocator, so it runs before anything
+ * else at boot. Returns 0, or -1 if the blob is missing or malformed,
+ * in which case there is no device tree and memory_end and the command
+ * line are left alone.
+ */
+int early_init_dt_scan(const void *params);
+
+/*
+ * early_init_fdt_scan_reserved_mem - Keep the page allocator off the
+ * blob itself and off the /memreserve/ ranges it lists
+ */
+void early_init_fdt_scan_reserved_mem(void);
+
+#endif /* _KERNEL_OF_FDT_H */
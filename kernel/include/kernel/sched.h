@@ -0,0 +1,96 @@
+#ifndef _KERNEL_SCHED_H
+#define _KERNEL_SCHED_H
+
+#include <types.h>
+#include <kernel/mm_types.h>
+#include <asm/processor.h>
+#include <asm/smp.h>
+
+/*
+ * Cooperative kernel threads
+ *
+ * Threads run at EL1 on the boot CPU and switch only when they call
+ * schedule(); there is no preemption and no migration between CPUs.
+ * kernel_main() becomes the idle task (init_task) and runs whenever no
+ * other thread is runnable.
+ */
+
+#define THREAD_SIZE     0x4000      /* 16KB kernel stack per thread */
+#define MAX_THREADS     8
+
+#define TASK_UNUSED     0
+#define TASK_RUNNING    1
+#define TASK_DEAD       2
+
+struct task_struct {
+    struct thread_struct thread;    /* Must be first, see switch_to.S */
+    int state;
+    int pid;
+    const char *name;
+    struct task_struct *run_next;   /* Round-robin ring of live tasks */
+    void *stack;
+    struct mm_struct *mm;           /* User address space, NULL for kthreads */
+};
+
+extern struct task_struct init_task;
+extern struct task_struct *current_task[NR_CPUS];
+
+static inline struct task_struct *get_current(void)
+{
+    return current_task[smp_processor_id()];
+}
+
+#define current get_current()
+
+/*
+ * kthread_run - Create a kernel thread and make it runnable
+ * @fn: Thread body; the thread exits when it returns
+ * @arg: Argument passed to @fn
+ * @name: Name used in diagnostics
+ *
+ * Returns the new task, or NULL if all thread slots are in use.
+ */
+struct task_struct *kthread_run(int (*fn)(void *), void *arg, const char *name);
+
+/*
+ * kthread_exit - Terminate the calling thread
+ */
+void kthread_exit(void) __attribute__((noreturn));
+
+/*
+ * schedule - Yield the CPU to the next runnable thread, if any
+ */
+void schedule(void);
+
+/*
+ * yield_or_wfi - Wait for an interrupt, letting other tasks run meanwhile
+ *
+ * For completion loops that check their condition with IRQs masked and
+ * call this until it holds. Switches to another runnable task if there
+ * is one, so a probe waiting on hardware lets the rest of boot go on;
+ * otherwise sleeps in wfi, which a pending interrupt wakes even while
+ * masked. Returns with IRQs masked.
+ */
+void yield_or_wfi(void);
+
+/*
+ * nr_running - Number of runnable threads, not counting the idle task
+ */
+int nr_running(void);
+
+/*
+ * cpu_idle_loop - Idle task body: run threads, sleep when there are none
+ */
+void cpu_idle_loop(void) __attribute__((noreturn));
+
+/*
+ * cpu_idle_ticks - Generic timer ticks @cpu has spent asleep in the idle
+ * loop since boot
+ */
+uint64_t cpu_idle_ticks(unsigned int cpu);
+
+/* Low-level context switch, returns the previous task in the new context */
+struct task_struct *cpu_switch_to(struct task_struct *prev,
+                                  struct task_struct *next);
+
+#endif /* _KERNEL_SCHED_H */
@@ -0,0 +1,24 @@
+#ifndef _KERNEL_STRING_H
+#define _KERNEL_STRING_H
+
+#include <types.h>
+#include <asm/string.h>
+
+/*
+ * Freestanding string and memory helpers.
+ *
+ * GCC may also emit calls to memcpy/memset/memmove/memcmp on its own
+ * (struct copies, large initialisers), so these symbols must always
+ * be provided by the kernel.
+ */
+void *memcpy(void *dest, const void *src, size_t n);
+void *memmove(void *dest, const void *src, size_t n);
+void *memset(void *s, int c, size_t n);
+int memcmp(const void *s1, const void *s2, size_t n);
+void *memchr(const void *s, int c, size_t n);
+size_t strlen(const char *s);
+size_t strnlen(const char *s, size_t maxlen);
+int strcmp(const char *s1, const char *s2);
+int strncmp(const char *s1, const char *s2, size_t n);
+
+#endif /* _KERNEL_STRING_H */
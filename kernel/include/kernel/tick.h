@@ -0,0 +1,37 @@
+#ifndef _KERNEL_TICK_H
+#define _KERNEL_TICK_H
+
+#include <types.h>
+
+/*
+ * Periodic tick and idle tick stopping
+ *
+ * The tick only advances jiffies, so while the CPU is idle it can be
+ * stopped: the clockevent is pushed out to the next real timer event
+ * (there are no timers yet, so TICK_NOHZ_MAX_US from now) and jiffies
+ * are caught up from the generic timer counter when the tick restarts.
+ * Jiffies stay on the grid of the original tick, so a stopped tick
+ * never gains or loses one.
+ */
+#define TICK_PERIOD_US      10000UL     /* 10ms */
+#define TICK_NOHZ_MAX_US    1000000UL   /* Longest a stopped tick sleeps */
+
+/*
+ * tick_nohz_get_sleep_length - How long the CPU could sleep from now
+ * @delta_tick: Set to the time until the next tick, in microseconds
+ *
+ * Returns the time until the next timer event if the tick were
+ * stopped, in microseconds.
+ */
+uint64_t tick_nohz_get_sleep_length(uint64_t *delta_tick);
+
+/*
+ * tick_nohz_idle_stop_tick - Stop the tick for an idle period
+ * tick_nohz_idle_restart_tick - Catch up jiffies and restart the tick
+ *
+ * Called from the idle loop with interrupts masked, in pairs.
+ */
+void tick_nohz_idle_stop_tick(void);
+void tick_nohz_idle_restart_tick(void);
+
+#endif /* _KERNEL_TICK_H */
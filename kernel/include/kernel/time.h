@@ -0,0 +1,9 @@
+#ifndef _KERNEL_TIME_H
+#define _KERNEL_TIME_H
+
+/* Time unit conversions */
+#define MSEC_PER_SEC    1000UL
+#define USEC_PER_SEC    1000000UL
+#define NSEC_PER_SEC    1000000000UL
+
+#endif /* _KERNEL_TIME_H */
@@ -0,0 +1,141 @@
+#ifndef _MAILBOX_BCM2837_MBOX_H
+#define _MAILBOX_BCM2837_MBOX_H
+
+#include <types.h>
+
+/*
+ * VideoCore mailbox property interface (channel 8)
+ *
+ * A property message is a list of tags, each a request to the firmware
+ * with room for its answer. Several tags go to the firmware in one
+ * message, so a caller that needs several values (or a framebuffer,
+ * which takes half a dozen tags) pays for one round trip:
+ *
+ *     struct mbox_batch b;
+ *     uint32_t rate;
+ *     int arm, temp;
+ *
+ *     mbox_batch_init(&b);
+ *     arm = mbox_batch_add(&b, MBOX_TAG_GET_CLOCK_RATE,
+ *                          (const uint32_t[]){ MBOX_CLK_ARM }, 1, 2);
+ *     temp = mbox_batch_add(&b, MBOX_TAG_GET_TEMPERATURE,
+ *                           (const uint32_t[]){ 0 }, 1, 2);
+ *     if (!mbox_batch_submit(&b))
+ *         rate = mbox_batch_value(&b, arm)[1];
+ *
+ * The typed helpers below each send a one-tag batch.
+ *
+ * Only one message is with the firmware at a time; submitting waits
+ * for the mailbox interrupt and must not be called from interrupt
+ * context.
+ */
+
+/* Tags */
+#define MBOX_TAG_GET_FIRMWARE_REV       0x00000001
+#define MBOX_TAG_GET_BOARD_REV          0x00010002
+#define MBOX_TAG_GET_ARM_MEMORY         0x00010005
+#define MBOX_TAG_GET_VC_MEMORY          0x00010006
+#define MBOX_TAG_GET_CLOCK_RATE         0x00030002
+#define MBOX_TAG_GET_MAX_CLOCK_RATE     0x00030004
+#define MBOX_TAG_GET_TEMPERATURE        0x00030006
+#define MBOX_TAG_GET_MIN_CLOCK_RATE     0x00030007
+#define MBOX_TAG_GET_MAX_TEMPERATURE    0x0003000a
+#define MBOX_TAG_SET_CLOCK_RATE         0x00038002
+#define MBOX_TAG_FB_ALLOCATE            0x00040001
+#define MBOX_TAG_FB_GET_PITCH           0x00040008
+#define MBOX_TAG_FB_SET_PHYS_WH         0x00048003
+#define MBOX_TAG_FB_SET_VIRT_WH         0x00048004
+#define MBOX_TAG_FB_SET_DEPTH           0x00048005
+#define MBOX_TAG_FB_SET_PIXEL_ORDER     0x00048006
+#define MBOX_TAG_FB_SET_VIRT_OFFSET     0x00048009
+
+/* Clock IDs */
+#define MBOX_CLK_EMMC       1
+#define MBOX_CLK_UART       2
+#define MBOX_CLK_ARM        3
+#define MBOX_CLK_CORE       4
+#define MBOX_CLK_V3D        5
+#define MBOX_CLK_H264       6
+#define MBOX_CLK_ISP        7
+#define MBOX_CLK_SDRAM      8
+#define MBOX_CLK_PIXEL      9
+#define MBOX_CLK_PWM        10
+
+/* Words of tags and values one message can carry */
+#define MBOX_BATCH_WORDS    64
+
+struct mbox_batch {
+    uint32_t buf[MBOX_BATCH_WORDS] __attribute__((aligned(16)));
+    unsigned int len;           /* Words used, including the header */
+    int overflow;
+};
+
+/*
+ * mbox_batch_init - Start an empty message
+ */
+void mbox_batch_init(struct mbox_batch *b);
+
+/*
+ * mbox_batch_add - Append a tag
+ * @req: Request values, @req_words of them (may be NULL if 0)
+ * @val_words: Size of the value buffer, at least as large as both the
+ *             request and the longest answer the tag can give
+ *
+ * Returns a handle for mbox_batch_value(), or -1 if the message is
+ * full, in which case submitting it fails too.
+ */
+int mbox_batch_add(struct mbox_batch *b, uint32_t tag, const uint32_t *req,
+                   unsigned int req_words, unsigned int val_words);
+
+/*
+ * mbox_batch_submit - Send the message and wait for the answer
+ *
+ * Returns 0 when the firmware processed the message, -1 otherwise
+ * (driver not probed, message full, or a malformed message).
+ */
+int mbox_batch_submit(struct mbox_batch *b);
+
+/*
+ * mbox_batch_value - Answer to the tag added as @handle
+ *
+ * Returns its value words, or NULL if the firmware did not answer that
+ * tag (unknown tag, or the answer did not fit).
+ */
+const uint32_t *mbox_batch_value(const struct mbox_batch *b, int handle);
+
+/* One-tag helpers; all return 0 on success, -1 on failure */
+int mbox_get_firmware_revision(uint32_t *rev);
+int mbox_get_arm_memory(uint32_t *base, uint32_t *size);
+int mbox_get_clock_rate(unsigned int clk, uint32_t *rate);
+int mbox_get_max_clock_rate(unsigned int clk, uint32_t *rate);
+int mbox_get_min_clock_rate(unsigned int clk, uint32_t *rate);
+/* @rate is the requested rate in Hz; @actual (may be NULL) what was set */
+int mbox_set_clock_rate(unsigned int clk, uint32_t rate, uint32_t *actual);
+/* SoC temperature in thousandths of a degree Celsius */
+int mbox_get_temperature(uint32_t *millicelsius);
+int mbox_get_max_temperature(uint32_t *millicelsius);
+
+/*
+ * Framebuffer allocation: the geometry and depth requests and the
+ * allocation itself go to the firmware as one batch. On return @cfg
+ * holds what the firmware actually set up.
+ */
+struct mbox_fb_config {
+    uint32_t width, height;     /* Physical (display) size */
+    uint32_t virt_width, virt_height;
+    uint32_t depth;             /* Bits per pixel */
+    uint32_t pixel_order;       /* 0 = BGR, 1 = RGB */
+    uint32_t pitch;             /* Out: bytes per line */
+    uint32_t bus_addr;          /* Out: VideoCore bus address */
+    uint32_t size;              /* Out: bytes */
+};
+
+int mbox_fb_alloc(struct mbox_fb_config *cfg);
+
+/*
+ * bcm2837_mbox_init - Map the mailbox and take its interrupt
+ * Needs the IRQ controllers and the DMA coherent pool.
+ */
+int bcm2837_mbox_init(void);
+
+#endif /* _MAILBOX_BCM2837_MBOX_H */
@@ -1,6 +1,7 @@
 #ifndef _SERIAL_CORE_H
 #define _SERIAL_CORE_H
 
+#include <stddef.h>
 #include <types.h>
 
 #ifndef __iomem
@@ -16,11 +17,27 @@ struct uart_port;
 struct uart_ops {
     int  (*startup)(struct uart_port *port);
     void (*poll_put_char)(struct uart_port *port, unsigned char ch);
+    /*
+     * Optional asynchronous transmit. start_tx() starts sending what is
+     * queued in the log ring (uart_tx_peek()/uart_tx_consume()) and
+     * must be callable from any context. poll_tx() makes progress with
+     * interrupts masked and returns nonzero while the port still has
+     * data in flight.
+     */
+    void (*start_tx)(struct uart_port *port);
+    int  (*poll_tx)(struct uart_port *port);
+    /*
+     * Reprogram the line for @baud once the transmitter is idle.
+     * Returns 0, or -1 if the clock cannot produce that rate.
+     */
+    int  (*set_termios)(struct uart_port *port, unsigned int baud);
 };
 
 struct uart_port {
     void __iomem            *membase;     /* MMIO base */
+    unsigned long           mapbase;      /* physical address of the registers */
     unsigned int            uartclk;      /* input clock */
+    unsigned int            baud;         /* current line rate */
     unsigned int            fifosize;
     unsigned char           regshift;
     enum uart_iotype        iotype;
@@ -29,7 +46,54 @@ struct uart_port {
 };
 
 void uart_add_one_port(struct uart_port *port);
+
+/*
+ * Change the console line rate at runtime. Buffered output is flushed
+ * at the old rate first. Returns 0, or -1 if the port cannot do @baud.
+ */
+int uart_set_baud(unsigned int baud);
+unsigned int uart_get_baud(void);
+
+/*
+ * Console output. Until the port can transmit asynchronously this is
+ * written straight to the UART; after that it is queued in the log
+ * ring like uart_write(), so the two keep their order on the line.
+ */
 void uart_poll_putc(char c);
 void uart_poll_puts(const char *s);
+void uart_poll_put_dec(uint64_t val);
+void uart_poll_put_hex(uint64_t val);
+
+/*
+ * Polled output for panics and early boot: flushes whatever is queued,
+ * then writes straight to the UART before returning.
+ */
+void uart_sync_putc(char c);
+void uart_sync_puts(const char *s);
+
+/*
+ * Also hand every character of console output, polled or buffered, to
+ * @mirror (NULL to stop), e.g. to show kernel logs on the framebuffer.
+ * @mirror runs in the caller's context, which may be an IRQ handler or
+ * an IRQ-masked section, so it must only queue the character.
+ */
+void uart_set_mirror(void (*mirror)(char c));
+
+/*
+ * Buffered output through the log ring, for bulk dumps. If the port
+ * can transmit asynchronously (DMA), uart_write() only copies into the
+ * ring and returns, waiting only when the ring is full; otherwise it
+ * falls back to polled output. uart_flush() waits until everything
+ * queued has left the UART.
+ */
+size_t uart_write(const char *buf, size_t len);
+void uart_flush(void);
+
+/*
+ * For drivers: the oldest queued bytes that are contiguous in the ring,
+ * and marking @n of them as sent. Callers mask interrupts.
+ */
+size_t uart_tx_peek(const char **data);
+void uart_tx_consume(size_t n);
 
 #endif
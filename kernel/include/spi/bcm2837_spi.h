@@ -0,0 +1,18 @@
+#ifndef _SPI_BCM2837_SPI_H
+#define _SPI_BCM2837_SPI_H
+
+/*
+ * BCM2837 SPI0 master
+ *
+ * On the 40-pin header: CE1 GPIO 7, CE0 GPIO 8, MISO GPIO 9,
+ * MOSI GPIO 10 and SCLK GPIO 11, all ALT0.
+ */
+#define BCM2837_SPI0_PA         0x3F204000
+
+/*
+ * bcm2837_spi_init - Set up SPI0 and its DMA channels
+ * Needs the DMA engine, GPIO and the mailbox (for the core clock).
+ */
+int bcm2837_spi_init(void);
+
+#endif /* _SPI_BCM2837_SPI_H */
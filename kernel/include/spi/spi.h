@@ -0,0 +1,96 @@
+#ifndef _SPI_SPI_H
+#define _SPI_SPI_H
+
+#include <stddef.h>
+#include <types.h>
+
+/*
+ * SPI master
+ *
+ * A client describes one chip-select-framed exchange with a device as
+ * a message: an array of transfers sent back to back with chip select
+ * held asserted throughout. Messages are queued on the controller and
+ * run in order, driven entirely from interrupts: the CPU is not needed
+ * between bytes, chunks or transfers except to start the next one from
+ * the completion interrupt of the last.
+ *
+ * Display controllers take a data/command (DC) line next to the SPI
+ * signals; a device with dc_gpio set gets it driven to each transfer's
+ * @dc level before that transfer's first byte, so a command byte and
+ * its parameters can go out in one message.
+ */
+
+#define SPI_CPHA        0x01
+#define SPI_CPOL        0x02
+#define SPI_CS_HIGH     0x04
+
+#define SPI_MODE_0      0
+#define SPI_MODE_1      SPI_CPHA
+#define SPI_MODE_2      SPI_CPOL
+#define SPI_MODE_3      (SPI_CPOL | SPI_CPHA)
+
+#define SPI_NO_DC       (-1)    /* dc_gpio: device has no DC line */
+#define SPI_DC_KEEP     (-1)    /* dc: leave the DC line as it is */
+#define SPI_DC_COMMAND  0
+#define SPI_DC_DATA     1
+
+#define SPI_MSG_QUEUED  1       /* msg->status until the message completes */
+
+struct spi_device {
+    unsigned int chip_select;   /* Native chip select line */
+    uint32_t max_speed_hz;
+    unsigned int mode;          /* SPI_MODE_* | SPI_CS_HIGH */
+    int dc_gpio;                /* GPIO of the DC line, already an output,
+                                   or SPI_NO_DC */
+};
+
+struct spi_transfer {
+    const void *tx_buf;         /* NULL to clock out zeros */
+    void *rx_buf;               /* NULL to discard what comes in */
+    size_t len;
+    int dc;                     /* SPI_DC_COMMAND, SPI_DC_DATA or SPI_DC_KEEP */
+};
+
+struct spi_message {
+    struct spi_device *spi;
+    struct spi_transfer *transfers;
+    unsigned int nr_transfers;
+    /* Called from interrupt context once the message is done, may be NULL */
+    void (*complete)(void *context);
+    void *context;
+    int status;                 /* 0, -1 on error, SPI_MSG_QUEUED */
+    size_t actual_length;
+    struct spi_message *next;   /* Controller queue */
+};
+
+/*
+ * spi_async - Queue @msg and return at once
+ *
+ * The buffers must stay untouched until msg->complete runs. Returns 0,
+ * or -1 if the controller is not available or @msg is invalid.
+ */
+int spi_async(struct spi_message *msg);
+
+/*
+ * spi_sync - Queue @msg and sleep until it is done
+ *
+ * Works with interrupts masked too, by doing the interrupt handlers'
+ * work while waiting. Returns msg->status.
+ */
+int spi_sync(struct spi_message *msg);
+
+/*
+ * spi_write - Send @len bytes from @buf in a single-transfer message
+ * @dc: Level of the DC line, as for struct spi_transfer
+ */
+int spi_write(struct spi_device *spi, const void *buf, size_t len, int dc);
+
+/*
+ * spi_effective_speed_hz - SCLK rate @spi's messages run at
+ *
+ * At most spi->max_speed_hz, as the controller's divider allows.
+ * Returns 0 if the controller is not available.
+ */
+uint32_t spi_effective_speed_hz(struct spi_device *spi);
+
+#endif /* _SPI_SPI_H */
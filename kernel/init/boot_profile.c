@@ -0,0 +1,93 @@
+/*
+ * Boot-time profiler
+ *
+ * boot.S's stamps come first in the timeline, followed by the marks
+ * taken from C in the order they were made. Each stage's duration is
+ * the time since the stamp before it.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/boot_profile.h>
+#include <kernel/time.h>
+#include <asm/arch_timer.h>
+
+#define BOOT_PROFILE_MAX_MARKS  24
+
+struct boot_mark {
+    const char *name;
+    uint64_t stamp;
+};
+
+/* Written by boot.S after BSS is cleared */
+uint64_t boot_stamps[BOOT_NR_ASM_STAMPS];
+
+static const char *const boot_stamp_names[BOOT_NR_ASM_STAMPS] = {
+    [BOOT_STAMP_START]       = "firmware",
+    [BOOT_STAMP_EL1]         = "el2_to_el1",
+    [BOOT_STAMP_PGTABLE]     = "page_tables",
+    [BOOT_STAMP_MMU]         = "mmu_on",
+    [BOOT_STAMP_HIGHER_HALF] = "higher_half",
+    [BOOT_STAMP_BSS]         = "bss_clear",
+};
+
+static struct boot_mark boot_marks[BOOT_PROFILE_MAX_MARKS];
+static unsigned int nr_boot_marks;
+
+void boot_profile_mark(const char *name)
+{
+    if (nr_boot_marks == BOOT_PROFILE_MAX_MARKS)
+        return;
+    boot_marks[nr_boot_marks].name = name;
+    boot_marks[nr_boot_marks].stamp = arch_counter_get_cntvct();
+    nr_boot_marks++;
+}
+
+static uint64_t boot_ticks_to_ns(uint64_t ticks, uint64_t freq)
+{
+    /* Split so ticks since reset times NSEC_PER_SEC cannot overflow */
+    return (ticks / freq) * NSEC_PER_SEC +
+           ((ticks % freq) * NSEC_PER_SEC) / freq;
+}
+
+static void boot_profile_line(const char *name, uint64_t stamp,
+                              uint64_t prev, uint64_t freq)
+{
+    uint64_t ns = boot_ticks_to_ns(stamp - prev, freq);
+
+    uart_poll_puts("  ");
+    uart_poll_put_dec(boot_ticks_to_ns(stamp, freq) / 1000);
+    uart_poll_puts(" us  +");
+    uart_poll_put_dec(ns / 1000);
+    uart_poll_puts(" us  ");
+    uart_poll_puts(name);
+    uart_poll_puts("\n");
+
+#ifdef CONFIG_BENCH
+    uart_poll_puts("BENCH boot_");
+    uart_poll_puts(name);
+    uart_poll_puts(" iters=1 ns=");
+    uart_poll_put_dec(ns);
+    uart_poll_puts(" ns_per_op=");
+    uart_poll_put_dec(ns);
+    uart_poll_puts(".000\n");
+#endif
+}
+
+void boot_profile_dump(void)
+{
+    uint64_t freq = arch_timer_get_cntfrq();
+    uint64_t prev = 0;
+    unsigned int i;
+
+    uart_poll_puts("Boot timeline (end of stage since reset, duration):\n");
+
+    for (i = 0; i < BOOT_NR_ASM_STAMPS; i++) {
+        boot_profile_line(boot_stamp_names[i], boot_stamps[i], prev, freq);
+        prev = boot_stamps[i];
+    }
+    for (i = 0; i < nr_boot_marks; i++) {
+        boot_profile_line(boot_marks[i].name, boot_marks[i].stamp, prev, freq);
+        prev = boot_marks[i].stamp;
+    }
+}
@@ -0,0 +1,255 @@
+/*
+ * Initcall runner
+ *
+ * The initcall table is laid out by the linker sorted by level, so each
+ * level is one contiguous run of entries. A level is walked repeatedly:
+ * every pass starts the calls whose dependencies have all completed,
+ * until none is left waiting. Async calls are handed to kernel threads
+ * and the walk yields to them with schedule() when nothing else can
+ * start. A pass that starts nothing while no thread is running means
+ * the remaining dependencies can never be met (a cycle, or a name from
+ * a later level); those calls are skipped.
+ *
+ * Durations are taken from the generic timer counter, which runs from
+ * reset, so they are valid before the system timer is set up.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/init.h>
+#include <kernel/sched.h>
+#include <kernel/string.h>
+#include <asm/arch_timer.h>
+
+#define MAX_INITCALLS   64
+
+#define IC_PENDING  0
+#define IC_RUNNING  1
+#define IC_DONE     2
+#define IC_FAILED   3       /* Ran and returned nonzero */
+#define IC_SKIPPED  4       /* Never ran */
+
+struct initcall_stat {
+    const struct initcall *call;
+    int state;
+    int ret;
+    uint64_t start;         /* Counter ticks */
+    uint64_t end;
+};
+
+/* Provided by the linker script */
+extern const struct initcall __initcall_start[];
+extern const struct initcall __initcall_end[];
+
+static struct initcall_stat initcall_stats[MAX_INITCALLS];
+static unsigned int nr_initcalls;
+
+static int initcall_debug;
+
+static int initcall_debug_setup(const char *val)
+{
+    initcall_debug = 1;
+    return 0;
+}
+early_param("initcall_debug", initcall_debug_setup);
+
+static unsigned long ticks_to_usecs(uint64_t ticks)
+{
+    return ticks * 1000000 / arch_timer_get_cntfrq();
+}
+
+static void initcall_print_ret(int ret)
+{
+    if (ret < 0) {
+        uart_poll_putc('-');
+        uart_poll_put_dec(-(int64_t)ret);
+    } else {
+        uart_poll_put_dec(ret);
+    }
+}
+
+static void initcall_skip(struct initcall_stat *st, const char *why,
+                          const char *dep)
+{
+    st->state = IC_SKIPPED;
+    uart_poll_puts("initcall ");
+    uart_poll_puts(st->call->name);
+    uart_poll_puts(" skipped: ");
+    uart_poll_puts(why);
+    if (dep) {
+        uart_poll_puts(" ");
+        uart_poll_puts(dep);
+    }
+    uart_poll_puts("\n");
+}
+
+static void do_one_initcall(struct initcall_stat *st)
+{
+    st->start = arch_counter_get_cntvct();
+    st->ret = st->call->fn();
+    st->end = arch_counter_get_cntvct();
+    st->state = st->ret ? IC_FAILED : IC_DONE;
+
+    if (!st->ret && !initcall_debug)
+        return;
+
+    uart_poll_puts("initcall ");
+    uart_poll_puts(st->call->name);
+    uart_poll_puts(" returned ");
+    initcall_print_ret(st->ret);
+    uart_poll_puts(" after ");
+    uart_poll_put_dec(ticks_to_usecs(st->end - st->start));
+    uart_poll_puts(" usecs\n");
+}
+
+static int initcall_thread(void *arg)
+{
+    do_one_initcall(arg);
+    return 0;
+}
+
+static struct initcall_stat *find_initcall(const char *name)
+{
+    for (unsigned int i = 0; i < nr_initcalls; i++) {
+        if (!strcmp(initcall_stats[i].call->name, name))
+            return &initcall_stats[i];
+    }
+    return NULL;
+}
+
+/*
+ * Returns IC_DONE when @st may run, IC_PENDING while a dependency has
+ * yet to finish, and IC_SKIPPED (after reporting why) when one never
+ * will succeed.
+ */
+static int initcall_deps_state(struct initcall_stat *st)
+{
+    const struct initcall *call = st->call;
+    int state = IC_DONE;
+
+    for (unsigned int i = 0; i < call->nr_deps; i++) {
+        struct initcall_stat *dep = find_initcall(call->deps[i]);
+
+        if (!dep) {
+            initcall_skip(st, "unknown dependency", call->deps[i]);
+            return IC_SKIPPED;
+        }
+        if (dep->state == IC_FAILED || dep->state == IC_SKIPPED) {
+            initcall_skip(st, "dependency failed:", call->deps[i]);
+            return IC_SKIPPED;
+        }
+        if (dep->state != IC_DONE)
+            state = IC_PENDING;
+    }
+    return state;
+}
+
+static void do_initcall_level(struct initcall_stat *first,
+                              struct initcall_stat *last)
+{
+    for (;;) {
+        int started = 0, waiting = 0, running = 0;
+        struct initcall_stat *st;
+
+        for (st = first; st < last; st++) {
+            if (st->state == IC_RUNNING)
+                running++;
+            if (st->state != IC_PENDING)
+                continue;
+
+            switch (initcall_deps_state(st)) {
+            case IC_PENDING:
+                waiting++;
+                continue;
+            case IC_SKIPPED:
+                started++;
+                continue;
+            }
+
+            started++;
+            if ((st->call->flags & INITCALL_ASYNC) &&
+                st->call->level >= INITCALL_LEVEL_DEVICE) {
+                st->state = IC_RUNNING;
+                if (kthread_run(initcall_thread, st, st->call->name)) {
+                    running++;
+                    continue;
+                }
+                /* No free thread: run it here instead */
+            }
+            do_one_initcall(st);
+        }
+
+        if (!waiting && !running)
+            return;
+        if (running) {
+            schedule();
+            continue;
+        }
+        if (started)
+            continue;
+
+        for (st = first; st < last; st++) {
+            if (st->state == IC_PENDING)
+                initcall_skip(st, "unresolved dependencies", NULL);
+        }
+        return;
+    }
+}
+
+int do_initcall_table(const struct initcall *start, const struct initcall *end)
+{
+    unsigned int i, level_start;
+    int ret = 0;
+
+    nr_initcalls = 0;
+    if (end - start > MAX_INITCALLS) {
+        uart_poll_puts("initcall: table too large\n");
+        return -1;
+    }
+
+    for (i = 0; start + i < end; i++) {
+        initcall_stats[i].call = &start[i];
+        initcall_stats[i].state = IC_PENDING;
+        initcall_stats[i].ret = 0;
+    }
+    nr_initcalls = i;
+
+    for (level_start = 0; level_start < nr_initcalls; level_start = i) {
+        unsigned int level = initcall_stats[level_start].call->level;
+
+        for (i = level_start; i < nr_initcalls; i++) {
+            if (initcall_stats[i].call->level != level)
+                break;
+        }
+        do_initcall_level(&initcall_stats[level_start], &initcall_stats[i]);
+    }
+
+    for (i = 0; i < nr_initcalls; i++) {
+        if (initcall_stats[i].state != IC_DONE)
+            ret = -1;
+    }
+    return ret;
+}
+
+int do_initcalls(void)
+{
+    uint64_t start = arch_counter_get_cntvct();
+    int ret;
+
+    ret = do_initcall_table(__initcall_start, __initcall_end);
+
+    uart_poll_puts("Initcalls done in ");
+    uart_poll_put_dec(ticks_to_usecs(arch_counter_get_cntvct() - start));
+    uart_poll_puts(" usecs\n");
+    return ret;
+}
+
+long initcall_usecs(const char *name)
+{
+    struct initcall_stat *st = find_initcall(name);
+
+    if (!st || (st->state != IC_DONE && st->state != IC_FAILED))
+        return -1;
+    return ticks_to_usecs(st->end - st->start);
+}
@@ -1,13 +1,20 @@
 #include <types.h>
 #include <serial_core.h>
 #include <kernel/irq_chip.h>
+#include <kernel/bench.h>
+#include <kernel/boot_profile.h>
+#include <kernel/sched.h>
+#include <kernel/init.h>
+#include <kernel/of_fdt.h>
+#include <kernel/mm.h>
+#include <kernel/dma-mapping.h>
+#include <asm/memory.h>
+#include <asm/pgtable.h>
+#include <asm/sections.h>
 #include <asm/irqflags.h>
 
 extern void pl011_register(void);
 extern void install_exception_vectors(void);
-extern int bcm2837_irq_init(void);
-extern int bcm2837_armctrl_init(void);
-extern int bcm2837_timer_init(void);
 
 static inline unsigned int current_el(void)
 {
@@ -16,15 +23,39 @@ static inline unsigned int current_el(void)
     return (el >> 2) & 0x3;
 }
 
-void kernel_main(void)
+void kernel_main(unsigned long dtb_phys)
 {
     unsigned int el;
-    
-    // TODO: Dynamic detection of UART base address via DTB parsing
+    int have_dt;
+
+    // Index the firmware's device tree before any driver looks up its
+    // registers. The blob is in RAM, reached through the boot mapping
+    // now and through the linear map after paging_init()
+    have_dt = dtb_phys && !early_init_dt_scan(__va(dtb_phys));
+    boot_profile_mark("dt_scan");
+
     pl011_register();
+    boot_profile_mark("console");
 
     uart_poll_puts("\n");
     uart_poll_puts("MulberryOS booting\n");
+
+    if (have_dt) {
+        uart_poll_puts("Device tree at ");
+        uart_poll_put_hex(dtb_phys);
+        uart_poll_puts(", RAM up to ");
+        uart_poll_put_hex(memory_end);
+        uart_poll_puts("\n");
+    } else {
+        uart_poll_puts("No device tree, using built-in addresses\n");
+    }
+
+    // Console options (console=ttyAMA0,921600) take effect from here on
+    uart_poll_puts("Kernel command line: ");
+    uart_poll_puts(boot_command_line);
+    uart_poll_puts("\n");
+    parse_early_params(boot_command_line);
+    boot_profile_mark("early_params");
     
     // Display exception level
     el = current_el();
@@ -33,35 +64,44 @@ void kernel_main(void)
     uart_poll_puts("\n");
     
     // Install exception vector table
-    uart_poll_puts("Installing exception vectors...\n");
     install_exception_vectors();
     uart_poll_puts("Exception vectors installed at VBAR_EL1\n");
+    boot_profile_mark("vectors");
 
-    // Initialize IRQ subsystem
-    uart_poll_puts("Initializing IRQ subsystem...\n");
-    irq_init();
+    // Page allocator takes all RAM above the kernel image
+    page_alloc_init(__pa(_end), memory_end);
+    early_init_fdt_scan_reserved_mem();
+    boot_profile_mark("page_alloc");
 
-    // Initialize BCM2837 local interrupt controller
-    uart_poll_puts("Initializing BCM2837 IRQ controller...\n");
-    bcm2837_irq_init();
-    
-    // Initialize ARMCTRL (GPU peripheral interrupts)
-    uart_poll_puts("Initializing ARMCTRL interrupt controller...\n");
-    bcm2837_armctrl_init();
-    uart_poll_puts("IRQ initialization complete.\n");
+    // Replace the boot block mapping of the kernel half
+    paging_init();
+    boot_profile_mark("paging_init");
+
+    // Uncached pool for DMA descriptors and small device buffers
+    dma_coherent_init();
+    boot_profile_mark("dma_coherent");
+
+    // Clear the IRQ descriptor table before any chip registers itself
+    irq_init();
+    boot_profile_mark("irq_init");
 
-    // Initialize System Timer
-    uart_poll_puts("Initializing BCM2837 System Timer...\n");
-    bcm2837_timer_init();
-    uart_poll_puts("System Timer initialized.\n");
+    // Interrupt controllers, timer, DMA and device probes, in
+    // dependency order (see include/kernel/init.h)
+    do_initcalls();
+    boot_profile_mark("initcalls");
 
     uart_poll_puts("\nKernel initialization complete.\n");
+    boot_profile_dump();
+
+#ifdef CONFIG_BENCH
+    /* Benchmark kernel: run with interrupts still masked to avoid noise */
+    bench_run_all();
+#endif
+
     uart_poll_puts("Entering idle loop...\n");
     uart_poll_puts("========================================\n");
     local_irq_enable();
 
-    /* Main idle loop */
-    for (;;) {
-        __asm__ volatile("wfi");
-    }
+    /* Run kernel threads, sleep when there are none */
+    cpu_idle_loop();
 }
\ No newline at end of file
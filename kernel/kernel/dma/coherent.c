@@ -0,0 +1,107 @@
+/*
+ * DMA coherent pool
+ *
+ * A 1MB physically contiguous pool, mapped Normal Non-cacheable at
+ * DMA_COHERENT_BASE and handed out a page at a time (first fit, one
+ * bit per page). Its cacheable alias in the linear map is removed:
+ * mapping the same memory with mismatched cacheability is not allowed,
+ * and a dirty line from the alias could later be evicted on top of
+ * what a device wrote.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/dma-mapping.h>
+#include <kernel/mm.h>
+#include <asm/cacheflush.h>
+#include <asm/memory.h>
+#include <asm/pgtable.h>
+
+#define DMA_COHERENT_POOL_ORDER 8
+#define DMA_COHERENT_POOL_PAGES (1UL << DMA_COHERENT_POOL_ORDER)
+#define DMA_COHERENT_POOL_SIZE  (DMA_COHERENT_POOL_PAGES * PAGE_SIZE)
+#define BITS_PER_LONG           64
+
+static unsigned long pool_pa;
+static unsigned long pool_map[DMA_COHERENT_POOL_PAGES / BITS_PER_LONG];
+
+static inline int pool_page_used(unsigned long i)
+{
+    return (pool_map[i / BITS_PER_LONG] >> (i % BITS_PER_LONG)) & 1;
+}
+
+static void pool_set(unsigned long first, unsigned long n, int used)
+{
+    unsigned long i;
+
+    for (i = first; i < first + n; i++) {
+        if (used)
+            pool_map[i / BITS_PER_LONG] |= 1UL << (i % BITS_PER_LONG);
+        else
+            pool_map[i / BITS_PER_LONG] &= ~(1UL << (i % BITS_PER_LONG));
+    }
+}
+
+int dma_coherent_init(void)
+{
+    unsigned long pa = __alloc_pages(DMA_COHERENT_POOL_ORDER);
+    unsigned long va = (unsigned long)__va(pa);
+
+    if (!pa) {
+        uart_poll_puts("dma: no memory for the coherent pool\n");
+        return -1;
+    }
+
+    if (unmap_pages(swapper_pg_dir, va, DMA_COHERENT_POOL_SIZE) ||
+        map_pages(swapper_pg_dir, DMA_COHERENT_BASE, pa,
+                  DMA_COHERENT_POOL_SIZE, PAGE_KERNEL_NC)) {
+        uart_poll_puts("dma: failed to map the coherent pool\n");
+        return -1;
+    }
+
+    /*
+     * Maintenance by VA acts on the physical line whatever the mapping's
+     * attributes, so this drops anything still cached from the old alias.
+     */
+    dcache_clean_inval_range(DMA_COHERENT_BASE,
+                             DMA_COHERENT_BASE + DMA_COHERENT_POOL_SIZE);
+
+    pool_pa = pa;
+    return 0;
+}
+
+void *dma_alloc_coherent(size_t size, dma_addr_t *handle)
+{
+    unsigned long n = PAGE_ALIGN(size) >> PAGE_SHIFT;
+    unsigned long first, i;
+
+    if (!pool_pa || n == 0 || n > DMA_COHERENT_POOL_PAGES)
+        return NULL;
+
+    for (first = 0; first + n <= DMA_COHERENT_POOL_PAGES; first = i + 1) {
+        for (i = first; i < first + n; i++) {
+            if (pool_page_used(i))
+                break;
+        }
+        if (i == first + n) {
+            pool_set(first, n, 1);
+            *handle = phys_to_dma(pool_pa + first * PAGE_SIZE);
+            return (void *)(DMA_COHERENT_BASE + first * PAGE_SIZE);
+        }
+    }
+
+    return NULL;
+}
+
+void dma_free_coherent(size_t size, void *cpu_addr, dma_addr_t handle)
+{
+    unsigned long first = ((unsigned long)cpu_addr - DMA_COHERENT_BASE) >> PAGE_SHIFT;
+    unsigned long n = PAGE_ALIGN(size) >> PAGE_SHIFT;
+
+    (void)handle;
+    if (first + n > DMA_COHERENT_POOL_PAGES)
+        return;
+
+    pool_set(first, n, 0);
+}
@@ -0,0 +1,58 @@
+/*
+ * Streaming DMA mappings
+ *
+ * Same rules as Linux arm64: before the device runs, write back what
+ * the CPU wrote (or drop stale lines of a receive buffer); after it
+ * ran, drop whatever the CPU may have speculatively refetched into the
+ * buffer in the meantime.
+ */
+
+#include <kernel/dma-mapping.h>
+#include <asm/cacheflush.h>
+#include <asm/memory.h>
+
+static inline unsigned long dma_to_virt(dma_addr_t addr)
+{
+    return (unsigned long)__va(dma_to_phys(addr));
+}
+
+static void __dma_map_area(unsigned long start, size_t size,
+                           enum dma_data_direction dir)
+{
+    if (dir == DMA_FROM_DEVICE)
+        dcache_inval_range(start, start + size);
+    else
+        dcache_clean_range(start, start + size);
+}
+
+static void __dma_unmap_area(unsigned long start, size_t size,
+                             enum dma_data_direction dir)
+{
+    if (dir != DMA_TO_DEVICE)
+        dcache_inval_range(start, start + size);
+}
+
+dma_addr_t dma_map_single(void *cpu_addr, size_t size,
+                          enum dma_data_direction dir)
+{
+    __dma_map_area((unsigned long)cpu_addr, size, dir);
+    return phys_to_dma(__pa(cpu_addr));
+}
+
+void dma_unmap_single(dma_addr_t addr, size_t size,
+                      enum dma_data_direction dir)
+{
+    __dma_unmap_area(dma_to_virt(addr), size, dir);
+}
+
+void dma_sync_single_for_cpu(dma_addr_t addr, size_t size,
+                             enum dma_data_direction dir)
+{
+    __dma_unmap_area(dma_to_virt(addr), size, dir);
+}
+
+void dma_sync_single_for_device(dma_addr_t addr, size_t size,
+                                enum dma_data_direction dir)
+{
+    __dma_map_area(dma_to_virt(addr), size, dir);
+}
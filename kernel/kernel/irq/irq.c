@@ -1,9 +1,13 @@
 #include <stddef.h>
 #include <kernel/irq.h>
+#include <asm/smp.h>
 
 /* Global IRQ handler function pointer */
 void (*handle_arch_irq)(void) = NULL;
 
+/* IRQ handler nesting depth per CPU */
+static unsigned int irq_nesting[NR_CPUS];
+
 void set_handle_irq(void (*handler)(void))
 {
     handle_arch_irq = handler;
@@ -11,7 +15,16 @@ void set_handle_irq(void (*handler)(void))
 
 void irq_handler_c(void)
 {
+    unsigned int cpu = smp_processor_id();
+
+    irq_nesting[cpu]++;
     if (handle_arch_irq)
         handle_arch_irq();
+    irq_nesting[cpu]--;
+}
+
+int in_interrupt(void)
+{
+    return irq_nesting[smp_processor_id()] != 0;
 }
 
@@ -0,0 +1,70 @@
+/*
+ * Kernel command line parsing
+ *
+ * parse_early_params() works on a private copy of the command line,
+ * splitting it in place so that handlers get NUL-terminated values.
+ */
+
+#include <types.h>
+#include <serial_core.h>
+#include <kernel/init.h>
+#include <kernel/string.h>
+
+#ifndef CONFIG_CMDLINE
+#define CONFIG_CMDLINE  ""
+#endif
+
+char boot_command_line[COMMAND_LINE_SIZE] = CONFIG_CMDLINE;
+
+/* Provided by the linker script */
+extern const struct early_param __setup_start[];
+extern const struct early_param __setup_end[];
+
+static void do_early_param(char *name, const char *val)
+{
+    const struct early_param *p;
+
+    for (p = __setup_start; p < __setup_end; p++) {
+        if (strcmp(p->name, name))
+            continue;
+        if (p->setup(val)) {
+            uart_poll_puts("Malformed early option '");
+            uart_poll_puts(name);
+            uart_poll_puts("'\n");
+        }
+    }
+}
+
+void parse_early_params(const char *cmdline)
+{
+    static char tmp_cmdline[COMMAND_LINE_SIZE];
+    char *s = tmp_cmdline;
+    size_t len = strlen(cmdline);
+
+    if (len >= COMMAND_LINE_SIZE)
+        len = COMMAND_LINE_SIZE - 1;
+    memcpy(tmp_cmdline, cmdline, len);
+    tmp_cmdline[len] = '\0';
+
+    while (*s) {
+        char *name, *val = NULL;
+
+        while (*s == ' ')
+            s++;
+        if (!*s)
+            break;
+
+        name = s;
+        while (*s && *s != ' ') {
+            if (*s == '=' && !val) {
+                *s = '\0';
+                val = s + 1;
+            }
+            s++;
+        }
+        if (*s)
+            *s++ = '\0';
+
+        do_early_param(name, val ? val : "");
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * Cooperative round-robin scheduler for kernel threads
+ *
+ * All live tasks sit on a single ring linked through run_next, starting
+ * at init_task (the boot flow, which becomes the idle loop). schedule()
+ * walks the ring from the current task and switches to the next runnable
+ * one. Thread structs and stacks come from static pools; a dead thread's
+ * slot is reclaimed by whichever task runs next, once nothing is
+ * executing on its stack any more.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/sched.h>
+#include <kernel/string.h>
+#include <asm/fpsimd.h>
+#include <asm/irqflags.h>
+#include <asm/mmu_context.h>
+
+extern void ret_from_fork(void);
+
+struct task_struct init_task = {
+    .state    = TASK_RUNNING,
+    .pid      = 0,
+    .name     = "idle",
+    .run_next = &init_task,
+};
+
+struct task_struct *current_task[NR_CPUS] = {
+    [0] = &init_task,
+};
+
+static struct task_struct threads[MAX_THREADS];
+static uint8_t thread_stacks[MAX_THREADS][THREAD_SIZE]
+    __attribute__((aligned(16)));
+
+static int next_pid = 1;
+static int nr_runnable;
+
+int nr_running(void)
+{
+    return nr_runnable;
+}
+
+static void unlink_task(struct task_struct *tsk)
+{
+    struct task_struct *p = &init_task;
+
+    while (p->run_next != tsk)
+        p = p->run_next;
+    p->run_next = tsk->run_next;
+}
+
+/*
+ * Called on the new task's stack right after a switch. Reclaims @prev if
+ * it was exiting: only now is nobody running on its stack.
+ */
+static void finish_task_switch(struct task_struct *prev)
+{
+    if (prev->state == TASK_DEAD) {
+        unlink_task(prev);
+        prev->state = TASK_UNUSED;
+    }
+}
+
+/*
+ * First C code run by a new thread (from ret_from_fork). The switch
+ * happened with IRQs masked inside schedule(); new threads start with
+ * them enabled.
+ */
+void schedule_tail(struct task_struct *prev)
+{
+    finish_task_switch(prev);
+    local_irq_enable();
+}
+
+void schedule(void)
+{
+    struct task_struct *prev, *next;
+    unsigned long flags;
+
+    flags = local_irq_save();
+
+    prev = current;
+    next = prev->run_next;
+    while (next != prev && next->state != TASK_RUNNING)
+        next = next->run_next;
+
+    if (next == prev && prev->state == TASK_RUNNING) {
+        local_irq_restore(flags);
+        return;
+    }
+
+    switch_mm(prev->mm, next->mm);
+    fpsimd_thread_switch(next);
+    current_task[smp_processor_id()] = next;
+    prev = cpu_switch_to(prev, next);
+    finish_task_switch(prev);
+
+    local_irq_restore(flags);
+}
+
+void yield_or_wfi(void)
+{
+    /* The idle task is always runnable but not counted */
+    int others = nr_runnable - (current != &init_task);
+
+    if (others > 0)
+        schedule();
+    else
+        __asm__ volatile("wfi" : : : "memory");
+}
+
+struct task_struct *kthread_run(int (*fn)(void *), void *arg, const char *name)
+{
+    struct task_struct *tsk = NULL;
+    unsigned long flags;
+    int i;
+
+    flags = local_irq_save();
+
+    for (i = 0; i < MAX_THREADS; i++) {
+        if (threads[i].state == TASK_UNUSED) {
+            tsk = &threads[i];
+            break;
+        }
+    }
+    if (!tsk) {
+        local_irq_restore(flags);
+        return NULL;
+    }
+
+    memset(tsk, 0, sizeof(*tsk));
+    tsk->pid = next_pid++;
+    tsk->name = name;
+    tsk->stack = thread_stacks[i];
+
+    tsk->thread.cpu_context.x19 = (unsigned long)fn;
+    tsk->thread.cpu_context.x20 = (unsigned long)arg;
+    tsk->thread.cpu_context.pc  = (unsigned long)ret_from_fork;
+    tsk->thread.cpu_context.sp  = (unsigned long)tsk->stack + THREAD_SIZE;
+
+    tsk->state = TASK_RUNNING;
+    tsk->run_next = init_task.run_next;
+    init_task.run_next = tsk;
+    nr_runnable++;
+
+    local_irq_restore(flags);
+    return tsk;
+}
+
+void kthread_exit(void)
+{
+    struct task_struct *tsk = current;
+
+    local_irq_disable();
+    fpsimd_flush_task_state(tsk);
+    tsk->state = TASK_DEAD;
+    nr_runnable--;
+
+    schedule();
+
+    /* A dead task is never picked again */
+    for (;;)
+        __asm__ volatile("wfe");
+}
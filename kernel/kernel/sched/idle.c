@@ -0,0 +1,57 @@
+/*
+ * Idle loop and idle-time accounting
+ *
+ * kernel_main() ends in cpu_idle_loop() as the idle task: it runs the
+ * kernel threads until none is runnable, then sleeps until the next
+ * interrupt, in the idle state cpuidle picks or in plain wfi before a
+ * cpuidle driver has registered. The time spent asleep is added up per
+ * CPU from the generic timer counter; cpufreq turns it into a load
+ * figure.
+ *
+ * The sleep is entered with interrupts masked so a wake-up cannot slip
+ * in between the run-queue check and the sleep. A pending interrupt
+ * still wakes the core, and it is taken once they are unmasked again,
+ * after the sleep has been accounted and the tick restarted.
+ */
+
+#include <types.h>
+#include <kernel/cpufreq.h>
+#include <kernel/cpuidle.h>
+#include <kernel/sched.h>
+#include <asm/arch_timer.h>
+#include <asm/irqflags.h>
+#include <asm/smp.h>
+
+static uint64_t idle_ticks[NR_CPUS];
+
+uint64_t cpu_idle_ticks(unsigned int cpu)
+{
+    return cpu < NR_CPUS ? idle_ticks[cpu] : 0;
+}
+
+static void do_idle(void)
+{
+    unsigned int cpu = smp_processor_id();
+    uint64_t start;
+
+    local_irq_disable();
+    if (!nr_running()) {
+        start = arch_counter_get_cntvct();
+        if (cpuidle_idle_call())
+            __asm__ volatile("wfi" : : : "memory");
+        idle_ticks[cpu] += arch_counter_get_cntvct() - start;
+    }
+    local_irq_enable();
+}
+
+void cpu_idle_loop(void)
+{
+    for (;;) {
+        while (nr_running()) {
+            schedule();
+            cpufreq_update();
+        }
+        cpufreq_update();
+        do_idle();
+    }
+}
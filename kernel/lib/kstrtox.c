@@ -0,0 +1,51 @@
+/*
+ * String to integer conversion for command line arguments
+ */
+
+#include <kernel/kstrtox.h>
+
+static int kstrtox_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    return 36;
+}
+
+int kstrtouint(const char *s, unsigned int base, unsigned int *res)
+{
+    unsigned long long val = 0;
+
+    if (base == 0) {
+        if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+            base = 16;
+            s += 2;
+        } else if (s[0] == '0' && s[1]) {
+            base = 8;
+            s++;
+        } else {
+            base = 10;
+        }
+    } else if (base == 16 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        s += 2;
+    }
+
+    if (!*s)
+        return -1;
+
+    for (; *s; s++) {
+        int digit = kstrtox_digit(*s);
+
+        if (digit >= (int)base)
+            return -1;
+        val = val * base + digit;
+        if (val > 0xFFFFFFFFULL)
+            return -1;
+    }
+
+    *res = (unsigned int)val;
+    return 0;
+}
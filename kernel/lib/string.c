@@ -0,0 +1,161 @@
+/*
+ * Generic C implementations of the string and memory helpers.
+ *
+ * These are deliberately simple: word-sized accesses when both pointers
+ * share alignment, bytes otherwise. An architecture that provides an
+ * optimised version defines __HAVE_ARCH_<NAME> in <asm/string.h> and
+ * the generic one is compiled out. This file is built with
+ * -fno-tree-loop-distribute-patterns so GCC cannot turn the loops below
+ * back into calls to memcpy/memset.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/string.h>
+
+#define WORD_SIZE       sizeof(unsigned long)
+#define WORD_MASK       (WORD_SIZE - 1)
+
+#ifndef __HAVE_ARCH_MEMCPY
+void *memcpy(void *dest, const void *src, size_t n)
+{
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+
+    if ((((uintptr_t)d ^ (uintptr_t)s) & WORD_MASK) == 0) {
+        while (n && ((uintptr_t)d & WORD_MASK)) {
+            *d++ = *s++;
+            n--;
+        }
+        while (n >= WORD_SIZE) {
+            *(unsigned long *)d = *(const unsigned long *)s;
+            d += WORD_SIZE;
+            s += WORD_SIZE;
+            n -= WORD_SIZE;
+        }
+    }
+
+    while (n--)
+        *d++ = *s++;
+
+    return dest;
+}
+#endif
+
+#ifndef __HAVE_ARCH_MEMMOVE
+void *memmove(void *dest, const void *src, size_t n)
+{
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+
+    if (d <= s || d >= s + n)
+        return memcpy(dest, src, n);
+
+    /* Overlapping with dest above src: copy backwards */
+    d += n;
+    s += n;
+    while (n--)
+        *--d = *--s;
+
+    return dest;
+}
+#endif
+
+#ifndef __HAVE_ARCH_MEMSET
+void *memset(void *s, int c, size_t n)
+{
+    unsigned char *p = s;
+    unsigned long word = (unsigned char)c;
+
+    word |= word << 8;
+    word |= word << 16;
+    word |= word << 32;
+
+    while (n && ((uintptr_t)p & WORD_MASK)) {
+        *p++ = (unsigned char)c;
+        n--;
+    }
+    while (n >= WORD_SIZE) {
+        *(unsigned long *)p = word;
+        p += WORD_SIZE;
+        n -= WORD_SIZE;
+    }
+    while (n--)
+        *p++ = (unsigned char)c;
+
+    return s;
+}
+#endif
+
+#ifndef __HAVE_ARCH_MEMCMP
+int memcmp(const void *s1, const void *s2, size_t n)
+{
+    const unsigned char *a = s1;
+    const unsigned char *b = s2;
+
+    for (; n; n--, a++, b++) {
+        if (*a != *b)
+            return *a - *b;
+    }
+    return 0;
+}
+#endif
+
+#ifndef __HAVE_ARCH_STRLEN
+size_t strlen(const char *s)
+{
+    const char *p = s;
+
+    while (*p)
+        p++;
+    return p - s;
+}
+#endif
+
+#ifndef __HAVE_ARCH_STRCMP
+int strcmp(const char *s1, const char *s2)
+{
+    while (*s1 && *s1 == *s2) {
+        s1++;
+        s2++;
+    }
+    return (unsigned char)*s1 - (unsigned char)*s2;
+}
+#endif
+
+#ifndef __HAVE_ARCH_STRNLEN
+size_t strnlen(const char *s, size_t maxlen)
+{
+    const char *p = s;
+
+    while (maxlen-- && *p)
+        p++;
+    return p - s;
+}
+#endif
+
+#ifndef __HAVE_ARCH_STRNCMP
+int strncmp(const char *s1, const char *s2, size_t n)
+{
+    for (; n; n--, s1++, s2++) {
+        if (*s1 != *s2)
+            return (unsigned char)*s1 - (unsigned char)*s2;
+        if (!*s1)
+            break;
+    }
+    return 0;
+}
+#endif
+
+#ifndef __HAVE_ARCH_MEMCHR
+void *memchr(const void *s, int c, size_t n)
+{
+    const unsigned char *p = s;
+
+    for (; n; n--, p++) {
+        if (*p == (unsigned char)c)
+            return (void *)p;
+    }
+    return NULL;
+}
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Physical page allocator
+ *
+ * One bit per page frame (set = in use) covering everything below
+ * RAM_MAX_PA. Frames outside [first_pfn, end_pfn) are never handed out.
+ * Allocations are aligned to their own size; fully used bitmap words
+ * are skipped a word at a time, which keeps order-0 scans short.
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <kernel/mm.h>
+#include <kernel/string.h>
+#include <asm/memory.h>
+
+#define BITS_PER_LONG   64
+#define MAX_PFN         (RAM_MAX_PA >> PAGE_SHIFT)
+
+static unsigned long page_bitmap[MAX_PFN / BITS_PER_LONG];
+static unsigned long first_pfn, end_pfn;
+static unsigned long free_pages_count;
+
+unsigned long memory_end = RAM_END_PA;
+
+static inline int pfn_in_use(unsigned long pfn)
+{
+    return (page_bitmap[pfn / BITS_PER_LONG] >> (pfn % BITS_PER_LONG)) & 1;
+}
+
+static int pfn_range_free(unsigned long pfn, unsigned long n)
+{
+    while (n) {
+        if (pfn % BITS_PER_LONG == 0 && n >= BITS_PER_LONG) {
+            if (page_bitmap[pfn / BITS_PER_LONG])
+                return 0;
+            pfn += BITS_PER_LONG;
+            n -= BITS_PER_LONG;
+        } else {
+            if (pfn_in_use(pfn))
+                return 0;
+            pfn++;
+            n--;
+        }
+    }
+    return 1;
+}
+
+static void pfn_range_set(unsigned long pfn, unsigned long n, int used)
+{
+    while (n) {
+        if (pfn % BITS_PER_LONG == 0 && n >= BITS_PER_LONG) {
+            page_bitmap[pfn / BITS_PER_LONG] = used ? ~0UL : 0;
+            pfn += BITS_PER_LONG;
+            n -= BITS_PER_LONG;
+        } else {
+            if (used)
+                page_bitmap[pfn / BITS_PER_LONG] |= 1UL << (pfn % BITS_PER_LONG);
+            else
+                page_bitmap[pfn / BITS_PER_LONG] &= ~(1UL << (pfn % BITS_PER_LONG));
+            pfn++;
+            n--;
+        }
+    }
+}
+
+void page_alloc_init(unsigned long start, unsigned long end)
+{
+    if (end > RAM_MAX_PA)
+        end = RAM_MAX_PA;
+
+    first_pfn = PAGE_ALIGN(start) >> PAGE_SHIFT;
+    end_pfn = (end & PAGE_MASK) >> PAGE_SHIFT;
+    if (end_pfn < first_pfn)
+        end_pfn = first_pfn;
+
+    memset(page_bitmap, 0, sizeof(page_bitmap));
+    free_pages_count = end_pfn - first_pfn;
+}
+
+void page_alloc_reserve(unsigned long pa, unsigned long size)
+{
+    unsigned long pfn = pa >> PAGE_SHIFT;
+    unsigned long last = PAGE_ALIGN(pa + size) >> PAGE_SHIFT;
+
+    if (pfn < first_pfn)
+        pfn = first_pfn;
+    if (last > end_pfn)
+        last = end_pfn;
+
+    for (; pfn < last; pfn++) {
+        if (!pfn_in_use(pfn)) {
+            pfn_range_set(pfn, 1, 1);
+            free_pages_count--;
+        }
+    }
+}
+
+unsigned long __alloc_pages(unsigned int order)
+{
+    unsigned long n = 1UL << order;
+    unsigned long pfn = (first_pfn + n - 1) & ~(n - 1);
+
+    while (pfn + n <= end_pfn) {
+        /* Small orders: skip words with no free frame in one go */
+        if (n < BITS_PER_LONG && page_bitmap[pfn / BITS_PER_LONG] == ~0UL) {
+            pfn = (pfn | (BITS_PER_LONG - 1)) + 1;
+            continue;
+        }
+        if (pfn_range_free(pfn, n)) {
+            pfn_range_set(pfn, n, 1);
+            free_pages_count -= n;
+            return pfn << PAGE_SHIFT;
+        }
+        pfn += n;
+    }
+
+    return 0;
+}
+
+void __free_pages(unsigned long pa, unsigned int order)
+{
+    unsigned long pfn = pa >> PAGE_SHIFT;
+    unsigned long n = 1UL << order;
+
+    if (pfn < first_pfn || pfn + n > end_pfn)
+        return;
+
+    pfn_range_set(pfn, n, 0);
+    free_pages_count += n;
+}
+
+void *alloc_pages(unsigned int order)
+{
+    unsigned long pa = __alloc_pages(order);
+
+    return pa ? __va(pa) : NULL;
+}
+
+void free_pages(void *addr, unsigned int order)
+{
+    if (addr)
+        __free_pages(__pa(addr), order);
+}
+
+void *get_zeroed_page(void)
+{
+    void *page = alloc_pages(0);
+
+    if (page)
+        memset(page, 0, PAGE_SIZE);
+    return page;
+}
+
+unsigned long nr_free_pages(void)
+{
+    return free_pages_count;
+}
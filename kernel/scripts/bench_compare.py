@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+Compare benchmark kernel results against a stored baseline.
+
+The benchmark kernel prints one line per case on the UART:
+
+    BENCH <name> iters=<n> ns=<total> ns_per_op=<x.xxx> [bytes=<b> mb_per_s=<y> bytes_per_s=<z>]
+
+or, for a case that did not run to the end:
+
+    BENCH-SKIP <name> <why>
+    BENCH-FAIL <name> <why>
+
+Usage:
+    bench_compare.py [--threshold PCT] BASELINE LOG
+    bench_compare.py --update BASELINE LOG
+
+Exits with status 1 if any case failed, got slower than the baseline
+by more than the threshold (default 10%), or is in the baseline but
+missing from the log (a skipped case counts as missing). --update
+rewrites BASELINE from the BENCH lines in LOG.
+"""
+
+import argparse
+import os
+import sys
+
+
+def parse_results(path):
+    results = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            fields = line.strip().split()
+            if len(fields) < 2 or fields[0] != "BENCH":
+                continue
+            values = {}
+            for field in fields[2:]:
+                key, sep, value = field.partition("=")
+                if sep:
+                    values[key] = float(value)
+            if "ns_per_op" in values:
+                results[fields[1]] = (values, line.strip())
+    return results
+
+
+def parse_stopped(path, tag):
+    stopped = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            fields = line.strip().split(None, 2)
+            if len(fields) >= 2 and fields[0] == tag:
+                stopped[fields[1]] = fields[2] if len(fields) > 2 else ""
+    return stopped
+
+
+def update_baseline(baseline, log):
+    results = parse_results(log)
+    if not results:
+        print(f"bench: no BENCH lines in {log}", file=sys.stderr)
+        return 1
+    with open(baseline, "w") as f:
+        for name in sorted(results):
+            f.write(results[name][1] + "\n")
+    print(f"bench: wrote {len(results)} cases to {baseline}")
+    return 0
+
+
+def compare(baseline, log, threshold):
+    current = parse_results(log)
+    failures = parse_stopped(log, "BENCH-FAIL")
+    skips = parse_stopped(log, "BENCH-SKIP")
+    for name, why in sorted(failures.items()):
+        print(f"bench: {name} failed: {why}", file=sys.stderr)
+    for name, why in sorted(skips.items()):
+        print(f"bench: {name} skipped: {why}")
+    if not current:
+        print(f"bench: no BENCH lines in {log}", file=sys.stderr)
+        return 1
+    if not os.path.exists(baseline):
+        print(f"bench: no baseline at {baseline}, run `make bench-baseline` to record one")
+        return 1 if failures else 0
+
+    reference = parse_results(baseline)
+    failed = bool(failures)
+
+    print(f"{'case':<28} {'baseline':>12} {'current':>12} {'delta':>8}")
+    for name in sorted(set(reference) | set(current)):
+        if name not in current:
+            print(f"{name:<28} {'':>12} {'missing':>12}")
+            failed = True
+            continue
+        if name not in reference:
+            print(f"{name:<28} {'new':>12} {current[name][0]['ns_per_op']:>12.3f}")
+            continue
+
+        old = reference[name][0]["ns_per_op"]
+        new = current[name][0]["ns_per_op"]
+        delta = (new - old) / old * 100.0 if old else 0.0
+        mark = ""
+        if delta > threshold:
+            mark = "  REGRESSION"
+            failed = True
+        print(f"{name:<28} {old:>12.3f} {new:>12.3f} {delta:>+7.1f}%{mark}")
+
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("log")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default: 10)")
+    parser.add_argument("--update", action="store_true",
+                        help="rewrite the baseline from the log")
+    args = parser.parse_args()
+
+    if args.update:
+        return update_baseline(args.baseline, args.log)
+    return compare(args.baseline, args.log, args.threshold)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
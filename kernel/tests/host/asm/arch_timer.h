@@ -0,0 +1,24 @@
+#ifndef _HOST_ASM_ARCH_TIMER_H
+#define _HOST_ASM_ARCH_TIMER_H
+
+#include <stdint.h>
+
+/*
+ * Host stand-in for arch/arm64/include/asm/arch_timer.h. The counter
+ * only moves when a test advances host_cntvct, at 1MHz so that ticks
+ * read as microseconds.
+ */
+
+extern uint64_t host_cntvct;
+
+static inline uint64_t arch_counter_get_cntvct(void)
+{
+    return host_cntvct;
+}
+
+static inline uint32_t arch_timer_get_cntfrq(void)
+{
+    return 1000000;
+}
+
+#endif /* _HOST_ASM_ARCH_TIMER_H */
@@ -0,0 +1,16 @@
+#ifndef _HOST_ASM_BARRIER_H
+#define _HOST_ASM_BARRIER_H
+
+/*
+ * Host stand-in for arch/arm64/include/asm/barrier.h, found first on
+ * the host include path. Tests are single-threaded, so a barrier only
+ * has to stop the compiler; wfi() calls host_wfi(), which a test whose
+ * driver sleeps in wfi defines to let its device model make progress.
+ */
+
+void host_wfi(void);
+
+#define dsb(opt)    __asm__ volatile("" : : : "memory")
+#define wfi()       host_wfi()
+
+#endif /* _HOST_ASM_BARRIER_H */
@@ -0,0 +1,10 @@
+#ifndef _HOST_ASM_FB_CONVERT_H
+#define _HOST_ASM_FB_CONVERT_H
+
+/*
+ * Host stand-in for arch/arm64/include/asm/fb_convert.h: no NEON
+ * kernels, so the generic code runs everything through the scalar
+ * versions.
+ */
+
+#endif /* _HOST_ASM_FB_CONVERT_H */
@@ -0,0 +1,49 @@
+#ifndef _HOST_ASM_IO_H
+#define _HOST_ASM_IO_H
+
+/*
+ * Host stand-in for arch/arm64/include/asm/io.h, found first on the
+ * host include path. readl() and writel() go to a register model when
+ * a test has put one at the address, and to plain memory otherwise
+ * (the fake register arrays of mmio_stub.h).
+ */
+
+#include <stddef.h>
+#include <types.h>
+#include <asm/memory.h>
+
+#define IO_ADDRESS(pa)      ((uintptr_t)(pa) + KERNEL_VA_BASE)
+
+struct mmio_model {
+    uintptr_t base;
+    size_t size;
+    uint32_t (*read)(struct mmio_model *m, unsigned int off);
+    void (*write)(struct mmio_model *m, unsigned int off, uint32_t val);
+    struct mmio_model *next;
+};
+
+/* Models stay in place until mmio_model_remove() */
+void mmio_model_add(struct mmio_model *m);
+void mmio_model_remove(struct mmio_model *m);
+struct mmio_model *mmio_model_find(uintptr_t addr);
+
+static inline uint32_t readl(uintptr_t addr)
+{
+    struct mmio_model *m = mmio_model_find(addr);
+
+    if (m)
+        return m->read(m, addr - m->base);
+    return *(volatile uint32_t *)addr;
+}
+
+static inline void writel(uint32_t val, uintptr_t addr)
+{
+    struct mmio_model *m = mmio_model_find(addr);
+
+    if (m)
+        m->write(m, addr - m->base, val);
+    else
+        *(volatile uint32_t *)addr = val;
+}
+
+#endif /* _HOST_ASM_IO_H */
@@ -0,0 +1,40 @@
+#ifndef _HOST_ASM_IRQFLAGS_H
+#define _HOST_ASM_IRQFLAGS_H
+
+/*
+ * Host stand-in for arch/arm64/include/asm/irqflags.h, found first on
+ * the host include path. Tests run single-threaded with no interrupts,
+ * so masking only needs to be tracked.
+ */
+
+extern int host_irqs_disabled;
+
+static inline void local_irq_enable(void)
+{
+    host_irqs_disabled = 0;
+}
+
+static inline void local_irq_disable(void)
+{
+    host_irqs_disabled = 1;
+}
+
+static inline unsigned long local_irq_save(void)
+{
+    unsigned long flags = host_irqs_disabled;
+
+    host_irqs_disabled = 1;
+    return flags;
+}
+
+static inline int irqs_disabled_flags(unsigned long flags)
+{
+    return flags != 0;
+}
+
+static inline void local_irq_restore(unsigned long flags)
+{
+    host_irqs_disabled = flags;
+}
+
+#endif /* _HOST_ASM_IRQFLAGS_H */
@@ -0,0 +1,16 @@
+#ifndef _HOST_ASM_SMP_H
+#define _HOST_ASM_SMP_H
+
+/*
+ * Host stand-in for arch/arm64/include/asm/smp.h: the tests run as
+ * the boot CPU.
+ */
+
+#define NR_CPUS     4
+
+static inline unsigned int smp_processor_id(void)
+{
+    return 0;
+}
+
+#endif /* _HOST_ASM_SMP_H */
@@ -0,0 +1,247 @@
+#include <stddef.h>
+#include <string.h>
+#include <kernel/dmaengine.h>
+#include <kernel/dma-mapping.h>
+#include "dma_stub.h"
+
+#define STUB_CHANS      4
+#define STUB_DESCS      8
+#define STUB_MAPS       8
+#define STUB_POOL_SIZE  (64 * 1024)
+#define STUB_TX_LOG     (64 * 1024)
+
+int host_irqs_disabled;
+
+struct dma_chan {
+    int allocated;
+    dma_cookie_t completed_cookie;
+};
+
+static struct dma_chan stub_chans[STUB_CHANS];
+static struct dma_desc stub_descs[STUB_DESCS];
+static struct dma_desc *stub_queue[STUB_DESCS];
+static unsigned int stub_queued;
+static dma_cookie_t stub_last_cookie;
+
+static unsigned char stub_pool[STUB_POOL_SIZE] __attribute__((aligned(4096)));
+static size_t stub_pool_used;
+
+/* Streaming mappings get bus addresses above the coherent pool */
+static struct {
+    void *cpu_addr;
+    unsigned long phys;
+    size_t size;
+} stub_maps[STUB_MAPS];
+static unsigned long stub_map_next;
+
+unsigned char dma_stub_tx_log[STUB_TX_LOG];
+size_t dma_stub_tx_len;
+
+void dma_stub_reset(void)
+{
+    memset(stub_descs, 0, sizeof(stub_descs));
+    memset(stub_chans, 0, sizeof(stub_chans));
+    memset(stub_maps, 0, sizeof(stub_maps));
+    stub_queued = 0;
+    stub_last_cookie = 0;
+    stub_pool_used = 0;
+    stub_map_next = STUB_POOL_SIZE;
+    dma_stub_tx_len = 0;
+}
+
+void *dma_alloc_coherent(size_t size, dma_addr_t *handle)
+{
+    size = (size + 4095) & ~(size_t)4095;
+    if (stub_pool_used + size > STUB_POOL_SIZE)
+        return NULL;
+
+    *handle = phys_to_dma(stub_pool_used);
+    stub_pool_used += size;
+    return &stub_pool[stub_pool_used - size];
+}
+
+void dma_free_coherent(size_t size, void *cpu_addr, dma_addr_t handle)
+{
+}
+
+dma_addr_t dma_map_single(void *cpu_addr, size_t size,
+                          enum dma_data_direction dir)
+{
+    for (unsigned int i = 0; i < STUB_MAPS; i++) {
+        if (stub_maps[i].cpu_addr)
+            continue;
+        stub_maps[i].cpu_addr = cpu_addr;
+        stub_maps[i].phys = stub_map_next;
+        stub_maps[i].size = size;
+        stub_map_next += (size + 4095) & ~(size_t)4095;
+        return phys_to_dma(stub_maps[i].phys);
+    }
+    return DMA_SG_DISCARD;
+}
+
+void dma_unmap_single(dma_addr_t addr, size_t size,
+                      enum dma_data_direction dir)
+{
+    for (unsigned int i = 0; i < STUB_MAPS; i++) {
+        if (stub_maps[i].cpu_addr &&
+            stub_maps[i].phys == dma_to_phys(addr) &&
+            stub_maps[i].size == size)
+            stub_maps[i].cpu_addr = NULL;
+    }
+}
+
+unsigned int dma_stub_mapped(void)
+{
+    unsigned int n = 0;
+
+    for (unsigned int i = 0; i < STUB_MAPS; i++)
+        n += stub_maps[i].cpu_addr != NULL;
+    return n;
+}
+
+void *dma_stub_bus_to_virt(dma_addr_t addr)
+{
+    unsigned long phys = dma_to_phys(addr);
+
+    if (phys < STUB_POOL_SIZE)
+        return &stub_pool[phys];
+
+    for (unsigned int i = 0; i < STUB_MAPS; i++) {
+        if (stub_maps[i].cpu_addr &&
+            phys - stub_maps[i].phys < stub_maps[i].size)
+            return (uint8_t *)stub_maps[i].cpu_addr + phys - stub_maps[i].phys;
+    }
+    return NULL;
+}
+
+struct dma_chan *dma_request_chan(void)
+{
+    for (unsigned int i = 0; i < STUB_CHANS; i++) {
+        if (!stub_chans[i].allocated) {
+            stub_chans[i].allocated = 1;
+            return &stub_chans[i];
+        }
+    }
+    return NULL;
+}
+
+void dma_release_chan(struct dma_chan *chan)
+{
+    chan->allocated = 0;
+}
+
+struct dma_desc *dma_prep_memcpy(struct dma_chan *chan, dma_addr_t dst,
+                                 dma_addr_t src, size_t len)
+{
+    return NULL;
+}
+
+struct dma_desc *dma_prep_slave_sg(struct dma_chan *chan,
+                                   const struct dma_sg *sg, unsigned int nents,
+                                   enum dma_transfer_direction dir,
+                                   dma_addr_t dev_addr, unsigned int dreq)
+{
+    for (unsigned int i = 0; i < STUB_DESCS; i++) {
+        struct dma_desc *desc = &stub_descs[i];
+
+        if (desc->in_use || nents > DMA_STUB_MAX_SG)
+            continue;
+        desc->in_use = 1;
+        desc->chan = chan;
+        memcpy(desc->sg, sg, nents * sizeof(*sg));
+        desc->nents = nents;
+        desc->dir = dir;
+        desc->dev_addr = dev_addr;
+        desc->dreq = dreq;
+        return desc;
+    }
+    return NULL;
+}
+
+dma_cookie_t dma_submit(struct dma_desc *desc, dma_callback_t callback,
+                        void *param)
+{
+    desc->callback = callback;
+    desc->param = param;
+    desc->cookie = ++stub_last_cookie;
+    stub_queue[stub_queued++] = desc;
+    return desc->cookie;
+}
+
+unsigned int dma_stub_pending(void)
+{
+    return stub_queued;
+}
+
+struct dma_desc *dma_stub_pending_desc(unsigned int idx)
+{
+    return idx < stub_queued ? stub_queue[idx] : NULL;
+}
+
+static void stub_dequeue(unsigned int idx)
+{
+    stub_queued--;
+    memmove(&stub_queue[idx], &stub_queue[idx + 1],
+            (stub_queued - idx) * sizeof(stub_queue[0]));
+}
+
+static void stub_log_tx(const struct dma_desc *desc)
+{
+    for (unsigned int n = 0; n < desc->nents; n++) {
+        const uint32_t *words = dma_stub_bus_to_virt(desc->sg[n].addr);
+
+        for (uint32_t i = 0; i < desc->sg[n].len / 4; i++) {
+            if (dma_stub_tx_len < STUB_TX_LOG)
+                dma_stub_tx_log[dma_stub_tx_len++] = (unsigned char)words[i];
+        }
+    }
+}
+
+int dma_stub_complete(unsigned int idx)
+{
+    struct dma_desc *desc;
+
+    if (idx >= stub_queued)
+        return 0;
+
+    desc = stub_queue[idx];
+    stub_dequeue(idx);
+    desc->chan->completed_cookie = desc->cookie;
+    if (desc->dir == DMA_MEM_TO_DEV)
+        stub_log_tx(desc);
+    if (desc->callback)
+        desc->callback(desc->param, 0);
+    desc->in_use = 0;
+    return 1;
+}
+
+int dma_stub_complete_one(void)
+{
+    return dma_stub_complete(0);
+}
+
+int dma_cookie_complete(struct dma_chan *chan, dma_cookie_t cookie)
+{
+    return (int32_t)(chan->completed_cookie - cookie) >= 0;
+}
+
+int dma_sync_wait(struct dma_chan *chan, dma_cookie_t cookie)
+{
+    while (!dma_cookie_complete(chan, cookie) && dma_stub_complete_one())
+        ;
+    return 0;
+}
+
+void dma_terminate_all(struct dma_chan *chan)
+{
+    unsigned int i = 0;
+
+    while (i < stub_queued) {
+        if (stub_queue[i]->chan == chan) {
+            stub_queue[i]->in_use = 0;
+            stub_dequeue(i);
+        } else {
+            i++;
+        }
+    }
+}
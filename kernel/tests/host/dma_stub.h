@@ -0,0 +1,61 @@
+#ifndef _HOST_DMA_STUB_H
+#define _HOST_DMA_STUB_H
+
+#include <kernel/dmaengine.h>
+#include <kernel/dma-mapping.h>
+
+/*
+ * Fake DMA engine, coherent allocator and streaming mappings for the
+ * host build.
+ *
+ * Descriptors are recorded in submission order across all channels and
+ * only complete when a test calls dma_stub_complete() (or a client
+ * calls dma_sync_wait()), which runs the callback like the channel IRQ
+ * would.
+ */
+
+#define DMA_STUB_MAX_SG     32
+
+struct dma_desc {
+    struct dma_chan *chan;
+    struct dma_sg sg[DMA_STUB_MAX_SG];
+    unsigned int nents;
+    enum dma_transfer_direction dir;
+    dma_addr_t dev_addr;
+    unsigned int dreq;
+    dma_callback_t callback;
+    void *param;
+    dma_cookie_t cookie;
+    int in_use;
+};
+
+void dma_stub_reset(void);
+
+/* Submitted descriptors that have not completed yet, oldest first */
+unsigned int dma_stub_pending(void);
+struct dma_desc *dma_stub_pending_desc(unsigned int idx);
+
+/*
+ * Complete pending descriptor @idx, or the oldest one; both return 0
+ * if there was no such descriptor
+ */
+int dma_stub_complete(unsigned int idx);
+int dma_stub_complete_one(void);
+
+/*
+ * Low bytes of every 32-bit word that completed memory-to-device
+ * transfers wrote, i.e. what a UART data register would have received
+ */
+extern unsigned char dma_stub_tx_log[];
+extern size_t dma_stub_tx_len;
+
+/*
+ * CPU pointer for a bus address handed out by dma_alloc_coherent() or
+ * dma_map_single()
+ */
+void *dma_stub_bus_to_virt(dma_addr_t addr);
+
+/* dma_map_single() calls not yet undone by dma_unmap_single() */
+unsigned int dma_stub_mapped(void);
+
+#endif /* _HOST_DMA_STUB_H */
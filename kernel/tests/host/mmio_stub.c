@@ -0,0 +1,36 @@
+#include <stddef.h>
+#include <asm/io.h>
+#include "mmio_stub.h"
+
+unsigned int pl011_fake_regs[MMIO_STUB_WORDS];
+
+static struct mmio_model *mmio_models;
+
+void mmio_model_add(struct mmio_model *m)
+{
+    m->next = mmio_models;
+    mmio_models = m;
+}
+
+void mmio_model_remove(struct mmio_model *m)
+{
+    struct mmio_model **p;
+
+    for (p = &mmio_models; *p; p = &(*p)->next) {
+        if (*p == m) {
+            *p = m->next;
+            return;
+        }
+    }
+}
+
+struct mmio_model *mmio_model_find(uintptr_t addr)
+{
+    struct mmio_model *m;
+
+    for (m = mmio_models; m; m = m->next) {
+        if (addr - m->base < m->size)
+            return m;
+    }
+    return NULL;
+}
@@ -0,0 +1,18 @@
+#ifndef _HOST_MMIO_STUB_H
+#define _HOST_MMIO_STUB_H
+
+/*
+ * MMIO stubs for the host build.
+ *
+ * Force-included (-include) ahead of every kernel source compiled for
+ * the host. Device base addresses are redirected to plain arrays so
+ * that drivers read and write ordinary memory, and tests can inspect
+ * the "registers" afterwards.
+ */
+
+#define MMIO_STUB_WORDS     (0x1000 / 4)
+
+extern unsigned int pl011_fake_regs[MMIO_STUB_WORDS];
+#define PL011_UART0_BASE    ((unsigned long)pl011_fake_regs)
+
+#endif /* _HOST_MMIO_STUB_H */
@@ -0,0 +1,64 @@
+/*
+ * Host unit test runner
+ *
+ * Runs every TEST() linked into the binary and exits non-zero if any
+ * expectation failed. A test that has not returned after
+ * HOST_TEST_TIMEOUT seconds (a driver waiting on an event that never
+ * comes) fails the whole run.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+
+#define HOST_TEST_TIMEOUT   10
+
+extern const struct host_test *__start_host_tests[];
+extern const struct host_test *__stop_host_tests[];
+
+int host_test_failures;
+
+static const struct host_test *running;
+
+static void host_test_timeout(int sig)
+{
+    static const char msg[] = " (timed out)\n";
+
+    /* Only async-signal-safe calls from here */
+    write(STDOUT_FILENO, "FAIL ", 5);
+    write(STDOUT_FILENO, running->name, strlen(running->name));
+    write(STDOUT_FILENO, msg, sizeof(msg) - 1);
+    _exit(1);
+}
+
+int main(void)
+{
+    const struct host_test **t;
+    int failed = 0, total = 0;
+
+    /* Keep what passed on screen if a test times out */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGALRM, host_test_timeout);
+
+    for (t = __start_host_tests; t < __stop_host_tests; t++) {
+        int before = host_test_failures;
+
+        running = *t;
+        alarm(HOST_TEST_TIMEOUT);
+        (*t)->fn();
+        alarm(0);
+        total++;
+
+        if (host_test_failures != before) {
+            printf("FAIL %s\n", (*t)->name);
+            failed++;
+        } else {
+            printf("ok   %s\n", (*t)->name);
+        }
+    }
+
+    printf("%d/%d tests passed\n", total - failed, total);
+    return failed ? 1 : 0;
+}
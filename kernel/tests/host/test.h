@@ -0,0 +1,52 @@
+#ifndef _HOST_TEST_H
+#define _HOST_TEST_H
+
+/*
+ * Minimal host-side unit test framework.
+ *
+ * Tests are registered with TEST(name) { ... }. Registration stores a
+ * pointer in the "host_tests" section, which the runner walks using the
+ * __start_/__stop_ symbols that GNU ld emits for such sections. This is
+ * the same pattern the kernel uses for BENCH_CASE().
+ *
+ * EXPECT_* macros record a failure and let the test continue.
+ */
+
+#include <stdio.h>
+
+struct host_test {
+    const char *name;
+    void (*fn)(void);
+};
+
+extern int host_test_failures;
+
+#define TEST(_name)                                                      \
+    static void _name(void);                                             \
+    static const struct host_test __host_test_##_name = {                \
+        .name = #_name,                                                  \
+        .fn   = _name,                                                   \
+    };                                                                   \
+    static const struct host_test *__host_test_ptr_##_name               \
+    __attribute__((used, section("host_tests"))) = &__host_test_##_name; \
+    static void _name(void)
+
+#define EXPECT_TRUE(cond) do {                                           \
+    if (!(cond)) {                                                       \
+        fprintf(stderr, "    %s:%d: expected %s\n",                      \
+                __FILE__, __LINE__, #cond);                              \
+        host_test_failures++;                                            \
+    }                                                                    \
+} while (0)
+
+#define EXPECT_EQ(a, b) do {                                             \
+    unsigned long long __a = (unsigned long long)(a);                    \
+    unsigned long long __b = (unsigned long long)(b);                    \
+    if (__a != __b) {                                                    \
+        fprintf(stderr, "    %s:%d: %s == %s (0x%llx != 0x%llx)\n",      \
+                __FILE__, __LINE__, #a, #b, __a, __b);                   \
+        host_test_failures++;                                            \
+    }                                                                    \
+} while (0)
+
+#endif /* _HOST_TEST_H */
@@ -0,0 +1,516 @@
+/*
+ * BCM2837 DMA engine: control block chains, the lite channel length
+ * limit and cookie completion
+ *
+ * Runs in its own binary (see HOST_DMA_TEST_SRC): the other tests link
+ * the DMA clients against dma_stub.c. The channel registers are a model
+ * that runs a chain when the test says the hardware is done, copying
+ * memory-to-memory blocks and recording every control block it read.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <serial_core.h>
+#include <kernel/dmaengine.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <dma/bcm2837_dma.h>
+#include <asm/io.h>
+#include "test.h"
+
+#define DMA_PA              0x3F007000
+#define DMA_REG_ENABLE      0xFF0
+#define NR_CHANS            16
+
+/* ARMCTRL GPU IRQ 16 + n */
+#define DMA_IRQ(n)          (16 + (n) + 32 + ARMCTRL_IRQ_OFFSET)
+
+#define CS_ACTIVE           (1U << 0)
+#define CS_END              (1U << 1)
+#define CS_INT              (1U << 2)
+#define CS_ERROR            (1U << 8)
+#define CS_RESET            (1U << 31)
+
+#define TI_INTEN            (1U << 0)
+#define TI_WAIT_RESP        (1U << 3)
+#define TI_DEST_INC         (1U << 4)
+#define TI_DEST_WIDTH       (1U << 5)
+#define TI_DEST_DREQ        (1U << 6)
+#define TI_DEST_IGNORE      (1U << 7)
+#define TI_SRC_INC          (1U << 8)
+#define TI_SRC_WIDTH        (1U << 9)
+#define TI_SRC_DREQ         (1U << 10)
+#define TI_BURST_LENGTH(x)  ((x) << 12)
+#define TI_PERMAP(x)        ((x) << 16)
+
+#define LITE_MAX_LEN        0xFFF0U
+#define CBS_PER_DESC        32
+
+/* The main runner gets this from dma_stub.c */
+int host_irqs_disabled;
+
+/* No device tree: the driver uses its built-in base and channel mask */
+struct device_node *of_find_compatible_node(struct device_node *from,
+                                            const char *compat)
+{
+    return NULL;
+}
+
+void __iomem *of_iomap(const struct device_node *np, int index)
+{
+    return NULL;
+}
+
+int of_property_read_u32(const struct device_node *np, const char *name,
+                         uint32_t *out)
+{
+    return -1;
+}
+
+void uart_poll_puts(const char *s)
+{
+}
+
+struct cb {
+    uint32_t info;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t length;
+    uint32_t stride;
+    uint32_t next;
+    uint32_t pad[2];
+};
+
+/* Coherent pool: control blocks and test buffers */
+static uint8_t pool[512 * 1024] __attribute__((aligned(4096)));
+static size_t pool_used;
+
+void *dma_alloc_coherent(size_t size, dma_addr_t *handle)
+{
+    size = (size + 4095) & ~(size_t)4095;
+    if (pool_used + size > sizeof(pool))
+        return NULL;
+
+    *handle = phys_to_dma(pool_used);
+    pool_used += size;
+    return &pool[pool_used - size];
+}
+
+void dma_free_coherent(size_t size, void *cpu_addr, dma_addr_t handle)
+{
+}
+
+static void *bus_to_virt(dma_addr_t addr)
+{
+    return &pool[dma_to_phys(addr)];
+}
+
+/* Register model */
+static struct {
+    uint32_t cs;
+    uint32_t conblk;
+    uint32_t debug;
+    unsigned int starts;
+} chans[NR_CHANS];
+static uint32_t enable;
+static int last_reset = -1;
+
+/* Control blocks read by the last model_run() */
+static struct cb seen[2 * CBS_PER_DESC];
+static unsigned int nr_seen;
+
+static uint32_t dma_model_read(struct mmio_model *m, unsigned int off)
+{
+    if (off == DMA_REG_ENABLE)
+        return enable;
+
+    switch (off & 0xFF) {
+    case 0x00:
+        return chans[off >> 8].cs;
+    case 0x04:
+        return chans[off >> 8].conblk;
+    case 0x20:
+        return chans[off >> 8].debug;
+    }
+    return 0;
+}
+
+static void dma_model_write(struct mmio_model *m, unsigned int off,
+                            uint32_t val)
+{
+    unsigned int n = off >> 8;
+
+    if (off == DMA_REG_ENABLE) {
+        enable = val;
+        return;
+    }
+
+    switch (off & 0xFF) {
+    case 0x00:
+        if (val & CS_RESET) {
+            chans[n].cs = 0;
+            last_reset = n;
+            break;
+        }
+        chans[n].cs &= ~(val & (CS_INT | CS_END));
+        if (val & CS_ACTIVE) {
+            chans[n].cs |= CS_ACTIVE;
+            chans[n].starts++;
+        }
+        break;
+    case 0x04:
+        chans[n].conblk = val;
+        break;
+    case 0x20:
+        chans[n].debug &= ~val;
+        break;
+    }
+}
+
+static struct mmio_model dma_model = {
+    .base = IO_ADDRESS(DMA_PA),
+    .size = 0x1000,
+    .read = dma_model_read,
+    .write = dma_model_write,
+};
+
+/* The channel works through its chain and stops */
+static void model_run(unsigned int n)
+{
+    dma_addr_t addr = chans[n].conblk;
+    struct cb *cb = NULL;
+
+    nr_seen = 0;
+    while (addr && nr_seen < 2 * CBS_PER_DESC) {
+        cb = bus_to_virt(addr);
+        seen[nr_seen++] = *cb;
+        if (!(cb->info & (TI_SRC_DREQ | TI_DEST_DREQ)))
+            memcpy(bus_to_virt(cb->dst), bus_to_virt(cb->src), cb->length);
+        addr = cb->next;
+    }
+
+    chans[n].cs = (chans[n].cs & ~CS_ACTIVE) | CS_END;
+    if (cb && (cb->info & TI_INTEN))
+        chans[n].cs |= CS_INT;
+}
+
+static void model_fail(unsigned int n)
+{
+    chans[n].cs = (chans[n].cs & ~CS_ACTIVE) | CS_ERROR;
+}
+
+static void channel_irq(unsigned int n)
+{
+    generic_handle_irq(DMA_IRQ(n));
+}
+
+/* Completion callbacks, in order */
+static int done_log[8];
+static int done_error[8];
+static unsigned int nr_done;
+
+static void done(void *param, int error)
+{
+    if (nr_done < 8) {
+        done_log[nr_done] = *(int *)param;
+        done_error[nr_done] = error;
+    }
+    nr_done++;
+}
+
+static void setup(void)
+{
+    unsigned int i;
+
+    memset(chans, 0, sizeof(chans));
+    enable = 0;
+    last_reset = -1;
+    pool_used = 0;
+    nr_done = 0;
+
+    mmio_model_remove(&dma_model);
+    mmio_model_add(&dma_model);
+
+    irq_init();
+    EXPECT_EQ(bcm2837_dma_init(), 0);
+    for (i = 0; i < NR_CHANS; i++)
+        irq_set_chip_and_handler(DMA_IRQ(i), NULL, handle_simple_irq);
+}
+
+/* Take a channel; @id is the one it turned out to be */
+static struct dma_chan *request_chan(int *id)
+{
+    struct dma_chan *chan = dma_request_chan();
+
+    *id = last_reset;
+    return chan;
+}
+
+static void *alloc_buf(size_t size, dma_addr_t *bus, int seed)
+{
+    uint8_t *buf = dma_alloc_coherent(size, bus);
+
+    for (size_t i = 0; i < size; i++)
+        buf[i] = seed + i * 7;
+    return buf;
+}
+
+TEST(dma_memcpy_runs_one_control_block_chain)
+{
+    struct dma_chan *chan;
+    struct dma_desc *desc;
+    dma_addr_t src_bus, dst_bus;
+    uint8_t *src, *dst;
+    dma_cookie_t cookie;
+    int id, tag = 1;
+
+    setup();
+    /* Channels 0, 2 and 4-10 are ours */
+    EXPECT_EQ(enable, 0x07F5);
+
+    chan = request_chan(&id);
+    EXPECT_TRUE(chan != NULL);
+    EXPECT_EQ(id, 0);
+
+    src = alloc_buf(4096, &src_bus, 1);
+    dst = alloc_buf(4096, &dst_bus, 0);
+
+    desc = dma_prep_memcpy(chan, dst_bus, src_bus, 4096);
+    EXPECT_TRUE(desc != NULL);
+    cookie = dma_submit(desc, done, &tag);
+    EXPECT_TRUE(chans[0].cs & CS_ACTIVE);
+    EXPECT_TRUE(!dma_cookie_complete(chan, cookie));
+
+    model_run(0);
+    EXPECT_EQ(nr_seen, 1);
+    /* 16-byte aligned: 128-bit accesses in bursts */
+    EXPECT_EQ(seen[0].info, TI_SRC_INC | TI_DEST_INC | TI_WAIT_RESP |
+                            TI_SRC_WIDTH | TI_DEST_WIDTH |
+                            TI_BURST_LENGTH(4) | TI_INTEN);
+    EXPECT_EQ(seen[0].src, src_bus);
+    EXPECT_EQ(seen[0].dst, dst_bus);
+    EXPECT_EQ(seen[0].length, 4096);
+    EXPECT_EQ(seen[0].next, 0);
+
+    channel_irq(0);
+    EXPECT_EQ(nr_done, 1);
+    EXPECT_EQ(done_error[0], 0);
+    EXPECT_TRUE(dma_cookie_complete(chan, cookie));
+    EXPECT_EQ(chans[0].cs & (CS_INT | CS_END), 0);
+    EXPECT_EQ(memcmp(src, dst, 4096), 0);
+
+    /* Unaligned: byte-wide accesses */
+    desc = dma_prep_memcpy(chan, dst_bus + 1, src_bus, 100);
+    cookie = dma_submit(desc, NULL, NULL);
+    model_run(0);
+    EXPECT_EQ(seen[0].info, TI_SRC_INC | TI_DEST_INC | TI_WAIT_RESP |
+                            TI_INTEN);
+    EXPECT_EQ(dma_sync_wait(chan, cookie), 0);
+    EXPECT_EQ(memcmp(src, dst + 1, 100), 0);
+
+    dma_release_chan(chan);
+}
+
+TEST(dma_lite_channel_splits_at_0xfff0)
+{
+    struct dma_chan *chans_taken[6], *full, *lite;
+    size_t len = 2 * LITE_MAX_LEN + 0x20;
+    dma_addr_t src_bus, dst_bus;
+    struct dma_desc *desc;
+    uint8_t *src, *dst;
+    dma_cookie_t cookie;
+    unsigned int i;
+    int id = -1;
+
+    setup();
+    /* 0, 2, 4, 5 and 6 are full channels, 7 the first lite one */
+    for (i = 0; i < 6; i++)
+        chans_taken[i] = request_chan(&id);
+    EXPECT_EQ(id, 7);
+    full = chans_taken[0];
+    lite = chans_taken[5];
+
+    src = alloc_buf(len, &src_bus, 3);
+    dst = alloc_buf(len, &dst_bus, 0);
+
+    desc = dma_prep_memcpy(lite, dst_bus, src_bus, len);
+    EXPECT_TRUE(desc != NULL);
+    cookie = dma_submit(desc, NULL, NULL);
+    model_run(7);
+
+    EXPECT_EQ(nr_seen, 3);
+    EXPECT_EQ(seen[0].length, LITE_MAX_LEN);
+    EXPECT_EQ(seen[1].length, LITE_MAX_LEN);
+    EXPECT_EQ(seen[2].length, 0x20);
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(seen[i].src, src_bus + i * LITE_MAX_LEN);
+        EXPECT_EQ(seen[i].dst, dst_bus + i * LITE_MAX_LEN);
+        /* Interrupt at the end of the chain only */
+        EXPECT_EQ(seen[i].info & TI_INTEN, i == 2);
+    }
+    /* Linked through consecutive blocks of the descriptor's slot */
+    EXPECT_EQ(seen[0].next, chans[7].conblk + sizeof(struct cb));
+    EXPECT_EQ(seen[1].next, chans[7].conblk + 2 * sizeof(struct cb));
+    EXPECT_EQ(seen[2].next, 0);
+
+    EXPECT_EQ(dma_sync_wait(lite, cookie), 0);
+    EXPECT_EQ(memcmp(src, dst, len), 0);
+
+    /* More than a descriptor's blocks can cover */
+    EXPECT_TRUE(dma_prep_memcpy(lite, dst_bus, src_bus,
+                                CBS_PER_DESC * LITE_MAX_LEN + 1) == NULL);
+
+    /* A full channel takes it in one block */
+    cookie = dma_submit(dma_prep_memcpy(full, dst_bus, src_bus, len),
+                        NULL, NULL);
+    model_run(0);
+    EXPECT_EQ(nr_seen, 1);
+    EXPECT_EQ(seen[0].length, len);
+    EXPECT_EQ(dma_sync_wait(full, cookie), 0);
+
+    for (i = 0; i < 6; i++)
+        dma_release_chan(chans_taken[i]);
+}
+
+TEST(dma_slave_sg_paces_on_dreq)
+{
+    dma_addr_t fifo = periph_to_dma(0x3F204004), buf_bus;
+    struct dma_sg sg[2];
+    struct dma_chan *chan;
+    struct dma_desc *desc;
+    dma_cookie_t cookie;
+    unsigned int i;
+    int id;
+
+    setup();
+    chan = request_chan(&id);
+    alloc_buf(256, &buf_bus, 0);
+
+    /* Into memory, then thrown away */
+    sg[0] = (struct dma_sg){ buf_bus, 64 };
+    sg[1] = (struct dma_sg){ DMA_SG_DISCARD, 32 };
+    desc = dma_prep_slave_sg(chan, sg, 2, DMA_DEV_TO_MEM, fifo,
+                             BCM2837_DREQ_SPI_RX);
+    cookie = dma_submit(desc, NULL, NULL);
+    model_run(id);
+    EXPECT_EQ(dma_sync_wait(chan, cookie), 0);
+
+    EXPECT_EQ(nr_seen, 2);
+    EXPECT_EQ(seen[0].info, TI_WAIT_RESP | TI_PERMAP(BCM2837_DREQ_SPI_RX) |
+                            TI_DEST_INC | TI_SRC_DREQ);
+    EXPECT_EQ(seen[0].src, fifo);
+    EXPECT_EQ(seen[0].dst, buf_bus);
+    EXPECT_EQ(seen[1].info, TI_WAIT_RESP | TI_PERMAP(BCM2837_DREQ_SPI_RX) |
+                            TI_DEST_IGNORE | TI_SRC_DREQ | TI_INTEN);
+    EXPECT_EQ(seen[1].length, 32);
+
+    /* Out to the device */
+    desc = dma_prep_slave_sg(chan, sg, 1, DMA_MEM_TO_DEV, fifo,
+                             BCM2837_DREQ_SPI_TX);
+    cookie = dma_submit(desc, NULL, NULL);
+    model_run(id);
+    EXPECT_EQ(dma_sync_wait(chan, cookie), 0);
+    EXPECT_EQ(nr_seen, 1);
+    EXPECT_EQ(seen[0].info, TI_WAIT_RESP | TI_PERMAP(BCM2837_DREQ_SPI_TX) |
+                            TI_SRC_INC | TI_DEST_DREQ | TI_INTEN);
+    EXPECT_EQ(seen[0].src, buf_bus);
+    EXPECT_EQ(seen[0].dst, fifo);
+
+    /* Rejected lists give their descriptor back */
+    sg[1].len = 0;
+    EXPECT_TRUE(dma_prep_slave_sg(chan, sg, 2, DMA_MEM_TO_DEV, fifo, 0) == NULL);
+    EXPECT_TRUE(dma_prep_slave_sg(chan, sg, 1, DMA_MEM_TO_MEM, fifo, 0) == NULL);
+    EXPECT_TRUE(dma_prep_slave_sg(chan, sg, CBS_PER_DESC + 1, DMA_MEM_TO_DEV,
+                                  fifo, 0) == NULL);
+    for (i = 0; i < 4; i++)
+        EXPECT_TRUE(dma_prep_slave_sg(chan, sg, 1, DMA_MEM_TO_DEV,
+                                      fifo, 0) != NULL);
+    EXPECT_TRUE(dma_prep_slave_sg(chan, sg, 1, DMA_MEM_TO_DEV, fifo, 0) == NULL);
+
+    dma_terminate_all(chan);
+    dma_release_chan(chan);
+}
+
+TEST(dma_cookies_complete_in_submission_order)
+{
+    dma_addr_t src_bus, dst_bus;
+    dma_cookie_t c1, c2, c3;
+    struct dma_chan *chan;
+    uint32_t first_cb;
+    int id, tags[3] = { 1, 2, 3 };
+
+    setup();
+    chan = request_chan(&id);
+    alloc_buf(256, &src_bus, 5);
+    alloc_buf(256, &dst_bus, 0);
+
+    c1 = dma_submit(dma_prep_memcpy(chan, dst_bus, src_bus, 64), done, &tags[0]);
+    c2 = dma_submit(dma_prep_memcpy(chan, dst_bus, src_bus, 128), done, &tags[1]);
+    EXPECT_TRUE(c2 - c1 > 0);
+
+    /* Only the first one runs until it completes */
+    EXPECT_EQ(chans[id].starts, 1);
+    first_cb = chans[id].conblk;
+
+    model_run(id);
+    EXPECT_EQ(seen[0].length, 64);
+    channel_irq(id);
+    EXPECT_EQ(nr_done, 1);
+    EXPECT_EQ(done_log[0], 1);
+    EXPECT_TRUE(dma_cookie_complete(chan, c1));
+    EXPECT_TRUE(!dma_cookie_complete(chan, c2));
+
+    /* The completion started the next one */
+    EXPECT_EQ(chans[id].starts, 2);
+    EXPECT_TRUE(chans[id].conblk != first_cb);
+
+    /* A bus error completes it with an error and resets the channel */
+    model_fail(id);
+    channel_irq(id);
+    EXPECT_EQ(nr_done, 2);
+    EXPECT_EQ(done_log[1], 2);
+    EXPECT_EQ(done_error[1], -1);
+    EXPECT_TRUE(dma_cookie_complete(chan, c2));
+
+    /* dma_sync_wait() reports an error during the wait */
+    c3 = dma_submit(dma_prep_memcpy(chan, dst_bus, src_bus, 64), done, &tags[2]);
+    model_fail(id);
+    EXPECT_EQ(dma_sync_wait(chan, c3), -1);
+    EXPECT_EQ(nr_done, 3);
+
+    /* Nothing running: a stray interrupt is not ours */
+    channel_irq(id);
+    EXPECT_EQ(nr_done, 3);
+
+    dma_release_chan(chan);
+}
+
+TEST(dma_terminate_all_drops_the_queue)
+{
+    dma_addr_t src_bus, dst_bus;
+    struct dma_chan *chan;
+    dma_cookie_t c1, c2;
+    unsigned int i;
+    int id, tag = 1;
+
+    setup();
+    chan = request_chan(&id);
+    alloc_buf(256, &src_bus, 5);
+    alloc_buf(256, &dst_bus, 0);
+
+    c1 = dma_submit(dma_prep_memcpy(chan, dst_bus, src_bus, 64), done, &tag);
+    c2 = dma_submit(dma_prep_memcpy(chan, dst_bus, src_bus, 64), done, &tag);
+    dma_terminate_all(chan);
+
+    EXPECT_TRUE(dma_cookie_complete(chan, c1));
+    EXPECT_TRUE(dma_cookie_complete(chan, c2));
+    EXPECT_EQ(nr_done, 0);
+    EXPECT_EQ(chans[id].cs & CS_ACTIVE, 0);
+
+    /* Every descriptor is free again */
+    for (i = 0; i < 4; i++)
+        EXPECT_TRUE(dma_prep_memcpy(chan, dst_bus, src_bus, 64) != NULL);
+
+    dma_terminate_all(chan);
+    dma_release_chan(chan);
+}
@@ -0,0 +1,587 @@
+/*
+ * BCM2837 BSC1: messages, repeated starts, aborts and the transaction
+ * queue
+ *
+ * Runs in its own binary (see HOST_I2C_TEST_SRC): test_bcm2837_spi.c
+ * owns yield_or_wfi() in the main runner. The controller registers are
+ * a model with one slave on the bus, a bank of 256 byte registers that
+ * a write points into with its first byte. The bus moves one byte at a
+ * time, while a waiter sleeps or each time a masked waiter polls S; a
+ * C.ST written during a transfer is taken as a repeated start once it
+ * ends, with the A, DLEN and direction the new write gave.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <serial_core.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <kernel/sched.h>
+#include <gpio/bcm2837_gpio.h>
+#include <i2c/bcm2837_i2c.h>
+#include <i2c/i2c.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+#include "test.h"
+
+#define BSC_C               0x00
+#define BSC_S               0x04
+#define BSC_DLEN            0x08
+#define BSC_A               0x0C
+#define BSC_FIFO            0x10
+#define BSC_DIV             0x14
+#define BSC_DEL             0x18
+#define BSC_CLKT            0x1C
+
+#define C_READ              (1U << 0)
+#define C_CLEAR             (3U << 4)
+#define C_ST                (1U << 7)
+#define C_INTD              (1U << 8)
+#define C_INTT              (1U << 9)
+#define C_INTR              (1U << 10)
+#define C_I2CEN             (1U << 15)
+
+#define S_TA                (1U << 0)
+#define S_DONE              (1U << 1)
+#define S_TXW               (1U << 2)
+#define S_RXR               (1U << 3)
+#define S_TXD               (1U << 4)
+#define S_RXD               (1U << 5)
+#define S_ERR               (1U << 8)
+#define S_CLKT              (1U << 9)
+
+#define FIFO_SIZE           16
+#define I2C_IRQ             (53 + 32 + ARMCTRL_IRQ_OFFSET)
+
+#define SLAVE_ADDR          0x38
+#define MAX_STARTS          16
+
+struct bsc_xfer {
+    uint16_t addr;
+    int read;
+    unsigned int len;
+};
+
+static struct {
+    uint32_t c, dlen, a, div, del, clkt;
+    uint32_t s;                 /* DONE, ERR and CLKT, until cleared */
+    uint8_t fifo[FIFO_SIZE];
+    unsigned int fifo_head, fifo_count;
+
+    /* The transfer on the bus */
+    int active;
+    int addressed;
+    struct bsc_xfer xfer;
+    unsigned int count;
+    /* C.ST written while it ran */
+    int restart;
+    struct bsc_xfer next;
+
+    /* Faults: no acknowledge, clock stretched too long, DONE early */
+    int nack;
+    int stretch;
+    unsigned int stop_after;
+
+    int in_irq;
+    unsigned int polls, irqs, yields;
+    unsigned int nr_stops, nr_restarts;
+    struct bsc_xfer starts[MAX_STARTS];
+    unsigned int nr_starts;
+} bsc;
+
+static struct {
+    uint8_t regs[256];
+    uint8_t ptr;
+    int ptr_set;
+} slave;
+
+/* The main runner gets this from dma_stub.c */
+int host_irqs_disabled;
+
+/* No device tree, no mailbox: the driver uses its defaults */
+struct device_node *of_find_compatible_node(struct device_node *from,
+                                            const char *compat)
+{
+    return NULL;
+}
+
+int of_device_is_available(const struct device_node *np)
+{
+    return 0;
+}
+
+int of_address_to_phys(const struct device_node *np, int index,
+                       unsigned long *pa, unsigned long *size)
+{
+    return -1;
+}
+
+int of_property_read_u32(const struct device_node *np, const char *name,
+                         uint32_t *out)
+{
+    return -1;
+}
+
+int mbox_get_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    return -1;
+}
+
+void bcm2837_gpio_set_function(unsigned int gpio, unsigned int fsel)
+{
+}
+
+void uart_poll_puts(const char *s)
+{
+}
+
+void uart_poll_put_dec(uint64_t val)
+{
+}
+
+static void bsc_start(const struct bsc_xfer *x)
+{
+    bsc.active = 1;
+    bsc.addressed = 0;
+    bsc.xfer = *x;
+    bsc.count = 0;
+    slave.ptr_set = 0;
+    if (bsc.nr_starts < MAX_STARTS)
+        bsc.starts[bsc.nr_starts++] = *x;
+}
+
+static void bsc_stop(uint32_t why)
+{
+    bsc.active = 0;
+    bsc.restart = 0;
+    bsc.s |= S_DONE | why;
+    bsc.nr_stops++;
+}
+
+/* One byte time on the bus; returns 0 if nothing could move */
+static int bsc_step(void)
+{
+    if (!bsc.active)
+        return 0;
+
+    if (!bsc.addressed) {
+        bsc.addressed = 1;
+        if (bsc.xfer.addr != SLAVE_ADDR || bsc.nack)
+            bsc_stop(S_ERR);
+        else if (bsc.stretch)
+            bsc_stop(S_CLKT);
+        return 1;
+    }
+
+    if (bsc.stop_after && bsc.count == bsc.stop_after) {
+        bsc_stop(0);
+        return 1;
+    }
+
+    if (bsc.xfer.read) {
+        if (bsc.fifo_count == FIFO_SIZE)
+            return 0;
+        bsc.fifo[(bsc.fifo_head + bsc.fifo_count++) % FIFO_SIZE] =
+            slave.regs[slave.ptr++];
+    } else {
+        uint8_t b;
+
+        if (!bsc.fifo_count)
+            return 0;
+        b = bsc.fifo[bsc.fifo_head];
+        bsc.fifo_head = (bsc.fifo_head + 1) % FIFO_SIZE;
+        bsc.fifo_count--;
+        if (slave.ptr_set) {
+            slave.regs[slave.ptr++] = b;
+        } else {
+            slave.ptr = b;
+            slave.ptr_set = 1;
+        }
+    }
+
+    if (++bsc.count == bsc.xfer.len) {
+        if (bsc.restart) {
+            bsc.restart = 0;
+            bsc.nr_restarts++;
+            bsc_start(&bsc.next);
+        } else {
+            bsc_stop(0);
+        }
+    }
+    return 1;
+}
+
+static uint32_t bsc_status(void)
+{
+    uint32_t s = bsc.s;
+
+    if (bsc.active) {
+        s |= S_TA;
+        /* Not once the FIFO holds the rest of the transfer */
+        if (!bsc.xfer.read && bsc.fifo_count < FIFO_SIZE / 4 &&
+            bsc.fifo_count < bsc.xfer.len - bsc.count)
+            s |= S_TXW;
+        if (bsc.xfer.read && bsc.fifo_count >= FIFO_SIZE * 3 / 4)
+            s |= S_RXR;
+    }
+    if (bsc.fifo_count < FIFO_SIZE)
+        s |= S_TXD;
+    if (bsc.fifo_count)
+        s |= S_RXD;
+    return s;
+}
+
+static uint32_t bsc_model_read(struct mmio_model *m, unsigned int off)
+{
+    uint32_t val;
+
+    switch (off) {
+    case BSC_C:
+        return bsc.c;
+    case BSC_S:
+        /* Time passes while a waiter polls */
+        if (!bsc.in_irq) {
+            bsc.polls++;
+            bsc_step();
+        }
+        return bsc_status();
+    case BSC_DLEN:
+        return bsc.dlen;
+    case BSC_A:
+        return bsc.a;
+    case BSC_FIFO:
+        if (!bsc.fifo_count)
+            return 0;
+        val = bsc.fifo[bsc.fifo_head];
+        bsc.fifo_head = (bsc.fifo_head + 1) % FIFO_SIZE;
+        bsc.fifo_count--;
+        return val;
+    case BSC_DIV:
+        return bsc.div;
+    case BSC_DEL:
+        return bsc.del;
+    case BSC_CLKT:
+        return bsc.clkt;
+    }
+    return 0;
+}
+
+static void bsc_model_write(struct mmio_model *m, unsigned int off,
+                            uint32_t val)
+{
+    struct bsc_xfer x;
+
+    switch (off) {
+    case BSC_C:
+        if (val & C_CLEAR)
+            bsc.fifo_head = bsc.fifo_count = 0;
+        bsc.c = val & ~(C_CLEAR | C_ST);
+        if (!(val & C_I2CEN)) {
+            bsc.active = 0;
+            bsc.restart = 0;
+        }
+        if (!(val & C_ST))
+            break;
+        x = (struct bsc_xfer){ bsc.a, !!(val & C_READ), bsc.dlen };
+        if (bsc.active) {
+            EXPECT_TRUE(!bsc.restart);
+            bsc.restart = 1;
+            bsc.next = x;
+        } else {
+            bsc_start(&x);
+        }
+        break;
+    case BSC_S:
+        bsc.s &= ~(val & (S_DONE | S_ERR | S_CLKT));
+        break;
+    case BSC_DLEN:
+        bsc.dlen = val & 0xFFFF;
+        break;
+    case BSC_A:
+        bsc.a = val & 0x7F;
+        break;
+    case BSC_FIFO:
+        if (bsc.fifo_count < FIFO_SIZE)
+            bsc.fifo[(bsc.fifo_head + bsc.fifo_count++) % FIFO_SIZE] = val;
+        break;
+    case BSC_DIV:
+        bsc.div = val;
+        break;
+    case BSC_DEL:
+        bsc.del = val;
+        break;
+    case BSC_CLKT:
+        bsc.clkt = val;
+        break;
+    }
+}
+
+static struct mmio_model bsc_model = {
+    .base = IO_ADDRESS(BCM2837_I2C1_PA),
+    .size = 0x20,
+    .read = bsc_model_read,
+    .write = bsc_model_write,
+};
+
+static int bsc_irq_line(void)
+{
+    uint32_t s = bsc_status();
+
+    return ((bsc.c & C_INTD) && (s & S_DONE)) ||
+           ((bsc.c & C_INTT) && (s & S_TXW)) ||
+           ((bsc.c & C_INTR) && (s & S_RXR));
+}
+
+static void bsc_irq(void)
+{
+    bsc.irqs++;
+    bsc.in_irq = 1;
+    generic_handle_irq(I2C_IRQ);
+    bsc.in_irq = 0;
+}
+
+/* Take interrupts until the bus goes quiet */
+static void run_bus(void)
+{
+    for (unsigned int n = 0; n < 100000; n++) {
+        if (bsc_irq_line())
+            bsc_irq();
+        else if (!bsc_step())
+            return;
+    }
+    EXPECT_TRUE(!"the bus never went quiet");
+}
+
+/* i2c_sync() sleeps here; the wakeup is the next interrupt */
+void yield_or_wfi(void)
+{
+    bsc.yields++;
+    while (!bsc_irq_line()) {
+        if (!bsc_step()) {
+            /* Nothing will ever wake it: fail rather than hang */
+            fprintf(stderr, "    i2c_sync() is waiting on an idle bus\n");
+            abort();
+        }
+    }
+    bsc_irq();
+}
+
+static void setup(void)
+{
+    memset(&bsc, 0, sizeof(bsc));
+    for (unsigned int i = 0; i < sizeof(slave.regs); i++)
+        slave.regs[i] = 0xA0 + i;
+    slave.ptr = 0;
+    slave.ptr_set = 0;
+
+    mmio_model_remove(&bsc_model);
+    mmio_model_add(&bsc_model);
+    local_irq_enable();
+
+    irq_init();
+    EXPECT_EQ(bcm2837_i2c_init(), 0);
+    irq_set_chip_and_handler(I2C_IRQ, NULL, handle_simple_irq);
+}
+
+TEST(i2c_init_programs_the_default_clock)
+{
+    setup();
+
+    /* 250 MHz core clock / 100 kHz, and 35 ms of stretching */
+    EXPECT_EQ(bsc.div, 2500);
+    EXPECT_EQ(bsc.clkt, 3500);
+    EXPECT_EQ(bsc.c & C_I2CEN, 0);
+}
+
+TEST(i2c_write_read_uses_a_repeated_start)
+{
+    uint8_t reg = 0x10;
+    uint8_t buf[20];
+
+    setup();
+    memset(buf, 0, sizeof(buf));
+
+    EXPECT_EQ(i2c_write_read(SLAVE_ADDR, &reg, 1, buf, sizeof(buf)), 0);
+
+    /* One start, one repeated start into the read, one stop */
+    EXPECT_EQ(bsc.nr_starts, 2);
+    EXPECT_EQ(bsc.nr_restarts, 1);
+    EXPECT_EQ(bsc.nr_stops, 1);
+    EXPECT_EQ(bsc.starts[0].read, 0);
+    EXPECT_EQ(bsc.starts[0].len, 1);
+    EXPECT_EQ(bsc.starts[1].read, 1);
+    EXPECT_EQ(bsc.starts[1].len, sizeof(buf));
+    for (unsigned int i = 0; i < sizeof(buf); i++)
+        EXPECT_EQ(buf[i], 0xA0 + 0x10 + i);
+
+    /* Driven by interrupts: S was never polled outside the handler */
+    EXPECT_TRUE(bsc.yields > 0);
+    EXPECT_EQ(bsc.polls, 0);
+    EXPECT_EQ(bsc.c & C_I2CEN, 0);
+}
+
+TEST(i2c_write_refills_the_fifo)
+{
+    uint8_t data[40];
+    struct i2c_msg msg = { .addr = SLAVE_ADDR, .len = sizeof(data),
+                           .buf = data };
+    struct i2c_transaction t = { .msgs = &msg, .nr_msgs = 1 };
+
+    setup();
+    data[0] = 0x20;
+    for (unsigned int i = 1; i < sizeof(data); i++)
+        data[i] = i;
+
+    EXPECT_EQ(i2c_sync(&t), 0);
+    EXPECT_EQ(bsc.nr_starts, 1);
+    EXPECT_EQ(memcmp(&slave.regs[0x20], &data[1], sizeof(data) - 1), 0);
+    /* More than a FIFO's worth takes several TXW interrupts */
+    EXPECT_TRUE(bsc.irqs > 2);
+}
+
+TEST(i2c_done_early_fails_the_transaction)
+{
+    uint8_t buf[8];
+    struct i2c_msg msg = { .addr = SLAVE_ADDR, .flags = I2C_M_RD,
+                           .len = sizeof(buf), .buf = buf };
+    struct i2c_transaction t = { .msgs = &msg, .nr_msgs = 1 };
+
+    setup();
+    bsc.stop_after = 5;
+
+    EXPECT_EQ(i2c_sync(&t), -1);
+    EXPECT_EQ(buf[4], 0xA4);
+    EXPECT_EQ(bsc.s, 0);
+}
+
+TEST(i2c_nack_aborts_and_the_queue_goes_on)
+{
+    uint8_t reg = 0, a[2], b[2];
+    struct i2c_msg ma[2] = {
+        { .addr = 0x50, .len = 1, .buf = &reg },
+        { .addr = 0x50, .flags = I2C_M_RD, .len = 2, .buf = a },
+    };
+    struct i2c_msg mb[2] = {
+        { .addr = SLAVE_ADDR, .len = 1, .buf = &reg },
+        { .addr = SLAVE_ADDR, .flags = I2C_M_RD, .len = 2, .buf = b },
+    };
+    struct i2c_transaction ta = { .msgs = ma, .nr_msgs = 2 };
+    struct i2c_transaction tb = { .msgs = mb, .nr_msgs = 2 };
+
+    setup();
+
+    EXPECT_EQ(i2c_async(&ta), 0);
+    EXPECT_EQ(i2c_async(&tb), 0);
+    EXPECT_EQ(bsc.nr_starts, 1);
+    run_bus();
+
+    /* Nobody at 0x50: the first ends at its address byte */
+    EXPECT_EQ(ta.status, -1);
+    EXPECT_EQ(tb.status, 0);
+    EXPECT_EQ(b[0], 0xA0);
+    EXPECT_EQ(b[1], 0xA1);
+    EXPECT_EQ(bsc.starts[1].addr, SLAVE_ADDR);
+    /* ERR was cleared for the next transaction */
+    EXPECT_EQ(bsc.s, 0);
+}
+
+TEST(i2c_clock_stretch_timeout_aborts)
+{
+    uint8_t data[2] = { 0x40, 0x55 };
+    struct i2c_msg msg = { .addr = SLAVE_ADDR, .len = sizeof(data),
+                           .buf = data };
+    struct i2c_transaction t = { .msgs = &msg, .nr_msgs = 1 };
+
+    setup();
+    bsc.stretch = 1;
+
+    /* Every byte was in the FIFO, so only CLKT tells it failed */
+    EXPECT_EQ(i2c_sync(&t), -1);
+    EXPECT_EQ(slave.regs[0x40], 0xA0 + 0x40);
+    EXPECT_EQ(bsc.s, 0);
+    EXPECT_EQ(bsc.c & C_I2CEN, 0);
+}
+
+/* What a client like ft5x06 does: queue the next read on completion */
+static uint8_t chain_reg = 0x08, chain_buf[3][2];
+static struct i2c_msg chain_msgs[2];
+static struct i2c_transaction chain_t;
+static unsigned int chain_done;
+static int chain_status[3];
+
+static void chain_complete(void *context)
+{
+    chain_status[chain_done++] = chain_t.status;
+    if (chain_done == 3)
+        return;
+
+    chain_msgs[1].buf = chain_buf[chain_done];
+    chain_reg += 2;
+    EXPECT_EQ(i2c_async(&chain_t), 0);
+}
+
+TEST(i2c_completion_can_queue_the_next_transaction)
+{
+    setup();
+    chain_done = 0;
+    chain_reg = 0x08;
+    chain_msgs[0] = (struct i2c_msg){ .addr = SLAVE_ADDR, .len = 1,
+                                      .buf = &chain_reg };
+    chain_msgs[1] = (struct i2c_msg){ .addr = SLAVE_ADDR,
+                                      .flags = I2C_M_RD, .len = 2,
+                                      .buf = chain_buf[0] };
+    chain_t = (struct i2c_transaction){ .msgs = chain_msgs, .nr_msgs = 2,
+                                        .complete = chain_complete };
+
+    EXPECT_EQ(i2c_async(&chain_t), 0);
+    run_bus();
+
+    EXPECT_EQ(chain_done, 3);
+    for (unsigned int i = 0; i < 3; i++) {
+        EXPECT_EQ(chain_status[i], 0);
+        EXPECT_EQ(chain_buf[i][0], 0xA8 + 2 * i);
+        EXPECT_EQ(chain_buf[i][1], 0xA9 + 2 * i);
+    }
+    EXPECT_EQ(bsc.nr_starts, 6);
+    EXPECT_EQ(bsc.nr_stops, 3);
+}
+
+TEST(i2c_sync_polls_status_with_irqs_masked)
+{
+    uint8_t reg = 0x30;
+    uint8_t buf[20];
+
+    setup();
+    local_irq_disable();
+
+    EXPECT_EQ(i2c_write_read(SLAVE_ADDR, &reg, 1, buf, sizeof(buf)), 0);
+    for (unsigned int i = 0; i < sizeof(buf); i++)
+        EXPECT_EQ(buf[i], 0xA0 + 0x30 + i);
+    EXPECT_EQ(bsc.nr_restarts, 1);
+
+    /* The handler's work done by the waiter, spinning on S */
+    EXPECT_EQ(bsc.irqs, 0);
+    EXPECT_EQ(bsc.yields, 0);
+    EXPECT_TRUE(bsc.polls > sizeof(buf));
+    EXPECT_TRUE(host_irqs_disabled);
+
+    local_irq_enable();
+}
+
+TEST(i2c_async_rejects_bad_messages)
+{
+    uint8_t b;
+    struct i2c_msg msg = { .addr = 0x80, .len = 1, .buf = &b };
+    struct i2c_transaction t = { .msgs = &msg, .nr_msgs = 1 };
+
+    setup();
+
+    EXPECT_EQ(i2c_async(&t), -1);
+    msg.addr = SLAVE_ADDR;
+    msg.len = 0;
+    EXPECT_EQ(i2c_async(&t), -1);
+    t.nr_msgs = 0;
+    EXPECT_EQ(i2c_async(&t), -1);
+    EXPECT_EQ(bsc.nr_starts, 0);
+}
@@ -0,0 +1,394 @@
+/*
+ * BCM2837 mailbox property channel: message packing, answer checks and
+ * the two ways a submitter waits
+ *
+ * Runs in its own binary (see HOST_MBOX_TEST_SRC): test_cpufreq.c
+ * stands in for the mailbox in the main runner. The mailbox registers
+ * are a model of the firmware, which answers the tags it knows in place
+ * and posts the message back in mailbox 0; it does so either at once or,
+ * in deferred mode, only once the ARM sleeps waiting for it.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <serial_core.h>
+#include <kernel/irq_chip.h>
+#include <kernel/of.h>
+#include <kernel/sched.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+#include "dma_stub.h"
+#include "test.h"
+
+#define MBOX_PA             0x3F00B880
+#define MBOX0_READ          0x00
+#define MBOX0_STATUS        0x18
+#define MBOX0_CONFIG        0x1C
+#define MBOX1_WRITE         0x20
+#define MBOX1_STATUS        0x38
+
+#define STATUS_FULL         (1U << 31)
+#define STATUS_EMPTY        (1U << 30)
+#define CONFIG_DATA_IRQ     (1U << 0)
+
+#define CHAN_PROPERTY       8
+#define MBOX_IRQ            (1 + ARMCTRL_IRQ_OFFSET)
+
+#define RESPONSE_OK         0x80000000
+#define RESPONSE_ERROR      0x80000001
+#define TAG_RESPONSE        (1U << 31)
+
+/* A tag the model does not know, so leaves unanswered */
+#define TAG_UNKNOWN         0x0004BEEF
+
+#define FW_REVISION         1700000000
+#define FW_ARM_HZ           1000000000
+#define FW_MILLICELSIUS     47230
+
+static struct {
+    uint32_t config;
+    uint32_t reply[4];          /* Mailbox 0, oldest first */
+    unsigned int nr_reply;
+    uint32_t posted;            /* Last word written to mailbox 1 */
+    unsigned int nr_posted;
+    unsigned int full_reads;    /* Mailbox 1 reads full this many times */
+    int defer;                  /* Answer only when the ARM waits */
+    int pending;                /* A deferred message to answer */
+    uint32_t status;            /* Message code the firmware answers */
+    uint32_t seen[MBOX_BATCH_WORDS];    /* Messages as they arrived */
+    unsigned int yields, wfis, irqs;
+} fw;
+
+/* No device tree: the driver uses its built-in base */
+struct device_node *of_find_compatible_node(struct device_node *from,
+                                            const char *compat)
+{
+    return NULL;
+}
+
+void __iomem *of_iomap(const struct device_node *np, int index)
+{
+    return NULL;
+}
+
+void uart_poll_puts(const char *s)
+{
+}
+
+void uart_poll_put_dec(uint64_t val)
+{
+}
+
+/* Single-threaded: the buffer is never owned by another thread */
+void schedule(void)
+{
+}
+
+static uint32_t *fw_message(void)
+{
+    return dma_stub_bus_to_virt(fw.posted & ~0xFU);
+}
+
+/* Fill in one tag's value buffer; returns the answer length in bytes */
+static uint32_t fw_tag(uint32_t tag, uint32_t *val, uint32_t size)
+{
+    uint32_t ans[2];
+    uint32_t len;
+
+    switch (tag) {
+    case MBOX_TAG_GET_FIRMWARE_REV:
+        ans[0] = FW_REVISION;
+        len = 4;
+        break;
+    case MBOX_TAG_GET_CLOCK_RATE:
+        ans[0] = val[0];
+        ans[1] = val[0] == MBOX_CLK_ARM ? FW_ARM_HZ : 0;
+        len = 8;
+        break;
+    case MBOX_TAG_GET_TEMPERATURE:
+        ans[0] = 0;
+        ans[1] = FW_MILLICELSIUS;
+        len = 8;
+        break;
+    case MBOX_TAG_GET_VC_MEMORY:
+        ans[0] = 0x3C000000;
+        ans[1] = 0x04000000;
+        len = 8;
+        break;
+    default:
+        return 0;
+    }
+
+    /* The firmware truncates, but reports the full length */
+    memcpy(val, ans, len < size ? len : size);
+    return TAG_RESPONSE | len;
+}
+
+/* Process the message in place, as the VideoCore does */
+static void fw_answer(void)
+{
+    uint32_t *msg = fw_message();
+    unsigned int i = 2;
+
+    memcpy(fw.seen, msg, msg[0] < sizeof(fw.seen) ? msg[0] : sizeof(fw.seen));
+    while (msg[i]) {
+        uint32_t code = fw_tag(msg[i], &msg[i + 3], msg[i + 1]);
+
+        if (code)
+            msg[i + 2] = code;
+        i += 3 + msg[i + 1] / 4;
+    }
+    msg[1] = fw.status;
+
+    fw.reply[fw.nr_reply++] = fw.posted;
+    fw.pending = 0;
+}
+
+static uint32_t fw_read(struct mmio_model *m, unsigned int off)
+{
+    uint32_t val;
+
+    switch (off) {
+    case MBOX0_READ:
+        if (!fw.nr_reply)
+            return 0;
+        val = fw.reply[0];
+        memmove(fw.reply, fw.reply + 1, --fw.nr_reply * sizeof(fw.reply[0]));
+        return val;
+    case MBOX0_STATUS:
+        return fw.nr_reply ? 0 : STATUS_EMPTY;
+    case MBOX0_CONFIG:
+        return fw.config;
+    case MBOX1_STATUS:
+        if (fw.full_reads) {
+            fw.full_reads--;
+            return STATUS_FULL;
+        }
+        return STATUS_EMPTY;
+    }
+    return 0;
+}
+
+static void fw_write(struct mmio_model *m, unsigned int off, uint32_t val)
+{
+    switch (off) {
+    case MBOX0_CONFIG:
+        fw.config = val;
+        break;
+    case MBOX1_WRITE:
+        EXPECT_EQ(fw.full_reads, 0);
+        fw.posted = val;
+        fw.nr_posted++;
+        if (fw.defer)
+            fw.pending = 1;
+        else
+            fw_answer();
+        break;
+    }
+}
+
+static struct mmio_model fw_model = {
+    .base = IO_ADDRESS(MBOX_PA),
+    .size = 0x40,
+    .read = fw_read,
+    .write = fw_write,
+};
+
+/* Answer a deferred message; nothing to answer means a hang */
+static void fw_wake(const char *where)
+{
+    if (!fw.pending) {
+        fprintf(stderr, "    %s with no message at the firmware\n", where);
+        abort();
+    }
+    fw_answer();
+}
+
+/* Interrupts on: the mailbox IRQ is the wakeup */
+void yield_or_wfi(void)
+{
+    fw.yields++;
+    fw_wake("yield_or_wfi()");
+    if (fw.config & CONFIG_DATA_IRQ) {
+        fw.irqs++;
+        generic_handle_irq(MBOX_IRQ);
+    }
+}
+
+/* Interrupts masked: the IRQ only wakes the core, the waiter drains */
+void host_wfi(void)
+{
+    fw.wfis++;
+    EXPECT_TRUE(host_irqs_disabled);
+    fw_wake("wfi");
+}
+
+static void setup(void)
+{
+    memset(&fw, 0, sizeof(fw));
+    fw.status = RESPONSE_OK;
+    /* Left over from the boot firmware */
+    fw.reply[fw.nr_reply++] = 0x12345678;
+
+    mmio_model_remove(&fw_model);
+    mmio_model_add(&fw_model);
+    dma_stub_reset();
+    local_irq_enable();
+
+    irq_init();
+    EXPECT_EQ(bcm2837_mbox_init(), 0);
+    irq_set_chip_and_handler(MBOX_IRQ, NULL, handle_simple_irq);
+
+    fw.nr_posted = 0;
+}
+
+TEST(mbox_init_drains_and_reads_the_revision)
+{
+    setup();
+
+    EXPECT_EQ(fw.nr_reply, 0);
+    EXPECT_EQ(fw.config, CONFIG_DATA_IRQ);
+    /* A 16-byte aligned buffer on the property channel */
+    EXPECT_EQ(fw.posted & 0xF, CHAN_PROPERTY);
+    EXPECT_EQ(fw.seen[2], MBOX_TAG_GET_FIRMWARE_REV);
+}
+
+TEST(mbox_batch_packs_tags_and_pads_to_16_bytes)
+{
+    struct mbox_batch b;
+    int rev, arm, temp;
+
+    setup();
+    memset(&b, 0xAA, sizeof(b));
+
+    mbox_batch_init(&b);
+    rev = mbox_batch_add(&b, MBOX_TAG_GET_FIRMWARE_REV, NULL, 0, 1);
+    arm = mbox_batch_add(&b, MBOX_TAG_GET_CLOCK_RATE,
+                         (const uint32_t[]){ MBOX_CLK_ARM }, 1, 2);
+    temp = mbox_batch_add(&b, MBOX_TAG_GET_TEMPERATURE,
+                          (const uint32_t[]){ 0 }, 1, 2);
+    EXPECT_EQ(rev, 2);
+    EXPECT_EQ(arm, 6);
+    EXPECT_EQ(temp, 11);
+
+    fw.full_reads = 3;
+    EXPECT_EQ(mbox_batch_submit(&b), 0);
+    EXPECT_EQ(fw.nr_posted, 1);
+
+    /* 16 words of tags, the end tag and three words of padding */
+    EXPECT_EQ(fw.seen[0], 20 * 4);
+    EXPECT_EQ(fw.seen[1], 0);
+    EXPECT_EQ(fw.seen[3], 4);
+    EXPECT_EQ(fw.seen[4], 0);
+    EXPECT_EQ(fw.seen[7], 8);
+    EXPECT_EQ(fw.seen[8], 0);
+    EXPECT_EQ(fw.seen[9], MBOX_CLK_ARM);
+    EXPECT_EQ(fw.seen[10], 0);
+    for (unsigned int i = 16; i < 20; i++)
+        EXPECT_EQ(fw.seen[i], 0);
+
+    EXPECT_EQ(mbox_batch_value(&b, rev)[0], FW_REVISION);
+    EXPECT_EQ(mbox_batch_value(&b, arm)[1], FW_ARM_HZ);
+    EXPECT_EQ(mbox_batch_value(&b, temp)[1], FW_MILLICELSIUS);
+}
+
+TEST(mbox_batch_overflow_sticks_and_is_not_sent)
+{
+    struct mbox_batch b;
+    int n = 0;
+
+    setup();
+    mbox_batch_init(&b);
+
+    while (mbox_batch_add(&b, MBOX_TAG_GET_TEMPERATURE, NULL, 0, 2) >= 0)
+        n++;
+    /* 2 + 5 words a tag, with room for the end tag and padding */
+    EXPECT_EQ(n, 11);
+    EXPECT_TRUE(b.overflow);
+
+    /* Would still fit, but the message is already incomplete */
+    EXPECT_EQ(mbox_batch_add(&b, MBOX_TAG_GET_FIRMWARE_REV, NULL, 0, 0), -1);
+    EXPECT_EQ(mbox_batch_submit(&b), -1);
+    EXPECT_EQ(fw.nr_posted, 0);
+}
+
+TEST(mbox_batch_value_checks_the_answer)
+{
+    struct mbox_batch b;
+    int unknown, truncated, ok;
+
+    setup();
+    mbox_batch_init(&b);
+    unknown = mbox_batch_add(&b, TAG_UNKNOWN, NULL, 0, 1);
+    /* The answer is two words, the buffer only one */
+    truncated = mbox_batch_add(&b, MBOX_TAG_GET_VC_MEMORY, NULL, 0, 1);
+    ok = mbox_batch_add(&b, MBOX_TAG_GET_FIRMWARE_REV, NULL, 0, 1);
+    EXPECT_EQ(mbox_batch_submit(&b), 0);
+
+    EXPECT_TRUE(mbox_batch_value(&b, unknown) == NULL);
+    EXPECT_TRUE(mbox_batch_value(&b, truncated) == NULL);
+    EXPECT_TRUE(mbox_batch_value(&b, ok) != NULL);
+
+    /* Handles that are not tags of this message */
+    EXPECT_TRUE(mbox_batch_value(&b, -1) == NULL);
+    EXPECT_TRUE(mbox_batch_value(&b, 0) == NULL);
+    EXPECT_TRUE(mbox_batch_value(&b, b.len) == NULL);
+}
+
+TEST(mbox_submit_fails_on_a_message_error)
+{
+    uint32_t rev = 0;
+
+    setup();
+    fw.status = RESPONSE_ERROR;
+
+    EXPECT_EQ(mbox_get_firmware_revision(&rev), -1);
+    EXPECT_EQ(fw.nr_posted, 1);
+    EXPECT_EQ(rev, 0);
+}
+
+TEST(mbox_completes_from_the_interrupt)
+{
+    uint32_t temp = 0;
+
+    setup();
+    fw.defer = 1;
+
+    EXPECT_EQ(mbox_get_temperature(&temp), 0);
+    EXPECT_EQ(temp, FW_MILLICELSIUS);
+    /* Slept once and the handler drained the mailbox */
+    EXPECT_EQ(fw.yields, 1);
+    EXPECT_EQ(fw.irqs, 1);
+    EXPECT_EQ(fw.wfis, 0);
+    EXPECT_EQ(fw.nr_reply, 0);
+    EXPECT_TRUE(!host_irqs_disabled);
+}
+
+TEST(mbox_waits_in_wfi_with_irqs_masked)
+{
+    uint32_t rate = 0;
+
+    setup();
+    fw.defer = 1;
+    local_irq_disable();
+
+    EXPECT_EQ(mbox_get_clock_rate(MBOX_CLK_ARM, &rate), 0);
+    EXPECT_EQ(rate, FW_ARM_HZ);
+    /* No handler: the waiter took the message out itself */
+    EXPECT_EQ(fw.wfis, 1);
+    EXPECT_EQ(fw.yields, 0);
+    EXPECT_EQ(fw.irqs, 0);
+    EXPECT_EQ(fw.nr_reply, 0);
+    EXPECT_TRUE(host_irqs_disabled);
+
+    local_irq_enable();
+}
+
+TEST(mbox_set_clock_rate_rejects_an_unknown_clock)
+{
+    setup();
+
+    /* The firmware answers 0 Hz for a clock it does not have */
+    EXPECT_EQ(mbox_set_clock_rate(MBOX_CLK_PWM, 1000000, NULL), -1);
+}
@@ -0,0 +1,679 @@
+/*
+ * BCM2837 SPI0: the transfer queue, FIFO and DMA phases, and the DC line
+ *
+ * The controller registers are a model whose shift register is
+ * infinitely fast: a byte written to the TX FIFO is clocked as soon as
+ * RX has room, and comes back inverted. DMA goes through dma_stub.c;
+ * run_dma() plays the two channels of a DMA phase, TX before RX as on
+ * the wire, clocking as many bytes as DLEN says. Every byte clocked is
+ * logged with the DC level and chip select bits it went out with.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <kernel/irq_chip.h>
+#include <kernel/sched.h>
+#include <dma/bcm2837_dma.h>
+#include <gpio/bcm2837_gpio.h>
+#include <spi/bcm2837_spi.h>
+#include <spi/spi.h>
+#include <asm/io.h>
+#include <asm/irqflags.h>
+#include "dma_stub.h"
+#include "test.h"
+
+#define SPI_CS              0x00
+#define SPI_FIFO            0x04
+#define SPI_CLK             0x08
+#define SPI_DLEN            0x0C
+
+#define CS_CS_MASK          0x3U
+#define CS_CPHA             (1U << 2)
+#define CS_CPOL             (1U << 3)
+#define CS_CLEAR_TX         (1U << 4)
+#define CS_CLEAR_RX         (1U << 5)
+#define CS_TA               (1U << 7)
+#define CS_DMAEN            (1U << 8)
+#define CS_INTD             (1U << 9)
+#define CS_INTR             (1U << 10)
+#define CS_DONE             (1U << 16)
+#define CS_RXD              (1U << 17)
+#define CS_TXD              (1U << 18)
+#define CS_RXR              (1U << 19)
+
+#define FIFO_SIZE           64
+#define SPI0_IRQ            (54 + 32 + ARMCTRL_IRQ_OFFSET)
+#define DC_GPIO             25
+
+/* Most the driver clocks in one DMA phase, under the 16-bit DLEN */
+#define DMA_CHUNK           0xFFF0U
+
+#define WIRE_MAX            (4 * DMA_CHUNK)
+
+/* Register model */
+static struct {
+    uint32_t cs;
+    uint32_t clk;
+    uint32_t dlen;                  /* Left to clock in DMA mode */
+    uint8_t tx[FIFO_SIZE];
+    unsigned int tx_count;
+    uint8_t rx[FIFO_SIZE];
+    unsigned int rx_head, rx_count;
+    unsigned int errors;            /* FIFO misuse */
+    int absent;                     /* Read as all zeroes */
+} spi;
+
+static int dc_level = -1;
+static unsigned int dc_sets;
+
+/* Every byte clocked out, with the DC level and CS bits at the time */
+static uint8_t wire[WIRE_MAX];
+static int8_t wire_dc[WIRE_MAX];
+static uint8_t wire_cs[WIRE_MAX];
+static size_t nr_wire;
+
+static void wire_put(uint8_t b)
+{
+    if (nr_wire < WIRE_MAX) {
+        wire[nr_wire] = b;
+        wire_dc[nr_wire] = dc_level;
+        wire_cs[nr_wire] = spi.cs & (CS_CS_MASK | CS_CPHA | CS_CPOL);
+        nr_wire++;
+    }
+}
+
+static void spi_clock(void)
+{
+    while (spi.tx_count && spi.rx_count < FIFO_SIZE) {
+        uint8_t b = spi.tx[0];
+
+        memmove(&spi.tx[0], &spi.tx[1], --spi.tx_count);
+        wire_put(b);
+        spi.rx[(spi.rx_head + spi.rx_count++) % FIFO_SIZE] = ~b;
+    }
+}
+
+static uint32_t spi_model_read(struct mmio_model *m, unsigned int off)
+{
+    uint32_t val;
+
+    if (spi.absent)
+        return 0;
+
+    switch (off) {
+    case SPI_CS:
+        val = spi.cs;
+        if (spi.tx_count < FIFO_SIZE)
+            val |= CS_TXD;
+        if (spi.rx_count)
+            val |= CS_RXD;
+        if (spi.rx_count >= FIFO_SIZE * 3 / 4)
+            val |= CS_RXR;
+        if ((spi.cs & CS_TA) && !spi.tx_count)
+            val |= CS_DONE;
+        return val;
+    case SPI_FIFO:
+        if (!spi.rx_count || (spi.cs & CS_DMAEN)) {
+            spi.errors++;
+            return 0;
+        }
+        val = spi.rx[spi.rx_head];
+        spi.rx_head = (spi.rx_head + 1) % FIFO_SIZE;
+        spi.rx_count--;
+        spi_clock();
+        return val;
+    case SPI_CLK:
+        return spi.clk;
+    case SPI_DLEN:
+        return spi.dlen;
+    }
+    return 0;
+}
+
+static void spi_model_write(struct mmio_model *m, unsigned int off,
+                            uint32_t val)
+{
+    switch (off) {
+    case SPI_CS:
+        if (val & CS_CLEAR_TX)
+            spi.tx_count = 0;
+        if (val & CS_CLEAR_RX)
+            spi.rx_head = spi.rx_count = 0;
+        spi.cs = val & ~(CS_CLEAR_TX | CS_CLEAR_RX);
+        break;
+    case SPI_FIFO:
+        if (!(spi.cs & CS_TA) || (spi.cs & CS_DMAEN) ||
+            spi.tx_count == FIFO_SIZE) {
+            spi.errors++;
+            break;
+        }
+        spi.tx[spi.tx_count++] = val;
+        spi_clock();
+        break;
+    case SPI_CLK:
+        spi.clk = val;
+        break;
+    case SPI_DLEN:
+        spi.dlen = val & 0xFFFF;
+        break;
+    }
+}
+
+static struct mmio_model spi_model = {
+    .base = IO_ADDRESS(BCM2837_SPI0_PA),
+    .size = 0x100,
+    .read = spi_model_read,
+    .write = spi_model_write,
+};
+
+static int spi_irq_line(void)
+{
+    uint32_t cs = spi_model_read(&spi_model, SPI_CS);
+
+    return ((cs & CS_INTR) && (cs & CS_RXR)) ||
+           ((cs & CS_INTD) && (cs & CS_DONE));
+}
+
+/* GPIO and the scheduler are not built for the host */
+void bcm2837_gpio_set_function(unsigned int gpio, unsigned int fsel)
+{
+}
+
+void bcm2837_gpio_set(unsigned int gpio, int value)
+{
+    if (gpio == DC_GPIO) {
+        dc_level = !!value;
+        dc_sets++;
+    }
+}
+
+static int find_pending(enum dma_transfer_direction dir)
+{
+    for (unsigned int i = 0; i < dma_stub_pending(); i++) {
+        if (dma_stub_pending_desc(i)->dir == dir)
+            return i;
+    }
+    return -1;
+}
+
+/*
+ * Run the DMA phase the driver set up: TX feeds the wire, RX fills its
+ * buffer with what came back and completes last. Returns 0 if there
+ * was none.
+ */
+static int run_dma(void)
+{
+    int tx = find_pending(DMA_MEM_TO_DEV), rx = find_pending(DMA_DEV_TO_MEM);
+    struct dma_desc *desc;
+    size_t start = nr_wire;
+
+    if (tx < 0 || rx < 0)
+        return 0;
+    EXPECT_TRUE((spi.cs & (CS_TA | CS_DMAEN)) == (CS_TA | CS_DMAEN));
+
+    /* The controller stops clocking, and DREQ with it, after DLEN */
+    desc = dma_stub_pending_desc(tx);
+    for (unsigned int n = 0; n < desc->nents; n++) {
+        const uint8_t *p = dma_stub_bus_to_virt(desc->sg[n].addr);
+
+        for (uint32_t i = 0; i < desc->sg[n].len && spi.dlen; i++) {
+            wire_put(p[i]);
+            spi.dlen--;
+        }
+    }
+    dma_stub_complete(tx);
+
+    desc = dma_stub_pending_desc(find_pending(DMA_DEV_TO_MEM));
+    for (unsigned int n = 0; n < desc->nents; n++) {
+        uint8_t *p = dma_stub_bus_to_virt(desc->sg[n].addr);
+
+        for (uint32_t i = 0; i < desc->sg[n].len; i++, start++) {
+            if (desc->sg[n].addr != DMA_SG_DISCARD)
+                p[i] = ~wire[start];
+        }
+    }
+    dma_stub_complete(find_pending(DMA_DEV_TO_MEM));
+    return 1;
+}
+
+/* Take interrupts until the bus goes quiet */
+static void run_bus(void)
+{
+    for (unsigned int n = 0; n < 100000; n++) {
+        if (spi_irq_line())
+            generic_handle_irq(SPI0_IRQ);
+        else if (!run_dma())
+            return;
+    }
+    EXPECT_TRUE(!"the bus never went quiet");
+}
+
+/* spi_sync() sleeps here; the wakeup is the next interrupt */
+void yield_or_wfi(void)
+{
+    if (spi_irq_line())
+        generic_handle_irq(SPI0_IRQ);
+    else if (!run_dma()) {
+        /* Nothing will ever wake it: fail rather than hang */
+        fprintf(stderr, "    spi_sync() is waiting on an idle bus\n");
+        abort();
+    }
+}
+
+static void setup(void)
+{
+    memset(&spi, 0, sizeof(spi));
+    dc_level = -1;
+    dc_sets = 0;
+    nr_wire = 0;
+
+    mmio_model_remove(&spi_model);
+    mmio_model_add(&spi_model);
+    dma_stub_reset();
+
+    irq_init();
+    EXPECT_EQ(bcm2837_spi_init(), 0);
+    irq_set_chip_and_handler(SPI0_IRQ, NULL, handle_simple_irq);
+}
+
+static void fill(uint8_t *buf, size_t len, int seed)
+{
+    for (size_t i = 0; i < len; i++)
+        buf[i] = seed + i * 13 + (i >> 8);
+}
+
+static int inverted(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if ((uint8_t)~a[i] != b[i])
+            return 0;
+    }
+    return 1;
+}
+
+static struct spi_device panel = {
+    .chip_select = 0,
+    .max_speed_hz = 32000000,
+    .mode = SPI_MODE_0,
+    .dc_gpio = DC_GPIO,
+};
+
+static uint8_t tx_buf[WIRE_MAX], rx_buf[WIRE_MAX];
+
+TEST(spi_short_transfer_goes_through_the_fifo)
+{
+    struct spi_transfer t = {
+        .tx_buf = tx_buf,
+        .rx_buf = rx_buf,
+        .len = 40,
+        .dc = SPI_DC_KEEP,
+    };
+    struct spi_message msg = {
+        .spi = &panel,
+        .transfers = &t,
+        .nr_transfers = 1,
+    };
+
+    setup();
+    fill(tx_buf, sizeof(tx_buf), 1);
+
+    EXPECT_EQ(spi_async(&msg), 0);
+    EXPECT_EQ(msg.status, SPI_MSG_QUEUED);
+    /* All of it fits: the drain interrupt is armed, no DMA */
+    EXPECT_EQ(nr_wire, 40);
+    EXPECT_TRUE(spi.cs & CS_TA);
+    EXPECT_TRUE(spi.cs & CS_INTD);
+    EXPECT_EQ(dma_stub_pending(), 0);
+
+    run_bus();
+    EXPECT_EQ(msg.status, 0);
+    EXPECT_EQ(msg.actual_length, 40);
+    EXPECT_EQ(memcmp(wire, tx_buf, 40), 0);
+    EXPECT_TRUE(inverted(tx_buf, rx_buf, 40));
+    /* Chip select released, interrupts masked */
+    EXPECT_EQ(spi.cs & (CS_TA | CS_INTD | CS_INTR), 0);
+    EXPECT_EQ(spi.errors, 0);
+    EXPECT_EQ(dc_sets, 0);
+}
+
+TEST(spi_read_refills_the_fifo_from_the_interrupt)
+{
+    struct spi_transfer t = {
+        .rx_buf = rx_buf,
+        .len = 1000,
+        .dc = SPI_DC_KEEP,
+    };
+    struct spi_message msg = {
+        .spi = &panel,
+        .transfers = &t,
+        .nr_transfers = 1,
+    };
+    size_t i;
+
+    setup();
+    memset(rx_buf, 0x55, 1000);
+
+    /* Nothing to send: zeros through the FIFO however long it is */
+    EXPECT_EQ(spi_async(&msg), 0);
+    /* Never more in flight than RX holds */
+    EXPECT_EQ(nr_wire, FIFO_SIZE);
+    EXPECT_TRUE(spi_irq_line());
+
+    run_bus();
+    EXPECT_EQ(msg.status, 0);
+    EXPECT_EQ(nr_wire, 1000);
+    for (i = 0; i < 1000 && !wire[i] && rx_buf[i] == 0xFF; i++)
+        ;
+    EXPECT_EQ(i, 1000);
+    EXPECT_EQ(dma_stub_pending(), 0);
+    EXPECT_EQ(spi.errors, 0);
+}
+
+static unsigned int done_order[4];
+static unsigned int nr_done;
+static struct spi_message *chained;
+
+static void msg_done(void *context)
+{
+    if (nr_done < 4)
+        done_order[nr_done] = (uintptr_t)context;
+    nr_done++;
+
+    /* A completion that queues the next message itself */
+    if (chained) {
+        EXPECT_EQ(spi_async(chained), 0);
+        chained = NULL;
+    }
+}
+
+TEST(spi_messages_run_in_queue_order)
+{
+    struct spi_device other = {
+        .chip_select = 1,
+        .max_speed_hz = 1000000,
+        .mode = SPI_MODE_3,
+        .dc_gpio = SPI_NO_DC,
+    };
+    struct spi_transfer t1 = {
+        .tx_buf = tx_buf, .len = 10, .dc = SPI_DC_DATA,
+    };
+    struct spi_transfer t2 = {
+        .tx_buf = tx_buf + 10, .len = 20, .dc = SPI_DC_KEEP,
+    };
+    struct spi_transfer t3 = {
+        .tx_buf = tx_buf + 30, .len = 5, .dc = SPI_DC_COMMAND,
+    };
+    struct spi_message m1 = {
+        .spi = &panel, .transfers = &t1, .nr_transfers = 1,
+        .complete = msg_done, .context = (void *)1,
+    };
+    struct spi_message m2 = {
+        .spi = &other, .transfers = &t2, .nr_transfers = 1,
+        .complete = msg_done, .context = (void *)2,
+    };
+    struct spi_message m3 = {
+        .spi = &panel, .transfers = &t3, .nr_transfers = 1,
+        .complete = msg_done, .context = (void *)3,
+    };
+    size_t i;
+
+    setup();
+    fill(tx_buf, sizeof(tx_buf), 2);
+    nr_done = 0;
+    chained = &m3;
+
+    EXPECT_EQ(spi_async(&m1), 0);
+    EXPECT_EQ(spi_async(&m2), 0);
+    /* m2 waits behind m1 */
+    EXPECT_EQ(nr_wire, 10);
+    EXPECT_EQ(m2.status, SPI_MSG_QUEUED);
+
+    run_bus();
+    EXPECT_EQ(nr_done, 3);
+    EXPECT_EQ(done_order[0], 1);
+    EXPECT_EQ(done_order[1], 2);
+    EXPECT_EQ(done_order[2], 3);
+    EXPECT_EQ(m1.status | m2.status | m3.status, 0);
+    EXPECT_EQ(nr_wire, 35);
+    EXPECT_EQ(memcmp(wire, tx_buf, 35), 0);
+
+    /* Each message with its own chip select, mode and DC level */
+    for (i = 0; i < 35; i++) {
+        if (i < 10) {
+            EXPECT_EQ(wire_cs[i], 0);
+            EXPECT_EQ(wire_dc[i], SPI_DC_DATA);
+        } else if (i < 30) {
+            EXPECT_EQ(wire_cs[i], 1 | CS_CPHA | CS_CPOL);
+            EXPECT_EQ(wire_dc[i], SPI_DC_DATA);
+        } else {
+            EXPECT_EQ(wire_cs[i], 0);
+            EXPECT_EQ(wire_dc[i], SPI_DC_COMMAND);
+        }
+    }
+    EXPECT_EQ(spi.errors, 0);
+}
+
+TEST(spi_dma_runs_one_dlen_phase_per_chunk)
+{
+    /* Two full DMA phases, a short one and a word-unaligned tail */
+    size_t len = 2 * DMA_CHUNK + 0x103;
+    struct spi_transfer t = {
+        .tx_buf = tx_buf,
+        .len = len,
+        .dc = SPI_DC_DATA,
+    };
+    struct spi_message msg = {
+        .spi = &panel,
+        .transfers = &t,
+        .nr_transfers = 1,
+    };
+    struct dma_desc *tx, *rx;
+    unsigned int n;
+
+    setup();
+    fill(tx_buf, sizeof(tx_buf), 3);
+
+    EXPECT_EQ(spi_async(&msg), 0);
+    EXPECT_EQ(nr_wire, 0);
+    EXPECT_EQ(dma_stub_pending(), 2);
+    EXPECT_EQ(dma_stub_mapped(), 1);
+
+    /* RX is submitted first and is the one that completes the phase */
+    rx = dma_stub_pending_desc(0);
+    tx = dma_stub_pending_desc(1);
+    EXPECT_EQ(rx->dir, DMA_DEV_TO_MEM);
+    EXPECT_EQ(rx->dreq, BCM2837_DREQ_SPI_RX);
+    EXPECT_TRUE(rx->callback != NULL);
+    EXPECT_EQ(tx->dreq, BCM2837_DREQ_SPI_TX);
+    EXPECT_EQ(tx->dev_addr, periph_to_dma(BCM2837_SPI0_PA + SPI_FIFO));
+    EXPECT_EQ(rx->dev_addr, tx->dev_addr);
+    EXPECT_TRUE(rx->chan != tx->chan);
+    /* Nowhere to put what comes back */
+    EXPECT_EQ(rx->sg[0].addr, DMA_SG_DISCARD);
+
+    for (n = 0; n < 3; n++) {
+        uint32_t expect = n < 2 ? DMA_CHUNK : 0x100;
+
+        tx = dma_stub_pending_desc(1);
+        EXPECT_EQ(tx->nents, 1);
+        EXPECT_EQ(tx->sg[0].len, expect);
+        EXPECT_EQ(dma_stub_pending_desc(0)->sg[0].len, expect);
+        EXPECT_TRUE(dma_stub_bus_to_virt(tx->sg[0].addr) ==
+                    tx_buf + n * DMA_CHUNK);
+        /* The controller is told how much this phase clocks */
+        EXPECT_EQ(spi.dlen, expect);
+
+        /* Its completion starts the next phase, or the FIFO tail */
+        EXPECT_EQ(run_dma(), 1);
+        if (n < 2)
+            EXPECT_EQ(nr_wire, (n + 1) * DMA_CHUNK);
+    }
+
+    /* Then the last three bytes through the FIFO */
+    EXPECT_EQ(dma_stub_pending(), 0);
+    EXPECT_EQ(nr_wire, len);
+    EXPECT_EQ(spi.cs & CS_DMAEN, 0);
+    EXPECT_TRUE(spi.cs & CS_INTD);
+
+    run_bus();
+    EXPECT_EQ(msg.status, 0);
+    EXPECT_EQ(msg.actual_length, len);
+    EXPECT_EQ(memcmp(wire, tx_buf, len), 0);
+    EXPECT_EQ(dma_stub_mapped(), 0);
+    EXPECT_EQ(spi.errors, 0);
+}
+
+TEST(spi_dma_reads_into_the_rx_buffer)
+{
+    struct spi_transfer t = {
+        .tx_buf = tx_buf,
+        .rx_buf = rx_buf,
+        .len = 1001,
+        .dc = SPI_DC_KEEP,
+    };
+    struct spi_message msg = {
+        .spi = &panel,
+        .transfers = &t,
+        .nr_transfers = 1,
+    };
+
+    setup();
+    fill(tx_buf, sizeof(tx_buf), 4);
+    memset(rx_buf, 0, 1001);
+
+    EXPECT_EQ(spi_async(&msg), 0);
+    EXPECT_EQ(dma_stub_mapped(), 2);
+    EXPECT_TRUE(dma_stub_bus_to_virt(dma_stub_pending_desc(0)->sg[0].addr) ==
+                rx_buf);
+    EXPECT_EQ(dma_stub_pending_desc(0)->sg[0].len, 1000);
+
+    run_bus();
+    EXPECT_EQ(msg.status, 0);
+    EXPECT_EQ(nr_wire, 1001);
+    EXPECT_EQ(memcmp(wire, tx_buf, 1001), 0);
+    EXPECT_TRUE(inverted(tx_buf, rx_buf, 1001));
+    EXPECT_EQ(dma_stub_mapped(), 0);
+}
+
+TEST(spi_dc_is_set_before_each_transfer)
+{
+    static const uint8_t cmd = 0x2C;
+    struct spi_transfer t[] = {
+        { .tx_buf = &cmd, .len = 1, .dc = SPI_DC_COMMAND },
+        { .tx_buf = tx_buf, .len = 300, .dc = SPI_DC_DATA },
+        { .tx_buf = tx_buf + 300, .len = 7, .dc = SPI_DC_KEEP },
+        { .tx_buf = &cmd, .len = 1, .dc = SPI_DC_COMMAND },
+    };
+    struct spi_message msg = {
+        .spi = &panel,
+        .transfers = t,
+        .nr_transfers = 4,
+    };
+    size_t i;
+
+    setup();
+    fill(tx_buf, sizeof(tx_buf), 5);
+
+    /* The DMA phase in the middle must not run ahead of the command */
+    EXPECT_EQ(spi_async(&msg), 0);
+    run_bus();
+    EXPECT_EQ(msg.status, 0);
+    EXPECT_EQ(msg.actual_length, 309);
+    EXPECT_EQ(nr_wire, 309);
+    EXPECT_EQ(dc_sets, 3);
+
+    EXPECT_EQ(wire[0], cmd);
+    EXPECT_EQ(wire_dc[0], SPI_DC_COMMAND);
+    for (i = 1; i < 308 && wire_dc[i] == SPI_DC_DATA; i++)
+        ;
+    EXPECT_EQ(i, 308);
+    EXPECT_EQ(memcmp(wire + 1, tx_buf, 307), 0);
+    EXPECT_EQ(wire[308], cmd);
+    EXPECT_EQ(wire_dc[308], SPI_DC_COMMAND);
+}
+
+TEST(spi_clock_divider_is_even_and_rounded_up)
+{
+    static const struct {
+        uint32_t hz;
+        uint32_t cdiv;
+    } cases[] = {
+        { 125000000, 2 },           /* 250MHz core clock / 2 */
+        { 200000000, 2 },           /* Fastest there is */
+        { 32000000, 8 },            /* 7.8 */
+        { 40000000, 8 },            /* 6.25, up to 7, even 8 */
+        { 3900000, 66 },            /* 64.1 */
+        { 1000, 0 },                /* Slowest: 65536 */
+    };
+    static const uint32_t effective[] = {
+        125000000, 125000000, 31250000, 31250000, 3787878, 3814,
+    };
+    struct spi_device dev = { .dc_gpio = SPI_NO_DC };
+    uint8_t b = 0;
+    unsigned int i;
+
+    setup();
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        dev.max_speed_hz = cases[i].hz;
+        EXPECT_EQ(spi_write(&dev, &b, 1, SPI_DC_KEEP), 0);
+        EXPECT_EQ(spi.clk, cases[i].cdiv);
+        EXPECT_EQ(spi_effective_speed_hz(&dev), effective[i]);
+    }
+}
+
+TEST(spi_sync_polls_with_irqs_masked)
+{
+    struct spi_transfer t = {
+        .rx_buf = rx_buf,
+        .len = 500,
+        .dc = SPI_DC_KEEP,
+    };
+    struct spi_message msg = {
+        .spi = &panel,
+        .transfers = &t,
+        .nr_transfers = 1,
+    };
+
+    setup();
+    memset(rx_buf, 0, 500);
+
+    host_irqs_disabled = 1;
+    EXPECT_EQ(spi_sync(&msg), 0);
+    host_irqs_disabled = 0;
+
+    EXPECT_EQ(nr_wire, 500);
+    EXPECT_EQ(rx_buf[499], 0xFF);
+    EXPECT_EQ(spi.cs & CS_TA, 0);
+}
+
+TEST(spi_init_fails_without_a_controller)
+{
+    struct spi_device dev = { .max_speed_hz = 1000000, .dc_gpio = SPI_NO_DC };
+    uint8_t b = 0;
+
+    memset(&spi, 0, sizeof(spi));
+    spi.absent = 1;
+    mmio_model_remove(&spi_model);
+    mmio_model_add(&spi_model);
+    dma_stub_reset();
+    irq_init();
+
+    EXPECT_EQ(bcm2837_spi_init(), -1);
+    EXPECT_EQ(spi_write(&dev, &b, 1, SPI_DC_KEEP), -1);
+    EXPECT_EQ(spi_effective_speed_hz(&dev), 0);
+    spi.absent = 0;
+}
+
+TEST(spi_rejects_bad_messages)
+{
+    struct spi_device bad = { .chip_select = 3, .dc_gpio = SPI_NO_DC };
+    struct spi_message msg = { .spi = &bad, .nr_transfers = 0 };
+
+    setup();
+    EXPECT_EQ(spi_async(&msg), -1);
+    msg.spi = NULL;
+    EXPECT_EQ(spi_async(&msg), -1);
+    msg.spi = &panel;
+    msg.nr_transfers = 1;
+    EXPECT_EQ(spi_async(&msg), -1);
+}
@@ -0,0 +1,41 @@
+/*
+ * container_of()
+ */
+
+#include <container_of.h>
+#include "test.h"
+
+struct inner {
+    int a;
+    long b;
+};
+
+struct outer {
+    char tag;
+    struct inner in;
+    int tail[4];
+};
+
+TEST(container_of_recovers_outer)
+{
+    struct outer o;
+
+    EXPECT_TRUE(container_of(&o.in, struct outer, in) == &o);
+    EXPECT_TRUE(container_of(&o.tag, struct outer, tag) == &o);
+    EXPECT_TRUE(container_of(&o.tail, struct outer, tail) == &o);
+}
+
+TEST(container_of_nested_member)
+{
+    struct outer o;
+
+    EXPECT_TRUE(container_of(&o.in.b, struct outer, in.b) == &o);
+}
+
+TEST(container_of_accepts_void_pointer)
+{
+    struct outer o;
+    void *p = &o.in;
+
+    EXPECT_TRUE(container_of(p, struct outer, in) == &o);
+}
@@ -0,0 +1,167 @@
+/*
+ * cpufreq governor against a stub mailbox
+ *
+ * The stub firmware reports a 600-1000MHz ARM clock and logs every
+ * SET_CLOCK_RATE request; idle time and the run queue are set by the
+ * tests. host_cntvct runs at 1MHz, so one sample period is
+ * CPUFREQ_SAMPLE_US ticks.
+ */
+
+#include <string.h>
+#include <kernel/cpufreq.h>
+#include <kernel/sched.h>
+#include <mailbox/bcm2837_mbox.h>
+#include <asm/arch_timer.h>
+#include "test.h"
+
+#define MHZ     1000000U
+
+static uint32_t fw_rate = 700 * MHZ;
+static int fw_fail;
+static uint32_t set_log[16];
+static unsigned int set_count;
+
+static uint64_t stub_idle_ticks;
+static int stub_nr_running;
+
+/* drivers/mailbox and kernel/sched are not built for the host */
+int mbox_get_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    *rate = fw_rate;
+    return clk == MBOX_CLK_ARM ? 0 : -1;
+}
+
+int mbox_get_min_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    *rate = 600 * MHZ;
+    return clk == MBOX_CLK_ARM ? 0 : -1;
+}
+
+int mbox_get_max_clock_rate(unsigned int clk, uint32_t *rate)
+{
+    *rate = 1000 * MHZ;
+    return clk == MBOX_CLK_ARM ? 0 : -1;
+}
+
+int mbox_set_clock_rate(unsigned int clk, uint32_t rate, uint32_t *actual)
+{
+    if (clk != MBOX_CLK_ARM || fw_fail)
+        return -1;
+    if (set_count < 16)
+        set_log[set_count] = rate;
+    set_count++;
+    fw_rate = rate;
+    *actual = rate;
+    return 0;
+}
+
+int nr_running(void)
+{
+    return stub_nr_running;
+}
+
+uint64_t cpu_idle_ticks(unsigned int cpu)
+{
+    return cpu == 0 ? stub_idle_ticks : 0;
+}
+
+/* One sample period with @idle_pct of it spent asleep */
+static void run_sample(unsigned int idle_pct)
+{
+    host_cntvct += CPUFREQ_SAMPLE_US;
+    stub_idle_ticks += CPUFREQ_SAMPLE_US * idle_pct / 100;
+    cpufreq_update();
+}
+
+static void setup(void)
+{
+    fw_rate = 700 * MHZ;
+    fw_fail = 0;
+    set_count = 0;
+    stub_nr_running = 0;
+    memset(set_log, 0, sizeof(set_log));
+    EXPECT_EQ(cpufreq_init(), 0);
+}
+
+TEST(cpufreq_reads_limits_from_firmware)
+{
+    const struct cpufreq_policy *p = cpufreq_get_policy();
+
+    setup();
+    EXPECT_EQ(p->min, 600 * MHZ);
+    EXPECT_EQ(p->max, 1000 * MHZ);
+    EXPECT_EQ(p->cur, 700 * MHZ);
+
+    /* Nothing happens before a whole sample period has passed */
+    host_cntvct += CPUFREQ_SAMPLE_US - 1;
+    cpufreq_update();
+    EXPECT_EQ(set_count, 0);
+}
+
+TEST(cpufreq_ramps_to_max_on_a_burst)
+{
+    setup();
+
+    run_sample(10);
+    EXPECT_EQ(set_count, 1);
+    EXPECT_EQ(set_log[0], 1000 * MHZ);
+
+    /* Still busy: no further request */
+    run_sample(0);
+    EXPECT_EQ(set_count, 1);
+    EXPECT_EQ(cpufreq_get_policy()->load, 100);
+
+    /* Runnable threads count as full load whatever the idle time */
+    run_sample(100);
+    EXPECT_EQ(set_log[1], 600 * MHZ);
+    stub_nr_running = 1;
+    run_sample(100);
+    EXPECT_EQ(set_log[2], 1000 * MHZ);
+    EXPECT_EQ(cpufreq_get_policy()->transitions, 3);
+}
+
+TEST(cpufreq_drops_to_min_when_idle)
+{
+    setup();
+
+    run_sample(100);
+    EXPECT_EQ(set_count, 1);
+    EXPECT_EQ(set_log[0], 600 * MHZ);
+    EXPECT_EQ(cpufreq_get_policy()->cur, 600 * MHZ);
+
+    /* Idle time longer than the window (counter read skew) is 0% load */
+    host_cntvct += CPUFREQ_SAMPLE_US;
+    stub_idle_ticks += CPUFREQ_SAMPLE_US + 5;
+    cpufreq_update();
+    EXPECT_EQ(cpufreq_get_policy()->load, 0);
+    EXPECT_EQ(set_count, 1);
+}
+
+TEST(cpufreq_scales_with_moderate_load)
+{
+    setup();
+
+    /* 50% load: 600 + 400 * 0.5 = 800MHz */
+    run_sample(50);
+    EXPECT_EQ(set_log[0], 800 * MHZ);
+
+    /* 65%: 860MHz, rounded down to the 800MHz step already set */
+    run_sample(35);
+    EXPECT_EQ(cpufreq_get_policy()->load, 65);
+    EXPECT_EQ(set_count, 1);
+}
+
+TEST(cpufreq_keeps_rate_when_firmware_refuses)
+{
+    setup();
+
+    fw_fail = 1;
+    run_sample(0);
+    EXPECT_EQ(cpufreq_get_policy()->cur, 700 * MHZ);
+
+    /* Retried on the next sample */
+    fw_fail = 0;
+    run_sample(0);
+    EXPECT_EQ(set_count, 1);
+    EXPECT_EQ(cpufreq_get_policy()->cur, 1000 * MHZ);
+}
@@ -0,0 +1,175 @@
+/*
+ * cpuidle core, menu governor and idle tick stopping
+ *
+ * A fake clockevent remembers when it was programmed to fire and a fake
+ * idle driver "sleeps" by moving host_cntvct (1MHz) on to whichever
+ * comes first, that event or the next device interrupt the test has
+ * scheduled. When the event ended the sleep the tick handler is run
+ * afterwards, as the timer interrupt would be once unmasked.
+ */
+
+#include <kernel/cpuidle.h>
+#include <kernel/clockchip.h>
+#include <kernel/jiffies.h>
+#include <kernel/tick.h>
+#include <asm/arch_timer.h>
+#include "test.h"
+
+enum { WFI, WFI_NOHZ, RET };
+
+static uint64_t evt_deadline;
+static uint64_t evt_last_delta;
+
+static uint64_t irq_after;          /* Next device interrupt, us from entry */
+static unsigned int exit_delay;     /* Wake-up time added after a timer event */
+
+static void fake_set_next_event(unsigned long delta, struct clock_event_device *dev)
+{
+    evt_last_delta = delta;
+    evt_deadline = host_cntvct + delta;
+}
+
+static struct clock_event_device fake_evt = {
+    .name = "fake",
+    .set_next_event = fake_set_next_event,
+};
+
+static void fake_enter(struct cpuidle_driver *drv, int index)
+{
+    uint64_t end = host_cntvct + irq_after;
+
+    if (evt_deadline < end)
+        end = evt_deadline + exit_delay;
+    host_cntvct = end;
+}
+
+static struct cpuidle_driver fake_idle_driver = {
+    .name = "fake_idle",
+    .states = {
+        { .name = "WFI", .exit_latency = 1, .target_residency = 1,
+          .enter = fake_enter },
+        { .name = "WFI-NOHZ", .exit_latency = 10,
+          .target_residency = TICK_PERIOD_US,
+          .flags = CPUIDLE_FLAG_TICK_STOP, .enter = fake_enter },
+        { .name = "RET", .exit_latency = 100,
+          .target_residency = 2 * TICK_PERIOD_US,
+          .flags = CPUIDLE_FLAG_TICK_STOP, .enter = fake_enter },
+    },
+    .state_count = 3,
+};
+
+static const struct cpuidle_state_usage *usage(int index)
+{
+    return &cpuidle_get_device(0)->states_usage[index];
+}
+
+static void setup(void)
+{
+    host_cntvct = 5000000;
+    exit_delay = 0;
+    clockevents_config_and_register(&fake_evt);
+    EXPECT_EQ(cpuidle_register_driver(&fake_idle_driver), 0);
+}
+
+/* One pass of the idle loop, woken by a device after @after us at most */
+static int idle_once(uint64_t after)
+{
+    irq_after = after;
+    EXPECT_EQ(cpuidle_idle_call(), 0);
+    if (host_cntvct >= evt_deadline)
+        fake_evt.event_handler(&fake_evt);
+    return cpuidle_get_device(0)->menu.last_state_idx;
+}
+
+TEST(cpuidle_rejects_bad_drivers)
+{
+    struct cpuidle_driver empty = { .name = "empty", .state_count = 0 };
+
+    EXPECT_EQ(cpuidle_register_driver(&empty), -1);
+    empty.state_count = CPUIDLE_STATE_MAX + 1;
+    EXPECT_EQ(cpuidle_register_driver(&empty), -1);
+}
+
+TEST(cpuidle_long_idle_stops_the_tick)
+{
+    uint64_t j0;
+
+    setup();
+    j0 = jiffies_64;
+
+    /* No history: trust the timer, which with the tick stopped is far */
+    EXPECT_EQ(idle_once(35000), RET);
+    EXPECT_EQ(usage(RET)->usage, 1);
+    EXPECT_EQ(usage(RET)->time, 35000);
+    EXPECT_EQ(usage(RET)->above, 0);
+
+    /* Three tick boundaries passed; the next one stays on the grid */
+    EXPECT_EQ(jiffies_64 - j0, 3);
+    EXPECT_EQ(evt_last_delta, 5000);
+
+    host_cntvct += 5000;
+    fake_evt.event_handler(&fake_evt);
+    EXPECT_EQ(jiffies_64 - j0, 4);
+}
+
+TEST(cpuidle_counts_early_wakeups)
+{
+    setup();
+
+    EXPECT_EQ(idle_once(5000), RET);
+    EXPECT_EQ(usage(RET)->above, 1);
+    EXPECT_EQ(usage(RET)->exit_samples, 0);
+}
+
+TEST(cpuidle_learns_regular_wakeups)
+{
+    int i, idx = RET;
+
+    setup();
+
+    /* A device interrupting every 300us: no point in a deep state */
+    for (i = 0; i < 2 * MENU_INTERVALS; i++)
+        idx = idle_once(300);
+    EXPECT_EQ(idx, WFI);
+    EXPECT_TRUE(cpuidle_get_device(0)->menu.predicted_us < 1000);
+    EXPECT_TRUE(usage(WFI)->usage >= MENU_INTERVALS);
+
+    /* It stops: long stays again, back to the deepest state */
+    for (i = 0; i < 2 * MENU_INTERVALS; i++)
+        idx = idle_once(60000);
+    EXPECT_EQ(idx, RET);
+}
+
+TEST(cpuidle_measures_exit_latency_on_tick_wakeups)
+{
+    uint64_t j0;
+    int i;
+
+    setup();
+    exit_delay = 7;
+
+    for (i = 0; i < 2 * MENU_INTERVALS; i++)
+        idle_once(300);
+    j0 = jiffies_64;
+
+    /* Shallow state with the tick running: the tick ends the stay */
+    EXPECT_EQ(idle_once(50000), WFI);
+    EXPECT_EQ(jiffies_64 - j0, 1);
+    EXPECT_TRUE(usage(WFI)->exit_samples >= 1);
+    EXPECT_EQ(usage(WFI)->exit_latency_max, 7);
+}
+
+TEST(menu_keeps_tick_states_within_the_tick)
+{
+    struct cpuidle_device dev;
+
+    menu_enable_device(&dev);
+
+    /* Long predicted sleep: the deepest state */
+    EXPECT_EQ(menu_select(&fake_idle_driver, &dev, 100000, 10000), RET);
+
+    /* Short timer: only the shallow state covers it */
+    EXPECT_EQ(menu_select(&fake_idle_driver, &dev, 500, 500), WFI);
+    EXPECT_EQ(dev.menu.predicted_us, 500);
+    EXPECT_EQ(menu_select(&fake_idle_driver, &dev, 15000, 2000), WFI_NOHZ);
+}
@@ -0,0 +1,329 @@
+/*
+ * E-ink framebuffer: pixel packing, dirty rectangle coalescing and the
+ * ghosting budget, against a panel that only logs its refreshes
+ */
+
+#include <string.h>
+#include <kernel/fb.h>
+#include "test.h"
+
+#define MAX_LOG     16
+
+static struct fb_rect refresh_log[MAX_LOG];
+static int refresh_full[MAX_LOG];
+static int nr_refresh;
+static int refresh_fail;
+
+/* Marked from inside the nth refresh, as an interrupt would */
+static struct fb_rect mark_during;
+static int mark_during_nr = -1;
+
+static int fake_refresh(struct fb_info *info, const struct fb_rect *rect,
+                        int full)
+{
+    if (nr_refresh == mark_during_nr)
+        fb_mark_dirty(info, &mark_during);
+    if (refresh_fail)
+        return -1;
+    if (nr_refresh < MAX_LOG) {
+        refresh_log[nr_refresh] = *rect;
+        refresh_full[nr_refresh] = full;
+    }
+    nr_refresh++;
+    return 0;
+}
+
+static const struct fb_ops fake_fbops = {
+    .fb_refresh = fake_refresh,
+};
+
+static uint8_t screen[1600 * 1280 / 8];
+static struct fb_info fb;
+
+/* Register a fresh framebuffer and get its initial full refresh done */
+static void setup(unsigned int width, unsigned int height, unsigned int format)
+{
+    mark_during_nr = -1;
+    memset(screen, 0, sizeof(screen));
+    fb = (struct fb_info){
+        .name = "fake",
+        .width = width,
+        .height = height,
+        .format = format,
+        .screen_base = screen,
+        .fbops = &fake_fbops,
+    };
+    EXPECT_EQ(register_framebuffer(&fb), 0);
+    EXPECT_EQ(fb_flush(&fb), 0);
+    nr_refresh = 0;
+    refresh_fail = 0;
+}
+
+static void mark(unsigned int x, unsigned int y, unsigned int w, unsigned int h)
+{
+    struct fb_rect r = { x, y, w, h };
+
+    fb_mark_dirty(&fb, &r);
+}
+
+static int dirty_covers(unsigned int x, unsigned int y, unsigned int w,
+                        unsigned int h)
+{
+    const struct fb_rect *d;
+    int i;
+
+    for (i = 0; i < fb.nr_dirty; i++) {
+        d = &fb.dirty[i];
+        if (x >= d->x && x + w <= d->x + d->w &&
+            y >= d->y && y + h <= d->y + d->h)
+            return 1;
+    }
+    return 0;
+}
+
+TEST(fb_register_checks_and_starts_with_full_refresh)
+{
+    struct fb_info bad = { .name = "bad", .width = 8, .height = 8,
+                           .format = 3, .screen_base = screen,
+                           .fbops = &fake_fbops };
+
+    EXPECT_EQ(register_framebuffer(&bad), -1);
+
+    nr_refresh = 0;
+    fb = (struct fb_info){ .name = "fake", .width = 250, .height = 122,
+                           .format = FB_FORMAT_MONO1, .screen_base = screen,
+                           .fbops = &fake_fbops };
+    EXPECT_EQ(register_framebuffer(&fb), 0);
+    EXPECT_EQ(fb.stride, 32);
+    EXPECT_EQ(fb.x_align, 8);
+    EXPECT_TRUE(fb_get_info() == &fb);
+
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 1);
+    EXPECT_EQ(refresh_full[0], 1);
+    EXPECT_EQ(refresh_log[0].w, 250);
+    EXPECT_EQ(refresh_log[0].h, 122);
+
+    /* Nothing dirty: nothing to do */
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 1);
+}
+
+TEST(fb_mono1_packs_msb_first)
+{
+    struct fb_rect r = { 3, 1, 10, 2 };
+
+    setup(20, 4, FB_FORMAT_MONO1);
+    EXPECT_EQ(fb.stride, 3);
+
+    fb_set_pixel(&fb, 0, 0, FB_WHITE);
+    fb_set_pixel(&fb, 9, 0, 12);
+    fb_set_pixel(&fb, 10, 0, 7);            /* Dark grey is black */
+    EXPECT_EQ(screen[0], 0x80);
+    EXPECT_EQ(screen[1], 0x40);
+    EXPECT_EQ(fb_get_pixel(&fb, 9, 0), FB_WHITE);
+    EXPECT_EQ(fb_get_pixel(&fb, 10, 0), FB_BLACK);
+
+    /* Pixels 3..12: partial first byte, no whole byte, partial second */
+    fb_fill_rect(&fb, &r, FB_WHITE);
+    EXPECT_EQ(screen[3], 0x1f);
+    EXPECT_EQ(screen[4], 0xf8);
+    EXPECT_EQ(screen[5], 0x00);
+    EXPECT_EQ(screen[6], 0x1f);
+    EXPECT_EQ(screen[9], 0x00);
+}
+
+TEST(fb_gray4_packs_high_nibble_first)
+{
+    struct fb_rect r = { 1, 0, 6, 1 };
+
+    setup(9, 2, FB_FORMAT_GRAY4);
+    EXPECT_EQ(fb.stride, 5);
+    EXPECT_EQ(fb.x_align, 2);
+
+    fb_set_pixel(&fb, 0, 1, 0xa);
+    fb_set_pixel(&fb, 1, 1, 0x5);
+    fb_set_pixel(&fb, 8, 1, 0x3);
+    EXPECT_EQ(screen[5], 0xa5);
+    EXPECT_EQ(screen[9], 0x30);
+    EXPECT_EQ(fb_get_pixel(&fb, 1, 1), 0x5);
+
+    fb_fill_rect(&fb, &r, 0x7);
+    EXPECT_EQ(screen[0], 0x07);
+    EXPECT_EQ(screen[1], 0x77);
+    EXPECT_EQ(screen[2], 0x77);
+    EXPECT_EQ(screen[3], 0x70);
+    EXPECT_EQ(screen[4], 0x00);
+}
+
+TEST(fb_gray2_keeps_top_bits_of_level)
+{
+    struct fb_rect r = { 2, 0, 9, 1 };
+
+    setup(12, 2, FB_FORMAT_GRAY2);
+    EXPECT_EQ(fb.stride, 3);
+    EXPECT_EQ(fb.x_align, 4);
+
+    fb_set_pixel(&fb, 1, 1, 0xb);           /* Level 2 */
+    fb_set_pixel(&fb, 3, 1, FB_WHITE);
+    EXPECT_EQ(screen[3], 0x23);
+    EXPECT_EQ(fb_get_pixel(&fb, 1, 1), 10);
+    EXPECT_EQ(fb_get_pixel(&fb, 3, 1), FB_WHITE);
+
+    fb_fill_rect(&fb, &r, 0x5);             /* Level 1 */
+    EXPECT_EQ(screen[0], 0x05);
+    EXPECT_EQ(screen[1], 0x55);
+    EXPECT_EQ(screen[2], 0x54);
+}
+
+TEST(fb_coalesces_neighbours_and_keeps_distant_areas)
+{
+    setup(800, 480, FB_FORMAT_MONO1);
+
+    /* Side by side: one refresh of the two is cheaper */
+    mark(0, 0, 64, 64);
+    mark(64, 0, 64, 64);
+    EXPECT_EQ(fb.nr_dirty, 1);
+    EXPECT_EQ(fb.dirty[0].w, 128);
+
+    /* Far away: refreshing the gap would cost more than a refresh */
+    mark(600, 400, 128, 64);
+    EXPECT_EQ(fb.nr_dirty, 2);
+
+    /* Inside an existing rectangle: nothing new */
+    mark(10, 10, 5, 5);
+    EXPECT_EQ(fb.nr_dirty, 2);
+
+    /* Overlapping: always merged, x widened to the byte */
+    mark(700, 380, 50, 30);
+    EXPECT_EQ(fb.nr_dirty, 2);
+    EXPECT_TRUE(dirty_covers(600, 380, 150, 84));
+
+    /* Clipped to the screen */
+    mark(790, 470, 100, 100);
+    EXPECT_TRUE(dirty_covers(784, 470, 16, 10));
+    EXPECT_TRUE(!dirty_covers(784, 470, 17, 10));
+}
+
+TEST(fb_merges_when_out_of_slots)
+{
+    int i;
+
+    setup(1600, 1280, FB_FORMAT_MONO1);
+
+    for (i = 0; i < FB_MAX_DIRTY; i++)
+        mark(i * 180, i * 140, 8, 8);
+    EXPECT_EQ(fb.nr_dirty, FB_MAX_DIRTY);
+
+    mark(1580, 1260, 8, 8);
+    EXPECT_EQ(fb.nr_dirty, FB_MAX_DIRTY);
+    for (i = 0; i < FB_MAX_DIRTY; i++)
+        EXPECT_TRUE(dirty_covers(i * 180, i * 140, 8, 8));
+    EXPECT_TRUE(dirty_covers(1580, 1260, 8, 8));
+}
+
+TEST(fb_flush_spends_ghost_budget_then_refreshes_fully)
+{
+    setup(800, 480, FB_FORMAT_MONO1);
+    fb.ghost_budget = 10000;
+
+    mark(0, 0, 64, 64);
+    mark(600, 400, 64, 64);
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 2);
+    EXPECT_EQ(refresh_full[0] + refresh_full[1], 0);
+    EXPECT_EQ(fb.ghost_used, 2 * 64 * 64);
+    EXPECT_EQ(fb.nr_dirty, 0);
+
+    mark(300, 200, 64, 32);
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 3);
+    EXPECT_EQ(refresh_full[2], 0);
+
+    /* 10240 partially refreshed pixels: over budget */
+    mark(300, 200, 8, 8);
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 4);
+    EXPECT_EQ(refresh_full[3], 1);
+    EXPECT_EQ(fb.ghost_used, 0);
+    EXPECT_EQ(fb.full_refreshes, 2);        /* With the initial one */
+    EXPECT_EQ(fb.partial_refreshes, 3);
+}
+
+TEST(fb_flush_refreshes_fully_when_most_is_dirty)
+{
+    struct fb_rect r = { 0, 0, 800, 300 };
+
+    setup(800, 480, FB_FORMAT_MONO1);
+
+    fb_fill_rect(&fb, &r, FB_WHITE);
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 1);
+    EXPECT_EQ(refresh_full[0], 1);
+
+    fb_force_full_refresh(&fb);
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(refresh_full[1], 1);
+}
+
+TEST(fb_failed_refresh_stays_dirty)
+{
+    setup(800, 480, FB_FORMAT_MONO1);
+
+    mark(0, 0, 64, 64);
+    mark(600, 400, 64, 64);
+    refresh_fail = 1;
+    EXPECT_EQ(fb_flush(&fb), -1);
+    EXPECT_EQ(fb.nr_dirty, 2);
+    EXPECT_EQ(fb.ghost_used, 0);
+
+    refresh_fail = 0;
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 2);
+    EXPECT_EQ(fb.nr_dirty, 0);
+}
+
+TEST(fb_mark_during_flush_stays_dirty)
+{
+    setup(800, 480, FB_FORMAT_MONO1);
+
+    mark(0, 0, 64, 64);
+    mark(600, 400, 64, 64);
+    mark_during = (struct fb_rect){ 300, 200, 64, 32 };
+    mark_during_nr = 0;
+    EXPECT_EQ(fb_flush(&fb), 0);
+
+    /* Both taken rectangles refreshed, the late one left for next time */
+    EXPECT_EQ(nr_refresh, 2);
+    EXPECT_EQ(refresh_log[0].x, 600);
+    EXPECT_EQ(refresh_log[0].w, 64);
+    EXPECT_EQ(refresh_log[1].x, 0);
+    EXPECT_EQ(refresh_log[1].w, 64);
+    EXPECT_EQ(fb.nr_dirty, 1);
+    EXPECT_TRUE(dirty_covers(300, 200, 64, 32));
+
+    mark_during_nr = -1;
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(nr_refresh, 3);
+    EXPECT_EQ(refresh_log[2].x, 296);     /* Widened to the byte */
+    EXPECT_EQ(fb.nr_dirty, 0);
+
+    /* Marked during a failing refresh: kept along with what failed */
+    mark(0, 0, 64, 64);
+    mark_during_nr = 3;
+    refresh_fail = 1;
+    EXPECT_EQ(fb_flush(&fb), -1);
+    EXPECT_EQ(fb.nr_dirty, 2);
+    EXPECT_TRUE(dirty_covers(0, 0, 64, 64));
+    EXPECT_TRUE(dirty_covers(300, 200, 64, 32));
+
+    /* And during a full refresh */
+    fb_force_full_refresh(&fb);
+    refresh_fail = 0;
+    mark_during_nr = 3;                     /* Failures are not logged */
+    EXPECT_EQ(fb_flush(&fb), 0);
+    EXPECT_EQ(refresh_full[3], 1);
+    EXPECT_EQ(fb.nr_dirty, 1);
+    EXPECT_TRUE(dirty_covers(300, 200, 64, 32));
+    mark_during_nr = -1;
+}
@@ -0,0 +1,176 @@
+/*
+ * Grey to panel format conversion: quantisation, packing, dithering,
+ * rotation and blitting. The host has no NEON kernels, so this checks
+ * the scalar code that is also their reference.
+ */
+
+#include <string.h>
+#include <kernel/fb_convert.h>
+#include "test.h"
+
+static uint8_t src[64 * 64];
+static uint8_t dst[64 * 64];
+
+static int fb_refresh_nop(struct fb_info *info, const struct fb_rect *rect,
+                          int full)
+{
+    return 0;
+}
+
+static const struct fb_ops nop_fbops = {
+    .fb_refresh = fb_refresh_nop,
+};
+
+static uint8_t screen[64 * 64 / 8];
+static struct fb_info fb;
+
+static void setup_fb(unsigned int width, unsigned int height,
+                     unsigned int format)
+{
+    memset(screen, 0, sizeof(screen));
+    fb = (struct fb_info){
+        .name = "fake",
+        .width = width,
+        .height = height,
+        .format = format,
+        .screen_base = screen,
+        .fbops = &nop_fbops,
+    };
+    EXPECT_EQ(register_framebuffer(&fb), 0);
+}
+
+static unsigned int popcount8(uint8_t b)
+{
+    unsigned int n = 0;
+
+    for (; b; b &= b - 1)
+        n++;
+    return n;
+}
+
+TEST(fb_pack_rounds_to_nearest_level)
+{
+    static const uint8_t grey[8] = { 0, 127, 128, 255, 42, 43, 200, 213 };
+
+    memcpy(src, grey, sizeof(grey));
+
+    /* Threshold at 128 */
+    fb_pack_gray8(dst, 1, src, 8, 8, 1, FB_FORMAT_MONO1, 0, 0, FB_DITHER_NONE);
+    EXPECT_EQ(dst[0], 0x33);
+
+    /* Levels 0, 85, 170, 255 */
+    fb_pack_gray8(dst, 2, src, 8, 8, 1, FB_FORMAT_GRAY2, 0, 0, FB_DITHER_NONE);
+    EXPECT_EQ(dst[0], 0x1b);                /* 0 1 2 3 */
+    EXPECT_EQ(dst[1], 0x1a);                /* 0 1 2 2 */
+
+    fb_pack_gray8(dst, 4, src, 8, 8, 1, FB_FORMAT_GRAY4, 0, 0, FB_DITHER_NONE);
+    EXPECT_EQ(dst[0], 0x07);
+    EXPECT_EQ(dst[1], 0x8f);
+    EXPECT_EQ(dst[2], 0x23);
+    EXPECT_EQ(dst[3], 0xcc);
+}
+
+TEST(fb_pack_ordered_dither_tiles_flat_grey)
+{
+    unsigned int y, ones = 0;
+
+    /* 25% grey: 4 of every 16 pixels white, in the same place each tile */
+    memset(src, 64, 32 * 4);
+    fb_pack_gray8(dst, 4, src, 32, 32, 4, FB_FORMAT_MONO1, 0, 0,
+                  FB_DITHER_ORDERED);
+    for (y = 0; y < 16; y++)
+        ones += popcount8(dst[y]);
+    EXPECT_EQ(ones, 32);
+    EXPECT_EQ(dst[0], dst[1]);
+    EXPECT_TRUE(dst[0] != dst[4]);
+
+    /* The pattern follows the screen position, not the buffer */
+    fb_pack_gray8(dst + 16, 4, src, 32, 32, 4, FB_FORMAT_MONO1, 0, 1,
+                  FB_DITHER_ORDERED);
+    EXPECT_EQ(dst[16], dst[4]);
+    EXPECT_EQ(dst[28], dst[0]);
+}
+
+TEST(fb_rotate_all_directions)
+{
+    unsigned int w = 19, h = 11, x, y, r, bad;
+    uint8_t got;
+
+    for (x = 0; x < w * h; x++)
+        src[x] = x;
+
+    for (r = FB_ROTATE_0; r <= FB_ROTATE_270; r++) {
+        memset(dst, 0, sizeof(dst));
+        fb_rotate_gray8(dst, 32, src, w, w, h, r);
+
+        bad = 0;
+        for (y = 0; y < h; y++) {
+            for (x = 0; x < w; x++) {
+                if (r == FB_ROTATE_0)
+                    got = dst[y * 32 + x];
+                else if (r == FB_ROTATE_90)
+                    got = dst[x * 32 + (h - 1 - y)];
+                else if (r == FB_ROTATE_180)
+                    got = dst[(h - 1 - y) * 32 + (w - 1 - x)];
+                else
+                    got = dst[(w - 1 - x) * 32 + y];
+                bad += got != src[y * w + x];
+            }
+        }
+        EXPECT_EQ(bad, 0);
+    }
+}
+
+TEST(fb_blit_handles_unaligned_edges_and_clips)
+{
+    struct fb_rect r = { 5, 1, 20, 2 };
+    struct fb_rect edge = { 60, 3, 10, 1 };
+
+    setup_fb(64, 4, FB_FORMAT_MONO1);
+    memset(src, 255, sizeof(src));
+
+    EXPECT_EQ(fb_blit_gray8(&fb, &r, src, 20, FB_DITHER_NONE), 0);
+    EXPECT_EQ(screen[0], 0x00);
+    EXPECT_EQ(screen[8], 0x07);
+    EXPECT_EQ(screen[9], 0xff);
+    EXPECT_EQ(screen[10], 0xff);
+    EXPECT_EQ(screen[11], 0x80);
+    EXPECT_EQ(screen[19], 0x80);
+    EXPECT_EQ(screen[27], 0x00);
+    EXPECT_EQ(fb.nr_dirty, 1);
+    EXPECT_EQ(fb.dirty[0].x, 0);
+    EXPECT_EQ(fb.dirty[0].w, 32);
+
+    /* Only 4 of the 10 pixels are on the screen */
+    EXPECT_EQ(fb_blit_gray8(&fb, &edge, src, 10, FB_DITHER_NONE), 0);
+    EXPECT_EQ(screen[31], 0x0f);
+
+    EXPECT_EQ(fb_blit_gray8(&fb, &r, src, 20, 7), -1);
+}
+
+TEST(fb_blit_floyd_steinberg_keeps_mean_grey)
+{
+    struct fb_rect r = { 0, 0, 64, 16 };
+    unsigned int i, ones = 0;
+
+    setup_fb(64, 16, FB_FORMAT_MONO1);
+
+    memset(src, 64, sizeof(src));
+    EXPECT_EQ(fb_blit_gray8(&fb, &r, src, 64, FB_DITHER_FS), 0);
+    for (i = 0; i < 128; i++)
+        ones += popcount8(screen[i]);
+    /* A quarter of 1024 pixels, give or take the edges */
+    EXPECT_TRUE(ones >= 240 && ones <= 272);
+
+    memset(src, 255, sizeof(src));
+    EXPECT_EQ(fb_blit_gray8(&fb, &r, src, 64, FB_DITHER_FS), 0);
+    for (i = 0; i < 128; i++)
+        EXPECT_EQ(screen[i], 0xff);
+
+    /* Two bits: mid grey is mostly levels 1 and 2 */
+    setup_fb(32, 8, FB_FORMAT_GRAY2);
+    memset(src, 128, sizeof(src));
+    EXPECT_EQ(fb_blit_gray8(&fb, &r, src, 64, FB_DITHER_FS), 0);
+    EXPECT_EQ(fb_get_pixel(&fb, 0, 0), 10);
+    EXPECT_EQ(fb_get_pixel(&fb, 1, 0), 5);
+}
@@ -0,0 +1,310 @@
+/*
+ * Device tree parsing and lookups
+ *
+ * There is no dtc on the build machine, so the blob is assembled here:
+ * a cut-down Raspberry Pi 3 tree with the nodes the drivers look up.
+ */
+
+#include <string.h>
+#include <kernel/init.h>
+#include <kernel/mm.h>
+#include <kernel/of.h>
+#include <kernel/of_fdt.h>
+#include <asm/io.h>
+#include <asm/memory.h>
+#include "test.h"
+
+/* kernel/params.c is not built for the host */
+char boot_command_line[COMMAND_LINE_SIZE];
+
+static uint32_t fdt_struct[1024];
+static unsigned int fdt_struct_words;
+static char fdt_strings[512];
+static unsigned int fdt_strings_len;
+static uint64_t fdt_blob[1024];
+
+static uint32_t cpu_to_be32(uint32_t v)
+{
+    return __builtin_bswap32(v);
+}
+
+static void fdt_emit(uint32_t w)
+{
+    fdt_struct[fdt_struct_words++] = cpu_to_be32(w);
+}
+
+static void fdt_emit_bytes(const void *p, size_t n)
+{
+    memcpy(&fdt_struct[fdt_struct_words], p, n);
+    fdt_struct_words += (n + 3) / 4;
+}
+
+static uint32_t fdt_string(const char *s)
+{
+    uint32_t off = fdt_strings_len;
+
+    strcpy(&fdt_strings[off], s);
+    fdt_strings_len += strlen(s) + 1;
+    return off;
+}
+
+static void begin_node(const char *name)
+{
+    fdt_emit(FDT_BEGIN_NODE);
+    fdt_emit_bytes(name, strlen(name) + 1);
+}
+
+static void end_node(void)
+{
+    fdt_emit(FDT_END_NODE);
+}
+
+static void prop(const char *name, const void *val, size_t len)
+{
+    fdt_emit(FDT_PROP);
+    fdt_emit(len);
+    fdt_emit(fdt_string(name));
+    fdt_emit_bytes(val, len);
+}
+
+static void prop_cells(const char *name, const uint32_t *cells, size_t n)
+{
+    uint32_t be[8];
+
+    for (size_t i = 0; i < n; i++)
+        be[i] = cpu_to_be32(cells[i]);
+    prop(name, be, n * 4);
+}
+
+#define prop_u32(name, v)   prop_cells(name, (const uint32_t[]){ v }, 1)
+#define prop_reg(name, ...)                                              \
+    prop_cells(name, (const uint32_t[]){ __VA_ARGS__ },                  \
+               sizeof((const uint32_t[]){ __VA_ARGS__ }) / 4)
+/* String literals, including "a\0b" lists, with their final NUL */
+#define prop_str(name, s)   prop(name, s, sizeof(s))
+
+/* Header, one /memreserve/ entry, structure block, strings block */
+static struct fdt_header *fdt_finish(void)
+{
+    struct fdt_header *h = (struct fdt_header *)fdt_blob;
+    uint32_t off_rsv = sizeof(*h);
+    uint32_t off_struct = off_rsv + 2 * 16;
+    uint32_t off_strings;
+    uint64_t *rsv = (uint64_t *)((char *)fdt_blob + off_rsv);
+
+    fdt_emit(FDT_END);
+    off_strings = off_struct + fdt_struct_words * 4;
+
+    memset(fdt_blob, 0, sizeof(fdt_blob));
+    rsv[0] = __builtin_bswap64(0x0);
+    rsv[1] = __builtin_bswap64(0x1000);
+    memcpy((char *)fdt_blob + off_struct, fdt_struct, fdt_struct_words * 4);
+    memcpy((char *)fdt_blob + off_strings, fdt_strings, fdt_strings_len);
+
+    h->magic = cpu_to_be32(FDT_MAGIC);
+    h->totalsize = cpu_to_be32(off_strings + fdt_strings_len);
+    h->off_dt_struct = cpu_to_be32(off_struct);
+    h->off_dt_strings = cpu_to_be32(off_strings);
+    h->off_mem_rsvmap = cpu_to_be32(off_rsv);
+    h->version = cpu_to_be32(17);
+    h->last_comp_version = cpu_to_be32(16);
+    h->size_dt_strings = cpu_to_be32(fdt_strings_len);
+    h->size_dt_struct = cpu_to_be32(fdt_struct_words * 4);
+    return h;
+}
+
+static struct fdt_header *build_rpi_tree(void)
+{
+    memset(fdt_struct, 0, sizeof(fdt_struct));
+    fdt_struct_words = 0;
+    fdt_strings_len = 0;
+
+    begin_node("");
+    prop_u32("#address-cells", 1);
+    prop_u32("#size-cells", 1);
+    prop_str("compatible", "raspberrypi,model-zero-2-w\0brcm,bcm2837");
+
+    begin_node("chosen");
+    prop_str("bootargs", "console=ttyAMA0,921600");
+    end_node();
+
+    begin_node("memory@0");
+    prop_str("device_type", "memory");
+    prop_reg("reg", 0x00000000, 0x1e000000);
+    end_node();
+
+    begin_node("soc");
+    prop_str("compatible", "simple-bus");
+    prop_u32("#address-cells", 1);
+    prop_u32("#size-cells", 1);
+    prop_reg("ranges", 0x7e000000, 0x3f000000, 0x01000000,
+                       0x40000000, 0x40000000, 0x00001000);
+
+    begin_node("timer@7e003000");
+    prop_str("compatible", "brcm,bcm2835-system-timer");
+    prop_reg("reg", 0x7e003000, 0x1000);
+    end_node();
+
+    begin_node("dma@7e007000");
+    prop_str("compatible", "brcm,bcm2835-dma");
+    prop_reg("reg", 0x7e007000, 0xf00);
+    prop_u32("brcm,dma-channel-mask", 0x7f35);
+    prop_u32("phandle", 5);
+    end_node();
+
+    begin_node("serial@7e201000");
+    prop_str("compatible", "arm,pl011\0arm,primecell");
+    prop_reg("reg", 0x7e201000, 0x200);
+    prop_str("status", "okay");
+    end_node();
+
+    begin_node("serial@7e215040");
+    prop_str("compatible", "brcm,bcm2835-aux-uart");
+    prop_reg("reg", 0x7e215040, 0x40);
+    prop_str("status", "disabled");
+    end_node();
+
+    begin_node("local_intc@40000000");
+    prop_str("compatible", "brcm,bcm2836-l1-intc");
+    prop_reg("reg", 0x40000000, 0x100);
+    end_node();
+
+    /* A bus without ranges: its children cannot be translated */
+    begin_node("hidden");
+    prop_u32("#address-cells", 1);
+    prop_u32("#size-cells", 0);
+    begin_node("dev@4");
+    prop_reg("reg", 4);
+    end_node();
+    end_node();
+
+    end_node();     /* soc */
+    end_node();     /* root */
+
+    return fdt_finish();
+}
+
+TEST(fdt_rejects_bad_blobs)
+{
+    struct fdt_header *h;
+
+    EXPECT_EQ(early_init_dt_scan(NULL), -1);
+
+    h = build_rpi_tree();
+    h->magic = 0;
+    EXPECT_EQ(early_init_dt_scan(h), -1);
+    EXPECT_TRUE(!of_have_populated_dt());
+
+    /* Structure block cut short: the END token is missing */
+    h = build_rpi_tree();
+    h->size_dt_struct = cpu_to_be32(fdt_struct_words * 4 - 4);
+    EXPECT_EQ(early_init_dt_scan(h), -1);
+    EXPECT_TRUE(of_find_node_by_path("/soc") == NULL);
+
+    /* A property claiming to run past the structure block */
+    h = build_rpi_tree();
+    h->size_dt_struct = cpu_to_be32(7 * 4);
+    EXPECT_EQ(early_init_dt_scan(h), -1);
+}
+
+TEST(fdt_finds_nodes_by_path)
+{
+    struct device_node *np;
+
+    EXPECT_EQ(early_init_dt_scan(build_rpi_tree()), 0);
+    EXPECT_TRUE(of_have_populated_dt());
+
+    np = of_find_node_by_path("/");
+    EXPECT_TRUE(np && np->parent == NULL);
+
+    np = of_find_node_by_path("/soc/serial@7e215040");
+    EXPECT_TRUE(np && !strcmp(np->name, "serial@7e215040"));
+
+    /* No unit address: the first serial node */
+    np = of_find_node_by_path("/soc/serial");
+    EXPECT_TRUE(np && !strcmp(np->name, "serial@7e201000"));
+
+    np = of_find_node_by_path("/soc/hidden/dev");
+    EXPECT_TRUE(np && !strcmp(np->parent->name, "hidden"));
+
+    EXPECT_TRUE(of_find_node_by_path("/soc/serial@7e2") == NULL);
+    EXPECT_TRUE(of_find_node_by_path("/timer@7e003000") == NULL);
+    EXPECT_TRUE(of_find_node_by_path("soc") == NULL);
+
+    early_init_dt_scan(NULL);
+}
+
+TEST(fdt_compatible_status_and_phandle)
+{
+    struct device_node *np;
+    uint32_t mask = 0;
+    int len = 0;
+
+    EXPECT_EQ(early_init_dt_scan(build_rpi_tree()), 0);
+
+    /* Second string of the compatible list */
+    np = of_find_compatible_node(NULL, "arm,primecell");
+    EXPECT_TRUE(np && !strcmp(np->name, "serial@7e201000"));
+    EXPECT_TRUE(of_device_is_available(np));
+    EXPECT_TRUE(of_find_compatible_node(np, "arm,primecell") == NULL);
+    /* Whole strings only */
+    EXPECT_TRUE(of_find_compatible_node(NULL, "arm,pl01") == NULL);
+
+    np = of_find_compatible_node(NULL, "brcm,bcm2835-aux-uart");
+    EXPECT_TRUE(np && !of_device_is_available(np));
+
+    np = of_find_node_by_phandle(5);
+    EXPECT_TRUE(np && of_device_is_compatible(np, "brcm,bcm2835-dma"));
+    EXPECT_EQ(of_property_read_u32(np, "brcm,dma-channel-mask", &mask), 0);
+    EXPECT_EQ(mask, 0x7f35);
+    EXPECT_EQ(of_property_read_u32(np, "missing", &mask), -1);
+    EXPECT_TRUE(of_get_property(np, "compatible", &len) != NULL);
+    EXPECT_EQ(len, sizeof("brcm,bcm2835-dma"));
+
+    EXPECT_TRUE(of_find_node_by_phandle(6) == NULL);
+
+    early_init_dt_scan(NULL);
+}
+
+TEST(fdt_translates_reg_through_ranges)
+{
+    struct device_node *np;
+    unsigned long pa = 0, size = 0;
+
+    EXPECT_EQ(early_init_dt_scan(build_rpi_tree()), 0);
+
+    np = of_find_compatible_node(NULL, "brcm,bcm2835-system-timer");
+    EXPECT_EQ(of_address_to_phys(np, 0, &pa, &size), 0);
+    EXPECT_EQ(pa, 0x3f003000);
+    EXPECT_EQ(size, 0x1000);
+    EXPECT_EQ(of_address_to_phys(np, 1, &pa, &size), -1);
+    EXPECT_TRUE(of_iomap(np, 0) == (void *)IO_ADDRESS(0x3f003000));
+
+    /* Second range of the soc bus */
+    np = of_find_compatible_node(NULL, "brcm,bcm2836-l1-intc");
+    EXPECT_EQ(of_address_to_phys(np, 0, &pa, NULL), 0);
+    EXPECT_EQ(pa, 0x40000000);
+
+    np = of_find_node_by_path("/soc/hidden/dev@4");
+    EXPECT_EQ(of_address_to_phys(np, 0, &pa, NULL), -1);
+    EXPECT_TRUE(of_iomap(np, 0) == NULL);
+    EXPECT_TRUE(of_iomap(NULL, 0) == NULL);
+
+    early_init_dt_scan(NULL);
+}
+
+TEST(fdt_reads_memory_and_bootargs)
+{
+    unsigned long saved_end = memory_end;
+
+    memory_end = RAM_END_PA;
+    strcpy(boot_command_line, "built-in");
+
+    EXPECT_EQ(early_init_dt_scan(build_rpi_tree()), 0);
+    EXPECT_EQ(memory_end, 0x1e000000);
+    EXPECT_TRUE(!strcmp(boot_command_line, "console=ttyAMA0,921600"));
+
+    early_init_dt_scan(NULL);
+    memory_end = saved_end;
+    boot_command_line[0] = '\0';
+}
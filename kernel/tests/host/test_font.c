@@ -0,0 +1,188 @@
+/*
+ * Glyph cache, text rendering and the framebuffer console
+ */
+
+#include <string.h>
+#include <serial_core.h>
+#include <kernel/fbcon.h>
+#include <kernel/font.h>
+#include <kernel/sched.h>
+#include "test.h"
+
+static unsigned int refreshes;
+/* Output that arrives while the panel refreshes */
+static const char *refresh_puts;
+
+static int fb_refresh_count(struct fb_info *info, const struct fb_rect *rect,
+                            int full)
+{
+    refreshes++;
+    if (refresh_puts) {
+        fbcon_puts(refresh_puts);
+        refresh_puts = NULL;
+    }
+    return 0;
+}
+
+static const struct fb_ops count_fbops = {
+    .fb_refresh = fb_refresh_count,
+};
+
+static uint8_t screen[64 * 32 / 2];
+static struct fb_info fb;
+
+static void setup(unsigned int width, unsigned int height, unsigned int format)
+{
+    memset(screen, 0, sizeof(screen));
+    refreshes = 0;
+    refresh_puts = NULL;
+    fb = (struct fb_info){
+        .name = "fake",
+        .width = width,
+        .height = height,
+        .format = format,
+        .screen_base = screen,
+        .fbops = &count_fbops,
+    };
+    EXPECT_EQ(register_framebuffer(&fb), 0);
+}
+
+/* Whether the cell at (@x, @y) shows @c at @scale in @fg on @bg */
+static int cell_is(unsigned int x, unsigned int y, char c, unsigned int scale,
+                   unsigned int fg, unsigned int bg)
+{
+    const uint8_t *bitmap = font_8x8.data + (c - font_8x8.first) * 8;
+    unsigned int r, col, ink;
+
+    for (r = 0; r < 8 * scale; r++) {
+        for (col = 0; col < 8 * scale; col++) {
+            ink = bitmap[r / scale] & (0x80 >> (col / scale));
+            if (fb_get_pixel(&fb, x + col, y + r) != (ink ? fg : bg))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+TEST(font_draws_opaque_cells_at_any_x)
+{
+    struct text_style style = { 1, FB_BLACK, FB_WHITE };
+
+    setup(64, 16, FB_FORMAT_MONO1);
+
+    EXPECT_EQ(fb_draw_text(&fb, 3, 2, "Ag", 2, &style), 16);
+    EXPECT_TRUE(cell_is(3, 2, 'A', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(11, 2, 'g', 1, FB_BLACK, FB_WHITE));
+
+    /* Nothing around the run changed */
+    EXPECT_EQ(fb_get_pixel(&fb, 2, 2), FB_BLACK);
+    EXPECT_EQ(fb_get_pixel(&fb, 19, 5), FB_BLACK);
+    EXPECT_EQ(screen[1 * 8], 0x00);
+    EXPECT_EQ(screen[10 * 8], 0x00);
+
+    EXPECT_EQ(fb.nr_dirty, 1);
+    EXPECT_EQ(fb.dirty[0].w, 24);
+}
+
+TEST(font_scales_and_expands_to_grey)
+{
+    struct text_style style = { 2, 0x5, FB_WHITE };
+
+    setup(64, 32, FB_FORMAT_GRAY2);
+    EXPECT_EQ(fb_draw_text(&fb, 6, 1, "#", 1, &style), 16);
+    EXPECT_TRUE(cell_is(6, 1, '#', 2, 5, FB_WHITE));
+
+    /* A 64-bit cell row is the limit */
+    setup(32, 32, FB_FORMAT_GRAY4);
+    style.scale = 3;
+    EXPECT_EQ(fb_draw_text(&fb, 0, 0, "x", 1, &style), 0);
+    style.scale = 2;
+    EXPECT_EQ(fb_draw_text(&fb, 1, 0, "x", 1, &style), 16);
+    EXPECT_TRUE(cell_is(1, 0, 'x', 2, 5, FB_WHITE));
+}
+
+TEST(font_clips_to_screen_edges)
+{
+    struct text_style style = { 1, FB_WHITE, FB_WHITE };
+
+    /* Rows of 3 bytes: the cell overhangs into the next row's bytes */
+    setup(20, 10, FB_FORMAT_MONO1);
+    EXPECT_EQ(fb_draw_text(&fb, 17, 5, "MM", 2, &style), 16);
+    EXPECT_EQ(screen[5 * 3 + 2], 0x70);       /* Pixels 17-19 */
+    EXPECT_EQ(screen[6 * 3], 0x00);
+    EXPECT_EQ(screen[9 * 3 + 2], 0x70);
+    EXPECT_EQ(screen[4 * 3 + 2], 0x00);
+}
+
+TEST(glyph_cache_hits_on_repeated_characters)
+{
+    struct text_style style = { 1, FB_BLACK, FB_WHITE };
+    struct glyph_cache_stats before, after;
+
+    setup(64, 16, FB_FORMAT_MONO1);
+    glyph_cache_flush();
+    glyph_cache_get_stats(&before);
+
+    fb_draw_text(&fb, 0, 0, "abab", 4, &style);
+    glyph_cache_get_stats(&after);
+    EXPECT_EQ(after.misses - before.misses, 2);
+    EXPECT_EQ(after.hits - before.hits, 2);
+
+    /* Same characters, other size: new glyphs */
+    style.scale = 2;
+    fb_draw_text(&fb, 0, 0, "ab", 2, &style);
+    glyph_cache_get_stats(&after);
+    EXPECT_EQ(after.misses - before.misses, 4);
+    EXPECT_TRUE(cell_is(0, 0, 'a', 2, FB_BLACK, FB_WHITE));
+}
+
+TEST(fbcon_mirrors_uart_wraps_and_scrolls)
+{
+    setup(32, 24, FB_FORMAT_MONO1);             /* 4 x 3 cells */
+    EXPECT_EQ(fbcon_init(&fb, 1), 0);
+    EXPECT_EQ(fb_get_pixel(&fb, 31, 23), FB_WHITE);
+
+    /* Only queued; the fbcon thread draws it and refreshes the panel */
+    uart_poll_puts("abcde\n");
+    EXPECT_TRUE(cell_is(0, 0, ' ', 1, FB_BLACK, FB_WHITE));
+    EXPECT_EQ(refreshes, 0);
+    schedule();
+    EXPECT_TRUE(cell_is(0, 0, 'a', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(24, 0, 'd', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(0, 8, 'e', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(refreshes > 0);
+    EXPECT_EQ(fb.nr_dirty, 0);
+
+    /*
+     * The third line fills the screen, the next newline scrolls it.
+     * "i" comes in during the refresh: the same thread draws it and
+     * refreshes again.
+     */
+    refreshes = 0;
+    fbcon_puts("fg\nh");
+    refresh_puts = "i";
+    schedule();
+    EXPECT_EQ(refreshes, 2);
+    EXPECT_EQ(fb.nr_dirty, 0);
+    EXPECT_TRUE(cell_is(0, 0, 'e', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(0, 8, 'f', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(8, 16, 'i', 1, FB_BLACK, FB_WHITE));
+
+    /* The tab runs to the end of the line, so 'j' wraps and scrolls */
+    refreshes = 0;
+    fbcon_puts("\n\tj");
+    fbcon_flush();
+    EXPECT_EQ(refreshes, 0);
+    EXPECT_TRUE(cell_is(0, 0, 'h', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(0, 8, ' ', 1, FB_BLACK, FB_WHITE));
+    EXPECT_TRUE(cell_is(0, 16, 'j', 1, FB_BLACK, FB_WHITE));
+
+    /* Queued when the console stops: never drawn */
+    fbcon_puts("k");
+    fbcon_exit();
+    uart_poll_puts("z");
+    schedule();
+    EXPECT_TRUE(cell_is(8, 16, ' ', 1, FB_BLACK, FB_WHITE));
+    EXPECT_EQ(refreshes, 0);
+    EXPECT_EQ(fbcon_init(&fb, 5), -1);
+}
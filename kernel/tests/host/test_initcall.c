@@ -0,0 +1,159 @@
+/*
+ * Initcall ordering, failure handling and async calls
+ *
+ * Tables are built here rather than taken from the linker, and the
+ * scheduler is replaced by a queue that schedule() drains, which is
+ * what the cooperative scheduler does for threads that never yield.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <kernel/init.h>
+#include <kernel/sched.h>
+#include "test.h"
+
+uint64_t host_cntvct;
+
+/* Laid out by the kernel linker script; do_initcalls() is not tested */
+const struct initcall __initcall_start[1], __initcall_end[1];
+
+/* kernel/sched/core.c is not built for the host */
+static struct task_struct stub_task;
+static int (*stub_thread_fn[MAX_THREADS])(void *);
+static void *stub_thread_arg[MAX_THREADS];
+static int stub_threads, stub_threads_started;
+
+struct task_struct *kthread_run(int (*fn)(void *), void *arg, const char *name)
+{
+    if (stub_threads == MAX_THREADS)
+        return NULL;
+    stub_thread_fn[stub_threads] = fn;
+    stub_thread_arg[stub_threads] = arg;
+    stub_threads++;
+    stub_threads_started++;
+    return &stub_task;
+}
+
+void schedule(void)
+{
+    while (stub_threads) {
+        stub_threads--;
+        stub_thread_fn[stub_threads](stub_thread_arg[stub_threads]);
+    }
+}
+
+static char order[16];
+static unsigned int order_len;
+
+static void reset(void)
+{
+    memset(order, 0, sizeof(order));
+    order_len = 0;
+    stub_threads = stub_threads_started = 0;
+}
+
+#define DEFINE_CALL(_c, _ret, _usecs)                                    \
+    static int call_##_c(void)                                           \
+    {                                                                    \
+        order[order_len++] = #_c[0];                                     \
+        host_cntvct += (_usecs);                                         \
+        return (_ret);                                                   \
+    }
+
+DEFINE_CALL(a, 0, 10)
+DEFINE_CALL(b, 0, 250)
+DEFINE_CALL(c, 0, 1)
+DEFINE_CALL(d, 0, 1)
+DEFINE_CALL(e, 0, 1)
+DEFINE_CALL(f, -1, 40)
+
+#define CALL(_c, _level, _flags, ...)                                    \
+    {                                                                    \
+        .name    = "call_" #_c,                                          \
+        .fn      = call_##_c,                                            \
+        .deps    = (const char *const[]){ __VA_ARGS__ },                 \
+        .nr_deps = sizeof((const char *const[]){ __VA_ARGS__ }) /        \
+                   sizeof(char *),                                       \
+        .level   = (_level),                                             \
+        .flags   = (_flags),                                             \
+    }
+
+TEST(initcall_runs_levels_in_dependency_order)
+{
+    const struct initcall table[] = {
+        CALL(a, 1, 0, "call_c", "call_b"),
+        CALL(b, 1, 0),
+        CALL(c, 1, 0, "call_b"),
+        /* Depending on an earlier level is always satisfied */
+        CALL(d, 3, 0, "call_a"),
+        CALL(e, 3, 0),
+    };
+
+    reset();
+    EXPECT_EQ(do_initcall_table(table, table + 5), 0);
+    EXPECT_TRUE(!strcmp(order, "bcade"));
+
+    EXPECT_EQ(initcall_usecs("call_b"), 250);
+    EXPECT_EQ(initcall_usecs("call_a"), 10);
+    EXPECT_EQ(initcall_usecs("call_x"), -1);
+}
+
+TEST(initcall_skips_dependents_of_failed_calls)
+{
+    const struct initcall table[] = {
+        CALL(a, 1, 0, "call_f"),
+        CALL(f, 1, 0),
+        /* Transitively */
+        CALL(b, 1, 0, "call_a"),
+        CALL(c, 1, 0, "call_nonexistent"),
+        CALL(d, 1, 0),
+        /* Later levels still run */
+        CALL(e, 6, 0, "call_d"),
+    };
+
+    reset();
+    EXPECT_EQ(do_initcall_table(table, table + 6), -1);
+    EXPECT_TRUE(!strcmp(order, "fde"));
+
+    /* Failed calls still have their time recorded */
+    EXPECT_EQ(initcall_usecs("call_f"), 40);
+    EXPECT_EQ(initcall_usecs("call_a"), -1);
+    EXPECT_EQ(initcall_usecs("call_c"), -1);
+}
+
+TEST(initcall_skips_unresolvable_dependencies)
+{
+    const struct initcall table[] = {
+        /* A cycle */
+        CALL(a, 1, 0, "call_b"),
+        CALL(b, 1, 0, "call_a"),
+        /* A later level can never have run */
+        CALL(c, 1, 0, "call_d"),
+        CALL(e, 1, 0),
+        CALL(d, 3, 0),
+    };
+
+    reset();
+    EXPECT_EQ(do_initcall_table(table, table + 5), -1);
+    EXPECT_TRUE(!strcmp(order, "ed"));
+}
+
+TEST(initcall_async_calls_run_in_threads)
+{
+    const struct initcall table[] = {
+        /* Too early for a thread: runs inline */
+        CALL(a, 1, INITCALL_ASYNC),
+        CALL(b, 6, INITCALL_ASYNC),
+        CALL(c, 6, 0, "call_b"),
+        CALL(d, 6, 0),
+        /* Waits for the level's threads to finish */
+        CALL(e, 7, 0),
+    };
+
+    reset();
+    EXPECT_EQ(do_initcall_table(table, table + 5), 0);
+    EXPECT_EQ(stub_threads_started, 1);
+    /* d goes ahead while b is still queued; c waits for it */
+    EXPECT_TRUE(!strcmp(order, "adbce"));
+    EXPECT_EQ(initcall_usecs("call_b"), 250);
+}
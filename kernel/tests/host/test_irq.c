@@ -0,0 +1,142 @@
+/*
+ * IRQ core: action chain management and flow handlers
+ */
+
+#include <stddef.h>
+#include <kernel/irq_chip.h>
+#include "test.h"
+
+#define TEST_IRQ    42
+
+static int mask_calls, unmask_calls;
+static int calls[3];
+static int call_order[3], call_seq;
+
+static void stub_mask(struct irq_data *d)   { mask_calls++; }
+static void stub_unmask(struct irq_data *d) { unmask_calls++; }
+
+static struct irq_chip stub_chip = {
+    .name       = "stub-chip",
+    .irq_mask   = stub_mask,
+    .irq_unmask = stub_unmask,
+};
+
+static irqreturn_t handler(unsigned int irq, void *dev_id)
+{
+    int *slot = dev_id;
+    int idx = slot - calls;
+
+    (*slot)++;
+    call_order[call_seq++] = idx;
+    /* Only device 1 claims the interrupt */
+    return idx == 1 ? IRQ_HANDLED : IRQ_NONE;
+}
+
+static void reset(void)
+{
+    irq_init();
+    mask_calls = unmask_calls = 0;
+    call_seq = 0;
+    for (int i = 0; i < 3; i++)
+        calls[i] = call_order[i] = 0;
+}
+
+TEST(request_irq_rejects_bad_arguments)
+{
+    reset();
+    EXPECT_EQ(request_irq(NR_IRQS, handler, 0, &calls[0]), -1);
+    EXPECT_EQ(request_irq(TEST_IRQ, NULL, 0, &calls[0]), -1);
+    EXPECT_TRUE(irq_get_desc(NR_IRQS) == NULL);
+}
+
+TEST(request_irq_chains_newest_first)
+{
+    struct irq_desc *desc;
+
+    reset();
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(request_irq(TEST_IRQ, handler, IRQF_SHARED, &calls[i]), 0);
+
+    desc = irq_get_desc(TEST_IRQ);
+    EXPECT_EQ(handle_irq_event(desc), IRQ_HANDLED);
+    EXPECT_EQ(call_seq, 3);
+    EXPECT_EQ(call_order[0], 2);
+    EXPECT_EQ(call_order[1], 1);
+    EXPECT_EQ(call_order[2], 0);
+}
+
+TEST(free_irq_unlinks_matching_dev_id)
+{
+    struct irq_desc *desc;
+
+    reset();
+    for (int i = 0; i < 3; i++)
+        request_irq(TEST_IRQ, handler, IRQF_SHARED, &calls[i]);
+
+    free_irq(TEST_IRQ, &calls[1]);
+    /* Unknown dev_id and out-of-range IRQ are ignored */
+    free_irq(TEST_IRQ, &mask_calls);
+    free_irq(NR_IRQS, &calls[0]);
+
+    desc = irq_get_desc(TEST_IRQ);
+    EXPECT_EQ(handle_irq_event(desc), IRQ_NONE);
+    EXPECT_EQ(calls[0], 1);
+    EXPECT_EQ(calls[1], 0);
+    EXPECT_EQ(calls[2], 1);
+
+    free_irq(TEST_IRQ, &calls[0]);
+    free_irq(TEST_IRQ, &calls[2]);
+    EXPECT_TRUE(desc->action == NULL);
+}
+
+TEST(generic_handle_irq_counts_and_dispatches)
+{
+    reset();
+    irq_set_chip_and_handler(TEST_IRQ, &stub_chip, handle_simple_irq);
+    request_irq(TEST_IRQ, handler, 0, &calls[1]);
+
+    generic_handle_irq(TEST_IRQ);
+    generic_handle_irq(TEST_IRQ);
+    generic_handle_irq(NR_IRQS);
+
+    EXPECT_EQ(irq_get_desc(TEST_IRQ)->irq_count, 2);
+    EXPECT_EQ(calls[1], 2);
+    /* The simple flow handler never touches the chip */
+    EXPECT_EQ(mask_calls, 0);
+    EXPECT_EQ(unmask_calls, 0);
+}
+
+TEST(handle_level_irq_masks_around_handler)
+{
+    reset();
+    irq_set_chip_and_handler(TEST_IRQ, &stub_chip, handle_level_irq);
+    request_irq(TEST_IRQ, handler, 0, &calls[0]);
+
+    generic_handle_irq(TEST_IRQ);
+
+    EXPECT_EQ(calls[0], 1);
+    EXPECT_EQ(mask_calls, 1);
+    EXPECT_EQ(unmask_calls, 1);
+}
+
+static unsigned int seen_irq;
+
+static irqreturn_t record_irq(unsigned int irq, void *dev_id)
+{
+    seen_irq = irq;
+    return IRQ_HANDLED;
+}
+
+TEST(irq_set_hwirq_reaches_handler)
+{
+    struct irq_desc *desc;
+
+    reset();
+    irq_set_hwirq(TEST_IRQ, 7);
+    request_irq(TEST_IRQ, record_irq, 0, NULL);
+    desc = irq_get_desc(TEST_IRQ);
+
+    EXPECT_EQ(handle_irq_event(desc), IRQ_HANDLED);
+    EXPECT_EQ(seen_irq, 7);
+    EXPECT_EQ(desc->irq_data.irq, TEST_IRQ);
+}
@@ -0,0 +1,34 @@
+/*
+ * Jiffies arithmetic
+ */
+
+#include <kernel/jiffies.h>
+#include <kernel/timekeeping.h>
+#include "test.h"
+
+TEST(time_after_plain)
+{
+    EXPECT_TRUE(time_after(11UL, 10UL));
+    EXPECT_TRUE(!time_after(10UL, 10UL));
+    EXPECT_TRUE(!time_after(9UL, 10UL));
+    EXPECT_TRUE(time_before(9UL, 10UL));
+}
+
+TEST(time_after_across_wraparound)
+{
+    uint64_t before_wrap = ~0UL - 5;
+    uint64_t after_wrap = 4;
+
+    EXPECT_TRUE(time_after(after_wrap, before_wrap));
+    EXPECT_TRUE(time_before(before_wrap, after_wrap));
+    EXPECT_TRUE(!time_after(before_wrap, after_wrap));
+}
+
+TEST(do_timer_advances_jiffies)
+{
+    uint64_t start = jiffies_64;
+
+    do_timer(1);
+    do_timer(3);
+    EXPECT_EQ(jiffies_64 - start, 4);
+}
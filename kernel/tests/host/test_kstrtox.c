@@ -0,0 +1,38 @@
+/*
+ * Command line number parsing
+ */
+
+#include <kernel/kstrtox.h>
+#include "test.h"
+
+TEST(kstrtouint_bases)
+{
+    unsigned int val = 0;
+
+    EXPECT_EQ(kstrtouint("921600", 10, &val), 0);
+    EXPECT_EQ(val, 921600);
+    EXPECT_EQ(kstrtouint("0x3F201000", 0, &val), 0);
+    EXPECT_EQ(val, 0x3F201000);
+    EXPECT_EQ(kstrtouint("ff", 16, &val), 0);
+    EXPECT_EQ(val, 0xFF);
+    EXPECT_EQ(kstrtouint("017", 0, &val), 0);
+    EXPECT_EQ(val, 017);
+    EXPECT_EQ(kstrtouint("0", 0, &val), 0);
+    EXPECT_EQ(val, 0);
+}
+
+TEST(kstrtouint_rejects_malformed)
+{
+    unsigned int val = 42;
+
+    EXPECT_EQ(kstrtouint("", 10, &val), -1);
+    EXPECT_EQ(kstrtouint("0x", 0, &val), -1);
+    EXPECT_EQ(kstrtouint("115200n8", 10, &val), -1);
+    EXPECT_EQ(kstrtouint("19", 8, &val), -1);
+    EXPECT_EQ(kstrtouint("4294967296", 10, &val), -1);
+    /* Failed conversions leave the result alone */
+    EXPECT_EQ(val, 42);
+
+    EXPECT_EQ(kstrtouint("4294967295", 10, &val), 0);
+    EXPECT_EQ(val, 0xFFFFFFFFU);
+}
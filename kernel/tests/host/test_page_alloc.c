@@ -0,0 +1,78 @@
+/*
+ * Physical page allocator
+ */
+
+#include <kernel/mm.h>
+#include <asm/memory.h>
+#include "test.h"
+
+#define TEST_START  0x00100000UL
+#define TEST_END    0x00400000UL    /* 768 pages */
+#define TEST_PAGES  ((TEST_END - TEST_START) >> PAGE_SHIFT)
+
+TEST(page_alloc_orders_are_naturally_aligned)
+{
+    unsigned long pa;
+    unsigned int order;
+
+    page_alloc_init(TEST_START, TEST_END);
+
+    for (order = 0; order <= 8; order++) {
+        pa = __alloc_pages(order);
+        EXPECT_TRUE(pa != 0);
+        EXPECT_EQ(pa & ((PAGE_SIZE << order) - 1), 0);
+        EXPECT_TRUE(pa >= TEST_START && pa + (PAGE_SIZE << order) <= TEST_END);
+    }
+
+    /* A 2MB block-mappable run */
+    page_alloc_init(TEST_START, TEST_END);
+    EXPECT_EQ(__alloc_pages(9), 0x00200000UL);
+}
+
+TEST(page_alloc_exhausts_and_reuses_freed_pages)
+{
+    unsigned long first, pa;
+    unsigned long n = 0;
+
+    page_alloc_init(TEST_START, TEST_END);
+    EXPECT_EQ(nr_free_pages(), TEST_PAGES);
+
+    first = __alloc_pages(0);
+    EXPECT_EQ(first, TEST_START);
+    n++;
+    while (__alloc_pages(0))
+        n++;
+
+    EXPECT_EQ(n, TEST_PAGES);
+    EXPECT_EQ(nr_free_pages(), 0);
+
+    __free_pages(first + 5 * PAGE_SIZE, 0);
+    EXPECT_EQ(nr_free_pages(), 1);
+    pa = __alloc_pages(0);
+    EXPECT_EQ(pa, first + 5 * PAGE_SIZE);
+    EXPECT_EQ(__alloc_pages(0), 0);
+}
+
+TEST(page_alloc_skips_reserved_ranges)
+{
+    unsigned long pa;
+
+    page_alloc_init(TEST_START, TEST_END);
+    /* Reserve the first 2MB-aligned run so an order-9 request must fail */
+    page_alloc_reserve(0x00200000UL, PAGE_SIZE);
+    EXPECT_EQ(nr_free_pages(), TEST_PAGES - 1);
+    EXPECT_EQ(__alloc_pages(9), 0);
+
+    /* Smaller orders still fit around the hole */
+    pa = __alloc_pages(8);
+    EXPECT_EQ(pa, TEST_START);
+    pa = __alloc_pages(8);
+    EXPECT_EQ(pa, 0x00300000UL);
+}
+
+TEST(page_alloc_unaligned_bounds_are_trimmed)
+{
+    page_alloc_init(TEST_START + 1, TEST_END + PAGE_SIZE - 1);
+    EXPECT_EQ(nr_free_pages(), TEST_PAGES - 1);
+    EXPECT_EQ(__alloc_pages(0), TEST_START + PAGE_SIZE);
+}
@@ -0,0 +1,82 @@
+/*
+ * PL011 baud rate divisors and register programming
+ */
+
+#include <amba/serial.h>
+#include <serial_core.h>
+#include "mmio_stub.h"
+#include "test.h"
+
+extern void pl011_register(void);
+
+#define REG(off)    pl011_fake_regs[(off) / 4]
+
+/*
+ * Expected values follow the PL011 TRM: divisor = uartclk / (16 * baud),
+ * IBRD is the integer part, FBRD = round(fraction * 64).
+ */
+TEST(pl011_divisors_48mhz)
+{
+    EXPECT_EQ(PL011_IBRD(48000000U, 115200U), 26);
+    EXPECT_EQ(PL011_FBRD(48000000U, 115200U), 3);
+
+    EXPECT_EQ(PL011_IBRD(48000000U, 9600U), 312);
+    EXPECT_EQ(PL011_FBRD(48000000U, 9600U), 32);
+
+    EXPECT_EQ(PL011_IBRD(48000000U, 921600U), 3);
+    EXPECT_EQ(PL011_FBRD(48000000U, 921600U), 16);
+}
+
+TEST(pl011_divisors_stay_in_range)
+{
+    static const unsigned int bauds[] = {
+        300, 1200, 9600, 19200, 38400, 57600, 115200,
+        230400, 460800, 921600, 1000000, 1500000, 3000000,
+    };
+
+    for (unsigned int i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++)
+        {
+        unsigned int ibrd = PL011_IBRD(PL011_UART_CLOCK_HZ, bauds[i]);
+        unsigned int fbrd = PL011_FBRD(PL011_UART_CLOCK_HZ, bauds[i]);
+
+        EXPECT_TRUE(fbrd < 64);
+        EXPECT_TRUE(ibrd >= 1 && ibrd <= 0xFFFF);
+    }
+}
+
+TEST(pl011_startup_programs_registers)
+{
+    pl011_register();
+
+    EXPECT_EQ(REG(UARTIBRD), PL011_IBRD(PL011_UART_CLOCK_HZ, PL011_DEFAULT_BAUD));
+    EXPECT_EQ(REG(UARTFBRD), PL011_FBRD(PL011_UART_CLOCK_HZ, PL011_DEFAULT_BAUD));
+    /* 8 bits, FIFO enabled */
+    EXPECT_EQ(REG(UARTLCR_H), (3 << 5) | (1 << 4));
+    /* UARTEN | TXE | RXE */
+    EXPECT_EQ(REG(UARTCR), (1 << 0) | (1 << 8) | (1 << 9));
+
+    uart_poll_putc('A');
+    EXPECT_EQ(REG(UARTDR), 'A');
+}
+
+TEST(pl011_set_baud_reprograms_divisors)
+{
+    pl011_register();
+
+    EXPECT_EQ(uart_set_baud(921600), 0);
+    EXPECT_EQ(uart_get_baud(), 921600);
+    EXPECT_EQ(REG(UARTIBRD), 3);
+    EXPECT_EQ(REG(UARTFBRD), 16);
+    /* LCR_H rewritten with FIFO enabled to latch the divisors */
+    EXPECT_EQ(REG(UARTLCR_H), UARTLCR_H_WLEN_8 | UARTLCR_H_FEN);
+    EXPECT_EQ(REG(UARTCR), UARTCR_UARTEN | UARTCR_TXE | UARTCR_RXE);
+
+    /* 48MHz / 16 is the fastest rate; IBRD would be 0 above that */
+    EXPECT_EQ(uart_set_baud(3000000), 0);
+    EXPECT_EQ(REG(UARTIBRD), 1);
+    EXPECT_EQ(uart_set_baud(4000000), -1);
+    EXPECT_EQ(uart_set_baud(0), -1);
+    EXPECT_EQ(uart_get_baud(), 3000000);
+
+    EXPECT_EQ(uart_set_baud(PL011_DEFAULT_BAUD), 0);
+}
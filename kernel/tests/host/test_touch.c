@@ -0,0 +1,113 @@
+/*
+ * Touch event queue
+ */
+
+#include <input/touch.h>
+#include "test.h"
+
+static void report(uint16_t x, uint8_t id, uint8_t type)
+{
+    struct touch_event ev = { .x = x, .y = 2 * x, .id = id, .type = type };
+
+    touch_report(&ev);
+}
+
+static void drain(void)
+{
+    struct touch_event ev;
+
+    while (!touch_get_event(&ev))
+        ;
+}
+
+TEST(touch_events_come_out_in_order)
+{
+    struct touch_event ev;
+
+    drain();
+    report(10, 0, TOUCH_DOWN);
+    report(11, 0, TOUCH_MOVE);
+    report(12, 0, TOUCH_UP);
+
+    EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_DOWN);
+    EXPECT_EQ(ev.x, 10);
+    EXPECT_EQ(ev.y, 20);
+    EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_MOVE);
+    EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_UP);
+    EXPECT_EQ(ev.x, 12);
+    EXPECT_EQ(touch_get_event(&ev), -1);
+}
+
+TEST(touch_full_queue_merges_moves_and_drops_the_rest)
+{
+    struct touch_event ev;
+    unsigned long dropped;
+    unsigned int i, n = TOUCH_QUEUE_SIZE - TOUCH_LIFT_RESERVE;
+
+    drain();
+    dropped = touch_dropped();
+
+    report(0, 1, TOUCH_DOWN);
+    for (i = 1; i < n; i++)
+        report(i, 1, TOUCH_MOVE);
+
+    /* The newest move takes the last one's place */
+    report(500, 1, TOUCH_MOVE);
+    EXPECT_EQ(touch_dropped(), dropped);
+    /* Another contact's move, or a touch, has nothing to merge with */
+    report(600, 2, TOUCH_MOVE);
+    report(700, 3, TOUCH_DOWN);
+    EXPECT_EQ(touch_dropped(), dropped + 2);
+
+    for (i = 0; i < n; i++)
+        EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_MOVE);
+    EXPECT_EQ(ev.x, 500);
+    EXPECT_EQ(touch_get_event(&ev), -1);
+
+    /* Room again */
+    report(800, 1, TOUCH_UP);
+    EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.x, 800);
+}
+
+TEST(touch_lifts_are_never_lost)
+{
+    struct touch_event ev;
+    unsigned long dropped;
+    unsigned int i, n = TOUCH_QUEUE_SIZE - TOUCH_LIFT_RESERVE;
+
+    drain();
+    dropped = touch_dropped();
+
+    /* Moves fill the queue up to the reserve, lifts go into it */
+    for (i = 0; i < n; i++)
+        report(i, i % 2, TOUCH_MOVE);
+    report(1000, 0, TOUCH_UP);
+    for (i = 1; i < TOUCH_LIFT_RESERVE; i++)
+        report(1000 + i, 2, TOUCH_UP);
+    EXPECT_EQ(touch_dropped(), dropped);
+
+    /* Completely full: contact 1's lift replaces its newest move */
+    report(2000, 1, TOUCH_UP);
+    EXPECT_EQ(touch_dropped(), dropped);
+    /* Nothing of contact 7 queued to replace */
+    report(3000, 7, TOUCH_UP);
+    EXPECT_EQ(touch_dropped(), dropped + 1);
+
+    for (i = 0; i < n - 1; i++)
+        EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_MOVE);
+    EXPECT_EQ(ev.x, n - 2);
+    EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_UP);
+    EXPECT_EQ(ev.id, 1);
+    EXPECT_EQ(ev.x, 2000);
+    EXPECT_EQ(touch_get_event(&ev), 0);
+    EXPECT_EQ(ev.type, TOUCH_UP);
+    EXPECT_EQ(ev.x, 1000);
+    drain();
+}
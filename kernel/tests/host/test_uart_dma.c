@@ -0,0 +1,140 @@
+/*
+ * PL011 DMA transmit from the serial core log ring
+ */
+
+#include <string.h>
+#include <amba/serial.h>
+#include <serial_core.h>
+#include <dma/bcm2837_dma.h>
+#include "dma_stub.h"
+#include "mmio_stub.h"
+#include "test.h"
+
+extern void pl011_register(void);
+extern int pl011_dma_probe(void);
+
+#define REG(off)    pl011_fake_regs[(off) / 4]
+
+static void uart_dma_setup(void)
+{
+    memset(pl011_fake_regs, 0, sizeof(pl011_fake_regs));
+    dma_stub_reset();
+    pl011_register();
+    pl011_dma_probe();
+}
+
+static void fill_pattern(char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        buf[i] = 'a' + i % 26;
+}
+
+TEST(uart_dma_probe_enables_tx_dma)
+{
+    uart_dma_setup();
+
+    EXPECT_EQ(REG(UARTDMACR), UARTDMACR_TXDMAE);
+}
+
+TEST(uart_dma_write_queues_one_word_per_char)
+{
+    struct dma_desc *desc;
+    const uint32_t *words;
+
+    uart_dma_setup();
+    uart_write("hi\n", 3);
+
+    EXPECT_EQ(dma_stub_pending(), 1);
+    desc = dma_stub_pending_desc(0);
+    EXPECT_EQ(desc->dir, DMA_MEM_TO_DEV);
+    EXPECT_EQ(desc->dreq, BCM2837_DREQ_UART_TX);
+    EXPECT_EQ(desc->dev_addr, 0x7E201000);
+    EXPECT_EQ(desc->nents, 1);
+    /* "\n" went into the ring as "\r\n" */
+    EXPECT_EQ(desc->sg[0].len, 4 * sizeof(uint32_t));
+
+    words = dma_stub_bus_to_virt(desc->sg[0].addr);
+    EXPECT_EQ(words[0], 'h');
+    EXPECT_EQ(words[1], 'i');
+    EXPECT_EQ(words[2], '\r');
+    EXPECT_EQ(words[3], '\n');
+
+    uart_flush();
+    EXPECT_EQ(dma_stub_pending(), 0);
+    EXPECT_EQ(dma_stub_tx_len, 4);
+}
+
+TEST(uart_dma_keeps_two_buffers_in_flight)
+{
+    static char buf[3000];
+    const uint32_t *words;
+
+    uart_dma_setup();
+    fill_pattern(buf, sizeof(buf));
+    uart_write(buf, sizeof(buf));
+
+    /* Double-buffered: two full buffers queued, the rest in the ring */
+    EXPECT_EQ(dma_stub_pending(), 2);
+    EXPECT_EQ(dma_stub_pending_desc(0)->sg[0].len, 1024 * sizeof(uint32_t));
+    EXPECT_EQ(dma_stub_pending_desc(1)->sg[0].len, 1024 * sizeof(uint32_t));
+
+    /* The first completion refills its buffer and queues it again */
+    dma_stub_complete_one();
+    EXPECT_EQ(dma_stub_pending(), 2);
+    EXPECT_EQ(dma_stub_pending_desc(1)->sg[0].len, (3000 - 2048) * sizeof(uint32_t));
+    words = dma_stub_bus_to_virt(dma_stub_pending_desc(1)->sg[0].addr);
+    EXPECT_EQ(words[0], buf[2048]);
+
+    uart_flush();
+    EXPECT_EQ(dma_stub_pending(), 0);
+    EXPECT_EQ(dma_stub_tx_len, sizeof(buf));
+    EXPECT_TRUE(memcmp(dma_stub_tx_log, buf, sizeof(buf)) == 0);
+}
+
+TEST(uart_dma_write_larger_than_ring)
+{
+    static char buf[40000];
+
+    uart_dma_setup();
+    fill_pattern(buf, sizeof(buf));
+
+    /* More than the 16KB ring: uart_write() has to wait for DMA */
+    EXPECT_EQ(uart_write(buf, sizeof(buf)), sizeof(buf));
+    uart_flush();
+
+    EXPECT_EQ(dma_stub_tx_len, sizeof(buf));
+    EXPECT_TRUE(memcmp(dma_stub_tx_log, buf, sizeof(buf)) == 0);
+}
+
+TEST(uart_dma_poll_and_write_share_the_ring)
+{
+    uart_dma_setup();
+
+    uart_write("ab", 2);
+    uart_poll_puts("cd\n");
+    uart_poll_putc('e');
+    uart_poll_put_dec(42);
+    uart_write("f", 1);
+
+    /* Nothing went around the ring to the FIFO */
+    EXPECT_EQ(REG(UARTDR), 0);
+    EXPECT_TRUE(dma_stub_pending() > 0);
+
+    uart_flush();
+    EXPECT_EQ(dma_stub_tx_len, 10);
+    EXPECT_TRUE(memcmp(dma_stub_tx_log, "abcd\r\ne42f", 10) == 0);
+}
+
+TEST(uart_dma_sync_puts_flushes_the_ring_first)
+{
+    uart_dma_setup();
+
+    uart_poll_puts("queued");
+    EXPECT_TRUE(dma_stub_pending() > 0);
+
+    uart_sync_puts("!");
+    EXPECT_EQ(dma_stub_pending(), 0);
+    EXPECT_EQ(dma_stub_tx_len, 6);
+    EXPECT_TRUE(memcmp(dma_stub_tx_log, "queued", 6) == 0);
+    EXPECT_EQ(REG(UARTDR), '!');
+}